@@ -7,6 +7,7 @@
 #include "APICommon.h"
 #include "ResourceIDs.hpp"
 #include "TopoMeshPalette.hpp"
+#include "AttributeCache.hpp"
 
 // -----------------------------------------------------------------------------
 // MenuCommandHandler
@@ -61,7 +62,15 @@ GSErrCode Initialize ()
 		return err;
 
 	err = TopoMeshPalette::RegisterPaletteControlCallBack();
-	return err;
+	if (err != NoError)
+		return err;
+
+	// Сброс кэша слоёв палитры при смене проекта и замене атрибутов. Без
+	// уведомлений кэш всё равно сверяется с проектом — add-on работает дальше
+	err = AttributeCache::RegisterNotifications();
+	if (err != NoError)
+		ACAPI_WriteReport("[TopoMesh] Уведомления кэша атрибутов не подключены: %d", false, (int)err);
+	return NoError;
 }
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+// Boundary.cpp
+#include "Boundary.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace Boundary {
+
+	using PathEngine::Seg;
+
+	// Полос не больше этого: память O(рёбра + полосы) и на огромных контурах
+	static constexpr Int32 kMaxBands = 4096;
+
+	bool IsBoundaryType(API_ElemTypeID tid)
+	{
+		switch (tid) {
+		case API_HatchID:
+		case API_SlabID:
+		case API_PolyLineID:
+		case API_CircleID:
+		case API_SplineID:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	static inline API_Coord SegBegin(const Seg& s)
+	{
+		if (s.kind == Seg::Line) return s.a;
+		return { s.c.x + s.r * std::cos(s.a0), s.c.y + s.r * std::sin(s.a0) };
+	}
+
+	static inline API_Coord SegEnd(const Seg& s)
+	{
+		if (s.kind == Seg::Line) return s.b;
+		return { s.c.x + s.r * std::cos(s.a1), s.c.y + s.r * std::sin(s.a1) };
+	}
+
+	bool Region::Build(const API_Guid& guid, double chordTolM)
+	{
+		API_Elem_Head head = {};
+		head.guid = guid;
+		if (ACAPI_Element_GetHeader(&head) != NoError || !IsBoundaryType(head.type.typeID)) {
+			m_edges.clear();
+			return false;
+		}
+
+		std::vector<Seg> segs;
+		if (head.type.typeID == API_HatchID || head.type.typeID == API_SlabID) {
+			// контуры многоугольника замкнуты: последняя точка = первой
+			API_ElementMemo memo = {};
+			if (ACAPI_Element_GetMemo(guid, &memo, APIMemoMask_Polygon) == NoError)
+				PathEngine::AppendPolyMemoSegments(memo, segs);
+			ACAPI_DisposeElemMemoHdls(&memo);
+		}
+		else {
+			double len = 0.0;
+			if (!PathEngine::BuildPathSegments(guid, segs, &len, chordTolM))
+				segs.clear();
+			if (!segs.empty()) {
+				const API_Coord a = SegEnd(segs.back());
+				const API_Coord b = SegBegin(segs.front());
+				if (std::hypot(b.x - a.x, b.y - a.y) > 1e-9) {
+					Seg s; s.kind = Seg::Line; s.a = a; s.b = b; s.L = std::hypot(b.x - a.x, b.y - a.y);
+					segs.push_back(s);
+				}
+			}
+		}
+
+		return Assign(segs, chordTolM);
+	}
+
+	bool Region::Assign(const std::vector<Seg>& segs, double chordTolM)
+	{
+		m_edges.clear();
+		m_edges.reserve(segs.size());
+
+		const double tol = std::max(chordTolM, 1e-6);
+		for (const Seg& s : segs) {
+			if (s.kind == Seg::Line) {
+				AddEdge(s.a, s.b);
+				continue;
+			}
+			// дуга: угол хорды, при котором стрелка прогиба не больше tol
+			const double sweep = s.a1 - s.a0;
+			const double maxStep = (tol >= s.r) ? PathEngine::kPI / 2.0 : 2.0 * std::acos(1.0 - tol / s.r);
+			const Int32 n = std::max<Int32>(1, (Int32)std::ceil(std::fabs(sweep) / maxStep));
+			API_Coord prev = SegBegin(s);
+			for (Int32 i = 1; i <= n; ++i) {
+				const double a = s.a0 + sweep * (double)i / (double)n;
+				const API_Coord p = { s.c.x + s.r * std::cos(a), s.c.y + s.r * std::sin(a) };
+				AddEdge(prev, p);
+				prev = p;
+			}
+		}
+
+		BuildBands();
+		return !m_edges.empty();
+	}
+
+	void Region::AddEdge(const API_Coord& a, const API_Coord& b)
+	{
+		if (m_edges.empty()) {
+			m_box = { std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y) };
+		}
+		else {
+			m_box.xMin = std::min(m_box.xMin, std::min(a.x, b.x));
+			m_box.yMin = std::min(m_box.yMin, std::min(a.y, b.y));
+			m_box.xMax = std::max(m_box.xMax, std::max(a.x, b.x));
+			m_box.yMax = std::max(m_box.yMax, std::max(a.y, b.y));
+		}
+		// горизонтальные рёбра горизонталь не пересекают (ForEachCrossing их
+		// пропускает), но хранятся — после Rotate они уже не горизонтальны
+		if (a.y < b.y) m_edges.push_back({ a.x, a.y, b.x, b.y });
+		else           m_edges.push_back({ b.x, b.y, a.x, a.y });
+	}
+
+	void Region::Rotate(double angleRad, const API_Coord& pivot)
+	{
+		const double c = std::cos(angleRad), s = std::sin(angleRad);
+		auto rot = [&](double x, double y) -> API_Coord {
+			const double dx = x - pivot.x, dy = y - pivot.y;
+			return { pivot.x + c * dx - s * dy, pivot.y + s * dx + c * dy };
+		};
+
+		std::vector<Edge> edges;
+		edges.swap(m_edges);
+		m_edges.reserve(edges.size());
+		for (const Edge& e : edges)
+			AddEdge(rot(e.x0, e.y0), rot(e.x1, e.y1));
+		BuildBands();
+	}
+
+	void Region::BuildBands()
+	{
+		m_bandStart.clear();
+		m_bandEdges.clear();
+		m_nb = 0;
+		if (m_edges.empty())
+			return;
+
+		const double h = m_box.yMax - m_box.yMin;
+		m_nb = std::max<Int32>(1, std::min<Int32>(kMaxBands, (Int32)m_edges.size()));
+		m_bandH = (h > 1e-12) ? h / (double)m_nb : 1.0;
+
+		auto band = [&](double y) -> Int32 {
+			const Int32 b = (Int32)std::floor((y - m_box.yMin) / m_bandH);
+			return std::max<Int32>(0, std::min<Int32>(m_nb - 1, b));
+		};
+
+		// CSR: подсчёт, префиксные суммы, раскладка
+		m_bandStart.assign((size_t)m_nb + 1, 0);
+		for (const Edge& e : m_edges)
+			for (Int32 b = band(e.y0), b1 = band(e.y1); b <= b1; ++b)
+				++m_bandStart[(size_t)b + 1];
+		for (Int32 b = 0; b < m_nb; ++b)
+			m_bandStart[(size_t)b + 1] += m_bandStart[(size_t)b];
+
+		m_bandEdges.resize(m_bandStart.back());
+		std::vector<UInt32> fill(m_bandStart.begin(), m_bandStart.end() - 1);
+		for (UInt32 i = 0; i < (UInt32)m_edges.size(); ++i)
+			for (Int32 b = band(m_edges[i].y0), b1 = band(m_edges[i].y1); b <= b1; ++b)
+				m_bandEdges[fill[(size_t)b]++] = i;
+	}
+
+	template <class F>
+	void Region::ForEachCrossing(double y, F&& f) const
+	{
+		if (m_nb == 0 || y < m_box.yMin || y > m_box.yMax)
+			return;
+		const Int32 b = std::max<Int32>(0, std::min<Int32>(m_nb - 1, (Int32)std::floor((y - m_box.yMin) / m_bandH)));
+		for (UInt32 k = m_bandStart[(size_t)b]; k < m_bandStart[(size_t)b + 1]; ++k) {
+			const Edge& e = m_edges[m_bandEdges[k]];
+			// полуоткрытый [y0, y1): общая вершина двух рёбер считается один раз
+			if (y < e.y0 || y >= e.y1)
+				continue;
+			f(e.x0 + (e.x1 - e.x0) * (y - e.y0) / (e.y1 - e.y0));
+		}
+	}
+
+	bool Region::Contains(double x, double y) const
+	{
+		if (x < m_box.xMin || x > m_box.xMax)
+			return false;
+		bool inside = false;
+		ForEachCrossing(y, [&](double cx) { if (cx < x) inside = !inside; });
+		return inside;
+	}
+
+	void Region::Spans(double y, std::vector<double>& outX) const
+	{
+		outX.clear();
+		ForEachCrossing(y, [&](double cx) { outX.push_back(cx); });
+		std::sort(outX.begin(), outX.end());
+		if (outX.size() % 2 != 0)   // вырожденный контур — лишнее пересечение отбрасывается
+			outX.pop_back();
+	}
+
+} // namespace Boundary
@@ -0,0 +1,61 @@
+// Boundary.hpp — область на плане по контуру элемента (штриховка, перекрытие,
+// полилиния, окружность, сплайн): рёбра контуров (дуги спрямлены по допуску
+// хорды), правило чёт-нечет — отверстия штриховки/перекрытия учитываются сами.
+// Рёбра разложены по горизонтальным полосам: проверка точки и пролёты на
+// горизонтали смотрят только рёбра своей полосы.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "PathEngine.hpp"
+
+#include <vector>
+
+namespace Boundary {
+
+	// Типы элементов, дающие область
+	bool IsBoundaryType(API_ElemTypeID tid);
+
+	class Region {
+	public:
+		// Контуры элемента; незамкнутая полилиния/сплайн замыкается отрезком
+		bool Build(const API_Guid& guid, double chordTolM = PathEngine::kDefaultChordTolM);
+		// Сегменты замкнутых контуров (дуги спрямляются)
+		bool Assign(const std::vector<PathEngine::Seg>& segs, double chordTolM = PathEngine::kDefaultChordTolM);
+
+		bool           IsEmpty() const { return m_edges.empty(); }
+		size_t         GetEdgeCount() const { return m_edges.size(); }
+		const API_Box& GetBox() const { return m_box; }
+
+		// Повернуть область на angleRad вокруг pivot (полосы перестраиваются) —
+		// для пролётов вдоль повёрнутой решётки
+		void Rotate(double angleRad, const API_Coord& pivot);
+
+		// Точка внутри (чёт-нечет)
+		bool Contains(double x, double y) const;
+
+		// Пересечения горизонтали y с контурами по возрастанию x; пары
+		// [outX[2i], outX[2i+1]] — пролёты внутри области
+		void Spans(double y, std::vector<double>& outX) const;
+
+	private:
+		struct Edge {
+			double x0, y0;   // y0 <= y1
+			double x1, y1;
+		};
+
+		void AddEdge(const API_Coord& a, const API_Coord& b);
+		void BuildBands();
+
+		template <class F>
+		void ForEachCrossing(double y, F&& f) const;
+
+		std::vector<Edge>   m_edges;
+		std::vector<UInt32> m_bandStart;   // размер m_nb+1
+		std::vector<UInt32> m_bandEdges;
+		double              m_bandH = 1.0;
+		Int32               m_nb = 0;
+		API_Box             m_box = {};
+	};
+
+} // namespace Boundary
@@ -0,0 +1,90 @@
+// BoundedQueue.hpp — ограниченная очередь без блокировок (несколько
+// поставщиков, несколько потребителей; кольцо с порядковыми номерами ячеек,
+// схема Д. Вьюкова). TryPush/TryPop не ждут: при полной/пустой очереди
+// возвращают false, ожидание — на стороне вызывающего.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace BoundedQueue {
+
+	template <class T>
+	class Queue {
+	public:
+		// capacity округляется вверх до степени двойки
+		explicit Queue(size_t capacity)
+		{
+			size_t n = 2;
+			while (n < capacity) n <<= 1;
+			m_mask = n - 1;
+			m_cells.reset(new Cell[n]);
+			for (size_t i = 0; i < n; ++i)
+				m_cells[i].seq.store(i, std::memory_order_relaxed);
+		}
+
+		Queue(const Queue&) = delete;
+		Queue& operator=(const Queue&) = delete;
+
+		bool TryPush(const T& value)
+		{
+			size_t pos = m_tail.load(std::memory_order_relaxed);
+			for (;;) {
+				Cell& cell = m_cells[pos & m_mask];
+				const size_t seq = cell.seq.load(std::memory_order_acquire);
+				const std::ptrdiff_t dif = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+				if (dif == 0) {
+					if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						cell.value = value;
+						cell.seq.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (dif < 0) {
+					return false;   // полна
+				}
+				else {
+					pos = m_tail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		bool TryPop(T& out)
+		{
+			size_t pos = m_head.load(std::memory_order_relaxed);
+			for (;;) {
+				Cell& cell = m_cells[pos & m_mask];
+				const size_t seq = cell.seq.load(std::memory_order_acquire);
+				const std::ptrdiff_t dif = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+				if (dif == 0) {
+					if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						out = cell.value;
+						cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (dif < 0) {
+					return false;   // пуста
+				}
+				else {
+					pos = m_head.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+	private:
+		struct Cell {
+			std::atomic<size_t> seq;
+			T                   value;
+		};
+
+		// голова и хвост — в разных строках кэша: поставщики и потребитель
+		// не толкаются на одной строке
+		std::unique_ptr<Cell[]>     m_cells;
+		size_t                      m_mask = 0;
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+	};
+
+} // namespace BoundedQueue
@@ -0,0 +1,231 @@
+// Corridor.cpp
+#include "Corridor.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace Corridor {
+
+	using PathEngine::Seg;
+
+	// Точка и единичная касательная сегмента на доле t
+	static void SegPointTan(const Seg& s, double t, API_Coord& p, API_Coord& tan)
+	{
+		if (s.kind == Seg::Line) {
+			p = { s.a.x + (s.b.x - s.a.x) * t, s.a.y + (s.b.y - s.a.y) * t };
+			const double L = std::max(s.L, 1e-12);
+			tan = { (s.b.x - s.a.x) / L, (s.b.y - s.a.y) / L };
+			return;
+		}
+		const double ang = s.a0 + (s.a1 - s.a0) * t;
+		p = { s.c.x + s.r * std::cos(ang), s.c.y + s.r * std::sin(ang) };
+		tan = (s.a1 >= s.a0) ? API_Coord{ -std::sin(ang), std::cos(ang) } : API_Coord{ std::sin(ang), -std::cos(ang) };
+	}
+
+	bool IsValid(const Template& tpl)
+	{
+		if (tpl.points.size() < 2 || tpl.thicknessM < 0.0)
+			return false;
+		for (size_t j = 0; j + 1 < tpl.points.size(); ++j) {
+			const Breakpoint& a = tpl.points[j];
+			const Breakpoint& b = tpl.points[j + 1];
+			if (b.offsetM < a.offsetM) return false;
+			if (b.offsetM == a.offsetM && b.heightM == a.heightM) return false;
+		}
+		return true;
+	}
+
+	// ---------- Запись тела по станциям ----------
+	// Станция: m вершин верха (по точкам шаблона) + вершины плоского низа
+	// (на min высоты - толщина; под вертикальной полосой — общая вершина).
+	class Writer {
+	public:
+		// closed — замкнутая ось: торцов нет, ни начального, ни конечного
+		Writer(MorphBody::Builder& body, const Template& tpl, const API_Coord3D& origin, bool closed)
+			: m_body(body), m_tpl(tpl), m_origin(origin), m_m((UInt32)tpl.points.size()), m_closed(closed)
+		{
+			m_thick = tpl.thicknessM > 1e-9;
+			double zMin = tpl.points[0].heightM;
+			for (const Breakpoint& b : tpl.points) zMin = std::min(zMin, b.heightM);
+			m_zBottom = zMin - tpl.thicknessM;
+
+			// слоты материалов: одинаковые материалы полос — один слот
+			std::vector<API_AttributeIndex> seen;
+			for (UInt32 j = 0; j + 1 < m_m; ++j) {
+				const API_AttributeIndex& mat = tpl.points[j].material;
+				UInt32 slot = (UInt32)-1;
+				for (size_t q = 0; q < seen.size(); ++q)
+					if (seen[q] == mat) { slot = m_slotTop[q]; break; }
+				if (slot == (UInt32)-1) {
+					API_OverriddenAttribute attr;
+					attr = mat;
+					slot = m_body.AddMaterial(attr);
+					seen.push_back(mat);
+				}
+				m_slotTop.push_back(slot);
+			}
+			API_OverriddenAttribute bottomAttr, sideAttr;
+			bottomAttr = tpl.materialBottom;
+			sideAttr = tpl.materialSide;
+			m_slotBottom = m_body.AddMaterial(bottomAttr);
+			m_slotSide = m_body.AddMaterial(sideAttr);
+		}
+
+		// Станция в точке p с нормалью n (влево), профиль растянут в scale раз
+		bool AddStation(const API_Coord& p, const API_Coord& n, double scale)
+		{
+			m_cur.assign(2 * (size_t)m_m, 0);
+			for (UInt32 j = 0; j < m_m; ++j) {
+				const Breakpoint& b = m_tpl.points[j];
+				const double ox = n.x * b.offsetM * scale, oy = n.y * b.offsetM * scale;
+				const API_Coord3D top = { p.x + ox - m_origin.x, p.y + oy - m_origin.y, b.heightM - m_origin.z };
+				if (!m_body.AddVertex(top, m_cur[j]))
+					return false;
+				if (!m_thick) continue;
+				if (j > 0 && b.offsetM == m_tpl.points[j - 1].offsetM) {
+					m_cur[m_m + j] = m_cur[m_m + j - 1];
+					continue;
+				}
+				const API_Coord3D bot = { top.x, top.y, m_zBottom - m_origin.z };
+				if (!m_body.AddVertex(bot, m_cur[m_m + j]))
+					return false;
+			}
+
+			if (m_prev.empty()) {
+				m_first = m_cur;
+				if (!m_closed && !Cap(m_cur, true)) return false;
+			}
+			else if (!Connect(m_prev, m_cur)) {
+				return false;
+			}
+			m_prev.swap(m_cur);
+			return true;
+		}
+
+		// Замкнутая ось: последняя станция соединяется с первой, торцов нет
+		bool CloseLoop() { return Connect(m_prev, m_first); }
+
+		bool EndCap() { return Cap(m_prev, false); }
+
+	private:
+		bool Connect(const std::vector<UInt32>& a, const std::vector<UInt32>& d)
+		{
+			const UInt32 m = m_m;
+			for (UInt32 j = 0; j + 1 < m; ++j) {
+				// верх полосы j: A-B на станции a, D-C на станции d (нормаль вверх/наружу)
+				if (!m_body.AddTriangle(a[j], d[j], d[j + 1], m_slotTop[j]) ||
+					!m_body.AddTriangle(a[j], d[j + 1], a[j + 1], m_slotTop[j]))
+					return false;
+				if (m_thick && a[m + j] != a[m + j + 1]) {
+					if (!m_body.AddTriangle(a[m + j], d[m + j + 1], d[m + j], m_slotBottom) ||
+						!m_body.AddTriangle(a[m + j], a[m + j + 1], d[m + j + 1], m_slotBottom))
+						return false;
+				}
+			}
+			if (!m_thick) return true;
+
+			// борта: левый (последняя точка) наружу влево, правый (первая) — вправо
+			const UInt32 l = m - 1;
+			if (!m_body.AddTriangle(a[l], d[l], d[m + l], m_slotSide) ||
+				!m_body.AddTriangle(a[l], d[m + l], a[m + l], m_slotSide) ||
+				!m_body.AddTriangle(a[0], a[m], d[m], m_slotSide) ||
+				!m_body.AddTriangle(a[0], d[m], d[0], m_slotSide))
+				return false;
+			return true;
+		}
+
+		// Торец: верх по точкам шаблона, затем низ в обратном порядке
+		bool Cap(const std::vector<UInt32>& st, bool start)
+		{
+			if (!m_thick) return true;
+			m_poly.clear();
+			for (UInt32 j = 0; j < m_m; ++j) m_poly.push_back(st[j]);
+			for (UInt32 j = m_m; j-- > 0; )
+				if (m_poly.back() != st[m_m + j]) m_poly.push_back(st[m_m + j]);
+			if (!start) std::reverse(m_poly.begin(), m_poly.end());
+			return m_body.AddPolygon(m_poly.data(), (UInt32)m_poly.size(), m_slotSide);
+		}
+
+		MorphBody::Builder&  m_body;
+		const Template&      m_tpl;
+		API_Coord3D          m_origin;
+		UInt32               m_m;
+		bool                 m_closed;
+		bool                 m_thick = false;
+		double               m_zBottom = 0.0;
+		std::vector<UInt32>  m_slotTop;
+		UInt32               m_slotBottom = 0, m_slotSide = 0;
+		std::vector<UInt32>  m_first, m_prev, m_cur, m_poly;
+	};
+
+	bool Sweep(const std::vector<Seg>& axis, bool closed, const Template& tpl,
+		const Options& opt, const API_Coord3D& origin, MorphBody::Builder& body, Stats* stats)
+	{
+		if (axis.empty() || !IsValid(tpl))
+			return false;
+
+		double wMax = 0.0;
+		for (const Breakpoint& b : tpl.points) wMax = std::max(wMax, std::fabs(b.offsetM));
+
+		Writer writer(body, tpl, origin, closed);
+		if (stats) { *stats = Stats(); stats->strips = (UInt32)tpl.points.size() - 1; }
+
+		auto LeftNormal = [](const API_Coord& t) -> API_Coord { return { -t.y, t.x }; };
+
+		// Излом оси: профиль по биссектрисе нормалей, растянут до 1/cos(θ/2)
+		auto JunctionNormal = [&](const API_Coord& tin, const API_Coord& tout, API_Coord& n, double& scale) {
+			const API_Coord nin = LeftNormal(tin), nout = LeftNormal(tout);
+			const double mx = nin.x + nout.x, my = nin.y + nout.y;
+			const double len = std::hypot(mx, my);
+			const double turn = tin.x * tout.y - tin.y * tout.x;
+			if (len < 1e-9) { n = nout; scale = 1.0; return; }   // разворот на 180°
+			n = { mx / len, my / len };
+			const double c = n.x * nin.x + n.y * nin.y;
+			scale = std::min(1.0 / std::max(c, 1e-9), opt.miterLimit);
+			if (std::fabs(turn) > 1e-9 && stats) ++stats->miterStations;
+		};
+
+		for (size_t i = 0; i < axis.size(); ++i) {
+			const Seg& s = axis[i];
+			API_Coord p, tout;
+			SegPointTan(s, 0.0, p, tout);
+
+			API_Coord n = LeftNormal(tout);
+			double scale = 1.0;
+			if (i > 0 || closed) {
+				API_Coord pe, tin;
+				SegPointTan(axis[i > 0 ? i - 1 : axis.size() - 1], 1.0, pe, tin);
+				JunctionNormal(tin, tout, n, scale);
+			}
+			if (!writer.AddStation(p, n, scale)) return false;
+			if (stats) ++stats->stations;
+
+			// Внутренние станции: дуга — по допуску хорды для дальней кромки, шаг — по maxStepM
+			UInt32 nSub = 1;
+			if (s.kind == Seg::Arc) {
+				const double R = s.r + wMax;
+				const double c = 1.0 - opt.chordTolM / std::max(R, 1e-9);
+				const double dAng = (c <= -1.0) ? PathEngine::kPI : 2.0 * std::acos(std::max(c, -1.0));
+				nSub = std::max<UInt32>(1, (UInt32)std::ceil(std::fabs(s.a1 - s.a0) / std::max(dAng, 1e-6)));
+			}
+			if (opt.maxStepM > 0.0)
+				nSub = std::max<UInt32>(nSub, (UInt32)std::ceil(s.L / opt.maxStepM));
+			for (UInt32 k = 1; k < nSub; ++k) {
+				API_Coord q, t;
+				SegPointTan(s, (double)k / (double)nSub, q, t);
+				if (!writer.AddStation(q, LeftNormal(t), 1.0)) return false;
+				if (stats) ++stats->stations;
+			}
+		}
+
+		if (closed)
+			return writer.CloseLoop();
+
+		API_Coord p, t;
+		SegPointTan(axis.back(), 1.0, p, t);
+		if (!writer.AddStation(p, LeftNormal(t), 1.0)) return false;
+		if (stats) ++stats->stations;
+		return writer.EndCap();
+	}
+
+} // namespace Corridor
@@ -0,0 +1,50 @@
+// Corridor.hpp — коридор дороги: поперечный профиль (шаблон из точек перелома
+// «смещение / высота / материал полосы») протягивается вдоль оси. Станции
+// ставятся адаптивно: концы сегментов, на дугах — по допуску хорды для самой
+// дальней точки шаблона. Тело пишется в MorphBody::Builder по станциям, без
+// промежуточного массива всех точек.
+#pragma once
+
+#include "PathEngine.hpp"
+#include "MorphBody.hpp"
+
+#include <vector>
+
+namespace Corridor {
+
+	// Точка перелома профиля. Полоса между точками i и i+1 берёт материал точки i.
+	// Смещение > 0 — влево по ходу оси; точки идут по возрастанию смещения,
+	// две точки с одним смещением — вертикальная грань (бордюр).
+	struct Breakpoint {
+		double             offsetM = 0.0;
+		double             heightM = 0.0;   // от отметки оси
+		API_AttributeIndex material;
+	};
+
+	struct Template {
+		std::vector<Breakpoint> points;
+		double             thicknessM = 0.0;   // 0 — только верхняя поверхность
+		API_AttributeIndex materialBottom;
+		API_AttributeIndex materialSide;       // крайние борта и торцы
+	};
+
+	struct Options {
+		double chordTolM = PathEngine::kDefaultChordTolM;   // отклонение от дуги для крайней полосы
+		double maxStepM = 0.0;                              // наибольший шаг станций (0 — без ограничения)
+		double miterLimit = 3.0;                            // растяжение профиля на изломе оси
+	};
+
+	struct Stats {
+		UInt32 stations = 0;
+		UInt32 strips = 0;
+		UInt32 miterStations = 0;
+	};
+
+	// Шаблон корректен: >= 2 точек, смещения не убывают, полосы ненулевые
+	bool IsValid(const Template& tpl);
+
+	// Тело коридора в body (Begin уже вызван); координаты — относительно origin.
+	bool Sweep(const std::vector<PathEngine::Seg>& axis, bool closed, const Template& tpl,
+		const Options& opt, const API_Coord3D& origin, MorphBody::Builder& body, Stats* stats = nullptr);
+
+} // namespace Corridor
@@ -0,0 +1,225 @@
+// CurveFit.cpp
+#include "CurveFit.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace CurveFit {
+
+	static constexpr double kLenEps = 1e-9;
+	static constexpr Int32  kMaxReparams = 4;
+
+	// ---------- Векторы ----------
+	static inline API_Coord Add(const API_Coord& a, const API_Coord& b) { return { a.x + b.x, a.y + b.y }; }
+	static inline API_Coord Sub(const API_Coord& a, const API_Coord& b) { return { a.x - b.x, a.y - b.y }; }
+	static inline API_Coord Mul(const API_Coord& a, double k) { return { a.x * k, a.y * k }; }
+	static inline double    Dot(const API_Coord& a, const API_Coord& b) { return a.x * b.x + a.y * b.y; }
+	static inline double    Dist(const API_Coord& a, const API_Coord& b) { return std::hypot(b.x - a.x, b.y - a.y); }
+
+	static inline API_Coord Unit(const API_Coord& v)
+	{
+		const double len = std::hypot(v.x, v.y);
+		return len > kLenEps ? API_Coord{ v.x / len, v.y / len } : API_Coord{ 1.0, 0.0 };
+	}
+
+	// ---------- Кубика Безье ----------
+	struct Bezier {
+		API_Coord p[4];
+	};
+
+	static inline API_Coord Eval(const Bezier& b, double t)
+	{
+		const double s = 1.0 - t;
+		const double b0 = s * s * s, b1 = 3.0 * s * s * t, b2 = 3.0 * s * t * t, b3 = t * t * t;
+		return { b0 * b.p[0].x + b1 * b.p[1].x + b2 * b.p[2].x + b3 * b.p[3].x,
+				 b0 * b.p[0].y + b1 * b.p[1].y + b2 * b.p[2].y + b3 * b.p[3].y };
+	}
+
+	static inline API_Coord Deriv1(const Bezier& b, double t)
+	{
+		const double s = 1.0 - t;
+		const API_Coord d0 = Sub(b.p[1], b.p[0]), d1 = Sub(b.p[2], b.p[1]), d2 = Sub(b.p[3], b.p[2]);
+		return Mul(Add(Add(Mul(d0, s * s), Mul(d1, 2.0 * s * t)), Mul(d2, t * t)), 3.0);
+	}
+
+	static inline API_Coord Deriv2(const Bezier& b, double t)
+	{
+		const API_Coord e0 = Add(Sub(b.p[2], Mul(b.p[1], 2.0)), b.p[0]);
+		const API_Coord e1 = Add(Sub(b.p[3], Mul(b.p[2], 2.0)), b.p[1]);
+		return Mul(Add(Mul(e0, 1.0 - t), Mul(e1, t)), 6.0);
+	}
+
+	// ---------- Один кусок ----------
+	// Кусок [first, last] с касательными вперёд t0 (в начале) и t3 (в конце):
+	// P1 = P0 + a0·t0, P2 = P3 − a3·t3
+	struct Piece {
+		UInt32    first, last;
+		API_Coord t0, t3;
+	};
+
+	class Fitter {
+	public:
+		Fitter(const std::vector<API_Coord>& pts, double tolM) : m_pts(pts), m_tol2(tolM * tolM) {}
+
+		void Run(const API_Coord& tBeg, const API_Coord& tEnd, std::vector<API_Coord>& coords,
+			std::vector<API_SplineDir>& dirs, Stats& st);
+
+	private:
+		// Длины ручек по МНК при заданных касательных и параметрах u
+		Bezier Generate(const Piece& pc, const std::vector<double>& u) const;
+		// Наибольший квадрат отклонения; split — индекс точки
+		double MaxError(const Piece& pc, const Bezier& b, const std::vector<double>& u, UInt32& split) const;
+		void   Reparameterize(const Piece& pc, const Bezier& b, std::vector<double>& u) const;
+
+		const std::vector<API_Coord>& m_pts;
+		const double                  m_tol2;
+	};
+
+	Bezier Fitter::Generate(const Piece& pc, const std::vector<double>& u) const
+	{
+		const API_Coord& P0 = m_pts[pc.first];
+		const API_Coord& P3 = m_pts[pc.last];
+
+		double c00 = 0.0, c01 = 0.0, c11 = 0.0, x0 = 0.0, x1 = 0.0;
+		for (UInt32 i = 0; i < (UInt32)u.size(); ++i) {
+			const double t = u[i], s = 1.0 - t;
+			const double b0 = s * s * s, b1 = 3.0 * s * s * t, b2 = 3.0 * s * t * t, b3 = t * t * t;
+			const API_Coord A0 = Mul(pc.t0, b1);
+			const API_Coord A1 = Mul(pc.t3, -b2);
+			const API_Coord r = Sub(m_pts[pc.first + i], Add(Mul(P0, b0 + b1), Mul(P3, b2 + b3)));
+			c00 += Dot(A0, A0); c01 += Dot(A0, A1); c11 += Dot(A1, A1);
+			x0 += Dot(A0, r);   x1 += Dot(A1, r);
+		}
+
+		const double chord = Dist(P0, P3);
+		const double det = c00 * c11 - c01 * c01;
+		double a0 = 0.0, a3 = 0.0;
+		if (std::fabs(det) > 1e-12 * std::max(1.0, c00 * c11)) {
+			a0 = (x0 * c11 - x1 * c01) / det;
+			a3 = (c00 * x1 - c01 * x0) / det;
+		}
+		// вырожденная система или ручка «назад» — треть хорды (Wu–Barsky)
+		const double eps = 1e-6 * chord;
+		if (a0 < eps || a3 < eps)
+			a0 = a3 = chord / 3.0;
+
+		Bezier b;
+		b.p[0] = P0;
+		b.p[1] = Add(P0, Mul(pc.t0, a0));
+		b.p[2] = Sub(P3, Mul(pc.t3, a3));
+		b.p[3] = P3;
+		return b;
+	}
+
+	double Fitter::MaxError(const Piece& pc, const Bezier& b, const std::vector<double>& u, UInt32& split) const
+	{
+		double worst = 0.0;
+		split = (pc.first + pc.last) / 2;
+		for (UInt32 i = 1; i + 1 < (UInt32)u.size(); ++i) {
+			const API_Coord d = Sub(Eval(b, u[i]), m_pts[pc.first + i]);
+			const double e = Dot(d, d);
+			if (e > worst) { worst = e; split = pc.first + i; }
+		}
+		return worst;
+	}
+
+	void Fitter::Reparameterize(const Piece& pc, const Bezier& b, std::vector<double>& u) const
+	{
+		// Ньютон для (Q(u) − P)·Q'(u) = 0 — ближайшая точка кривой
+		for (UInt32 i = 1; i + 1 < (UInt32)u.size(); ++i) {
+			const double t = u[i];
+			const API_Coord d = Sub(Eval(b, t), m_pts[pc.first + i]);
+			const API_Coord q1 = Deriv1(b, t);
+			const double num = Dot(d, q1);
+			const double den = Dot(q1, q1) + Dot(d, Deriv2(b, t));
+			if (std::fabs(den) > kLenEps)
+				u[i] = std::min(1.0, std::max(0.0, t - num / den));
+		}
+	}
+
+	void Fitter::Run(const API_Coord& tBeg, const API_Coord& tEnd, std::vector<API_Coord>& coords,
+		std::vector<API_SplineDir>& dirs, Stats& st)
+	{
+		const UInt32 n = (UInt32)m_pts.size();
+		coords.clear();
+		dirs.clear();
+		coords.push_back(m_pts[0]);
+		dirs.push_back({ 0.0, 0.0, std::atan2(tBeg.y, tBeg.x) });
+
+		// Стек кусков: правый кладётся раньше левого — узлы выходят по порядку
+		std::vector<Piece> stack;
+		stack.push_back({ 0, n - 1, tBeg, tEnd });
+		std::vector<double> u;
+
+		while (!stack.empty()) {
+			const Piece pc = stack.back();
+			stack.pop_back();
+
+			// параметры по длине хорд
+			const UInt32 m = pc.last - pc.first + 1;
+			u.resize(m);
+			u[0] = 0.0;
+			for (UInt32 i = 1; i < m; ++i)
+				u[i] = u[i - 1] + Dist(m_pts[pc.first + i - 1], m_pts[pc.first + i]);
+			const double total = u[m - 1];
+			for (UInt32 i = 1; i < m; ++i)
+				u[i] /= total;
+
+			Bezier b = Generate(pc, u);
+			UInt32 split = 0;
+			double err = MaxError(pc, b, u, split);
+			// близко к допуску — уточняем параметры, иначе сразу делим
+			if (err > m_tol2 && err < 4.0 * m_tol2) {
+				for (Int32 it = 0; it < kMaxReparams && err > m_tol2; ++it) {
+					Reparameterize(pc, b, u);
+					b = Generate(pc, u);
+					err = MaxError(pc, b, u, split);
+					++st.reparams;
+				}
+			}
+
+			if (err <= m_tol2 || m < 3) {
+				dirs.back().lenNext = Dist(b.p[0], b.p[1]);
+				coords.push_back(b.p[3]);
+				dirs.push_back({ Dist(b.p[2], b.p[3]), 0.0, std::atan2(pc.t3.y, pc.t3.x) });
+				st.maxErrM = std::max(st.maxErrM, std::sqrt(err));
+				continue;
+			}
+
+			// касательная в точке деления — по соседям, общая для обоих кусков
+			const API_Coord tc = Unit(Sub(m_pts[split + 1], m_pts[split - 1]));
+			stack.push_back({ split, pc.last, tc, pc.t3 });
+			stack.push_back({ pc.first, split, pc.t0, tc });
+		}
+	}
+
+	bool FitSpline(const API_Coord* pts, UInt32 count, double tolM, bool closed,
+		std::vector<API_Coord>& coords, std::vector<API_SplineDir>& dirs, Stats* stats)
+	{
+		coords.clear();
+		dirs.clear();
+
+		// совпадающие подряд точки ломают параметризацию по хордам
+		std::vector<API_Coord> clean;
+		clean.reserve(count);
+		for (UInt32 i = 0; i < count; ++i)
+			if (clean.empty() || Dist(clean.back(), pts[i]) > kLenEps)
+				clean.push_back(pts[i]);
+		const UInt32 n = (UInt32)clean.size();
+		if (n < 2 || tolM <= 0.0)
+			return false;
+
+		API_Coord tBeg = Unit(Sub(clean[1], clean[0]));
+		API_Coord tEnd = Unit(Sub(clean[n - 1], clean[n - 2]));
+		if (closed && n > 3 && Dist(clean.front(), clean.back()) <= 0.001)
+			tBeg = tEnd = Unit(Sub(clean[1], clean[n - 2]));
+
+		Stats st;
+		st.inPoints = n;
+		Fitter(clean, tolM).Run(tBeg, tEnd, coords, dirs, st);
+		st.knots = (UInt32)coords.size();
+		if (stats) *stats = st;
+		return coords.size() >= 2;
+	}
+
+} // namespace CurveFit
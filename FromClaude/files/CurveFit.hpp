@@ -0,0 +1,29 @@
+// CurveFit.hpp — аппроксимация ряда точек кусочно-кубическими Безье с
+// допуском (Шнайдер, Graphics Gems I): параметры по длине хорд, длины ручек
+// методом наименьших квадратов при заданных касательных, уточнение параметров
+// Ньютоном, деление по точке наибольшего отклонения. Касательная в узле
+// деления общая для соседних кусков — результат ложится в узлы сплайна
+// Archicad (одно направление dirAng и две длины ручек на узел).
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <vector>
+
+namespace CurveFit {
+
+	struct Stats {
+		UInt32 inPoints = 0;    // точек на входе (без совпадающих подряд)
+		UInt32 knots = 0;       // узлов сплайна на выходе
+		UInt32 reparams = 0;    // уточнений параметров Ньютоном
+		double maxErrM = 0.0;   // наибольшее отклонение точек от кривой
+	};
+
+	// pts[0..count) — точки вдоль кривой по порядку; tolM — наибольшее отклонение
+	// кривой от точек. closed — первая и последняя точки совпадают: касательная
+	// в них общая. coords/dirs — узлы сплайна (coords[k] + dirs[k]).
+	bool FitSpline(const API_Coord* pts, UInt32 count, double tolM, bool closed,
+		std::vector<API_Coord>& coords, std::vector<API_SplineDir>& dirs, Stats* stats = nullptr);
+
+} // namespace CurveFit
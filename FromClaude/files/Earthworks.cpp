@@ -0,0 +1,242 @@
+// Earthworks.cpp
+#include "Earthworks.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace Earthworks {
+
+	// Станций на одну выдачу воркеру: мелкие порции выравнивают нагрузку,
+	// но не превращают счётчик в узкое место
+	static constexpr size_t kChunk = 8;
+
+	// Бисекций при уточнении точки нулевых работ (шаг / 2^30 — далеко ниже мм)
+	static constexpr int kBisect = 30;
+
+	// Поперечник: план — ось p + n*u, u > 0 влево; проектная линия
+	// «откос справа — профиль шаблона — откос слева»
+	class Section {
+	public:
+		Section(const std::vector<Corridor::Breakpoint>& profile, const TerrainSampler::Index& terrain, const Params& p)
+			: m_prof(profile), m_terrain(terrain), m_p(p)
+		{
+		}
+
+		void Reset(const API_Coord& origin, const API_Coord& normal)
+		{
+			m_o = origin;
+			m_n = normal;
+		}
+
+		API_Coord At(double u) const { return { m_o.x + m_n.x * u, m_o.y + m_n.y * u }; }
+
+		bool Terrain(double u, double& z) const
+		{
+			const API_Coord q = At(u);
+			return m_terrain.SampleZ(q.x, q.y, z);
+		}
+
+		// Откос от кромки (uEdge, zEdge) наружу по dir (+1 влево, -1 вправо): ищем,
+		// где рельеф пересекает откос. outDist — длина откоса в плане, outK — уклон
+		// откоса со знаком (выемка вверх, насыпь вниз), м на м в плане.
+		bool Daylight(double uEdge, double zEdge, double dir, double& outDist, double& outK) const
+		{
+			outDist = 0.0;
+			outK = 0.0;
+			double zt;
+			if (!Terrain(uEdge, zt))
+				return false;
+
+			// рельеф выше кромки — выемка (откос вверх), ниже — насыпь (вниз)
+			const bool cut = zt > zEdge;
+			const double k = (cut ? 1.0 : -1.0) / std::max(cut ? m_p.cutSlopeH : m_p.fillSlopeH, 1e-6);
+			outK = k;
+			if (std::fabs(zt - zEdge) < 1e-9)
+				return true;
+
+			auto F = [&](double d, double& f) -> bool {
+				double z;
+				if (!Terrain(uEdge + dir * d, z)) return false;
+				f = (z - (zEdge + k * d)) * (cut ? 1.0 : -1.0);   // > 0 — ещё не дошли
+				return true;
+			};
+
+			const double step = std::max(m_p.sampleStepM, 1e-3);
+			double d0 = 0.0;
+			for (double d1 = step; d0 < m_p.maxReachM; d1 += step) {
+				d1 = std::min(d1, m_p.maxReachM);
+				double f1;
+				if (!F(d1, f1))
+					return false;   // откос ушёл за край рельефа
+				if (f1 <= 0.0) {
+					double lo = d0, hi = d1;
+					for (int it = 0; it < kBisect; ++it) {
+						const double mid = 0.5 * (lo + hi);
+						double fm;
+						if (!F(mid, fm) || fm <= 0.0) hi = mid;
+						else                          lo = mid;
+					}
+					outDist = hi;
+					return true;
+				}
+				d0 = d1;
+			}
+			return false;
+		}
+
+		// Проектная отметка в поперечнике u (от отметки оси)
+		double Design(double u, double kR, double kL) const
+		{
+			const Corridor::Breakpoint& r = m_prof.front();
+			const Corridor::Breakpoint& l = m_prof.back();
+			if (u <= r.offsetM) return r.heightM + kR * (r.offsetM - u);
+			if (u >= l.offsetM) return l.heightM + kL * (u - l.offsetM);
+
+			// внутри шаблона: профиль — кусочно-линейный по смещению
+			auto it = std::upper_bound(m_prof.begin(), m_prof.end(), u,
+				[](double v, const Corridor::Breakpoint& b) { return v < b.offsetM; });
+			const Corridor::Breakpoint& b = *it;
+			const Corridor::Breakpoint& a = *(it - 1);
+			const double w = b.offsetM - a.offsetM;
+			if (w < 1e-12) return b.heightM;
+			return a.heightM + (b.heightM - a.heightM) * (u - a.offsetM) / w;
+		}
+
+		// Площади выемки/насыпи: трапеции по разности «рельеф − проект»,
+		// на смене знака — разрез в нуле
+		void Areas(double uR, double kR, double uL, double kL, double baseZ,
+			double& outCut, double& outFill)
+		{
+			outCut = outFill = 0.0;
+
+			// узлы: концы откосов, точки перелома, внутри — равномерно
+			m_keys.clear();
+			m_keys.push_back(uR);
+			for (const Corridor::Breakpoint& b : m_prof) m_keys.push_back(b.offsetM);
+			m_keys.push_back(uL);
+
+			const double step = std::max(m_p.sampleStepM, 1e-3);
+			bool   havePrev = false;
+			double uPrev = 0.0, dPrev = 0.0;
+			auto Accumulate = [&](double u) {
+				double zt;
+				if (!Terrain(u, zt)) { havePrev = false; return; }
+				const double d = (zt - baseZ) - Design(u, kR, kL);
+				if (havePrev && u > uPrev) {
+					const double w = u - uPrev;
+					if ((dPrev >= 0.0) == (d >= 0.0)) {
+						const double a = 0.5 * (dPrev + d) * w;
+						if (a >= 0.0) outCut += a; else outFill -= a;
+					}
+					else {
+						const double t = dPrev / (dPrev - d);   // доля до нуля
+						const double a0 = 0.5 * dPrev * w * t;
+						const double a1 = 0.5 * d * w * (1.0 - t);
+						if (a0 >= 0.0) outCut += a0; else outFill -= a0;
+						if (a1 >= 0.0) outCut += a1; else outFill -= a1;
+					}
+				}
+				uPrev = u; dPrev = d; havePrev = true;
+			};
+
+			Accumulate(m_keys[0]);
+			for (size_t i = 0; i + 1 < m_keys.size(); ++i) {
+				const double a = m_keys[i], b = m_keys[i + 1];
+				if (b - a < 1e-9) continue;
+				const UInt32 n = std::max<UInt32>(1, (UInt32)std::ceil((b - a) / step));
+				for (UInt32 k = 1; k <= n; ++k)
+					Accumulate(a + (b - a) * (double)k / (double)n);
+			}
+		}
+
+	private:
+		const std::vector<Corridor::Breakpoint>& m_prof;
+		const TerrainSampler::Index&             m_terrain;
+		const Params&                            m_p;
+		API_Coord                                m_o = {}, m_n = {};
+		std::vector<double>                      m_keys;
+	};
+
+	static void ComputeStation(const PathEngine::CompiledPath& axis, Section& sec, const Params& p,
+		const std::vector<Corridor::Breakpoint>& profile, StationResult& r)
+	{
+		API_Coord o;
+		double ang = 0.0;
+		axis.Eval(r.s, &o, &ang);
+		const API_Coord n = { -std::sin(ang), std::cos(ang) };
+		sec.Reset(o, n);
+
+		const Corridor::Breakpoint& right = profile.front();
+		const Corridor::Breakpoint& left = profile.back();
+
+		// не найденная сторона считается без откоса — площадь только под шаблоном
+		double dL = 0.0, dR = 0.0, kL = 0.0, kR = 0.0;
+		r.foundL = sec.Daylight(left.offsetM, p.baseZ + left.heightM, 1.0, dL, kL);
+		r.foundR = sec.Daylight(right.offsetM, p.baseZ + right.heightM, -1.0, dR, kR);
+		if (!r.foundL) dL = kL = 0.0;
+		if (!r.foundR) dR = kR = 0.0;
+		const double uL = left.offsetM + dL, uR = right.offsetM - dR;
+		r.daylightL = sec.At(uL);
+		r.daylightR = sec.At(uR);
+
+		sec.Areas(uR, kR, uL, kL, p.baseZ, r.cutArea, r.fillArea);
+	}
+
+	bool Compute(const PathEngine::CompiledPath& axis, const std::vector<Corridor::Breakpoint>& profile,
+		const TerrainSampler::Index& terrain, const Params& p, std::vector<StationResult>& out, Totals& totals)
+	{
+		out.clear();
+		totals = Totals();
+		if (axis.IsEmpty() || terrain.IsEmpty() || profile.size() < 2 || p.stationStepM <= 0.0)
+			return false;
+
+		// пикеты: от 0 с шагом, последний — в конце оси
+		const double L = axis.GetLength();
+		const size_t nSt = (size_t)std::ceil(L / p.stationStepM - 1e-9) + 1;
+		out.resize(nSt);
+		for (size_t i = 0; i < nSt; ++i)
+			out[i].s = std::min(L, (double)i * p.stationStepM);
+
+		// Станции независимы: рельеф и ось только читаются, каждый воркер пишет
+		// свои out[i]; порции раздаёт атомарный счётчик
+		UInt32 nThreads = p.threads ? p.threads : std::max(1u, std::thread::hardware_concurrency());
+		nThreads = (UInt32)std::min<size_t>(nThreads, (nSt + kChunk - 1) / kChunk);
+		nThreads = std::max<UInt32>(1, nThreads);
+
+		std::atomic<size_t> next(0);
+		auto Worker = [&]() {
+			Section sec(profile, terrain, p);
+			for (;;) {
+				const size_t begin = next.fetch_add(kChunk);
+				if (begin >= nSt) break;
+				const size_t end = std::min(nSt, begin + kChunk);
+				for (size_t i = begin; i < end; ++i)
+					ComputeStation(axis, sec, p, profile, out[i]);
+			}
+		};
+
+		std::vector<std::thread> pool;
+		pool.reserve(nThreads - 1);
+		for (UInt32 t = 1; t < nThreads; ++t)
+			pool.emplace_back(Worker);
+		Worker();
+		for (std::thread& th : pool)
+			th.join();
+
+		// Объёмы — методом средних площадей между соседними пикетами
+		for (size_t i = 0; i < nSt; ++i) {
+			if (!out[i].foundL) ++totals.daylightMissing;
+			if (!out[i].foundR) ++totals.daylightMissing;
+			if (i == 0) continue;
+			const double ds = out[i].s - out[i - 1].s;
+			totals.cutVolume += 0.5 * (out[i - 1].cutArea + out[i].cutArea) * ds;
+			totals.fillVolume += 0.5 * (out[i - 1].fillArea + out[i].fillArea) * ds;
+		}
+		totals.stations = (UInt32)nSt;
+		totals.threads = nThreads;
+		return true;
+	}
+
+} // namespace Earthworks
@@ -0,0 +1,48 @@
+// Earthworks.hpp — земляные работы дороги: откосы от кромок проектного профиля
+// до пересечения с рельефом (линии нулевых работ), площади выемки/насыпи по
+// поперечникам и объёмы методом средних площадей. Станции независимы и
+// считаются параллельно; рельеф — TerrainSampler::Index (только чтение).
+#pragma once
+
+#include "PathEngine.hpp"
+#include "Corridor.hpp"
+#include "TerrainSampler.hpp"
+
+#include <vector>
+
+namespace Earthworks {
+
+	struct Params {
+		double cutSlopeH = 1.5;       // заложение откоса выемки (1 : m, по горизонтали на 1 м высоты)
+		double fillSlopeH = 2.0;      // заложение откоса насыпи
+		double stationStepM = 5.0;    // шаг поперечников по оси
+		double sampleStepM = 0.25;    // шаг по поперечнику (поиск пересечения и интегрирование)
+		double maxReachM = 50.0;      // наибольшая длина откоса в плане
+		double baseZ = 0.0;           // абсолютная отметка оси (высоты профиля — от неё)
+		UInt32 threads = 0;           // 0 — по числу ядер
+	};
+
+	struct StationResult {
+		double    s = 0.0;            // пикет по оси, м
+		API_Coord daylightL = {};     // точка нулевых работ слева / справа
+		API_Coord daylightR = {};
+		bool      foundL = false;
+		bool      foundR = false;
+		double    cutArea = 0.0;      // м²
+		double    fillArea = 0.0;     // м²
+	};
+
+	struct Totals {
+		double cutVolume = 0.0;       // м³
+		double fillVolume = 0.0;      // м³
+		UInt32 stations = 0;
+		UInt32 daylightMissing = 0;   // сторон без пересечения откоса с рельефом
+		UInt32 threads = 0;
+	};
+
+	// profile — точки перелома по возрастанию смещения (Corridor::Template::points):
+	// первая — правая кромка, последняя — левая.
+	bool Compute(const PathEngine::CompiledPath& axis, const std::vector<Corridor::Breakpoint>& profile,
+		const TerrainSampler::Index& terrain, const Params& p, std::vector<StationResult>& out, Totals& totals);
+
+} // namespace Earthworks
@@ -0,0 +1,94 @@
+// ElementBatch.cpp
+#include "ElementBatch.hpp"
+#include "AttributeCache.hpp"
+
+#include <unordered_map>
+
+namespace ElementBatch {
+
+	// ---------- Общий кэш умолчаний ----------
+	// Умолчания ссылаются на индексы слоёв, материалов, перьев — устаревают
+	// вместе с таблицами AttributeCache; номер сброса сверяется при каждом
+	// обращении (без вызова API)
+
+	static std::unordered_map<int, API_Element> s_defaults;   // typeID -> умолчания
+	static UInt32 s_defaultsEpoch = 0;
+
+	void InvalidateDefaults()
+	{
+		s_defaults.clear();
+	}
+
+	static const API_Element* GetDefaults(API_ElemTypeID typeID, UInt32& calls)
+	{
+		const UInt32 epoch = AttributeCache::GetEpoch();
+		if (epoch != s_defaultsEpoch) {
+			s_defaults.clear();
+			s_defaultsEpoch = epoch;
+		}
+
+		auto it = s_defaults.find((int)typeID);
+		if (it == s_defaults.end()) {
+			API_Element def = {};
+			def.header.type = typeID;
+			++calls;
+			if (ACAPI_Element_GetDefaults(&def, nullptr) != NoError)
+				return nullptr;
+			it = s_defaults.emplace((int)typeID, def).first;
+		}
+		return &it->second;
+	}
+
+	// ---------- Пакет ----------
+
+	Spec* Batch::Add(API_ElemTypeID typeID, const char* tag)
+	{
+		const API_Element* def = GetDefaults(typeID, m_defaultsCalls);
+		if (def == nullptr)
+			return nullptr;
+
+		m_specs.emplace_back();
+		Spec& spec = m_specs.back();
+		spec.element = *def;
+		spec.memo = {};
+		spec.tag = tag;
+		return &spec;
+	}
+
+	UInt32 Batch::CreateAll(std::vector<API_Guid>* outGuids)
+	{
+		UInt32 created = 0;
+		for (Spec& spec : m_specs) {
+			spec.element.header.guid = APINULLGuid;
+			const GSErrCode err = ACAPI_Element_Create(&spec.element, spec.hasMemo ? &spec.memo : nullptr);
+			if (spec.hasMemo) {
+				m_arena.Release(spec.memo);
+				spec.hasMemo = false;
+			}
+			if (err == NoError) ++created;
+			if (outGuids) outGuids->push_back(err == NoError ? spec.element.header.guid : APINULLGuid);
+		}
+		m_specs.clear();
+		return created;
+	}
+
+	bool Batch::Commit(const GS::UniString& undoName, std::vector<API_Guid>* outGuids, UInt32* outCreated)
+	{
+		UInt32 created = 0;
+		const GSErrCode err = ACAPI_CallUndoableCommand(undoName, [&]() -> GSErrCode {
+			created = CreateAll(outGuids);
+			return created > 0 ? NoError : APIERR_GENERAL;
+			});
+		Clear();
+		if (outCreated) *outCreated = created;
+		return err == NoError;
+	}
+
+	void Batch::Clear()
+	{
+		for (Spec& spec : m_specs)
+			if (spec.hasMemo) m_arena.Release(spec.memo);
+		m_specs.clear();
+	}
+
+} // namespace ElementBatch
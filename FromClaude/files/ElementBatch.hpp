@@ -0,0 +1,69 @@
+// ElementBatch.hpp — пакетное создание элементов: описания (элемент + memo)
+// копятся, затем создаются все разом одной командой Undo. Умолчания типа
+// (ACAPI_Element_GetDefaults) общие для всех пакетов: берутся один раз на тип
+// и сбрасываются по событиям AttributeCache (смена проекта, замена атрибутов,
+// смена умолчаний инструмента). Handle memo — из MemoArena пакета и
+// возвращаются в неё после создания.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "MemoArena.hpp"
+
+#include <deque>
+#include <vector>
+
+namespace ElementBatch {
+
+	struct Spec {
+		API_Element     element;
+		API_ElementMemo memo;
+		bool            hasMemo = false;   // memo заполнен из GetArena() и возвращается в неё
+		const char*     tag = "";          // для лога
+	};
+
+	class Batch {
+	public:
+		Batch() = default;
+		~Batch() { Clear(); }
+
+		Batch(const Batch&) = delete;
+		Batch& operator=(const Batch&) = delete;
+
+		// Новое описание с умолчаниями типа; nullptr — умолчания не получены.
+		// Указатель действителен до CreateAll/Commit/Clear. header.floorInd в
+		// умолчаниях — этаж, активный при первом запросе типа (смена этажа кэш
+		// не сбрасывает): этаж элемента задаёт вызывающий.
+		Spec* Add(API_ElemTypeID typeID, const char* tag);
+
+		// Пул handle для memo описаний
+		MemoArena::Arena& GetArena() { return m_arena; }
+
+		size_t GetSize() const { return m_specs.size(); }
+		// Вызовы ACAPI_Element_GetDefaults из Add этого пакета (0 — всё из общего кэша)
+		UInt32 GetDefaultsCalls() const { return m_defaultsCalls; }
+
+		// Создать накопленное внутри уже открытой команды Undo; описания
+		// снимаются, handle memo уходят в пул — следующие Add берут их оттуда,
+		// так что Add/CreateAll порциями не гоняют аллокатор. В outGuids
+		// дописываются guid по порядку Add (APINULLGuid для не созданных).
+		// Возвращает число созданных.
+		UInt32 CreateAll(std::vector<API_Guid>* outGuids = nullptr);
+
+		// Одна команда Undo на весь пакет; false — команда не прошла или не
+		// создан ни один элемент
+		bool Commit(const GS::UniString& undoName, std::vector<API_Guid>* outGuids = nullptr, UInt32* outCreated = nullptr);
+
+		// Снять описания, memo — в пул
+		void Clear();
+
+	private:
+		std::deque<Spec>                    m_specs;      // адреса не меняются при Add
+		UInt32                              m_defaultsCalls = 0;
+		MemoArena::Arena                    m_arena;
+	};
+
+	// Сбросить общий кэш умолчаний вручную (обычно хватает событий AttributeCache)
+	void InvalidateDefaults();
+
+} // namespace ElementBatch
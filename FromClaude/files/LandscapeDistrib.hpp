@@ -0,0 +1,76 @@
+// LandscapeDistrib.hpp — режимы распределения LandscapeHelper поверх
+// SetDistributionLine/SetDistributionObject: посадка на рельеф (Mesh),
+// обход препятствий, разброс прототипа в контуре (пуассоновский диск) и
+// регулярная решётка в контуре, управляемый повторный запуск без копий.
+#pragma once
+
+#include "LandscapeHelper.hpp"
+
+#include <vector>
+
+namespace LandscapeHelper {
+
+	// Посадка экземпляров на рельеф SetDistributionTerrain. Отметка задаётся
+	// полем своего типа: объект/светильник — level, колонна — bottomOffset,
+	// балка — level (ось) и, при tiltBeams, slantAngle по отметкам концов.
+	struct TerrainFollow {
+		bool   enabled = false;
+		double offsetMM = 0.0;     // подъём над рельефом
+		bool   tiltBeams = false;  // балку — по уклону рельефа между концами
+	};
+
+	// Mesh рельефа — первый Mesh из выделения; false — Mesh не выделен
+	bool SetDistributionTerrain();
+	void SetDistributionTerrainFollow(const TerrainFollow& follow);
+
+	// Препятствия: габариты элементов выбранных слоёв на этаже прототипа и
+	// отрезки линий/полилиний/дуг/сплайнов. Точка ближе clearanceMM к ним
+	// пропускается — и вдоль путей, и при разбросе в контуре.
+	struct ObstacleParams {
+		bool                       enabled = false;
+		std::vector<GS::UniString> layers;            // имена слоёв; пусто — все слои
+		double                     clearanceMM = 500.0;
+	};
+
+	void SetDistributionObstacles(const ObstacleParams& params);
+
+	// Управляемый режим: экземпляры помечаются путём/контуром и прототипом;
+	// повторный запуск (другой шаг, сдвинутый путь) оставляет совпавшие в
+	// пределах toleranceMM, сдвигает ближайшие в moveRadiusMM, создаёт и
+	// удаляет только остальные. Всё — одной командой Undo запуска.
+	struct ManagedParams {
+		bool   enabled = false;
+		double toleranceMM = 10.0;
+		double moveRadiusMM = 0.0;   // 0 — половина шага расстановки
+	};
+
+	void SetDistributionManaged(const ManagedParams& params);
+
+	struct ScatterParams {
+		double spacingMM = 3000.0;        // наименьшее расстояние между экземплярами
+		UInt64 seed = 1;                  // тот же seed — та же раскладка
+		double rotationJitterDeg = 0.0;   // угол прототипа ± разброс (180 — любой)
+		double scaleJitter = 0.0;         // масштаб плана 1 ± разброс (объект/светильник)
+		UInt32 maxCount = 0;              // 0 — без ограничения
+	};
+
+	// Контур разброса — первая штриховка/перекрытие/полилиния/окружность/
+	// сплайн из выделения; отверстия штриховки и перекрытия остаются пустыми
+	bool SetScatterBoundary();
+	// Прототип SetDistributionObject в контуре SetScatterBoundary одной
+	// командой Undo; посадка на рельеф — как у DistributeSelected
+	bool ScatterInBoundary(const ScatterParams& params);
+
+	struct PatternParams {
+		enum Kind { Square, Hex };
+		Kind   kind = Square;
+		double spacingMM = 5000.0;   // шаг решётки (у Hex — между соседями в ряду)
+		double angleDeg = 0.0;       // поворот решётки и экземпляров
+	};
+
+	// Прототип в узлах квадратной/шестиугольной решётки внутри контура
+	// SetScatterBoundary (отверстия пропускаются) одной командой Undo;
+	// рельеф, препятствия и управляемый режим — как у ScatterInBoundary
+	bool FillBoundaryPattern(const PatternParams& params);
+
+} // namespace LandscapeHelper
@@ -2,12 +2,25 @@
 #include "APIEnvir.h"
 #include "ACAPinc.h"
 #include "LandscapeHelper.hpp"
+#include "LandscapeDistrib.hpp"
 #include "BrowserRepl.hpp"
 #include "APICommon.h"
+#include "PathEngine.hpp"
+#include "TerrainSampler.hpp"
+#include "Boundary.hpp"
+#include "Scatter.hpp"
+#include "ObstacleIndex.hpp"
+#include "AttributeCache.hpp"
+#include "ManagedSet.hpp"
+#include "BoundedQueue.hpp"
 
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <thread>
 
 namespace LandscapeHelper {
 
@@ -19,6 +32,19 @@ namespace LandscapeHelper {
 	static double    g_stepM = 0.0; // ВНУТРИ: метры (UI → мм → м)
 	static int       g_count = 1;
 
+	// ---------- Рельеф ----------
+	static API_Guid      g_terrainGuid = APINULLGuid;
+	static TerrainFollow g_terrainFollow;
+
+	// ---------- Разброс в контуре ----------
+	static API_Guid g_boundaryGuid = APINULLGuid;
+
+	// ---------- Препятствия ----------
+	static ObstacleParams g_obstacles;
+
+	// ---------- Управляемая расстановка ----------
+	static ManagedParams g_managed;
+
 	static inline void LogA(const char* s) {
 		// if (BrowserRepl::HasInstance())
 		//	BrowserRepl::GetInstance().LogToBrowser(GS::UniString(s));
@@ -31,244 +57,36 @@ namespace LandscapeHelper {
 	}
 	static inline double UiStepToMeters(double stepMm) { return stepMm / 1000.0; }
 
-	// ---------- Геометрия ----------
-	struct Seg {
-		enum Kind { Line, Arc } kind;
-		API_Coord a{}, b{};   // Line
-		API_Coord c{};        // Arc: center
-		double    r = 0.0;
-		double    a0 = 0.0;   // start angle
-		double    a1 = 0.0;   // end angle (a1 - a0 = signed sweep)
-		double    L = 0.0;   // length
-	};
-
-	static inline double Dist(const API_Coord& p, const API_Coord& q) {
-		return std::hypot(q.x - p.x, q.y - p.y);
-	}
-	static inline API_Coord Lerp(const API_Coord& p, const API_Coord& q, double t) {
-		return { p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t };
-	}
-	static inline void PushLine(std::vector<Seg>& segs, const API_Coord& a, const API_Coord& b) {
-		Seg s; s.kind = Seg::Line; s.a = a; s.b = b; s.L = Dist(a, b);
-		if (s.L > 1e-9) segs.push_back(s);
-	}
-	static inline double Norm2PI(double a) {
-		const double two = 2.0 * PI;
-		while (a < 0.0)   a += two;
-		while (a >= two)  a -= two;
-		return a;
-	}
-	static inline double CCWDelta(double a0, double a1) {
-		a0 = Norm2PI(a0); a1 = Norm2PI(a1);
-		double d = a1 - a0; if (d < 0.0) d += 2.0 * PI;
-		return d; // [0,2pi)
-	}
-
-	// --------- Безье для сплайна ---------
-	static inline API_Coord Add(const API_Coord& a, const API_Coord& b) { return { a.x + b.x, a.y + b.y }; }
-	static inline API_Coord Sub(const API_Coord& a, const API_Coord& b) { return { a.x - b.x, a.y - b.y }; }
-	static inline API_Coord Mul(const API_Coord& a, double s) { return { a.x * s,   a.y * s }; }
-	static inline API_Coord FromAngLen(double ang, double len) { return { std::cos(ang) * len, std::sin(ang) * len }; }
-	static inline API_Coord BezierPoint(const API_Coord& P0, const API_Coord& C1,
-		const API_Coord& C2, const API_Coord& P3, double t)
-	{
-		const double u = 1.0 - t;
-		const double b0 = u * u * u, b1 = 3 * u * u * t, b2 = 3 * u * t * t, b3 = t * t * t;
-		return { b0 * P0.x + b1 * C1.x + b2 * C2.x + b3 * P3.x,
-				 b0 * P0.y + b1 * C1.y + b2 * C2.y + b3 * P3.y };
-	}
-
-	// ============= Полилиния (coords + parcs + pends(Int32)) =============
-	static void BuildFromPolyMemo(std::vector<Seg>& out, API_ElementMemo& memo)
-	{
-		if (memo.coords == nullptr) return;
-
-		const Int32 nAll = (Int32)(BMGetHandleSize((GSHandle)memo.coords) / sizeof(API_Coord));
-		const Int32 nPts = std::max<Int32>(0, nAll - 1);            // валидные 1..nPts
-		if (nPts < 2) return;
-
-		// «концы» цепочек (многоконтур/разрывы) — Int32
-		std::vector<Int32> ends;
-		if (memo.pends != nullptr) {
-			const Int32 nEnds = (Int32)(BMGetHandleSize((GSHandle)memo.pends) / sizeof(Int32));
-			for (Int32 k = 0; k < nEnds; ++k) {
-				const Int32 ind = (*memo.pends)[k];
-				if (ind >= 1 && ind <= nPts) ends.push_back(ind);
-			}
-		}
-		if (ends.empty()) ends.push_back(nPts); // одна открытая цепочка 1..nPts
+	// ---------- Геометрия: сегменты пути и параметризация по длине (PathEngine) ----------
+	using PathEngine::CompiledPath;
 
-		auto isEnd = [&](Int32 i) -> bool {
-			return std::find(ends.begin(), ends.end(), i) != ends.end();
-			};
-
-		// карта дуг по begIndex (разрешаем только рёбра 1..nPts-1)
-		std::vector<double> arcByBeg(nPts + 1, 0.0);
-		if (memo.parcs != nullptr) {
-			const Int32 nArcs = (Int32)(BMGetHandleSize((GSHandle)memo.parcs) / sizeof(API_PolyArc));
-			for (Int32 k = 0; k < nArcs; ++k) {
-				const API_PolyArc& pa = (*memo.parcs)[k];
-				if (pa.begIndex >= 1 && pa.begIndex <= nPts - 1)
-					arcByBeg[pa.begIndex] = pa.arcAngle; // со знаком
-			}
-		}
-
-		for (Int32 i = 1; i <= nPts - 1; ++i) {
-			if (isEnd(i)) continue;               // не соединяем через конец цепочки
-
-			const Int32 j = i + 1;
-			const API_Coord& A = (*memo.coords)[i];
-			const API_Coord& B = (*memo.coords)[j];
-
-			const double angArc = arcByBeg[i];
-			if (std::fabs(angArc) < 1e-9) { PushLine(out, A, B); continue; }
-
-			// две возможные окружности — выбираем ту, у которой sweep по знаку/модулю ближе к arcAngle
-			const double dx = B.x - A.x, dy = B.y - A.y;
-			const double chord = std::hypot(dx, dy);
-			if (chord < 1e-9) continue;
-
-			const double r = std::fabs(chord / (2.0 * std::sin(std::fabs(angArc) * 0.5)));
-			const double mx = (A.x + B.x) * 0.5, my = (A.y + B.y) * 0.5;
-			const double nx = -dy / chord, ny = dx / chord;
-			const double d = std::sqrt(std::max(r * r - 0.25 * chord * chord, 0.0));
-
-			struct Cand { API_Coord c; double a0, a1, L; };
-			auto makeCand = [&](double sx, double sy) -> Cand {
-				const double cx = mx + sx * d, cy = my + sy * d;
-				const double aA = std::atan2(A.y - cy, A.x - cx);
-				const double aB = std::atan2(B.y - cy, B.x - cx);
-				double sweep = (angArc > 0.0) ? CCWDelta(aA, aB) : -CCWDelta(aB, aA);
-				Cand cnd; cnd.c = { cx, cy }; cnd.a0 = aA; cnd.a1 = aA + sweep; cnd.L = r * std::fabs(sweep);
-				return cnd;
-				};
-
-			const Cand c1 = makeCand(nx, ny);
-			const Cand c2 = makeCand(-nx, -ny);
-
-			const double d1 = std::fabs((c1.a1 - c1.a0) - angArc);
-			const double d2 = std::fabs((c2.a1 - c2.a0) - angArc);
-			const Cand& best = (d1 <= d2 ? c1 : c2);
-
-			Seg s; s.kind = Seg::Arc; s.c = best.c; s.r = r; s.a0 = best.a0; s.a1 = best.a1; s.L = best.L;
-			if (s.L > 1e-9) out.push_back(s);
-		}
-	}
-
-	// ============= Сборка пути по элементу =============
-	static bool BuildPathSegments(const API_Guid& pathGuid, std::vector<Seg>& segs, double* totalLen)
-	{
-		segs.clear();
-		if (totalLen) *totalLen = 0.0;
+	// ---------- Посадка на рельеф ----------
+	// Индекс треугольников строится один раз на запуск; экземпляры
+	// создаются блоками по kPlaceBlock, отметки блока — одним SampleBatch.
+	static constexpr UInt32 kPlaceBlock = 256;
+	// Очередь блоков от рабочих потоков к главному (DistributeSelected)
+	static constexpr size_t kQueueBlocks = 64;
 
-		API_Element e = {}; e.header.guid = pathGuid;
-		if (ACAPI_Element_Get(&e) != NoError) return false;
-
-		switch (e.header.type.typeID) {
-		case API_LineID:
-			PushLine(segs, e.line.begC, e.line.endC);
-			break;
-
-		case API_ArcID: {
-			Seg s; s.kind = Seg::Arc; s.c = e.arc.origC; s.r = e.arc.r;
-			double a0 = Norm2PI(e.arc.begAng);
-			double sweep = e.arc.endAng - a0;
-			while (sweep <= -2.0 * PI) sweep += 2.0 * PI;
-			while (sweep > 2.0 * PI) sweep -= 2.0 * PI;
-			s.a0 = a0; s.a1 = a0 + sweep; s.L = s.r * std::fabs(sweep);
-			if (s.L > 1e-9) segs.push_back(s);
-			break;
-		}
-
-		case API_CircleID: {
-			Seg s; s.kind = Seg::Arc; s.c = e.circle.origC; s.r = e.circle.r;
-			s.a0 = 0.0; s.a1 = 2.0 * PI; s.L = 2.0 * PI * s.r;
-			segs.push_back(s);
-			break;
-		}
-
-		case API_PolyLineID: {
-			API_ElementMemo memo = {};
-			if (ACAPI_Element_GetMemo(pathGuid, &memo) == NoError && memo.coords != nullptr)
-				BuildFromPolyMemo(segs, memo);
-			ACAPI_DisposeElemMemoHdls(&memo);
-			break;
-		}
-
-		case API_SplineID: {
-			// Кубические Безье по bezierDirs (качественно + предсказуемо)
-			API_ElementMemo memo = {};
-			if (ACAPI_Element_GetMemo(pathGuid, &memo, APIMemoMask_Polygon) == NoError &&
-				memo.coords != nullptr && memo.bezierDirs != nullptr)
-			{
-				const Int32 n = (Int32)(BMGetHandleSize((GSHandle)memo.coords) / sizeof(API_Coord));
-				if (n >= 2) {
-					for (Int32 i = 0; i < n - 1; ++i) {
-						const API_Coord P0 = (*memo.coords)[i];
-						const API_Coord P3 = (*memo.coords)[i + 1];
-						const API_SplineDir d0 = (*memo.bezierDirs)[i];
-						const API_SplineDir d1 = (*memo.bezierDirs)[i + 1];
-						const API_Coord C1 = Add(P0, FromAngLen(d0.dirAng, d0.lenNext));
-						const API_Coord C2 = Sub(P3, FromAngLen(d1.dirAng, d1.lenPrev));
-
-						const int N = 32; // сабсегментов на ребро
-						API_Coord prev = P0;
-						for (int k = 1; k <= N; ++k) {
-							const double t = (double)k / (double)N;
-							const API_Coord pt = BezierPoint(P0, C1, C2, P3, t);
-							PushLine(segs, prev, pt);
-							prev = pt;
-						}
-					}
-				}
-			}
-			ACAPI_DisposeElemMemoHdls(&memo);
-			break;
-		}
-
-		default: return false;
-		}
-
-		if (segs.empty()) return false;
-
-		double sum = 0.0; for (const Seg& s : segs) sum += s.L;
-		if (totalLen) *totalLen = sum;
-
-		GS::UniString dbg; dbg.Printf("[Distrib] path len=%.3f, segs=%u", sum, (unsigned)segs.size());
-		Log(dbg);
-		return sum > 1e-9;
-	}
+	struct TerrainPlacement {
+		const TerrainSampler::Index* index = nullptr;
+		double baseZ = 0.0;        // уровень этажа прототипа минус подъём над рельефом
+		bool   tiltBeams = false;
+	};
 
-	// ============= Параметризация по длине s =============
-	static void EvalOnPath(const std::vector<Seg>& segs, double s, API_Coord* outP, double* outTanAngleRad)
+	static double GetStoryLevel(short floorInd)
 	{
-		double acc = 0.0;
-		for (const Seg& seg : segs) {
-			if (s > acc + seg.L) { acc += seg.L; continue; }
-			const double f = (seg.L < 1e-9) ? 0.0 : (s - acc) / seg.L;
-
-			if (seg.kind == Seg::Line) {
-				if (outP)           *outP = Lerp(seg.a, seg.b, f);
-				if (outTanAngleRad) *outTanAngleRad = std::atan2(seg.b.y - seg.a.y, seg.b.x - seg.a.x);
-			}
-			else {
-				const double sweep = seg.a1 - seg.a0;                 // со знаком!
-				const double ang = seg.a0 + f * sweep;
-				if (outP)           *outP = { seg.c.x + seg.r * std::cos(ang), seg.c.y + seg.r * std::sin(ang) };
-				if (outTanAngleRad) *outTanAngleRad = ang + ((sweep >= 0.0) ? +PI / 2.0 : -PI / 2.0);
-			}
-			return;
-		}
-		const Seg& seg = segs.back();
-		if (seg.kind == Seg::Line) {
-			if (outP)           *outP = seg.b;
-			if (outTanAngleRad) *outTanAngleRad = std::atan2(seg.b.y - seg.a.y, seg.b.x - seg.a.x);
-		}
-		else {
-			const double sweep = seg.a1 - seg.a0;
-			if (outP)           *outP = { seg.c.x + seg.r * std::cos(seg.a1), seg.c.y + seg.r * std::sin(seg.a1) };
-			if (outTanAngleRad) *outTanAngleRad = seg.a1 + ((sweep >= 0.0) ? +PI / 2.0 : -PI / 2.0);
-		}
+		API_StoryInfo si = {};
+		if (ACAPI_ProjectSetting_GetStorySettings(&si) != NoError || si.data == nullptr)
+			return 0.0;
+
+		double level = 0.0;
+		const Int32 cnt = (Int32)(BMGetHandleSize((GSHandle)si.data) / sizeof(API_StoryType));
+		const Int32 idx = floorInd - si.firstStory;
+		if (idx >= 0 && idx < cnt)
+			level = (*si.data)[idx].level;
+
+		BMKillHandle((GSHandle*)&si.data);
+		return level;
 	}
 
 	// ---------- Утилиты выбора ----------
@@ -416,85 +234,392 @@ namespace LandscapeHelper {
 		return false;
 	}
 
-	static bool DistributeOnSinglePath(const API_Element& proto, API_ElemTypeID tid,
-		const std::vector<Seg>& segs, double totalLen,
-		const double useStepM, const int useCount,
-		API_ElementMemo* protoMemo, UInt32* outCreated)
+	bool SetDistributionTerrain()
 	{
-		// точки размещения
-		std::vector<double> sVals;
-		if (useStepM > 1e-9) {
-			for (double s = 0.0; s <= totalLen + 1e-9; s += useStepM)
-				sVals.push_back(std::min(s, totalLen));
-		}
-		else {
-			if (useCount == 1) sVals.push_back(0.0);
-			else {
-				const double st = totalLen / (double)(useCount - 1);
-				for (int i = 0; i < useCount; ++i)
-					sVals.push_back(std::min(st * i, totalLen));
+		g_terrainGuid = APINULLGuid;
+
+		API_SelectionInfo si = {}; GS::Array<API_Neig> neigs;
+		ACAPI_Selection_Get(&si, &neigs, false, false);
+		BMKillHandle((GSHandle*)&si.marquee.coords);
+
+		for (const API_Neig& n : neigs) {
+			API_Element el = {}; el.header.guid = n.guid;
+			if (ACAPI_Element_GetHeader(&el.header) != NoError) continue;
+			if (el.header.type.typeID == API_MeshID) {
+				g_terrainGuid = n.guid;
+				GS::UniString dbg; dbg.Printf("[Distrib] TERRAIN SET: %s", APIGuidToString(n.guid).ToCStr().Get());
+				Log(dbg);
+				return true;
 			}
 		}
+		LogA("[Distrib] ERR no-mesh");
+		return false;
+	}
 
-		UInt32 created = 0;
-		for (double s : sVals) {
-			API_Coord P; double ang = 0.0;
-			EvalOnPath(segs, s, &P, &ang);
+	void SetDistributionTerrainFollow(const TerrainFollow& follow)
+	{
+		g_terrainFollow = follow;
+		GS::UniString m; m.Printf("[Distrib] terrain follow=%d, offset(mm)=%.1f, tilt beams=%d",
+			(int)follow.enabled, follow.offsetMM, (int)follow.tiltBeams);
+		Log(m);
+	}
 
-			API_Element e = proto; 
-			e.header.guid = APINULLGuid;  // Важно: сбрасываем GUID для создания нового элемента
+	void SetDistributionManaged(const ManagedParams& params)
+	{
+		g_managed = params;
+		GS::UniString m; m.Printf("[Distrib] managed=%d, tolerance(mm)=%.1f, move radius(mm)=%.1f",
+			(int)params.enabled, params.toleranceMM, params.moveRadiusMM);
+		Log(m);
+	}
+
+	void SetDistributionObstacles(const ObstacleParams& params)
+	{
+		g_obstacles = params;
+		GS::UniString m; m.Printf("[Distrib] obstacles=%d, layers=%u, clearance(mm)=%.1f",
+			(int)params.enabled, (unsigned)params.layers.size(), params.clearanceMM);
+		Log(m);
+	}
+
+	// Концы балки: середина в точке P, направление перпендикулярно пути
+	// (угол пути плюс PI/2), длина — как у прототипа
+	static inline void BeamEnds(const API_Coord& P, double ang, double halfLen, API_Coord& beg, API_Coord& end)
+	{
+		const double beamAng = ang + PI / 2.0;
+		beg.x = P.x - halfLen * std::cos(beamAng);
+		beg.y = P.y - halfLen * std::sin(beamAng);
+		end.x = P.x + halfLen * std::cos(beamAng);
+		end.y = P.y + halfLen * std::sin(beamAng);
+	}
+
+	// Угол прототипа в тех же единицах, что угол пути для Placement::ang
+	static double ProtoAngle(const API_Element& proto)
+	{
+		switch (proto.header.type.typeID) {
+		case API_ObjectID: return proto.object.angle;
+		case API_LampID:   return proto.lamp.angle;
+		case API_ColumnID: return proto.column.axisRotationAngle;
+		case API_BeamID:
+			return std::atan2(proto.beam.endC.y - proto.beam.begC.y, proto.beam.endC.x - proto.beam.begC.x) - PI / 2.0;
+		default:
+			return 0.0;
+		}
+	}
+
+	// Экземпляр прототипа: точка, угол (для балки — угол пути, балка поперёк),
+	// масштаб плана объекта/светильника (1 — как у прототипа)
+	struct Placement {
+		API_Coord P;
+		double    ang;
+		double    scale;
+	};
+
+	// Экземпляр, готовый к созданию: положение и отметки рельефа (точка и,
+	// для наклона балки, её концы); source — номер пути/источника в запуске
+	struct Prepared {
+		Placement p;
+		UInt32    source = 0;
+		double    z[3] = {};
+		bool      hit[3] = {};
+	};
+	using PreparedBlock = std::vector<Prepared>;
+
+	// Окружение расстановки на один запуск (nullptr — выключено)
+	struct PlaceContext {
+		const TerrainPlacement*     terrain = nullptr;
+		const ObstacleIndex::Index* obstacles = nullptr;
+		double                      clearanceM = 0.0;
+	};
 
-			if (tid == API_ObjectID) { 
-				e.object.pos = P;  
-				e.object.angle = ang; 
+	static inline double BeamLength(const API_Element& proto)
+	{
+		return (proto.header.type.typeID == API_BeamID)
+			? std::hypot(proto.beam.endC.x - proto.beam.begC.x, proto.beam.endC.y - proto.beam.begC.y)
+			: 0.0;
+	}
+
+	// Наклон балки по рельефу: в пакет идут и её концы
+	static inline bool TiltsBeam(const API_Element& proto, const PlaceContext& ctx)
+	{
+		return ctx.terrain != nullptr && ctx.terrain->tiltBeams && BeamLength(proto) > 1e-9;
+	}
+
+	// Расчёт без вызовов API — годится для рабочих потоков. Push отбрасывает
+	// точки у препятствий и копит блок kPlaceBlock; на полном блоке (и во
+	// Flush) отметки всего блока берутся одним SampleBatch, и блок уходит в sink.
+	class Planner {
+	public:
+		using Sink = std::function<void(PreparedBlock&&)>;
+
+		Planner(const API_Element& proto, const PlaceContext& ctx, UInt32 source, Sink sink)
+			: m_ctx(ctx)
+			, m_source(source)
+			, m_sink(std::move(sink))
+		{
+			m_halfLen = BeamLength(proto) * 0.5;
+			m_tiltBeam = TiltsBeam(proto, ctx);
+			m_perItem = m_tiltBeam ? 3 : 1;
+			m_block.reserve(kPlaceBlock);
+			if (ctx.terrain != nullptr) {
+				m_samplePts.resize(kPlaceBlock * m_perItem);
+				m_sampleZ.resize(kPlaceBlock * m_perItem);
+				m_sampleHit.reset(new bool[kPlaceBlock * m_perItem]);   // не vector<bool>: SampleBatch пишет в bool*
 			}
-			else if (tid == API_LampID) { 
-				e.lamp.pos = P;  
-				e.lamp.angle = ang; 
+		}
+
+		void Push(const Placement& p)
+		{
+			if (m_ctx.obstacles != nullptr && m_ctx.obstacles->Hits(p.P.x, p.P.y, m_ctx.clearanceM)) {
+				++m_blocked;
+				return;
 			}
-			else if (tid == API_BeamID) {
-				// Балка: размещаем по центру (середина балки совпадает с точкой P на пути)
-				// Добавляем поворот на 90 градусов (PI/2) к углу пути
-				const double beamAng = ang + PI / 2.0;
-				const double beamLen = std::hypot(
-					proto.beam.endC.x - proto.beam.begC.x,
-					proto.beam.endC.y - proto.beam.begC.y);
-				// Новая балка: середина в точке P, направление перпендикулярно пути (повернуто на 90°)
-				const double halfLen = beamLen * 0.5;
-				e.beam.begC.x = P.x - halfLen * std::cos(beamAng);
-				e.beam.begC.y = P.y - halfLen * std::sin(beamAng);
-				e.beam.endC.x = P.x + halfLen * std::cos(beamAng);
-				e.beam.endC.y = P.y + halfLen * std::sin(beamAng);
+			Prepared item;
+			item.p = p;
+			item.source = m_source;
+			m_block.push_back(item);
+			if (m_block.size() >= kPlaceBlock)
+				Flush();
+		}
+
+		void Flush();
+
+		UInt32 GetBlocked() const { return m_blocked; }
+
+	private:
+		const PlaceContext&     m_ctx;
+		UInt32                  m_source;
+		Sink                    m_sink;
+		double                  m_halfLen = 0.0;
+		bool                    m_tiltBeam = false;
+		UInt32                  m_perItem = 1;
+
+		PreparedBlock           m_block;
+		std::vector<API_Coord>  m_samplePts;
+		std::vector<double>     m_sampleZ;
+		std::unique_ptr<bool[]> m_sampleHit;
+
+		UInt32 m_blocked = 0;
+	};
+
+	void Planner::Flush()
+	{
+		const UInt32 n = (UInt32)m_block.size();
+		if (n == 0)
+			return;
+
+		if (m_ctx.terrain != nullptr) {
+			for (UInt32 i = 0; i < n; ++i) {
+				m_samplePts[i * m_perItem] = m_block[i].p.P;
+				if (m_tiltBeam)
+					BeamEnds(m_block[i].p.P, m_block[i].p.ang, m_halfLen, m_samplePts[i * m_perItem + 1], m_samplePts[i * m_perItem + 2]);
 			}
-			else if (tid == API_ColumnID) { 
-				// Колонна: устанавливаем позицию и угол поворота
-				// Важно: сохраняем все параметры из прототипа (bottomOffset, topOffset, floorInd и т.д.)
-				e.column.origoPos = P; 
-				e.column.axisRotationAngle = ang;
-				// Явно сохраняем этаж из прототипа (должен скопироваться, но для надежности)
-				// e.header.floorInd уже скопирован из proto через e = proto
+			m_ctx.terrain->index->SampleBatch(m_samplePts.data(), n * m_perItem, m_sampleZ.data(), m_sampleHit.get());
+			for (UInt32 i = 0; i < n; ++i) {
+				for (UInt32 j = 0; j < m_perItem; ++j) {
+					m_block[i].z[j] = m_sampleZ[i * m_perItem + j];
+					m_block[i].hit[j] = m_sampleHit[i * m_perItem + j];
+				}
 			}
+		}
 
-			const GSErrCode ce = ACAPI_Element_Create(&e, protoMemo);
-			if (ce == NoError) {
-				++created;
-				if (tid == API_ColumnID) {
-					GS::UniString colDbg; colDbg.Printf("[Distrib] Column created at (%.3f, %.3f), floor=%d, ang=%.3fdeg", 
-						P.x, P.y, (int)e.header.floorInd, ang * 180.0 / PI);
-					Log(colDbg);
-				}
+		m_sink(std::move(m_block));
+		m_block = PreparedBlock();
+		m_block.reserve(kPlaceBlock);
+	}
+
+	// Создание на главном потоке внутри команды Undo (GetCreated — число
+	// поставленных, в управляемом режиме вместе с оставленными и сдвинутыми)
+	class Creator {
+	public:
+		Creator(const API_Element& proto, const PlaceContext& ctx, API_ElementMemo* protoMemo)
+			: m_proto(proto)
+			, m_tid(proto.header.type.typeID)
+			, m_terrain(ctx.terrain)
+			, m_memo(protoMemo)
+		{
+			m_beamLen = BeamLength(proto);
+			m_tiltBeam = TiltsBeam(proto, ctx);
+		}
+
+		// managed — сверка с прежними экземплярами источника (nullptr — создать)
+		void Create(const Prepared& item, ManagedSet::Reconciler* managed);
+
+		UInt32 GetCreated() const { return m_created; }
+		UInt32 GetOffTerrain() const { return m_offTerrain; }
+
+	private:
+		const API_Element&      m_proto;
+		const API_ElemTypeID    m_tid;
+		const TerrainPlacement* m_terrain;
+		API_ElementMemo*        m_memo;
+		double                  m_beamLen = 0.0;
+		bool                    m_tiltBeam = false;
+
+		UInt32 m_created = 0;
+		UInt32 m_offTerrain = 0;
+	};
+
+	void Creator::Create(const Prepared& item, ManagedSet::Reconciler* managed)
+	{
+		const Placement& p = item.p;
+		const API_Coord& P = p.P;
+		const double ang = p.ang;
+
+		API_Element e = m_proto; 
+		e.header.guid = APINULLGuid;  // Важно: сбрасываем GUID для создания нового элемента
+
+		if (m_tid == API_ObjectID) { 
+			e.object.pos = P;  
+			e.object.angle = ang; 
+			e.object.xRatio *= p.scale;
+			e.object.yRatio *= p.scale;
+		}
+		else if (m_tid == API_LampID) { 
+			e.lamp.pos = P;  
+			e.lamp.angle = ang; 
+			e.lamp.xRatio *= p.scale;
+			e.lamp.yRatio *= p.scale;
+		}
+		else if (m_tid == API_BeamID) {
+			// Балка: середина совпадает с точкой P на пути, поперёк пути
+			BeamEnds(P, ang, m_beamLen * 0.5, e.beam.begC, e.beam.endC);
+		}
+		else if (m_tid == API_ColumnID) { 
+			// Колонна: устанавливаем позицию и угол поворота
+			// Важно: сохраняем все параметры из прототипа (bottomOffset, topOffset, floorInd и т.д.)
+			e.column.origoPos = P; 
+			e.column.axisRotationAngle = ang;
+			// Явно сохраняем этаж из прототипа (должен скопироваться, но для надежности)
+			// e.header.floorInd уже скопирован из proto через e = proto
+		}
+
+		// Рельеф: отметка от уровня этажа прототипа; вне сетки — отметка прототипа
+		if (m_terrain != nullptr) {
+			if (!item.hit[0]) {
+				++m_offTerrain;
 			}
 			else {
-				GS::UniString msg; 
-				msg.Printf("[Distrib] Create err=%d (type=%d, floor=%d)", 
-					(int)ce, (int)tid, (int)e.header.floorInd); 
-				Log(msg);
+				const double level = item.z[0] - m_terrain->baseZ;
+				if (m_tid == API_ObjectID)      e.object.level = level;
+				else if (m_tid == API_LampID)   e.lamp.level = level;
+				else if (m_tid == API_ColumnID) e.column.bottomOffset = level;
+				else if (m_tid == API_BeamID) {
+					e.beam.level = level;
+					// наклон: отметка оси — у начала, уклон — по отметкам концов
+					if (m_tiltBeam && item.hit[1] && item.hit[2]) {
+						e.beam.level = item.z[1] - m_terrain->baseZ;
+						e.beam.slantAngle = std::atan2(item.z[2] - item.z[1], m_beamLen);
+					}
+				}
 			}
 		}
 
-		if (outCreated) *outCreated += created;
-		GS::UniString dbg; dbg.Printf("[Distrib] path created=%u", (unsigned)created); Log(dbg);
-		return created > 0;
+		// Управляемый режим: прежний экземпляр остаётся или сдвигается,
+		// создаётся только недостающий
+		if (managed != nullptr) {
+			if (managed->Place(e, m_memo)) ++m_created;
+			return;
+		}
+
+		const GSErrCode ce = ACAPI_Element_Create(&e, m_memo);
+		if (ce == NoError) {
+			++m_created;
+			if (m_tid == API_ColumnID) {
+				GS::UniString colDbg; colDbg.Printf("[Distrib] Column created at (%.3f, %.3f), floor=%d, ang=%.3fdeg", 
+					P.x, P.y, (int)e.header.floorInd, ang * 180.0 / PI);
+				Log(colDbg);
+			}
+		}
+		else {
+			GS::UniString msg; 
+			msg.Printf("[Distrib] Create err=%d (type=%d, floor=%d)", 
+				(int)ce, (int)m_tid, (int)e.header.floorInd); 
+			Log(msg);
+		}
+	}
+
+	// Посадка на рельеф, если включена: индекс по g_terrainGuid и базовая
+	// отметка этажа прототипа. false — посадка включена, но рельефа нет.
+	static bool PrepareTerrain(const API_Element& proto, TerrainSampler::Index& index,
+		TerrainPlacement& terrain, const TerrainPlacement*& useTerrain)
+	{
+		useTerrain = nullptr;
+		if (!g_terrainFollow.enabled)
+			return true;
+		if (g_terrainGuid == APINULLGuid || !index.Build(g_terrainGuid) || index.IsEmpty()) {
+			LogA("[Distrib] ERR terrain (SetDistributionTerrain)");
+			return false;
+		}
+		terrain.index = &index;
+		terrain.baseZ = GetStoryLevel(proto.header.floorInd) - g_terrainFollow.offsetMM / 1000.0;
+		terrain.tiltBeams = g_terrainFollow.tiltBeams;
+		useTerrain = &terrain;
+		GS::UniString tDbg; tDbg.Printf("[Distrib] terrain tris=%u", (unsigned)index.GetTriangleCount());
+		Log(tDbg);
+		return true;
+	}
+
+	// Препятствия, если включены: элементы слоёв g_obstacles на этаже
+	// прототипа, кроме путей, контура, рельефа, самого прототипа и прежних
+	// управляемых экземпляров источников sources (их сверяет Reconciler —
+	// иначе они загородили бы свои же станции). Нет препятствий (или слоёв
+	// с такими именами) — расстановка без проверки.
+	static void PrepareObstacles(const API_Element& proto, const ManagedSet::Registry& registry,
+		const std::vector<API_Guid>& sources, ObstacleIndex::Index& index, PlaceContext& ctx)
+	{
+		ctx.obstacles = nullptr;
+		if (!g_obstacles.enabled)
+			return;
+
+		ObstacleIndex::BuildParams bp;
+		bp.floorInd = proto.header.floorInd;
+		for (const GS::UniString& name : g_obstacles.layers) {
+			API_AttributeIndex layer;
+			if (AttributeCache::Layers().FindIndex(name, layer))
+				bp.layers.push_back(layer.ToInt32_Deprecated());
+		}
+		if (!g_obstacles.layers.empty() && bp.layers.empty()) {
+			LogA("[Distrib] obstacles: no layers found by name");
+			return;
+		}
+		bp.exclude = g_pathGuids;
+		bp.exclude.push_back(proto.header.guid);
+		if (g_boundaryGuid != APINULLGuid) bp.exclude.push_back(g_boundaryGuid);
+		if (g_terrainGuid != APINULLGuid)  bp.exclude.push_back(g_terrainGuid);
+		for (const API_Guid& source : sources)
+			registry.AppendGuids(source, bp.exclude);
+
+		if (!index.Build(bp)) {
+			LogA("[Distrib] obstacles: none");
+			return;
+		}
+		ctx.obstacles = &index;
+		ctx.clearanceM = std::max(0.0, g_obstacles.clearanceMM / 1000.0);
+		GS::UniString dbg; dbg.Printf("[Distrib] obstacles=%u, clearance(m)=%.3f", (unsigned)index.GetCount(), ctx.clearanceM);
+		Log(dbg);
+	}
+
+	static void LogManaged(const ManagedSet::Stats& st)
+	{
+		GS::UniString dbg; dbg.Printf("[Distrib] managed: kept=%u, moved=%u, created=%u, deleted=%u, failed=%u",
+			(unsigned)st.kept, (unsigned)st.moved, (unsigned)st.created, (unsigned)st.deleted, (unsigned)st.failed);
+		Log(dbg);
+	}
+
+	// Станции одного пути — в planner. Без вызовов API: выполняется в
+	// рабочем потоке, созданием занимается главный.
+	static void DistributeOnSinglePath(const CompiledPath& path,
+		const double useStepM, const int useCount,
+		Planner& planner)
+	{
+		// точки размещения — потоком: шаг или количество, курсор идёт только вперёд
+		PathEngine::StationStream stations = (useStepM > 1e-9)
+			? PathEngine::StationStream::ByStep(path, useStepM)
+			: PathEngine::StationStream::ByCount(path, (UInt32)std::max(useCount, 1));
+
+		Placement p = { {}, 0.0, 1.0 };
+		while (stations.Next(&p.P, &p.ang))
+			planner.Push(p);
+		planner.Flush();
 	}
 
 	bool DistributeSelected(double stepMM, int count)
@@ -537,6 +662,56 @@ namespace LandscapeHelper {
 			return false; 
 		}
 
+		// Рельеф: индекс треугольников — один раз на все пути, до команды Undo
+		TerrainSampler::Index terrainIndex;
+		TerrainPlacement terrain;
+		const TerrainPlacement* useTerrain = nullptr;
+		if (!PrepareTerrain(proto, terrainIndex, terrain, useTerrain))
+			return false;
+
+		// Управляемый режим: прежние экземпляры прототипа — один проход, до
+		// препятствий (они из препятствий исключаются)
+		ManagedSet::Registry registry;
+		if (g_managed.enabled)
+			registry.Load(tid, proto.header.guid);
+
+		PlaceContext ctx;
+		ctx.terrain = useTerrain;
+		ObstacleIndex::Index obstacleIndex;
+		PrepareObstacles(proto, registry, g_pathGuids, obstacleIndex, ctx);
+
+		// Геометрия путей читается через API — на главном потоке, до команды
+		const UInt32 nPaths = (UInt32)g_pathGuids.size();
+		std::vector<std::vector<PathEngine::Seg>> pathSegs(nPaths);
+		std::vector<double> pathLen(nPaths, 0.0);
+		for (UInt32 i = 0; i < nPaths; ++i) {
+			PathEngine::PathStats stats;
+			if (!PathEngine::BuildPathSegments(g_pathGuids[i], pathSegs[i], &pathLen[i], PathEngine::kDefaultChordTolM, &stats) ||
+				pathLen[i] < 1e-6)
+			{
+				LogA("[Distrib] skip: empty/invalid path");
+				pathSegs[i].clear();
+				continue;
+			}
+			GS::UniString pathDbg; pathDbg.Printf("[Distrib] path len=%.3f, segs=%u (bezier edges=%u: %u segs, fixed 32/edge=%u)",
+				pathLen[i], (unsigned)pathSegs[i].size(),
+				(unsigned)stats.bezierEdges, (unsigned)stats.bezierSegs, (unsigned)stats.fixedSegs);
+			Log(pathDbg);
+		}
+
+		// Управляемый режим: сверка по путям
+		std::vector<std::unique_ptr<ManagedSet::Reconciler>> recs(nPaths);
+		if (g_managed.enabled) {
+			for (UInt32 i = 0; i < nPaths; ++i) {
+				if (pathSegs[i].empty()) continue;
+				// радиус сдвига по умолчанию — половина расстояния между станциями
+				const double spacing = (useStepM > 1e-9) ? useStepM : pathLen[i] / (double)std::max(useCount - 1, 1);
+				recs[i].reset(new ManagedSet::Reconciler(g_pathGuids[i], proto.header.guid, registry.Take(g_pathGuids[i]),
+					g_managed.toleranceMM / 1000.0,
+					g_managed.moveRadiusMM > 0.0 ? g_managed.moveRadiusMM / 1000.0 : spacing * 0.5));
+			}
+		}
+
 		// Undo + общий мемо
 		GSErrCode err = ACAPI_CallUndoableCommand("Distribute Along Multiple Paths", [&]() -> GSErrCode {
 			API_ElementMemo memo = {}; bool hasMemo = false;
@@ -553,21 +728,82 @@ namespace LandscapeHelper {
 				}
 			}
 
-			UInt32 totalCreated = 0;
+			// Рабочие потоки: путь целиком (компиляция, станции, препятствия,
+			// рельеф) -> блоки через очередь без блокировок. Главный поток
+			// создаёт элементы блоками по мере поступления — расчёт следующих
+			// путей идёт одновременно с вызовами API.
+			BoundedQueue::Queue<PreparedBlock*> queue(kQueueBlocks);
+			std::atomic<UInt32> nextPath(0);
+			std::atomic<UInt32> blocked(0);
+
+			UInt32 nThreads = std::max(1u, std::thread::hardware_concurrency());
+			nThreads = std::max<UInt32>(1, std::min<UInt32>(nThreads > 1 ? nThreads - 1 : 1, nPaths));
+			std::atomic<UInt32> workersLeft(nThreads);
+
+			auto Worker = [&]() {
+				for (;;) {
+					const UInt32 i = nextPath.fetch_add(1);
+					if (i >= nPaths) break;
+					CompiledPath path;
+					if (pathSegs[i].empty() || !path.Assign(std::move(pathSegs[i])))
+						continue;
+					Planner planner(proto, ctx, i, [&](PreparedBlock&& block) {
+						PreparedBlock* item = new PreparedBlock(std::move(block));
+						while (!queue.TryPush(item))
+							std::this_thread::yield();   // главный поток отстаёт — ждём место
+					});
+					DistributeOnSinglePath(path, useStepM, useCount, planner);
+					blocked.fetch_add(planner.GetBlocked());
+				}
+				workersLeft.fetch_sub(1, std::memory_order_release);
+			};
+
+			std::vector<std::thread> pool;
+			pool.reserve(nThreads);
+			for (UInt32 t = 0; t < nThreads; ++t)
+				pool.emplace_back(Worker);
+
+			Creator creator(proto, ctx, hasMemo ? &memo : nullptr);
+			std::vector<UInt32> createdByPath(nPaths, 0);
+			auto consume = [&](PreparedBlock* block) {
+				for (const Prepared& item : *block) {
+					const UInt32 before = creator.GetCreated();
+					creator.Create(item, recs[item.source].get());
+					createdByPath[item.source] += creator.GetCreated() - before;
+				}
+				delete block;
+			};
 
-			for (const API_Guid& pg : g_pathGuids) {
-				std::vector<Seg> segs; double totalLen = 0.0;
-				if (!BuildPathSegments(pg, segs, &totalLen) || totalLen < 1e-6) {
-					LogA("[Distrib] skip: empty/invalid path");
+			PreparedBlock* block = nullptr;
+			for (;;) {
+				if (queue.TryPop(block)) {
+					consume(block);
 					continue;
 				}
-				(void)DistributeOnSinglePath(proto, tid, segs, totalLen, useStepM, useCount,
-					hasMemo ? &memo : nullptr, &totalCreated);
+				if (workersLeft.load(std::memory_order_acquire) == 0) {
+					// блоки, положенные до выхода последнего потока
+					while (queue.TryPop(block))
+						consume(block);
+					break;
+				}
+				std::this_thread::yield();
+			}
+			for (std::thread& th : pool)
+				th.join();
+
+			for (UInt32 i = 0; i < nPaths; ++i) {
+				if (recs[i]) {
+					recs[i]->Finish();
+					LogManaged(recs[i]->GetStats());
+				}
+				GS::UniString dbg; dbg.Printf("[Distrib] path %u created=%u", (unsigned)i, (unsigned)createdByPath[i]);
+				Log(dbg);
 			}
 
 			if (hasMemo) ACAPI_DisposeElemMemoHdls(&memo);
 
-			GS::UniString fin; fin.Printf("[Distrib] DONE, total created=%u", (unsigned)totalCreated);
+			GS::UniString fin; fin.Printf("[Distrib] DONE, total created=%u, off-terrain=%u, blocked=%u, threads=%u",
+				(unsigned)creator.GetCreated(), (unsigned)creator.GetOffTerrain(), (unsigned)blocked.load(), (unsigned)nThreads);
 			Log(fin);
 			return NoError;
 			});
@@ -575,4 +811,210 @@ namespace LandscapeHelper {
 		return err == NoError;
 	}
 
+	// ---------- Разброс в контуре (пуассоновский диск) ----------
+	bool SetScatterBoundary()
+	{
+		g_boundaryGuid = APINULLGuid;
+
+		API_SelectionInfo si = {}; GS::Array<API_Neig> neigs;
+		ACAPI_Selection_Get(&si, &neigs, false, false);
+		BMKillHandle((GSHandle*)&si.marquee.coords);
+
+		for (const API_Neig& n : neigs) {
+			API_Element el = {}; el.header.guid = n.guid;
+			if (ACAPI_Element_GetHeader(&el.header) != NoError) continue;
+			if (Boundary::IsBoundaryType(el.header.type.typeID)) {
+				g_boundaryGuid = n.guid;
+				GS::UniString dbg; dbg.Printf("[Scatter] BOUNDARY SET: %s (type=%d)",
+					APIGuidToString(n.guid).ToCStr().Get(), (int)el.header.type.typeID);
+				Log(dbg);
+				return true;
+			}
+		}
+		LogA("[Scatter] ERR no-boundary");
+		return false;
+	}
+
+	bool ScatterInBoundary(const ScatterParams& params)
+	{
+		if (params.spacingMM <= 0.0) { LogA("[Scatter] ERR spacing"); return false; }
+		if (g_boundaryGuid == APINULLGuid && !SetScatterBoundary()) return false;
+		if (!AutoGrabProtoIfNeeded()) { LogA("[Scatter] ERR no-proto"); return false; }
+
+		API_Element proto = {}; proto.header.guid = g_protoGuid;
+		if (ACAPI_Element_Get(&proto) != NoError) { LogA("[Scatter] ERR proto-get"); return false; }
+		const API_ElemTypeID tid = proto.header.type.typeID;
+		if (tid != API_ObjectID && tid != API_LampID && tid != API_ColumnID && tid != API_BeamID) {
+			LogA("[Scatter] ERR proto-type");
+			return false;
+		}
+
+		Boundary::Region region;
+		if (!region.Build(g_boundaryGuid)) { LogA("[Scatter] ERR boundary-build"); return false; }
+
+		Scatter::PoissonParams pp;
+		pp.radiusM = params.spacingMM / 1000.0;
+		pp.seed = params.seed;
+		pp.maxPoints = params.maxCount;
+		std::vector<API_Coord> points;
+		if (!Scatter::PoissonDisk(region, pp, points)) {
+			LogA("[Scatter] ERR no points (empty boundary or spacing too small)");
+			return false;
+		}
+		{
+			GS::UniString dbg; dbg.Printf("[Scatter] edges=%u, points=%u, spacing(m)=%.3f, seed=%u",
+				(unsigned)region.GetEdgeCount(), (unsigned)points.size(), pp.radiusM, (unsigned)params.seed);
+			Log(dbg);
+		}
+
+		TerrainSampler::Index terrainIndex;
+		TerrainPlacement terrain;
+		const TerrainPlacement* useTerrain = nullptr;
+		if (!PrepareTerrain(proto, terrainIndex, terrain, useTerrain))
+			return false;
+		ManagedSet::Registry registry;
+		if (g_managed.enabled)
+			registry.Load(tid, proto.header.guid);
+
+		PlaceContext ctx;
+		ctx.terrain = useTerrain;
+		ObstacleIndex::Index obstacleIndex;
+		PrepareObstacles(proto, registry, { g_boundaryGuid }, obstacleIndex, ctx);
+
+		// Разброс поворота и масштаба — свой поток ГСЧ от того же seed:
+		// раскладка точек от настроек разброса не зависит
+		Scatter::Rng jitter(params.seed ^ 0xA5A5A5A5A5A5A5A5ull);
+		const double baseAng = ProtoAngle(proto);
+		const double rotJ = std::fabs(params.rotationJitterDeg) * PI / 180.0;
+		const double scaleJ = std::min(std::fabs(params.scaleJitter), 0.95);
+
+		UInt32 created = 0;
+		const GSErrCode err = ACAPI_CallUndoableCommand("Scatter In Boundary", [&]() -> GSErrCode {
+			API_ElementMemo memo = {};
+			const bool hasMemo = ACAPI_Element_GetMemo(proto.header.guid, &memo) == NoError;
+
+			std::unique_ptr<ManagedSet::Reconciler> rec;
+			if (g_managed.enabled) {
+				rec.reset(new ManagedSet::Reconciler(g_boundaryGuid, proto.header.guid, registry.Take(g_boundaryGuid),
+					g_managed.toleranceMM / 1000.0,
+					g_managed.moveRadiusMM > 0.0 ? g_managed.moveRadiusMM / 1000.0 : pp.radiusM * 0.5));
+			}
+
+			Creator creator(proto, ctx, hasMemo ? &memo : nullptr);
+			Planner planner(proto, ctx, 0, [&](PreparedBlock&& block) {
+				for (const Prepared& item : block)
+					creator.Create(item, rec.get());
+			});
+			for (const API_Coord& P : points) {
+				Placement p;
+				p.P = P;
+				p.ang = baseAng + (rotJ > 0.0 ? jitter.Uniform(-rotJ, rotJ) : 0.0);
+				p.scale = scaleJ > 0.0 ? jitter.Uniform(1.0 - scaleJ, 1.0 + scaleJ) : 1.0;
+				planner.Push(p);
+			}
+			planner.Flush();
+			created = creator.GetCreated();
+			if (rec) {
+				rec->Finish();
+				LogManaged(rec->GetStats());
+			}
+
+			if (hasMemo) ACAPI_DisposeElemMemoHdls(&memo);
+			GS::UniString fin; fin.Printf("[Scatter] DONE, created=%u, off-terrain=%u, blocked=%u",
+				(unsigned)created, (unsigned)creator.GetOffTerrain(), (unsigned)planner.GetBlocked());
+			Log(fin);
+			return created > 0 ? NoError : APIERR_GENERAL;
+			});
+
+		return err == NoError;
+	}
+
+	// ---------- Регулярная решётка в контуре ----------
+	bool FillBoundaryPattern(const PatternParams& params)
+	{
+		if (params.spacingMM <= 0.0) { LogA("[Pattern] ERR spacing"); return false; }
+		if (g_boundaryGuid == APINULLGuid && !SetScatterBoundary()) return false;
+		if (!AutoGrabProtoIfNeeded()) { LogA("[Pattern] ERR no-proto"); return false; }
+
+		API_Element proto = {}; proto.header.guid = g_protoGuid;
+		if (ACAPI_Element_Get(&proto) != NoError) { LogA("[Pattern] ERR proto-get"); return false; }
+		const API_ElemTypeID tid = proto.header.type.typeID;
+		if (tid != API_ObjectID && tid != API_LampID && tid != API_ColumnID && tid != API_BeamID) {
+			LogA("[Pattern] ERR proto-type");
+			return false;
+		}
+
+		Boundary::Region region;
+		if (!region.Build(g_boundaryGuid)) { LogA("[Pattern] ERR boundary-build"); return false; }
+
+		Scatter::LatticeParams lp;
+		lp.kind = params.kind == PatternParams::Hex ? Scatter::LatticeKind::Hex : Scatter::LatticeKind::Square;
+		lp.stepM = params.spacingMM / 1000.0;
+		lp.angleRad = params.angleDeg * PI / 180.0;
+		{
+			GS::UniString dbg; dbg.Printf("[Pattern] edges=%u, kind=%s, spacing(m)=%.3f, angle=%.2f",
+				(unsigned)region.GetEdgeCount(), params.kind == PatternParams::Hex ? "hex" : "square",
+				lp.stepM, params.angleDeg);
+			Log(dbg);
+		}
+
+		TerrainSampler::Index terrainIndex;
+		TerrainPlacement terrain;
+		const TerrainPlacement* useTerrain = nullptr;
+		if (!PrepareTerrain(proto, terrainIndex, terrain, useTerrain))
+			return false;
+		ManagedSet::Registry registry;
+		if (g_managed.enabled)
+			registry.Load(tid, proto.header.guid);
+
+		PlaceContext ctx;
+		ctx.terrain = useTerrain;
+		ObstacleIndex::Index obstacleIndex;
+		PrepareObstacles(proto, registry, { g_boundaryGuid }, obstacleIndex, ctx);
+
+		// Экземпляры повёрнуты вместе с решёткой
+		const double ang = ProtoAngle(proto) + lp.angleRad;
+
+		UInt32 created = 0;
+		const GSErrCode err = ACAPI_CallUndoableCommand("Fill Boundary Pattern", [&]() -> GSErrCode {
+			API_ElementMemo memo = {};
+			const bool hasMemo = ACAPI_Element_GetMemo(proto.header.guid, &memo) == NoError;
+
+			std::unique_ptr<ManagedSet::Reconciler> rec;
+			if (g_managed.enabled) {
+				rec.reset(new ManagedSet::Reconciler(g_boundaryGuid, proto.header.guid, registry.Take(g_boundaryGuid),
+					g_managed.toleranceMM / 1000.0,
+					g_managed.moveRadiusMM > 0.0 ? g_managed.moveRadiusMM / 1000.0 : lp.stepM * 0.5));
+			}
+
+			Creator creator(proto, ctx, hasMemo ? &memo : nullptr);
+			Planner planner(proto, ctx, 0, [&](PreparedBlock&& block) {
+				for (const Prepared& item : block)
+					creator.Create(item, rec.get());
+			});
+			// узлы идут в Planner по мере обхода рядов — без общего массива точек
+			const UInt32 nodes = Scatter::Lattice(region, lp, [&](const API_Coord& P) {
+				Placement p;
+				p.P = P;
+				p.ang = ang;
+				p.scale = 1.0;
+				planner.Push(p);
+			});
+			planner.Flush();
+			created = creator.GetCreated();
+			if (rec) {
+				rec->Finish();
+				LogManaged(rec->GetStats());
+			}
+
+			if (hasMemo) ACAPI_DisposeElemMemoHdls(&memo);
+			GS::UniString fin; fin.Printf("[Pattern] DONE, nodes=%u, created=%u, off-terrain=%u, blocked=%u",
+				(unsigned)nodes, (unsigned)created, (unsigned)creator.GetOffTerrain(), (unsigned)planner.GetBlocked());
+			Log(fin);
+			return created > 0 ? NoError : APIERR_GENERAL;
+			});
+
+		return err == NoError;
+	}
+
 } // namespace LandscapeHelper
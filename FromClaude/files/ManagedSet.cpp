@@ -0,0 +1,271 @@
+// ManagedSet.cpp
+#include "ManagedSet.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace ManagedSet {
+
+	static constexpr char   kMagic[4] = { 'L', 'H', 'D', '1' };
+	static constexpr double kAngTol = 1e-3;    // рад
+	static constexpr double kRatioTol = 1e-4;  // м
+
+	struct TagData {
+		char     magic[4];
+		API_Guid source;
+		API_Guid proto;
+	};
+
+	static inline double AngDiff(double a, double b)
+	{
+		double d = std::fmod(std::fabs(a - b), 2.0 * 3.14159265358979323846);
+		return std::min(d, 2.0 * 3.14159265358979323846 - d);
+	}
+
+	Transform TransformOf(const API_Element& e)
+	{
+		Transform t;
+		switch (e.header.type.typeID) {
+		case API_ObjectID:
+			t.pos = e.object.pos; t.angle = e.object.angle; t.level = e.object.level;
+			t.xRatio = e.object.xRatio; t.yRatio = e.object.yRatio;
+			break;
+		case API_LampID:
+			t.pos = e.lamp.pos; t.angle = e.lamp.angle; t.level = e.lamp.level;
+			t.xRatio = e.lamp.xRatio; t.yRatio = e.lamp.yRatio;
+			break;
+		case API_ColumnID:
+			t.pos = e.column.origoPos; t.angle = e.column.axisRotationAngle; t.level = e.column.bottomOffset;
+			break;
+		case API_BeamID:
+			t.pos = { (e.beam.begC.x + e.beam.endC.x) * 0.5, (e.beam.begC.y + e.beam.endC.y) * 0.5 };
+			t.angle = std::atan2(e.beam.endC.y - e.beam.begC.y, e.beam.endC.x - e.beam.begC.x);
+			t.level = e.beam.level;
+			t.slant = e.beam.slantAngle;
+			break;
+		default:
+			t.pos = { 0.0, 0.0 };
+			break;
+		}
+		return t;
+	}
+
+	static bool SameTransform(const Transform& a, const Transform& b, double tol)
+	{
+		return std::hypot(a.pos.x - b.pos.x, a.pos.y - b.pos.y) <= tol &&
+			AngDiff(a.angle, b.angle) <= kAngTol &&
+			std::fabs(a.level - b.level) <= tol &&
+			std::fabs(a.xRatio - b.xRatio) <= kRatioTol &&
+			std::fabs(a.yRatio - b.yRatio) <= kRatioTol &&
+			std::fabs(a.slant - b.slant) <= kAngTol;
+	}
+
+	GSErrCode Tag(const API_Elem_Head& head, const API_Guid& source, const API_Guid& proto)
+	{
+		TagData data;
+		std::memcpy(data.magic, kMagic, sizeof(kMagic));
+		data.source = source;
+		data.proto = proto;
+
+		API_ElementUserData ud = {};
+		ud.dataVersion = 1;
+		ud.platformSign = GS::Act_Platform_Sign;
+		ud.dataHdl = BMAllocateHandle(sizeof(TagData), 0, 0);
+		if (ud.dataHdl == nullptr)
+			return APIERR_MEMFULL;
+		std::memcpy(*ud.dataHdl, &data, sizeof(TagData));
+
+		API_Elem_Head h = head;
+		const GSErrCode err = ACAPI_Element_SetUserData(&h, &ud);
+		BMKillHandle(&ud.dataHdl);
+		return err;
+	}
+
+	static bool ReadTag(API_Elem_Head& head, TagData& out)
+	{
+		API_ElementUserData ud = {};
+		if (ACAPI_Element_GetUserData(&head, &ud) != NoError || ud.dataHdl == nullptr)
+			return false;
+		const bool ok = BMGetHandleSize(ud.dataHdl) == (GSSize)sizeof(TagData) &&
+			std::memcmp(*ud.dataHdl, kMagic, sizeof(kMagic)) == 0;
+		if (ok)
+			std::memcpy(&out, *ud.dataHdl, sizeof(TagData));
+		BMKillHandle(&ud.dataHdl);
+		return ok;
+	}
+
+	// ---------- Registry ----------
+
+	void Registry::Load(API_ElemTypeID tid, const API_Guid& proto)
+	{
+		m_bySource.clear();
+		m_count = 0;
+
+		GS::Array<API_Guid> list;
+		if (ACAPI_Element_GetElemList(tid, &list) != NoError)
+			return;
+
+		for (const API_Guid& g : list) {
+			API_Element e = {};
+			e.header.guid = g;
+			if (ACAPI_Element_GetHeader(&e.header) != NoError)
+				continue;
+			TagData tag;
+			if (!ReadTag(e.header, tag) || tag.proto != proto)
+				continue;
+			if (ACAPI_Element_Get(&e) != NoError)
+				continue;
+
+			auto it = std::find_if(m_bySource.begin(), m_bySource.end(),
+				[&](const std::pair<API_Guid, std::vector<Instance>>& s) { return s.first == tag.source; });
+			if (it == m_bySource.end()) {
+				m_bySource.emplace_back(tag.source, std::vector<Instance>());
+				it = m_bySource.end() - 1;
+			}
+			it->second.push_back({ g, TransformOf(e) });
+			++m_count;
+		}
+	}
+
+	std::vector<Instance> Registry::Take(const API_Guid& source)
+	{
+		for (auto& s : m_bySource)
+			if (s.first == source)
+				return std::move(s.second);
+		return {};
+	}
+
+	void Registry::AppendGuids(const API_Guid& source, std::vector<API_Guid>& out) const
+	{
+		for (const auto& s : m_bySource)
+			if (s.first == source)
+				for (const Instance& inst : s.second)
+					out.push_back(inst.guid);
+	}
+
+	// ---------- Reconciler ----------
+
+	Reconciler::Reconciler(const API_Guid& source, const API_Guid& proto, std::vector<Instance>&& existing,
+		double toleranceM, double moveRadiusM)
+		: m_source(source)
+		, m_proto(proto)
+		, m_existing(std::move(existing))
+		, m_used(m_existing.size(), false)
+		, m_tol(std::max(toleranceM, 1e-6))
+		, m_radius(std::max(moveRadiusM, std::max(toleranceM, 1e-6)))
+	{
+		// ячейка хэша = радиус сдвига: кандидаты — в 3×3 ячейках
+		m_hash.reserve(m_existing.size());
+		for (UInt32 i = 0; i < (UInt32)m_existing.size(); ++i) {
+			const API_Coord& p = m_existing[i].tr.pos;
+			m_hash[CellKey((Int64)std::floor(p.x / m_radius), (Int64)std::floor(p.y / m_radius))].push_back(i);
+		}
+	}
+
+	Int32 Reconciler::FindNearest(const API_Coord& p) const
+	{
+		const Int64 cx = (Int64)std::floor(p.x / m_radius);
+		const Int64 cy = (Int64)std::floor(p.y / m_radius);
+		Int32 best = -1;
+		double bestD = m_radius;
+		for (Int64 y = cy - 1; y <= cy + 1; ++y) {
+			for (Int64 x = cx - 1; x <= cx + 1; ++x) {
+				auto it = m_hash.find(CellKey(x, y));
+				if (it == m_hash.end()) continue;
+				for (UInt32 i : it->second) {
+					if (m_used[i]) continue;
+					const double d = std::hypot(m_existing[i].tr.pos.x - p.x, m_existing[i].tr.pos.y - p.y);
+					if (d <= bestD) { bestD = d; best = (Int32)i; }
+				}
+			}
+		}
+		return best;
+	}
+
+	bool Reconciler::Place(API_Element& e, API_ElementMemo* memo)
+	{
+		const Transform want = TransformOf(e);
+		const Int32 i = FindNearest(want.pos);
+
+		if (i >= 0) {
+			m_used[(size_t)i] = true;
+			if (SameTransform(m_existing[(size_t)i].tr, want, m_tol)) {
+				++m_stats.kept;
+				return true;
+			}
+
+			// сдвиг: только поля положения своего типа, параметры объекта не трогаем
+			API_Element mask;
+			ACAPI_ELEMENT_MASK_CLEAR(mask);
+			switch (e.header.type.typeID) {
+			case API_ObjectID:
+				ACAPI_ELEMENT_MASK_SET(mask, API_ObjectType, pos);
+				ACAPI_ELEMENT_MASK_SET(mask, API_ObjectType, angle);
+				ACAPI_ELEMENT_MASK_SET(mask, API_ObjectType, level);
+				ACAPI_ELEMENT_MASK_SET(mask, API_ObjectType, xRatio);
+				ACAPI_ELEMENT_MASK_SET(mask, API_ObjectType, yRatio);
+				break;
+			case API_LampID:
+				ACAPI_ELEMENT_MASK_SET(mask, API_LampType, pos);
+				ACAPI_ELEMENT_MASK_SET(mask, API_LampType, angle);
+				ACAPI_ELEMENT_MASK_SET(mask, API_LampType, level);
+				ACAPI_ELEMENT_MASK_SET(mask, API_LampType, xRatio);
+				ACAPI_ELEMENT_MASK_SET(mask, API_LampType, yRatio);
+				break;
+			case API_ColumnID:
+				ACAPI_ELEMENT_MASK_SET(mask, API_ColumnType, origoPos);
+				ACAPI_ELEMENT_MASK_SET(mask, API_ColumnType, axisRotationAngle);
+				ACAPI_ELEMENT_MASK_SET(mask, API_ColumnType, bottomOffset);
+				break;
+			case API_BeamID:
+				ACAPI_ELEMENT_MASK_SET(mask, API_BeamType, begC);
+				ACAPI_ELEMENT_MASK_SET(mask, API_BeamType, endC);
+				ACAPI_ELEMENT_MASK_SET(mask, API_BeamType, level);
+				ACAPI_ELEMENT_MASK_SET(mask, API_BeamType, slantAngle);
+				break;
+			default:
+				break;
+			}
+			e.header.guid = m_existing[(size_t)i].guid;
+			if (ACAPI_Element_Change(&e, &mask, nullptr, 0, true) == NoError) {
+				++m_stats.moved;
+				return true;
+			}
+			++m_stats.failed;
+			return false;
+		}
+
+		e.header.guid = APINULLGuid;
+		if (ACAPI_Element_Create(&e, memo) != NoError) {
+			++m_stats.failed;
+			return false;
+		}
+		// без метки экземпляр не найдётся при пересчёте и останется копией —
+		// такой лучше удалить сразу
+		if (Tag(e.header, m_source, m_proto) != NoError) {
+			GS::Array<API_Guid> untagged;
+			untagged.Push(e.header.guid);
+			(void)ACAPI_Element_Delete(untagged);
+			++m_stats.failed;
+			return false;
+		}
+		++m_stats.created;
+		return true;
+	}
+
+	void Reconciler::Finish()
+	{
+		GS::Array<API_Guid> stale;
+		for (size_t i = 0; i < m_existing.size(); ++i)
+			if (!m_used[i])
+				stale.Push(m_existing[i].guid);
+		if (stale.IsEmpty())
+			return;
+		if (ACAPI_Element_Delete(stale) == NoError)
+			m_stats.deleted += (UInt32)stale.GetSize();
+		else
+			m_stats.failed += (UInt32)stale.GetSize();
+	}
+
+} // namespace ManagedSet
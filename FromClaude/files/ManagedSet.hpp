@@ -0,0 +1,93 @@
+// ManagedSet.hpp — управляемая расстановка: созданные экземпляры помечаются
+// (userdata: источник — путь или контур, и прототип), повторный запуск не
+// плодит копии, а сверяет новые точки с помеченными через пространственный
+// хэш: совпавшие остаются, близкие сдвигаются ACAPI_Element_Change, новые
+// создаются, лишние удаляются. Пересчёт с другим шагом — десятки вызовов API
+// вместо удаления и создания всех экземпляров.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace ManagedSet {
+
+	// Положение экземпляра в полях своего типа (объект, светильник, колонна, балка)
+	struct Transform {
+		API_Coord pos;            // балка — середина
+		double    angle = 0.0;    // балка — направление begC→endC
+		double    level = 0.0;    // level / bottomOffset
+		double    xRatio = 1.0;   // объект/светильник
+		double    yRatio = 1.0;
+		double    slant = 0.0;    // балка
+	};
+
+	struct Instance {
+		API_Guid  guid;
+		Transform tr;
+	};
+
+	struct Stats {
+		UInt32 kept = 0;
+		UInt32 moved = 0;
+		UInt32 created = 0;
+		UInt32 deleted = 0;
+		UInt32 failed = 0;
+	};
+
+	Transform TransformOf(const API_Element& e);
+
+	// Пометить элемент: источник и прототип (внутри команды Undo)
+	GSErrCode Tag(const API_Elem_Head& head, const API_Guid& source, const API_Guid& proto);
+
+	// Помеченные экземпляры прототипа, по источникам; читается один раз на запуск
+	class Registry {
+	public:
+		void Load(API_ElemTypeID tid, const API_Guid& proto);
+
+		// Экземпляры источника (забираются из реестра)
+		std::vector<Instance> Take(const API_Guid& source);
+
+		// Дописать guid экземпляров источника (до Take): пересчитываемые
+		// экземпляры не должны попасть в препятствия
+		void AppendGuids(const API_Guid& source, std::vector<API_Guid>& out) const;
+
+		size_t GetCount() const { return m_count; }
+
+	private:
+		std::vector<std::pair<API_Guid, std::vector<Instance>>> m_bySource;
+		size_t m_count = 0;
+	};
+
+	// Сверка одного источника внутри команды Undo
+	class Reconciler {
+	public:
+		Reconciler(const API_Guid& source, const API_Guid& proto, std::vector<Instance>&& existing,
+			double toleranceM, double moveRadiusM);
+
+		// e — готовый экземпляр (позиция, отметка, масштаб); оставить, сдвинуть
+		// ближайший свободный в moveRadiusM или создать. false — ошибка API.
+		bool Place(API_Element& e, API_ElementMemo* memo);
+
+		// Удалить несопоставленные экземпляры
+		void Finish();
+
+		const Stats& GetStats() const { return m_stats; }
+
+	private:
+		UInt64 CellKey(Int64 cx, Int64 cy) const { return ((UInt64)(UInt32)cx << 32) | (UInt64)(UInt32)cy; }
+		Int32  FindNearest(const API_Coord& p) const;
+
+		API_Guid              m_source;
+		API_Guid              m_proto;
+		std::vector<Instance> m_existing;
+		std::vector<bool>     m_used;
+		std::unordered_map<UInt64, std::vector<UInt32>> m_hash;
+		double                m_tol;
+		double                m_radius;
+		Stats                 m_stats;
+	};
+
+} // namespace ManagedSet
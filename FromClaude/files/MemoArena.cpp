@@ -0,0 +1,73 @@
+// MemoArena.cpp
+#include "MemoArena.hpp"
+
+#include <cstring>
+
+namespace MemoArena {
+
+	// Пул не растёт без предела: лишние handle освобождаются сразу
+	static constexpr size_t kMaxPooled = 64;
+
+	Arena::~Arena()
+	{
+		for (GSHandle h : m_free)
+			BMKillHandle(&h);
+		m_free.clear();
+	}
+
+	GSHandle Arena::Acquire(GSSize bytes, bool clear)
+	{
+		if (bytes <= 0)
+			bytes = 1;
+
+		if (!m_free.empty()) {
+			GSHandle h = m_free.back();
+			m_free.pop_back();
+			if (BMGetHandleSize(h) != bytes) {
+				GSHandle r = BMReallocHandle(h, bytes, 0, 0);
+				if (r == nullptr) {
+					BMKillHandle(&h);
+					return nullptr;
+				}
+				h = r;
+			}
+			if (clear)
+				std::memset(*h, 0, (size_t)bytes);
+			++m_stats.reused;
+			return h;
+		}
+
+		++m_stats.allocated;
+		return BMAllocateHandle(bytes, clear ? ALLOCATE_CLEAR : 0, 0);
+	}
+
+	void Arena::Put(GSHandle h)
+	{
+		if (h == nullptr)
+			return;
+		if (m_free.size() < kMaxPooled)
+			m_free.push_back(h);
+		else
+			BMKillHandle(&h);
+	}
+
+	void Arena::Release(API_ElementMemo& memo)
+	{
+		Put(reinterpret_cast<GSHandle>(memo.coords));
+		Put(reinterpret_cast<GSHandle>(memo.pends));
+		Put(reinterpret_cast<GSHandle>(memo.parcs));
+		Put(reinterpret_cast<GSHandle>(memo.vertexIDs));
+		Put(reinterpret_cast<GSHandle>(memo.bezierDirs));
+		Put(reinterpret_cast<GSHandle>(memo.meshPolyZ));
+		Put(reinterpret_cast<GSHandle>(memo.textContent));
+		memo.coords = nullptr;
+		memo.pends = nullptr;
+		memo.parcs = nullptr;
+		memo.vertexIDs = nullptr;
+		memo.bezierDirs = nullptr;
+		memo.meshPolyZ = nullptr;
+		memo.textContent = nullptr;
+		ACAPI_DisposeElemMemoHdls(&memo);   // прочие поля — не из пула
+	}
+
+} // namespace MemoArena
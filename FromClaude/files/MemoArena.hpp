@@ -0,0 +1,52 @@
+// MemoArena.hpp — повторно используемые handle для полей API_ElementMemo.
+// Вместо BMAllocateHandle/ACAPI_DisposeElemMemoHdls на каждый элемент handle
+// после ACAPI_Element_Create возвращаются в пул и выдаются следующему элементу
+// с подгонкой размера (BMReallocHandle: уменьшение — на месте, рост — редко).
+// Размер handle выставляется точно: API берёт число точек сплайна и длину
+// текста из размера handle.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <vector>
+
+namespace MemoArena {
+
+	struct Stats {
+		UInt32 allocated = 0;   // новых BMAllocateHandle
+		UInt32 reused = 0;      // выдано из пула
+	};
+
+	class Arena {
+	public:
+		Arena() = default;
+		~Arena();
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		// Handle ровно на bytes байт; clear — обнулить содержимое
+		GSHandle Acquire(GSSize bytes, bool clear);
+
+		// Массив из n элементов T для поля memo (T** как в API_ElementMemo)
+		template <class T>
+		T** Alloc(UInt32 n, bool clear = false) {
+			return reinterpret_cast<T**>(Acquire((GSSize)n * (GSSize)sizeof(T), clear));
+		}
+
+		// Handle геометрии и текста (coords, pends, parcs, vertexIDs, bezierDirs,
+		// meshPolyZ, textContent) — в пул, остальные поля memo — через
+		// ACAPI_DisposeElemMemoHdls. Только для memo, собранных через Acquire.
+		void Release(API_ElementMemo& memo);
+
+		const Stats& GetStats() const { return m_stats; }
+
+	private:
+		void Put(GSHandle h);
+
+		std::vector<GSHandle> m_free;
+		Stats                 m_stats;
+	};
+
+} // namespace MemoArena
@@ -0,0 +1,308 @@
+// MorphBody.cpp
+#include "MorphBody.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace MorphBody {
+
+	// Нормали сравниваются после округления до 1e-9 (единичный вектор)
+	static constexpr double kNormalQuant = 1e9;
+
+	// Допуски компланарности при слиянии граней
+	static constexpr double kPlaneNormalEps = 1e-9;   // |n1 - n2| по компонентам
+	static constexpr double kPlaneDistEps = 1e-6;     // м, расстояние плоскостей
+
+	size_t Builder::NormalKeyHash::operator()(const NormalKey& k) const
+	{
+		UInt64 h = (UInt64)k.x * 0x9E3779B97F4A7C15ull;
+		h ^= (UInt64)k.y + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+		h ^= (UInt64)k.z + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+		return (size_t)h;
+	}
+
+	Builder::~Builder()
+	{
+		if (m_body != nullptr)
+			ACAPI_Body_Dispose(&m_body);
+	}
+
+	bool Builder::Begin()
+	{
+		if (m_body != nullptr)
+			ACAPI_Body_Dispose(&m_body);
+		m_body = nullptr;
+		m_verts.clear();
+		m_edges.clear();
+		m_normals.clear();
+		m_materials.clear();
+		m_faces.clear();
+		m_faceVerts.clear();
+		m_slotArea.clear();
+		m_volume6 = 0.0;
+		m_stats = Stats();
+
+		return ACAPI_Body_Create(nullptr, nullptr, &m_body) == NoError && m_body != nullptr;
+	}
+
+	bool Builder::AddVertex(const API_Coord3D& p, UInt32& outIndex)
+	{
+		if (ACAPI_Body_AddVertex(m_body, p, outIndex) != NoError)
+			return false;
+		if (outIndex >= m_verts.size())
+			m_verts.resize((size_t)outIndex + 1);
+		m_verts[outIndex] = p;
+		++m_stats.vertices;
+		return true;
+	}
+
+	// Ребро from->to: существующее ребро to->from используется с минусом.
+	// Индекс 0 нельзя развернуть знаком — для него заводим отдельное ребро.
+	bool Builder::GetEdge(UInt32 from, UInt32 to, Int32& outRef)
+	{
+		const bool   fwd = from < to;
+		const UInt64 key = fwd ? ((UInt64)from << 32 | to) : ((UInt64)to << 32 | from);
+		++m_stats.edgeRefs;
+
+		Int32 e = 0;
+		auto it = m_edges.find(key);
+		if (it != m_edges.end()) {
+			e = it->second;
+		}
+		else {
+			// ребро всегда хранится как min->max
+			if (ACAPI_Body_AddEdge(m_body, fwd ? from : to, fwd ? to : from, e) != NoError)
+				return false;
+			++m_stats.edges;
+			m_edges.emplace(key, e);
+		}
+
+		if (fwd || e != 0) {
+			outRef = fwd ? e : -e;
+			return true;
+		}
+
+		// обратное к ребру 0 — под собственным ключом (старший бит)
+		const UInt64 revKey = key | (1ull << 63);
+		auto rt = m_edges.find(revKey);
+		if (rt != m_edges.end()) {
+			outRef = rt->second;
+			return true;
+		}
+		if (ACAPI_Body_AddEdge(m_body, from, to, outRef) != NoError)
+			return false;
+		++m_stats.edges;
+		m_edges.emplace(revKey, outRef);
+		return true;
+	}
+
+	bool Builder::GetNormal(const API_Vector3D& n, Int32& outIndex)
+	{
+		const NormalKey key = { (Int64)std::llround(n.x * kNormalQuant),
+								(Int64)std::llround(n.y * kNormalQuant),
+								(Int64)std::llround(n.z * kNormalQuant) };
+		auto it = m_normals.find(key);
+		if (it != m_normals.end()) { outIndex = it->second; return true; }
+
+		if (ACAPI_Body_AddPolyNormal(m_body, n, outIndex) != NoError)
+			return false;
+		m_normals.emplace(key, outIndex);
+		++m_stats.normals;
+		return true;
+	}
+
+	UInt32 Builder::AddMaterial(const API_OverriddenAttribute& material)
+	{
+		m_materials.push_back(material);
+		m_slotArea.push_back(0.0);
+		return (UInt32)m_materials.size() - 1;
+	}
+
+	double Builder::GetArea() const
+	{
+		double sum = 0.0;
+		for (double a : m_slotArea) sum += a;
+		return sum;
+	}
+
+	bool Builder::AddPolygon(const UInt32* verts, UInt32 n, UInt32 materialSlot)
+	{
+		if (m_body == nullptr || n < 3 || materialSlot >= m_materials.size())
+			return false;
+
+		// Нормаль по Ньюэллу — устойчива и для неплоских/невыпуклых граней
+		API_Vector3D nrm = { 0.0, 0.0, 0.0 };
+		for (UInt32 i = 0; i < n; ++i) {
+			const API_Coord3D& p = m_verts[verts[i]];
+			const API_Coord3D& q = m_verts[verts[(i + 1) % n]];
+			nrm.x += (p.y - q.y) * (p.z + q.z);
+			nrm.y += (p.z - q.z) * (p.x + q.x);
+			nrm.z += (p.x - q.x) * (p.y + q.y);
+		}
+		const double len = std::sqrt(nrm.x * nrm.x + nrm.y * nrm.y + nrm.z * nrm.z);
+		if (len < 1e-12)
+			return true;   // вырожденная грань — в тело не идёт
+
+		// Вектор Ньюэлла = 2 * площадь * нормаль: площадь грани и её вклад
+		// в объём (теорема о дивергенции) — без второго прохода по граням
+		const API_Coord3D& p0 = m_verts[verts[0]];
+		m_slotArea[materialSlot] += 0.5 * len;
+		m_volume6 += nrm.x * p0.x + nrm.y * p0.y + nrm.z * p0.z;
+
+		nrm.x /= len; nrm.y /= len; nrm.z /= len;
+
+		Face f;
+		f.first = (UInt32)m_faceVerts.size();
+		f.count = n;
+		f.material = materialSlot;
+		f.normal = nrm;
+		f.planeD = nrm.x * p0.x + nrm.y * p0.y + nrm.z * p0.z;
+		m_faceVerts.insert(m_faceVerts.end(), verts, verts + n);
+		m_faces.push_back(f);
+		++m_stats.faces;
+		return true;
+	}
+
+	bool Builder::EmitPolygon(const UInt32* verts, UInt32 n, const API_Vector3D& normal, UInt32 materialSlot)
+	{
+		Int32 normalIndex = 0;
+		if (!GetNormal(normal, normalIndex))
+			return false;
+
+		m_polyEdges.Clear();
+		for (UInt32 i = 0; i < n; ++i) {
+			Int32 e = 0;
+			if (!GetEdge(verts[i], verts[(i + 1) % n], e))
+				return false;
+			m_polyEdges.Push(e);
+		}
+
+		UInt32 polyIndex = 0;
+		if (ACAPI_Body_AddPolygon(m_body, m_polyEdges, normalIndex, m_materials[materialSlot], polyIndex) != NoError)
+			return false;
+		++m_stats.polygons;
+		return true;
+	}
+
+	// Слияние: грани, соседние по ребру (встречные направления), с одним материалом
+	// и одной плоскостью объединяются (union-find). Граница группы собирается в
+	// цикл по направленным рёбрам, у которых нет встречного внутри группы. Если
+	// граница — не один простой цикл (дыра, касание в вершине), группа уходит
+	// в тело исходными гранями.
+	bool Builder::MergeAndEmit()
+	{
+		const UInt32 nFaces = (UInt32)m_faces.size();
+		auto DirKey = [](UInt32 a, UInt32 b) -> UInt64 { return (UInt64)a << 32 | b; };
+
+		std::vector<UInt32> parent(nFaces);
+		for (UInt32 i = 0; i < nFaces; ++i) parent[i] = i;
+		auto Find = [&](UInt32 x) -> UInt32 {
+			while (parent[x] != x) { parent[x] = parent[parent[x]]; x = parent[x]; }
+			return x;
+		};
+
+		std::unordered_map<UInt64, UInt32> edgeFace;   // направленное ребро -> грань
+		if (m_mergeCoplanar) {
+			edgeFace.reserve(m_faceVerts.size() * 2);
+			for (UInt32 f = 0; f < nFaces; ++f) {
+				const Face& fc = m_faces[f];
+				for (UInt32 k = 0; k < fc.count; ++k) {
+					const UInt32 a = m_faceVerts[fc.first + k];
+					const UInt32 b = m_faceVerts[fc.first + (k + 1) % fc.count];
+					edgeFace.emplace(DirKey(a, b), f);
+				}
+			}
+
+			for (UInt32 f = 0; f < nFaces; ++f) {
+				const Face& fc = m_faces[f];
+				for (UInt32 k = 0; k < fc.count; ++k) {
+					const UInt32 a = m_faceVerts[fc.first + k];
+					const UInt32 b = m_faceVerts[fc.first + (k + 1) % fc.count];
+					auto it = edgeFace.find(DirKey(b, a));
+					if (it == edgeFace.end() || it->second <= f) continue;
+					const Face& g = m_faces[it->second];
+					if (g.material != fc.material ||
+						std::fabs(g.normal.x - fc.normal.x) > kPlaneNormalEps ||
+						std::fabs(g.normal.y - fc.normal.y) > kPlaneNormalEps ||
+						std::fabs(g.normal.z - fc.normal.z) > kPlaneNormalEps ||
+						std::fabs(g.planeD - fc.planeD) > kPlaneDistEps)
+						continue;
+					const UInt32 ra = Find(f), rb = Find(it->second);
+					if (ra != rb) parent[std::max(ra, rb)] = std::min(ra, rb);
+				}
+			}
+		}
+
+		// Группы в порядке первой грани
+		std::vector<UInt32> groupStart(nFaces + 1, 0), groupFaces(nFaces);
+		for (UInt32 f = 0; f < nFaces; ++f) ++groupStart[Find(f) + 1];
+		for (UInt32 g = 0; g < nFaces; ++g) groupStart[g + 1] += groupStart[g];
+		{
+			std::vector<UInt32> fill(groupStart.begin(), groupStart.end() - 1);
+			for (UInt32 f = 0; f < nFaces; ++f) groupFaces[fill[Find(f)]++] = f;
+		}
+
+		std::unordered_map<UInt32, UInt32> next;       // граница группы: вершина -> следующая
+		std::vector<UInt32> loop;
+		for (UInt32 root = 0; root < nFaces; ++root) {
+			const UInt32 g0 = groupStart[root], g1 = groupStart[root + 1];
+			if (g0 == g1) continue;
+			const Face& head = m_faces[groupFaces[g0]];
+
+			bool merged = false;
+			if (g1 - g0 > 1) {
+				next.clear();
+				bool simple = true;
+				UInt32 nBoundary = 0;
+				for (UInt32 gi = g0; gi < g1 && simple; ++gi) {
+					const Face& fc = m_faces[groupFaces[gi]];
+					for (UInt32 k = 0; k < fc.count; ++k) {
+						const UInt32 a = m_faceVerts[fc.first + k];
+						const UInt32 b = m_faceVerts[fc.first + (k + 1) % fc.count];
+						auto it = edgeFace.find(DirKey(b, a));
+						if (it != edgeFace.end() && Find(it->second) == root) continue;   // внутреннее ребро
+						if (!next.emplace(a, b).second) { simple = false; break; }
+						++nBoundary;
+					}
+				}
+				if (simple && nBoundary >= 3) {
+					loop.clear();
+					UInt32 v = next.begin()->first;
+					do {
+						loop.push_back(v);
+						auto it = next.find(v);
+						if (it == next.end()) break;
+						v = it->second;
+					} while (v != loop.front() && loop.size() <= nBoundary);
+					if (v == loop.front() && loop.size() == nBoundary) {
+						if (!EmitPolygon(loop.data(), (UInt32)loop.size(), head.normal, head.material))
+							return false;
+						merged = true;
+					}
+				}
+			}
+
+			if (!merged) {
+				for (UInt32 gi = g0; gi < g1; ++gi) {
+					const Face& fc = m_faces[groupFaces[gi]];
+					if (!EmitPolygon(&m_faceVerts[fc.first], fc.count, fc.normal, fc.material))
+						return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool Builder::Finish(API_ElementMemo& memo)
+	{
+		if (m_body == nullptr)
+			return false;
+		if (!MergeAndEmit())
+			return false;
+		const GSErrCode err = ACAPI_Body_Finish(m_body, &memo.morphBody, &memo.morphMaterialMapTable);
+		ACAPI_Body_Dispose(&m_body);
+		m_body = nullptr;
+		return err == NoError;
+	}
+
+} // namespace MorphBody
@@ -0,0 +1,102 @@
+// MorphBody.hpp — сборка тела Morph через ACAPI_Body_* с общей топологией:
+// ребро между двумя вершинами создаётся один раз (обратный обход — отрицательный
+// индекс), одинаковые нормали граней хранятся один раз. Перед передачей в тело
+// соседние компланарные грани с одним материалом сливаются в один многоугольник.
+// Площадь по слотам и объём считаются попутно, из той же нормали грани.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace MorphBody {
+
+	struct Stats {
+		UInt32 vertices = 0;
+		UInt32 edges = 0;          // уникальных рёбер в теле
+		UInt32 edgeRefs = 0;       // ссылок на рёбра из граней (было бы рёбер без общей топологии)
+		UInt32 normals = 0;        // уникальных нормалей
+		UInt32 faces = 0;          // граней на входе (AddPolygon)
+		UInt32 polygons = 0;       // многоугольников в теле после слияния
+	};
+
+	class Builder {
+	public:
+		Builder() = default;
+		~Builder();
+
+		Builder(const Builder&) = delete;
+		Builder& operator=(const Builder&) = delete;
+
+		bool Begin();
+
+		// Вершина в локальных координатах тела; outIndex — индекс для AddPolygon
+		bool AddVertex(const API_Coord3D& p, UInt32& outIndex);
+
+		// Слот материала для граней; слияние идёт только внутри одного слота
+		UInt32 AddMaterial(const API_OverriddenAttribute& material);
+
+		// Грань по вершинам (против часовой стрелки, если смотреть снаружи).
+		// Нормаль считается по вершинам (Ньюэлл); вырожденная грань пропускается.
+		// Грани копятся до Finish.
+		bool AddPolygon(const UInt32* verts, UInt32 n, UInt32 materialSlot);
+
+		bool AddTriangle(UInt32 v0, UInt32 v1, UInt32 v2, UInt32 materialSlot) {
+			const UInt32 v[3] = { v0, v1, v2 };
+			return AddPolygon(v, 3, materialSlot);
+		}
+
+		// Слияние компланарных соседей (по умолчанию включено)
+		void SetMergeCoplanar(bool merge) { m_mergeCoplanar = merge; }
+
+		// Слияние, грани в тело, ACAPI_Body_Finish в memo.morphBody /
+		// memo.morphMaterialMapTable; тело освобождается
+		bool Finish(API_ElementMemo& memo);
+
+		const Stats& GetStats() const { return m_stats; }
+
+		// Площадь граней слота (м²) и объём тела (м³) — копятся в AddPolygon.
+		// Объём имеет смысл только для замкнутого тела с гранями наружу.
+		double GetSlotArea(UInt32 materialSlot) const { return materialSlot < m_slotArea.size() ? m_slotArea[materialSlot] : 0.0; }
+		double GetArea() const;
+		double GetVolume() const { return m_volume6 / 6.0; }
+
+	private:
+		struct Face {
+			UInt32       first = 0;      // в m_faceVerts
+			UInt32       count = 0;
+			UInt32       material = 0;
+			API_Vector3D normal = {};
+			double       planeD = 0.0;   // normal · p
+		};
+
+		bool MergeAndEmit();
+		bool EmitPolygon(const UInt32* verts, UInt32 n, const API_Vector3D& normal, UInt32 materialSlot);
+		bool GetEdge(UInt32 from, UInt32 to, Int32& outRef);
+		bool GetNormal(const API_Vector3D& n, Int32& outIndex);
+
+		struct NormalKey {
+			Int64 x, y, z;
+			bool operator==(const NormalKey& o) const { return x == o.x && y == o.y && z == o.z; }
+		};
+		struct NormalKeyHash {
+			size_t operator()(const NormalKey& k) const;
+		};
+
+		void*                                             m_body = nullptr;
+		std::vector<API_Coord3D>                          m_verts;       // по индексу из ACAPI_Body_AddVertex
+		std::unordered_map<UInt64, Int32>                 m_edges;       // (min,max) -> индекс ребра min->max
+		std::unordered_map<NormalKey, Int32, NormalKeyHash> m_normals;
+		std::vector<API_OverriddenAttribute>              m_materials;
+		std::vector<double>                               m_slotArea;    // по слотам материалов
+		double                                            m_volume6 = 0.0;   // 6 * объём
+		std::vector<Face>                                 m_faces;
+		std::vector<UInt32>                               m_faceVerts;
+		GS::Array<Int32>                                  m_polyEdges;   // буфер для ACAPI_Body_AddPolygon
+		bool                                              m_mergeCoplanar = true;
+		Stats                                             m_stats;
+	};
+
+} // namespace MorphBody
@@ -0,0 +1,240 @@
+// ObstacleIndex.cpp
+#include "ObstacleIndex.hpp"
+#include "PathEngine.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_set>
+
+namespace ObstacleIndex {
+
+	// Типы, дающие препятствия габаритом
+	static const API_ElemTypeID kBoxTypes[] = {
+		API_WallID, API_ColumnID, API_BeamID, API_SlabID, API_ObjectID, API_LampID,
+		API_ZoneID, API_HatchID, API_RoofID, API_ShellID, API_MorphID,
+	};
+	// Линейные: препятствие — сами отрезки, не габарит
+	static const API_ElemTypeID kSegTypes[] = {
+		API_LineID, API_ArcID, API_PolyLineID, API_SplineID,
+	};
+
+	static constexpr double kMaxCells = 1024.0 * 1024.0;
+	static constexpr Int32  kMaxCellsPerItem = 64;
+	static constexpr double kMinCellM = 0.5;
+	static constexpr double kArcTolM = 0.01;
+
+	bool Index::Build(const BuildParams& params)
+	{
+		m_items.clear();
+		m_big.clear();
+
+		std::unordered_set<Int32> layers(params.layers.begin(), params.layers.end());
+		// исключения — отсортированный вектор: проверка на каждом элементе
+		// проекта двоичным поиском, а не проходом по всем путям и экземплярам
+		auto guidLess = [](const API_Guid& a, const API_Guid& b) { return std::memcmp(&a, &b, sizeof(API_Guid)) < 0; };
+		std::vector<API_Guid> exclude(params.exclude);
+		std::sort(exclude.begin(), exclude.end(), guidLess);
+		auto accept = [&](API_Elem_Head& head) -> bool {
+			if (std::binary_search(exclude.begin(), exclude.end(), head.guid, guidLess)) return false;
+			if (ACAPI_Element_GetHeader(&head) != NoError) return false;
+			if (params.sameFloor && head.floorInd != params.floorInd) return false;
+			return layers.empty() || layers.count(head.layer.ToInt32_Deprecated()) != 0;
+		};
+
+		for (API_ElemTypeID tid : kBoxTypes) {
+			GS::Array<API_Guid> list;
+			if (ACAPI_Element_GetElemList(tid, &list) != NoError) continue;
+			for (const API_Guid& g : list) {
+				API_Elem_Head head = {}; head.guid = g;
+				if (!accept(head)) continue;
+				API_Box3D b3 = {};
+				if (ACAPI_Element_CalcBounds(&head, &b3) != NoError) continue;
+				AddBox({ b3.xMin, b3.yMin, b3.xMax, b3.yMax });
+			}
+		}
+
+		for (API_ElemTypeID tid : kSegTypes) {
+			GS::Array<API_Guid> list;
+			if (ACAPI_Element_GetElemList(tid, &list) != NoError) continue;
+			for (const API_Guid& g : list) {
+				API_Elem_Head head = {}; head.guid = g;
+				if (!accept(head)) continue;
+				std::vector<PathEngine::Seg> segs;
+				double len = 0.0;
+				if (!PathEngine::BuildPathSegments(g, segs, &len, kArcTolM)) continue;
+				for (const PathEngine::Seg& s : segs) {
+					if (s.kind == PathEngine::Seg::Line) {
+						AddSeg(s.a, s.b);
+						continue;
+					}
+					// дуга — ломаной со стрелкой не больше kArcTolM
+					const double sweep = s.a1 - s.a0;
+					const double maxStep = (kArcTolM >= s.r) ? PathEngine::kPI / 2.0 : 2.0 * std::acos(1.0 - kArcTolM / s.r);
+					const Int32 n = std::max<Int32>(1, (Int32)std::ceil(std::fabs(sweep) / maxStep));
+					API_Coord prev = { s.c.x + s.r * std::cos(s.a0), s.c.y + s.r * std::sin(s.a0) };
+					for (Int32 i = 1; i <= n; ++i) {
+						const double a = s.a0 + sweep * (double)i / (double)n;
+						const API_Coord p = { s.c.x + s.r * std::cos(a), s.c.y + s.r * std::sin(a) };
+						AddSeg(prev, p);
+						prev = p;
+					}
+				}
+			}
+		}
+
+		BuildGrid();
+		return !m_items.empty();
+	}
+
+	void Index::AddBox(const API_Box& box)
+	{
+		Item it = {};
+		it.box = box;
+		it.isSeg = false;
+		m_items.push_back(it);
+	}
+
+	void Index::AddSeg(const API_Coord& a, const API_Coord& b)
+	{
+		Item it = {};
+		it.box = { std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y) };
+		it.isSeg = true;
+		it.ax = a.x; it.ay = a.y; it.bx = b.x; it.by = b.y;
+		m_items.push_back(it);
+	}
+
+	void Index::BuildGrid()
+	{
+		m_cellStart.clear();
+		m_cellItems.clear();
+		m_nx = m_ny = 0;
+		if (m_items.empty())
+			return;
+
+		m_box = m_items.front().box;
+		std::vector<double> sizes;
+		sizes.reserve(m_items.size());
+		for (const Item& it : m_items) {
+			m_box.xMin = std::min(m_box.xMin, it.box.xMin);
+			m_box.yMin = std::min(m_box.yMin, it.box.yMin);
+			m_box.xMax = std::max(m_box.xMax, it.box.xMax);
+			m_box.yMax = std::max(m_box.yMax, it.box.yMax);
+			sizes.push_back(std::max(it.box.xMax - it.box.xMin, it.box.yMax - it.box.yMin));
+		}
+
+		// ячейка — медианный размер препятствия; сетка не больше kMaxCells
+		std::nth_element(sizes.begin(), sizes.begin() + sizes.size() / 2, sizes.end());
+		const double w = m_box.xMax - m_box.xMin, h = m_box.yMax - m_box.yMin;
+		m_cell = std::max(kMinCellM, sizes[sizes.size() / 2]);
+		if ((w / m_cell + 1.0) * (h / m_cell + 1.0) > kMaxCells)
+			m_cell = std::sqrt(w * h / kMaxCells) + 1e-6;
+		m_nx = (Int32)std::floor(w / m_cell) + 1;
+		m_ny = (Int32)std::floor(h / m_cell) + 1;
+
+		// Длинные отрезки (прямая ось дорожки) — кусками по ячейке: габарит
+		// куска занимает пару ячеек, а не полосу сетки или список крупных
+		const size_t nItems = m_items.size();
+		for (size_t i = 0; i < nItems; ++i) {
+			const Item it = m_items[i];
+			if (!it.isSeg) continue;
+			const Int32 n = (Int32)std::ceil(std::hypot(it.bx - it.ax, it.by - it.ay) / m_cell);
+			if (n <= 1) continue;
+			API_Coord prev = { it.ax, it.ay };
+			for (Int32 k = 1; k <= n; ++k) {
+				const double t = (double)k / (double)n;
+				const API_Coord p = { it.ax + (it.bx - it.ax) * t, it.ay + (it.by - it.ay) * t };
+				if (k == 1) {
+					m_items[i].box = { std::min(prev.x, p.x), std::min(prev.y, p.y), std::max(prev.x, p.x), std::max(prev.y, p.y) };
+					m_items[i].bx = p.x; m_items[i].by = p.y;
+				}
+				else {
+					AddSeg(prev, p);
+				}
+				prev = p;
+			}
+		}
+
+		auto range = [&](const API_Box& b, Int32& x0, Int32& y0, Int32& x1, Int32& y1) {
+			x0 = std::max<Int32>(0, (Int32)((b.xMin - m_box.xMin) / m_cell));
+			y0 = std::max<Int32>(0, (Int32)((b.yMin - m_box.yMin) / m_cell));
+			x1 = std::min<Int32>(m_nx - 1, (Int32)((b.xMax - m_box.xMin) / m_cell));
+			y1 = std::min<Int32>(m_ny - 1, (Int32)((b.yMax - m_box.yMin) / m_cell));
+		};
+
+		// CSR: подсчёт, префиксные суммы, раскладка
+		m_cellStart.assign((size_t)m_nx * (size_t)m_ny + 1, 0);
+		std::vector<bool> big(m_items.size(), false);
+		for (UInt32 i = 0; i < (UInt32)m_items.size(); ++i) {
+			Int32 x0, y0, x1, y1;
+			range(m_items[i].box, x0, y0, x1, y1);
+			if ((x1 - x0 + 1) * (y1 - y0 + 1) > kMaxCellsPerItem) {
+				big[i] = true;
+				m_big.push_back(i);
+				continue;
+			}
+			for (Int32 y = y0; y <= y1; ++y)
+				for (Int32 x = x0; x <= x1; ++x)
+					++m_cellStart[(size_t)y * (size_t)m_nx + (size_t)x + 1];
+		}
+		for (size_t c = 1; c < m_cellStart.size(); ++c)
+			m_cellStart[c] += m_cellStart[c - 1];
+
+		m_cellItems.resize(m_cellStart.back());
+		std::vector<UInt32> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+		for (UInt32 i = 0; i < (UInt32)m_items.size(); ++i) {
+			if (big[i]) continue;
+			Int32 x0, y0, x1, y1;
+			range(m_items[i].box, x0, y0, x1, y1);
+			for (Int32 y = y0; y <= y1; ++y)
+				for (Int32 x = x0; x <= x1; ++x)
+					m_cellItems[fill[(size_t)y * (size_t)m_nx + (size_t)x]++] = i;
+		}
+	}
+
+	bool Index::HitsItem(const Item& it, double x, double y, double clearance) const
+	{
+		if (x < it.box.xMin - clearance || x > it.box.xMax + clearance ||
+			y < it.box.yMin - clearance || y > it.box.yMax + clearance)
+			return false;
+		if (!it.isSeg)
+			return true;
+
+		const double dx = it.bx - it.ax, dy = it.by - it.ay;
+		const double len2 = dx * dx + dy * dy;
+		double t = (len2 > 1e-18) ? ((x - it.ax) * dx + (y - it.ay) * dy) / len2 : 0.0;
+		t = std::max(0.0, std::min(1.0, t));
+		const double ex = it.ax + dx * t - x, ey = it.ay + dy * t - y;
+		return ex * ex + ey * ey <= clearance * clearance;
+	}
+
+	bool Index::Hits(double x, double y, double clearance) const
+	{
+		if (m_items.empty())
+			return false;
+		clearance = std::max(clearance, 0.0);
+
+		for (UInt32 i : m_big)
+			if (HitsItem(m_items[i], x, y, clearance))
+				return true;
+
+		if (x < m_box.xMin - clearance || x > m_box.xMax + clearance ||
+			y < m_box.yMin - clearance || y > m_box.yMax + clearance)
+			return false;
+
+		const Int32 x0 = std::max<Int32>(0, (Int32)std::floor((x - clearance - m_box.xMin) / m_cell));
+		const Int32 y0 = std::max<Int32>(0, (Int32)std::floor((y - clearance - m_box.yMin) / m_cell));
+		const Int32 x1 = std::min<Int32>(m_nx - 1, (Int32)std::floor((x + clearance - m_box.xMin) / m_cell));
+		const Int32 y1 = std::min<Int32>(m_ny - 1, (Int32)std::floor((y + clearance - m_box.yMin) / m_cell));
+		for (Int32 gy = y0; gy <= y1; ++gy) {
+			for (Int32 gx = x0; gx <= x1; ++gx) {
+				const size_t c = (size_t)gy * (size_t)m_nx + (size_t)gx;
+				for (UInt32 k = m_cellStart[c]; k < m_cellStart[c + 1]; ++k)
+					if (HitsItem(m_items[m_cellItems[k]], x, y, clearance))
+						return true;
+			}
+		}
+		return false;
+	}
+
+} // namespace ObstacleIndex
@@ -0,0 +1,55 @@
+// ObstacleIndex.hpp — препятствия для расстановки: габариты элементов
+// выбранных слоёв (стены, колонны, перекрытия, объекты...) и отрезки
+// линейных элементов (линии, полилинии, дуги, сплайны — оси дорожек).
+// Собирается один раз; статическая сетка ячеек (CSR), запрос точки смотрит
+// только ячейки в пределах зазора. Габариты больше kMaxCellsPerItem ячеек (перекрытие на
+// весь участок) лежат отдельным коротким списком.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <vector>
+
+namespace ObstacleIndex {
+
+	struct BuildParams {
+		std::vector<Int32>    layers;           // индексы слоёв (ToInt32_Deprecated); пусто — все
+		bool                  sameFloor = true; // только элементы этажа floorInd
+		short                 floorInd = 0;
+		std::vector<API_Guid> exclude;          // пути, контур, прототип
+	};
+
+	class Index {
+	public:
+		// Элементы проекта по params; false — не найдено ни одного препятствия
+		bool Build(const BuildParams& params);
+
+		size_t GetCount() const { return m_items.size(); }
+		bool   IsEmpty() const { return m_items.empty(); }
+
+		// Точка ближе clearance к габариту или отрезку препятствия
+		bool Hits(double x, double y, double clearance) const;
+
+	private:
+		struct Item {
+			API_Box box;
+			bool    isSeg;      // отрезок a-b: расстояние до отрезка, иначе — до габарита
+			double  ax, ay, bx, by;
+		};
+
+		void AddBox(const API_Box& box);
+		void AddSeg(const API_Coord& a, const API_Coord& b);
+		void BuildGrid();
+		bool HitsItem(const Item& it, double x, double y, double clearance) const;
+
+		std::vector<Item>   m_items;
+		std::vector<UInt32> m_big;          // слишком крупные для сетки
+		std::vector<UInt32> m_cellStart;    // размер nx*ny+1
+		std::vector<UInt32> m_cellItems;
+		API_Box             m_box = {};
+		double              m_cell = 1.0;
+		Int32               m_nx = 0, m_ny = 0;
+	};
+
+} // namespace ObstacleIndex
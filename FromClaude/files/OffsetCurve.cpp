@@ -0,0 +1,353 @@
+// OffsetCurve.cpp
+#include "OffsetCurve.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace OffsetCurve {
+
+	using PathEngine::Seg;
+	using PathEngine::kPI;
+
+	static constexpr double kLenEps = 1e-9;
+	static constexpr double kParEps = 1e-9;
+
+	// ---------- Примитивы ----------
+	static inline double Cross(double ax, double ay, double bx, double by) { return ax * by - ay * bx; }
+	static inline double Dist(const API_Coord& p, const API_Coord& q) { return std::hypot(q.x - p.x, q.y - p.y); }
+	static inline API_Coord Lerp(const API_Coord& p, const API_Coord& q, double t) {
+		return { p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t };
+	}
+	static inline double CCWDelta(double a0, double a1) {
+		double d = std::fmod(a1 - a0, 2.0 * kPI);
+		if (d < 0.0) d += 2.0 * kPI;
+		return d; // [0,2pi)
+	}
+
+	static Seg MakeLine(const API_Coord& a, const API_Coord& b) {
+		Seg s; s.kind = Seg::Line; s.a = a; s.b = b; s.L = Dist(a, b);
+		return s;
+	}
+	static Seg MakeArc(const API_Coord& c, double r, double a0, double sweep) {
+		Seg s; s.kind = Seg::Arc; s.c = c; s.r = r; s.a0 = a0; s.a1 = a0 + sweep; s.L = r * std::fabs(sweep);
+		return s;
+	}
+
+	API_Coord SegStart(const Seg& s) {
+		if (s.kind == Seg::Line) return s.a;
+		return { s.c.x + s.r * std::cos(s.a0), s.c.y + s.r * std::sin(s.a0) };
+	}
+	API_Coord SegEnd(const Seg& s) {
+		if (s.kind == Seg::Line) return s.b;
+		return { s.c.x + s.r * std::cos(s.a1), s.c.y + s.r * std::sin(s.a1) };
+	}
+
+	// Единичная касательная в начале / конце сегмента (по ходу пути)
+	static API_Coord Tangent(const Seg& s, bool atEnd) {
+		if (s.kind == Seg::Line) {
+			const double L = std::max(s.L, kLenEps);
+			return { (s.b.x - s.a.x) / L, (s.b.y - s.a.y) / L };
+		}
+		const double ang = atEnd ? s.a1 : s.a0;
+		return (s.a1 - s.a0 >= 0.0) ? API_Coord{ -std::sin(ang), std::cos(ang) }
+									: API_Coord{ std::sin(ang), -std::cos(ang) };
+	}
+
+	// Параметр t в [0,1] точки P (лежащей на окружности дуги) или <0 / >1 вне дуги
+	static double ArcParam(const Seg& s, const API_Coord& P) {
+		const double sweep = s.a1 - s.a0;
+		const double phi = std::atan2(P.y - s.c.y, P.x - s.c.x);
+		double delta = (sweep >= 0.0) ? CCWDelta(s.a0, phi) : -CCWDelta(phi, s.a0);
+		// точка в самом начале может дать delta ≈ ±2π из-за округления
+		if (std::fabs(delta) > std::fabs(sweep) + 1e-12 && 2.0 * kPI - std::fabs(delta) < 1e-9)
+			delta = 0.0;
+		return (std::fabs(sweep) < 1e-15) ? 0.0 : delta / sweep;
+	}
+
+	static void TrimEnd(Seg& s, double t) {
+		if (s.kind == Seg::Line) { s.b = Lerp(s.a, s.b, t); s.L = Dist(s.a, s.b); }
+		else { const double sweep = s.a1 - s.a0; s.a1 = s.a0 + t * sweep; s.L = s.r * std::fabs(s.a1 - s.a0); }
+	}
+	static void TrimStart(Seg& s, double t) {
+		if (s.kind == Seg::Line) { s.a = Lerp(s.a, s.b, t); s.L = Dist(s.a, s.b); }
+		else { const double sweep = s.a1 - s.a0; s.a0 = s.a0 + t * sweep; s.L = s.r * std::fabs(s.a1 - s.a0); }
+	}
+
+	// ---------- Пересечения ----------
+	struct Hit { API_Coord p; double t1, t2; };
+
+	static inline bool InUnit(double t) { return t >= -kParEps && t <= 1.0 + kParEps; }
+	static inline double Clamp01(double t) { return std::min(std::max(t, 0.0), 1.0); }
+
+	static int IntersectLineLine(const Seg& s1, const Seg& s2, Hit* hits) {
+		const double rx = s1.b.x - s1.a.x, ry = s1.b.y - s1.a.y;
+		const double sx = s2.b.x - s2.a.x, sy = s2.b.y - s2.a.y;
+		const double den = Cross(rx, ry, sx, sy);
+		if (std::fabs(den) < 1e-15) return 0;   // параллельны (наложения не ищем)
+		const double qx = s2.a.x - s1.a.x, qy = s2.a.y - s1.a.y;
+		const double t = Cross(qx, qy, sx, sy) / den;
+		const double u = Cross(qx, qy, rx, ry) / den;
+		if (!InUnit(t) || !InUnit(u)) return 0;
+		hits[0] = { Lerp(s1.a, s1.b, t), Clamp01(t), Clamp01(u) };
+		return 1;
+	}
+
+	static int IntersectLineArc(const Seg& ln, const Seg& arc, Hit* hits, bool swap) {
+		const double rx = ln.b.x - ln.a.x, ry = ln.b.y - ln.a.y;
+		const double fx = ln.a.x - arc.c.x, fy = ln.a.y - arc.c.y;
+		const double A = rx * rx + ry * ry;
+		if (A < 1e-30) return 0;
+		const double B = 2.0 * (fx * rx + fy * ry);
+		const double C = fx * fx + fy * fy - arc.r * arc.r;
+		const double disc = B * B - 4.0 * A * C;
+		if (disc < 0.0) return 0;
+		const double sq = std::sqrt(disc);
+		int n = 0;
+		const double ts[2] = { (-B - sq) / (2.0 * A), (-B + sq) / (2.0 * A) };
+		for (int k = 0; k < (sq > 0.0 ? 2 : 1); ++k) {
+			if (!InUnit(ts[k])) continue;
+			const API_Coord P = Lerp(ln.a, ln.b, ts[k]);
+			const double u = ArcParam(arc, P);
+			if (!InUnit(u)) continue;
+			hits[n++] = swap ? Hit{ P, Clamp01(u), Clamp01(ts[k]) } : Hit{ P, Clamp01(ts[k]), Clamp01(u) };
+		}
+		return n;
+	}
+
+	static int IntersectArcArc(const Seg& s1, const Seg& s2, Hit* hits) {
+		const double dx = s2.c.x - s1.c.x, dy = s2.c.y - s1.c.y;
+		const double dd = std::hypot(dx, dy);
+		if (dd < 1e-12 || dd > s1.r + s2.r || dd < std::fabs(s1.r - s2.r)) return 0;
+		const double a = (s1.r * s1.r - s2.r * s2.r + dd * dd) / (2.0 * dd);
+		const double h = std::sqrt(std::max(s1.r * s1.r - a * a, 0.0));
+		const double mx = s1.c.x + a * dx / dd, my = s1.c.y + a * dy / dd;
+		const API_Coord cand[2] = { { mx - h * dy / dd, my + h * dx / dd }, { mx + h * dy / dd, my - h * dx / dd } };
+		int n = 0;
+		for (int k = 0; k < (h > 0.0 ? 2 : 1); ++k) {
+			const double t = ArcParam(s1, cand[k]);
+			const double u = ArcParam(s2, cand[k]);
+			if (InUnit(t) && InUnit(u)) hits[n++] = { cand[k], Clamp01(t), Clamp01(u) };
+		}
+		return n;
+	}
+
+	static int Intersect(const Seg& s1, const Seg& s2, Hit* hits) {
+		if (s1.kind == Seg::Line && s2.kind == Seg::Line) return IntersectLineLine(s1, s2, hits);
+		if (s1.kind == Seg::Line) return IntersectLineArc(s1, s2, hits, false);
+		if (s2.kind == Seg::Line) return IntersectLineArc(s2, s1, hits, true);
+		return IntersectArcArc(s1, s2, hits);
+	}
+
+	// ---------- Расстояние до исходного пути (для проверки петель) ----------
+	static double DistToSeg(const Seg& s, const API_Coord& P) {
+		if (s.kind == Seg::Line) {
+			const double rx = s.b.x - s.a.x, ry = s.b.y - s.a.y;
+			const double A = rx * rx + ry * ry;
+			const double t = (A < 1e-30) ? 0.0 : Clamp01(((P.x - s.a.x) * rx + (P.y - s.a.y) * ry) / A);
+			return Dist(P, Lerp(s.a, s.b, t));
+		}
+		if (InUnit(ArcParam(s, P)))
+			return std::fabs(Dist(P, s.c) - s.r);
+		return std::min(Dist(P, SegStart(s)), Dist(P, SegEnd(s)));
+	}
+
+	static double DistToPath(const std::vector<Seg>& path, const API_Coord& P) {
+		double best = 1e300;
+		for (const Seg& s : path) best = std::min(best, DistToSeg(s, P));
+		return best;
+	}
+
+	static API_Coord MidPoint(const Seg& s) {
+		if (s.kind == Seg::Line) return Lerp(s.a, s.b, 0.5);
+		const double ang = 0.5 * (s.a0 + s.a1);
+		return { s.c.x + s.r * std::cos(ang), s.c.y + s.r * std::sin(ang) };
+	}
+
+	// ---------- Сдвиг одного сегмента ----------
+	static bool OffsetSeg(const Seg& s, double d, Seg& out) {
+		if (s.kind == Seg::Line) {
+			const API_Coord t = Tangent(s, false);
+			const double nx = -t.y * d, ny = t.x * d;
+			out = MakeLine({ s.a.x + nx, s.a.y + ny }, { s.b.x + nx, s.b.y + ny });
+			return out.L > kLenEps;
+		}
+		// левая сторона CCW-дуги — к центру
+		const double sweep = s.a1 - s.a0;
+		const double r = (sweep >= 0.0) ? s.r - d : s.r + d;
+		if (r <= kLenEps) return false;
+		out = MakeArc(s.c, r, s.a0, sweep);
+		return out.L > kLenEps;
+	}
+
+	// ---------- Стык двух соседних сдвинутых сегментов ----------
+	// V — общая вершина исходного пути, tIn/tOut — касательные исходного пути в ней.
+	static void AddJoin(std::vector<Seg>& out, Seg& next, const API_Coord& V,
+		const API_Coord& tIn, const API_Coord& tOut, double d, const Options& opt, Stats* stats)
+	{
+		Seg& prev = out.back();
+		const API_Coord E = SegEnd(prev);
+		const API_Coord S = SegStart(next);
+		if (Dist(E, S) <= kLenEps) return;
+
+		const double cr = Cross(tIn.x, tIn.y, tOut.x, tOut.y);
+		const double dt = tIn.x * tOut.x + tIn.y * tOut.y;
+		const double theta = std::atan2(cr, dt);     // угол поворота пути со знаком
+
+		// внутренняя сторона поворота: сдвиги перекрываются — режем по пересечению
+		if (cr * d > 0.0) {
+			if (stats) ++stats->joinsInner;
+			Hit hits[2];
+			const int n = Intersect(prev, next, hits);
+			if (n > 0) {
+				const Hit& h = (n == 2 && hits[1].t1 > hits[0].t1) ? hits[1] : hits[0];
+				TrimEnd(prev, h.t1);
+				TrimStart(next, h.t2);
+			}
+			else {
+				out.push_back(MakeLine(E, S));   // перемычку уберёт проход по петлям
+			}
+			return;
+		}
+
+		const double ad = std::fabs(d);
+		const double half = 0.5 * std::fabs(theta);
+		const double miterRatio = 1.0 / std::max(std::cos(half), 1e-12);
+		const bool   smallTurn = ad * (miterRatio - 1.0) <= opt.chordTolM;
+
+		if (opt.join == JoinType::Round && !smallTurn) {
+			if (stats) ++stats->joinsRound;
+			const double a0 = std::atan2(E.y - V.y, E.x - V.x);
+			out.push_back(MakeArc(V, ad, a0, theta));
+			return;
+		}
+
+		if (stats) ++stats->joinsMiter;
+		if (miterRatio > opt.miterLimit && !smallTurn) {
+			out.push_back(MakeLine(E, S));   // bevel
+			return;
+		}
+		const double ext = ad * std::tan(half);
+		const API_Coord X = { E.x + tIn.x * ext, E.y + tIn.y * ext };
+		if (prev.kind == Seg::Line && next.kind == Seg::Line) {
+			prev.b = X; prev.L = Dist(prev.a, prev.b);
+			next.a = X; next.L = Dist(next.a, next.b);
+		}
+		else {
+			if (Dist(E, X) > kLenEps) out.push_back(MakeLine(E, X));
+			if (Dist(X, S) > kLenEps) out.push_back(MakeLine(X, S));
+		}
+	}
+
+	// ---------- Проход по петлям (sweep line по X) ----------
+	struct Cut { size_t i, j; double ti, tj; };
+
+	static void RemoveLoops(std::vector<Seg>& segs, const std::vector<Seg>& path, double d, bool closed, Stats* stats)
+	{
+		const size_t n = segs.size();
+		if (n < 3) return;
+
+		struct Box { double x0, y0, x1, y1; };
+		std::vector<Box> box(n);
+		for (size_t k = 0; k < n; ++k) {
+			const Seg& s = segs[k];
+			if (s.kind == Seg::Line)
+				box[k] = { std::min(s.a.x, s.b.x), std::min(s.a.y, s.b.y), std::max(s.a.x, s.b.x), std::max(s.a.y, s.b.y) };
+			else
+				box[k] = { s.c.x - s.r, s.c.y - s.r, s.c.x + s.r, s.c.y + s.r };
+		}
+
+		std::vector<size_t> order(n);
+		for (size_t k = 0; k < n; ++k) order[k] = k;
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return box[a].x0 < box[b].x0; });
+
+		std::vector<Cut> cand;
+		std::vector<size_t> active;
+		for (size_t k : order) {
+			const Box& bk = box[k];
+			active.erase(std::remove_if(active.begin(), active.end(),
+				[&](size_t a) { return box[a].x1 < bk.x0 - kLenEps; }), active.end());
+			for (size_t a : active) {
+				const size_t i = std::min(a, k), j = std::max(a, k);
+				if (j - i < 2) continue;                              // соседние делят вершину
+				if (closed && i == 0 && j == n - 1) continue;
+				if (box[a].y1 < bk.y0 - kLenEps || bk.y1 < box[a].y0 - kLenEps) continue;
+				Hit hits[2];
+				const int nh = Intersect(segs[i], segs[j], hits);
+				for (int h = 0; h < nh; ++h) cand.push_back({ i, j, hits[h].t1, hits[h].t2 });
+			}
+			active.push_back(k);
+		}
+		if (cand.empty()) return;
+
+		// самые широкие петли первыми; петля ложная, если её середина ближе |d| к оси
+		std::sort(cand.begin(), cand.end(), [](const Cut& a, const Cut& b) {
+			return a.i != b.i ? a.i < b.i : a.j > b.j;
+			});
+		const double limit = std::fabs(d) * (1.0 - 1e-6) - 1e-9;
+		std::vector<Cut> cuts;
+		size_t nextMin = 0;
+		for (const Cut& c : cand) {
+			if (c.i < nextMin) continue;
+			const API_Coord probe = MidPoint(segs[c.i + (c.j - c.i) / 2]);
+			if (DistToPath(path, probe) >= limit) continue;           // настоящая петля пути — оставляем
+			cuts.push_back(c);
+			nextMin = c.j + 1;
+		}
+		if (cuts.empty()) return;
+
+		std::vector<Seg> res;
+		res.reserve(n);
+		size_t k = 0;
+		for (const Cut& c : cuts) {
+			for (; k < c.i; ++k) res.push_back(segs[k]);
+			Seg a = segs[c.i]; TrimEnd(a, c.ti);
+			if (a.L > kLenEps) res.push_back(a);
+			Seg b = segs[c.j]; TrimStart(b, c.tj);
+			segs[c.j] = b;
+			k = c.j;
+		}
+		for (; k < n; ++k) if (segs[k].L > kLenEps) res.push_back(segs[k]);
+		segs.swap(res);
+		if (stats) stats->loopsRemoved += (UInt32)cuts.size();
+	}
+
+	// ============= Публичное =============
+	bool Offset(const std::vector<Seg>& path, double d, const Options& opt, std::vector<Seg>& out, Stats* stats)
+	{
+		out.clear();
+		if (path.empty()) return false;
+		if (std::fabs(d) < kLenEps) { out = path; return true; }
+
+		out.reserve(path.size() * 2);
+		// индексы исходных сегментов, к которым привязаны первый и последний добавленные сдвиги
+		size_t firstSrc = (size_t)-1, lastSrc = (size_t)-1;
+		for (size_t i = 0; i < path.size(); ++i) {
+			Seg o;
+			if (!OffsetSeg(path[i], d, o)) {
+				if (stats) ++stats->collapsedArcs;
+				continue;
+			}
+			if (out.empty()) { out.push_back(o); firstSrc = lastSrc = i; continue; }
+
+			// после схлопнувшихся дуг lastSrc < i - 1: вершина стыка — конец
+			// того сегмента, чей сдвиг последним лёг в out (и чьи касательные)
+			const API_Coord V = SegEnd(path[lastSrc]);
+			AddJoin(out, o, V, Tangent(path[lastSrc], true), Tangent(path[i], false), d, opt, stats);
+			out.push_back(o);
+			lastSrc = i;
+		}
+		if (out.empty()) return false;
+
+		if (opt.closed && out.size() > 1) {
+			Seg first = out.front();
+			const API_Coord V = SegEnd(path[lastSrc]);
+			AddJoin(out, first, V, Tangent(path[lastSrc], true), Tangent(path[firstSrc], false), d, opt, stats);
+			out.front() = first;
+		}
+
+		RemoveLoops(out, path, d, opt.closed, stats);
+		out.erase(std::remove_if(out.begin(), out.end(), [](const Seg& s) { return s.L <= kLenEps; }), out.end());
+		return !out.empty();
+	}
+
+} // namespace OffsetCurve
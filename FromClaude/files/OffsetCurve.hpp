@@ -0,0 +1,38 @@
+// OffsetCurve.hpp — точный эквидистантный сдвиг цепочки отрезков/дуг.
+// Отрезок сдвигается параллельно, дуга — сменой радиуса; стыки заполняются
+// скруглением или «митрой», петли на тесных внутренних изгибах срезаются.
+// Результат — такие же отрезки/дуги (PathEngine::Seg), без облака точек.
+#pragma once
+
+#include "PathEngine.hpp"
+
+#include <vector>
+
+namespace OffsetCurve {
+
+	enum class JoinType { Miter, Round };
+
+	struct Options {
+		JoinType join = JoinType::Round;
+		double   miterLimit = 2.0;                         // |X - вершина| / |d|; больше — срез (bevel)
+		double   chordTolM = PathEngine::kDefaultChordTolM; // малые изломы стыкуем митрой без дуги
+		bool     closed = false;                           // замкнутая цепочка: стык последний->первый
+	};
+
+	struct Stats {
+		UInt32 joinsRound = 0;
+		UInt32 joinsMiter = 0;
+		UInt32 joinsInner = 0;
+		UInt32 collapsedArcs = 0;   // дуги с радиусом <= |d| на внутренней стороне
+		UInt32 loopsRemoved = 0;
+	};
+
+	// d > 0 — влево по ходу пути, d < 0 — вправо.
+	bool Offset(const std::vector<PathEngine::Seg>& path, double d, const Options& opt,
+		std::vector<PathEngine::Seg>& out, Stats* stats = nullptr);
+
+	// Начальная/конечная точка сегмента
+	API_Coord SegStart(const PathEngine::Seg& s);
+	API_Coord SegEnd(const PathEngine::Seg& s);
+
+} // namespace OffsetCurve
@@ -0,0 +1,320 @@
+// PathEngine.cpp
+#include "PathEngine.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace PathEngine {
+
+	// ---------- Геометрия ----------
+	static inline double Dist(const API_Coord& p, const API_Coord& q) {
+		return std::hypot(q.x - p.x, q.y - p.y);
+	}
+	static inline API_Coord Lerp(const API_Coord& p, const API_Coord& q, double t) {
+		return { p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t };
+	}
+	static inline void PushLine(std::vector<Seg>& segs, const API_Coord& a, const API_Coord& b) {
+		Seg s; s.kind = Seg::Line; s.a = a; s.b = b; s.L = Dist(a, b);
+		if (s.L > 1e-9) segs.push_back(s);
+	}
+	static inline double Norm2PI(double a) {
+		const double two = 2.0 * kPI;
+		while (a < 0.0)   a += two;
+		while (a >= two)  a -= two;
+		return a;
+	}
+	static inline double CCWDelta(double a0, double a1) {
+		a0 = Norm2PI(a0); a1 = Norm2PI(a1);
+		double d = a1 - a0; if (d < 0.0) d += 2.0 * kPI;
+		return d; // [0,2pi)
+	}
+
+	// --------- Безье для сплайна ---------
+	static inline API_Coord Add(const API_Coord& a, const API_Coord& b) { return { a.x + b.x, a.y + b.y }; }
+	static inline API_Coord Sub(const API_Coord& a, const API_Coord& b) { return { a.x - b.x, a.y - b.y }; }
+	static inline API_Coord FromAngLen(double ang, double len) { return { std::cos(ang) * len, std::sin(ang) * len }; }
+
+	// Адаптивное спрямление кубической Безье: делим пополам (де Кастельжо),
+	// пока кривая не станет «плоской» в пределах допуска хорды. Оценка
+	// плоскостности (Willcocks): max отклонения кривой от хорды P0-P3 не
+	// больше 1/4 * sqrt(max(ux²,vx²) + max(uy²,vy²)), где
+	// u = 3*C1 - 2*P0 - P3, v = 3*C2 - P0 - 2*P3.
+	static void FlattenBezier(std::vector<Seg>& segs, const API_Coord& P0, const API_Coord& C1,
+		const API_Coord& C2, const API_Coord& P3, double tol16sq, int depth)
+	{
+		const double ux = 3.0 * C1.x - 2.0 * P0.x - P3.x, uy = 3.0 * C1.y - 2.0 * P0.y - P3.y;
+		const double vx = 3.0 * C2.x - P0.x - 2.0 * P3.x, vy = 3.0 * C2.y - P0.y - 2.0 * P3.y;
+		const double flat = std::max(ux * ux, vx * vx) + std::max(uy * uy, vy * vy);
+		if (flat <= tol16sq || depth >= 16) {
+			PushLine(segs, P0, P3);
+			return;
+		}
+
+		const API_Coord P01 = Lerp(P0, C1, 0.5), P12 = Lerp(C1, C2, 0.5), P23 = Lerp(C2, P3, 0.5);
+		const API_Coord P012 = Lerp(P01, P12, 0.5), P123 = Lerp(P12, P23, 0.5);
+		const API_Coord M = Lerp(P012, P123, 0.5);
+		FlattenBezier(segs, P0, P01, P012, M, tol16sq, depth + 1);
+		FlattenBezier(segs, M, P123, P23, P3, tol16sq, depth + 1);
+	}
+
+	// ============= Полилиния (coords + parcs + pends(Int32)) =============
+	void AppendPolyMemoSegments(const API_ElementMemo& memo, std::vector<Seg>& out)
+	{
+		if (memo.coords == nullptr) return;
+
+		const Int32 nAll = (Int32)(BMGetHandleSize((GSHandle)memo.coords) / sizeof(API_Coord));
+		const Int32 nPts = std::max<Int32>(0, nAll - 1);            // валидные 1..nPts
+		if (nPts < 2) return;
+
+		// «концы» цепочек (многоконтур/разрывы) — Int32
+		std::vector<Int32> ends;
+		if (memo.pends != nullptr) {
+			const Int32 nEnds = (Int32)(BMGetHandleSize((GSHandle)memo.pends) / sizeof(Int32));
+			for (Int32 k = 0; k < nEnds; ++k) {
+				const Int32 ind = (*memo.pends)[k];
+				if (ind >= 1 && ind <= nPts) ends.push_back(ind);
+			}
+		}
+		if (ends.empty()) ends.push_back(nPts); // одна открытая цепочка 1..nPts
+
+		// битовая маска концов: проверка вершины O(1) вместо поиска по ends
+		std::vector<bool> endMask(nPts + 1, false);
+		for (Int32 ind : ends) endMask[ind] = true;
+		auto isEnd = [&](Int32 i) -> bool { return endMask[i]; };
+
+		// карта дуг по begIndex (разрешаем только рёбра 1..nPts-1)
+		std::vector<double> arcByBeg(nPts + 1, 0.0);
+		if (memo.parcs != nullptr) {
+			const Int32 nArcs = (Int32)(BMGetHandleSize((GSHandle)memo.parcs) / sizeof(API_PolyArc));
+			for (Int32 k = 0; k < nArcs; ++k) {
+				const API_PolyArc& pa = (*memo.parcs)[k];
+				if (pa.begIndex >= 1 && pa.begIndex <= nPts - 1)
+					arcByBeg[pa.begIndex] = pa.arcAngle; // со знаком
+			}
+		}
+
+		for (Int32 i = 1; i <= nPts - 1; ++i) {
+			if (isEnd(i)) continue;               // не соединяем через конец цепочки
+
+			const Int32 j = i + 1;
+			const API_Coord& A = (*memo.coords)[i];
+			const API_Coord& B = (*memo.coords)[j];
+
+			const double angArc = arcByBeg[i];
+			if (std::fabs(angArc) < 1e-9) { PushLine(out, A, B); continue; }
+
+			// две возможные окружности — выбираем ту, у которой sweep по знаку/модулю ближе к arcAngle
+			const double dx = B.x - A.x, dy = B.y - A.y;
+			const double chord = std::hypot(dx, dy);
+			if (chord < 1e-9) continue;
+
+			const double r = std::fabs(chord / (2.0 * std::sin(std::fabs(angArc) * 0.5)));
+			const double mx = (A.x + B.x) * 0.5, my = (A.y + B.y) * 0.5;
+			const double nx = -dy / chord, ny = dx / chord;
+			const double d = std::sqrt(std::max(r * r - 0.25 * chord * chord, 0.0));
+
+			struct Cand { API_Coord c; double a0, a1, L; };
+			auto makeCand = [&](double sx, double sy) -> Cand {
+				const double cx = mx + sx * d, cy = my + sy * d;
+				const double aA = std::atan2(A.y - cy, A.x - cx);
+				const double aB = std::atan2(B.y - cy, B.x - cx);
+				double sweep = (angArc > 0.0) ? CCWDelta(aA, aB) : -CCWDelta(aB, aA);
+				Cand cnd; cnd.c = { cx, cy }; cnd.a0 = aA; cnd.a1 = aA + sweep; cnd.L = r * std::fabs(sweep);
+				return cnd;
+				};
+
+			const Cand c1 = makeCand(nx, ny);
+			const Cand c2 = makeCand(-nx, -ny);
+
+			const double d1 = std::fabs((c1.a1 - c1.a0) - angArc);
+			const double d2 = std::fabs((c2.a1 - c2.a0) - angArc);
+			const Cand& best = (d1 <= d2 ? c1 : c2);
+
+			Seg s; s.kind = Seg::Arc; s.c = best.c; s.r = r; s.a0 = best.a0; s.a1 = best.a1; s.L = best.L;
+			if (s.L > 1e-9) out.push_back(s);
+		}
+	}
+
+	// ============= Сборка пути по элементу =============
+	bool BuildPathSegments(const API_Guid& pathGuid, std::vector<Seg>& segs, double* totalLen,
+		double chordTolM, PathStats* stats)
+	{
+		segs.clear();
+		if (totalLen) *totalLen = 0.0;
+
+		API_Element e = {}; e.header.guid = pathGuid;
+		if (ACAPI_Element_Get(&e) != NoError) return false;
+
+		switch (e.header.type.typeID) {
+		case API_LineID:
+			PushLine(segs, e.line.begC, e.line.endC);
+			break;
+
+		case API_ArcID: {
+			Seg s; s.kind = Seg::Arc; s.c = e.arc.origC; s.r = e.arc.r;
+			double a0 = Norm2PI(e.arc.begAng);
+			double sweep = e.arc.endAng - a0;
+			while (sweep <= -2.0 * kPI) sweep += 2.0 * kPI;
+			while (sweep > 2.0 * kPI) sweep -= 2.0 * kPI;
+			s.a0 = a0; s.a1 = a0 + sweep; s.L = s.r * std::fabs(sweep);
+			if (s.L > 1e-9) segs.push_back(s);
+			break;
+		}
+
+		case API_CircleID: {
+			Seg s; s.kind = Seg::Arc; s.c = e.circle.origC; s.r = e.circle.r;
+			s.a0 = 0.0; s.a1 = 2.0 * kPI; s.L = 2.0 * kPI * s.r;
+			segs.push_back(s);
+			break;
+		}
+
+		case API_PolyLineID: {
+			API_ElementMemo memo = {};
+			if (ACAPI_Element_GetMemo(pathGuid, &memo) == NoError && memo.coords != nullptr)
+				AppendPolyMemoSegments(memo, segs);
+			ACAPI_DisposeElemMemoHdls(&memo);
+			break;
+		}
+
+		case API_SplineID: {
+			// Кубические Безье по bezierDirs, адаптивное спрямление по допуску хорды
+			API_ElementMemo memo = {};
+			if (ACAPI_Element_GetMemo(pathGuid, &memo, APIMemoMask_Polygon) == NoError &&
+				memo.coords != nullptr && memo.bezierDirs != nullptr)
+			{
+				const double tol = std::max(chordTolM, 1e-6);
+				const double tol16sq = 16.0 * tol * tol;
+				const Int32 n = (Int32)(BMGetHandleSize((GSHandle)memo.coords) / sizeof(API_Coord));
+				if (n >= 2) {
+					for (Int32 i = 0; i < n - 1; ++i) {
+						const API_Coord P0 = (*memo.coords)[i];
+						const API_Coord P3 = (*memo.coords)[i + 1];
+						const API_SplineDir d0 = (*memo.bezierDirs)[i];
+						const API_SplineDir d1 = (*memo.bezierDirs)[i + 1];
+						const API_Coord C1 = Add(P0, FromAngLen(d0.dirAng, d0.lenNext));
+						const API_Coord C2 = Sub(P3, FromAngLen(d1.dirAng, d1.lenPrev));
+
+						const size_t before = segs.size();
+						FlattenBezier(segs, P0, C1, C2, P3, tol16sq, 0);
+						if (stats) {
+							++stats->bezierEdges;
+							stats->bezierSegs += (UInt32)(segs.size() - before);
+							stats->fixedSegs += 32;
+						}
+					}
+				}
+			}
+			ACAPI_DisposeElemMemoHdls(&memo);
+			break;
+		}
+
+		default: return false;
+		}
+
+		if (segs.empty()) return false;
+
+		double sum = 0.0; for (const Seg& s : segs) sum += s.L;
+		if (totalLen) *totalLen = sum;
+		return sum > 1e-9;
+	}
+
+	// ============= CompiledPath =============
+	bool CompiledPath::Build(const API_Guid& pathGuid, double chordTolM, PathStats* stats)
+	{
+		std::vector<Seg> segs;
+		if (!BuildPathSegments(pathGuid, segs, nullptr, chordTolM, stats)) {
+			Assign({});
+			return false;
+		}
+		return Assign(std::move(segs));
+	}
+
+	bool CompiledPath::Assign(std::vector<Seg>&& segs)
+	{
+		m_segs = std::move(segs);
+		m_start.resize(m_segs.size() + 1);
+		m_start[0] = 0.0;
+		for (size_t i = 0; i < m_segs.size(); ++i)
+			m_start[i + 1] = m_start[i] + m_segs[i].L;
+		if (m_segs.empty()) m_start.clear();
+		return GetLength() > 1e-9;
+	}
+
+	// первый сегмент, конец которого >= s (как в прежнем линейном проходе)
+	size_t CompiledPath::FindSegment(double s) const
+	{
+		const auto it = std::lower_bound(m_start.begin() + 1, m_start.end(), s);
+		if (it == m_start.end()) return m_segs.size() - 1;
+		return (size_t)(it - (m_start.begin() + 1));
+	}
+
+	void CompiledPath::EvalInSegment(size_t i, double s, API_Coord* outP, double* outTanAngleRad) const
+	{
+		const Seg& seg = m_segs[i];
+		double f = (seg.L < 1e-9) ? 0.0 : (s - m_start[i]) / seg.L;
+		f = std::min(std::max(f, 0.0), 1.0);
+
+		if (seg.kind == Seg::Line) {
+			if (outP)           *outP = Lerp(seg.a, seg.b, f);
+			if (outTanAngleRad) *outTanAngleRad = std::atan2(seg.b.y - seg.a.y, seg.b.x - seg.a.x);
+		}
+		else {
+			const double sweep = seg.a1 - seg.a0;                 // со знаком!
+			const double ang = seg.a0 + f * sweep;
+			if (outP)           *outP = { seg.c.x + seg.r * std::cos(ang), seg.c.y + seg.r * std::sin(ang) };
+			if (outTanAngleRad) *outTanAngleRad = ang + ((sweep >= 0.0) ? +kPI / 2.0 : -kPI / 2.0);
+		}
+	}
+
+	void CompiledPath::Eval(double s, API_Coord* outP, double* outTanAngleRad) const
+	{
+		if (m_segs.empty()) return;
+		EvalInSegment(FindSegment(s), s, outP, outTanAngleRad);
+	}
+
+	void CompiledPath::Cursor::Eval(double s, API_Coord* outP, double* outTanAngleRad)
+	{
+		const size_t n = m_path.m_segs.size();
+		if (n == 0) return;
+
+		if (m_seg >= n || s < m_path.m_start[m_seg])
+			m_seg = m_path.FindSegment(s);
+		else
+			while (m_seg + 1 < n && s > m_path.m_start[m_seg + 1]) ++m_seg;
+
+		m_path.EvalInSegment(m_seg, s, outP, outTanAngleRad);
+	}
+
+	// ------------------------------------------------------------------------
+	// StationStream
+	// ------------------------------------------------------------------------
+	StationStream StationStream::ByStep(const CompiledPath& path, double stepM)
+	{
+		StationStream st(path);
+		const double L = path.GetLength();
+		if (path.IsEmpty() || stepM <= 1e-9) return st;
+		st.m_step = stepM;
+		st.m_count = (UInt32)std::floor((L + 1e-9) / stepM) + 1;
+		return st;
+	}
+
+	StationStream StationStream::ByCount(const CompiledPath& path, UInt32 count)
+	{
+		StationStream st(path);
+		if (path.IsEmpty() || count == 0) return st;
+		st.m_count = count;
+		st.m_step = (count > 1) ? path.GetLength() / (double)(count - 1) : 0.0;
+		return st;
+	}
+
+	bool StationStream::Next(API_Coord* outP, double* outTanAngleRad, double* outS)
+	{
+		if (m_i >= m_count) return false;
+		const double s = std::min((double)m_i * m_step, m_length);
+		++m_i;
+		m_cursor.Eval(s, outP, outTanAngleRad);
+		if (outS) *outS = s;
+		return true;
+	}
+
+} // namespace PathEngine
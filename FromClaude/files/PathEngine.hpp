@@ -0,0 +1,109 @@
+// PathEngine.hpp — путь (линия/дуга/окружность/полилиния/сплайн) как цепочка
+// сегментов с параметризацией по длине. Общий для RoadHelper и LandscapeHelper.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <vector>
+
+namespace PathEngine {
+
+	constexpr double kPI = 3.1415926535897932384626433832795;
+
+	struct Seg {
+		enum Kind { Line, Arc } kind;
+		API_Coord a{}, b{};   // Line
+		API_Coord c{};        // Arc: center
+		double    r = 0.0;
+		double    a0 = 0.0;   // start angle
+		double    a1 = 0.0;   // end angle (a1 - a0 = signed sweep)
+		double    L = 0.0;   // length
+	};
+
+	// Допуск хорды при спрямлении кривых Безье сплайна (м): отклонение
+	// ломаной от кривой не превышает этого значения.
+	constexpr double kDefaultChordTolM = 0.001;
+
+	// Статистика сборки — для лога (сколько сегментов дало спрямление сплайна)
+	struct PathStats {
+		UInt32 bezierEdges = 0;   // рёбер Безье в сплайне
+		UInt32 bezierSegs = 0;    // линейных сегментов после адаптивного спрямления
+		UInt32 fixedSegs = 0;     // сколько было бы при прежних 32 на ребро
+	};
+
+	// Сегменты из memo полилинии или многоугольника (coords 1..n, pends, parcs);
+	// цепочки/контуры между собой не соединяются
+	void AppendPolyMemoSegments(const API_ElementMemo& memo, std::vector<Seg>& out);
+
+	// Сборка сегментов пути из элемента (Line/Arc/Circle/PolyLine/Spline)
+	bool BuildPathSegments(const API_Guid& pathGuid, std::vector<Seg>& segs, double* totalLen,
+		double chordTolM = kDefaultChordTolM, PathStats* stats = nullptr);
+
+	// ------------------------------------------------------------------------
+	// Скомпилированный путь: префиксные суммы длин сегментов.
+	// Eval(s) — двоичный поиск O(log n); Cursor — для монотонно растущих s,
+	// амортизированно O(1) на точку (вся выборка O(сегменты + точки)).
+	// ------------------------------------------------------------------------
+	class CompiledPath {
+	public:
+		bool Build(const API_Guid& pathGuid, double chordTolM = kDefaultChordTolM, PathStats* stats = nullptr);
+		bool Assign(std::vector<Seg>&& segs);
+
+		double                  GetLength() const { return m_start.empty() ? 0.0 : m_start.back(); }
+		size_t                  GetSegmentCount() const { return m_segs.size(); }
+		const std::vector<Seg>& GetSegments() const { return m_segs; }
+		bool                    IsEmpty() const { return m_segs.empty(); }
+
+		// s за пределами [0, L] прижимается к концам
+		void Eval(double s, API_Coord* outP, double* outTanAngleRad) const;
+
+		class Cursor {
+		public:
+			explicit Cursor(const CompiledPath& path) : m_path(path) {}
+
+			// Для s, не убывающих от вызова к вызову, идёт вперёд по сегментам;
+			// при шаге назад откатывается на двоичный поиск.
+			void Eval(double s, API_Coord* outP, double* outTanAngleRad);
+
+		private:
+			const CompiledPath& m_path;
+			size_t              m_seg = 0;
+		};
+
+	private:
+		size_t FindSegment(double s) const;
+		void   EvalInSegment(size_t i, double s, API_Coord* outP, double* outTanAngleRad) const;
+
+		std::vector<Seg>    m_segs;
+		std::vector<double> m_start;  // m_start[i] — длина до начала сегмента i; размер n+1
+	};
+
+	// ------------------------------------------------------------------------
+	// Поток станций по пути: равный шаг или заданное число точек; позиция и
+	// касательная — через Cursor, без промежуточного массива пикетов.
+	// Весь проход O(сегменты + станции).
+	// ------------------------------------------------------------------------
+	class StationStream {
+	public:
+		// s = 0, step, 2*step, ... пока s <= L
+		static StationStream ByStep(const CompiledPath& path, double stepM);
+		// count точек на равных расстояниях, концы включены (1 — только начало)
+		static StationStream ByCount(const CompiledPath& path, UInt32 count);
+
+		UInt32 GetCount() const { return m_count; }
+
+		// Следующая станция; false — станции кончились
+		bool Next(API_Coord* outP, double* outTanAngleRad, double* outS = nullptr);
+
+	private:
+		explicit StationStream(const CompiledPath& path) : m_cursor(path), m_length(path.GetLength()) {}
+
+		CompiledPath::Cursor m_cursor;
+		double               m_length;
+		double               m_step = 0.0;
+		UInt32               m_count = 0;
+		UInt32               m_i = 0;
+	};
+
+} // namespace PathEngine
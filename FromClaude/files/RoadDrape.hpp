@@ -0,0 +1,55 @@
+// RoadDrape.hpp — тела дороги (Morph) вдоль осевой RoadHelper::SetCenterLine:
+// покрытие по рельефу (отметки кромок с Mesh из SetTerrainMesh) и коридор
+// по шаблону поперечного профиля; земляные работы (откосы до рельефа);
+// Morph из точек с выноской площади; допуск подгонки сплайновых кромок.
+#pragma once
+
+#include "RoadHelper.hpp"
+#include "Corridor.hpp"
+#include "Earthworks.hpp"
+
+namespace RoadHelper {
+
+	// Площади граней Morph по материалам (м²) и объём (м³, 0 без толщины)
+	struct MorphMeasure {
+		double topArea = 0.0;
+		double bottomArea = 0.0;
+		double sideArea = 0.0;
+		double volume = 0.0;
+	};
+
+	struct DrapeParams {
+		double             thicknessMM = 0.0;      // толщина покрытия (0 — только верх)
+		double             smoothLengthMM = 0.0;   // окно сглаживания продольного профиля (0 — без)
+		double             zOffsetMM = 0.0;        // подъём над рельефом
+		API_AttributeIndex materialTop;
+		API_AttributeIndex materialBottom;
+		API_AttributeIndex materialSide;
+	};
+
+	// Ось (SetCenterLine) + ширина/шаг из params: кромки, отметки с Mesh одним
+	// пакетом, сглаживание, Morph — всё одной командой Undo.
+	bool BuildDrapedRoad(const RoadParams& params, const DrapeParams& drape);
+
+	// Профиль tpl вдоль оси одним телом Morph (полосы со своими материалами),
+	// одной командой Undo. maxStepMM — наибольший шаг станций (0 — только
+	// концы сегментов и допуск хорды на дугах).
+	bool BuildCorridor(const Corridor::Template& tpl, double maxStepMM);
+
+	// Откосы от крайних точек tpl до рельефа (SetTerrainMesh) по пикетам оси:
+	// линии нулевых работ слева/справа и текст с объёмами выемки/насыпи —
+	// одной командой Undo. params.baseZ задаётся по этажу оси.
+	bool BuildEarthworks(const Corridor::Template& tpl, const Earthworks::Params& params);
+
+	// Допуск подгонки сплайновых кромок BuildRoad (мм): отклонение кривой от
+	// точек отбора; 0 — узел сплайна в каждой точке отбора. По умолчанию 2 мм.
+	void SetEdgeFitTolerance(double tolMM);
+
+	// Morph из точек (как CreateMorphFromPoints) и текст с площадью верха
+	// (и объёмом) в labelPos — одной командой Undo. Площадь и объём считаются
+	// при построении тела.
+	bool CreateMorphWithAreaLabel(const GS::Array<API_Coord3D>& points, double thicknessMM,
+		API_AttributeIndex materialTop, API_AttributeIndex materialBottom, API_AttributeIndex materialSide,
+		const API_Coord& labelPos, MorphMeasure* outMeasure = nullptr);
+
+} // namespace RoadHelper
@@ -3,6 +3,16 @@
 #include "BrowserRepl.hpp"
 #include "GroundHelper.hpp"
 #include "ShellHelper.hpp"
+#include "PathEngine.hpp"
+#include "OffsetCurve.hpp"
+#include "MorphBody.hpp"
+#include "TerrainSampler.hpp"
+#include "Corridor.hpp"
+#include "RoadDrape.hpp"
+#include "Earthworks.hpp"
+#include "AttributeCache.hpp"
+#include "ElementBatch.hpp"
+#include "CurveFit.hpp"
 
 #include "APIEnvir.h"
 #include "ACAPinc.h"
@@ -16,6 +26,12 @@
 #include <algorithm>
 #include <cstring>
 #include <cstdio>
+#include <memory>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#endif
 
 namespace RoadHelper {
 
@@ -29,6 +45,9 @@ namespace RoadHelper {
     static API_Guid g_terrainMeshGuid = APINULLGuid;
     static short    g_refFloor = 0;
 
+    // допуск подгонки сплайновых кромок (м); 0 — узел в каждой точке отбора
+    static double   g_edgeFitTolM = 0.002;
+
     // ----------------------------------------------------------------------------
     // лог
     // ----------------------------------------------------------------------------
@@ -124,634 +143,254 @@ namespace RoadHelper {
     // Вспомогательная геометрия 2D для одной осевой
     // ============================================================================
 
-    // Структуры для работы с сегментами пути (скопировано из LandscapeHelper)
-    struct Seg {
-        enum Kind { Line, Arc } kind;
-        API_Coord a{}, b{};   // Line
-        API_Coord c{};        // Arc: center
-        double    r = 0.0;
-        double    a0 = 0.0;   // start angle
-        double    a1 = 0.0;   // end angle (a1 - a0 = signed sweep)
-        double    L = 0.0;   // length
-    };
-
-    // Вспомогательные функции для работы с сегментами
-    static inline double Dist(const API_Coord& p, const API_Coord& q) {
-        return std::hypot(q.x - p.x, q.y - p.y);
-    }
-    static inline API_Coord Lerp(const API_Coord& p, const API_Coord& q, double t) {
-        return { p.x + (q.x - p.x) * t, p.y + (q.y - p.y) * t };
-    }
-    static inline void PushLine(std::vector<Seg>& segs, const API_Coord& a, const API_Coord& b) {
-        Seg s; s.kind = Seg::Line; s.a = a; s.b = b; s.L = Dist(a, b);
-        if (s.L > 1e-9) segs.push_back(s);
-    }
-    static inline double Norm2PI(double a) {
-        const double two = 2.0 * kPI;
-        while (a < 0.0)   a += two;
-        while (a >= two)  a -= two;
-        return a;
-    }
-    static inline double CCWDelta(double a0, double a1) {
-        a0 = Norm2PI(a0); a1 = Norm2PI(a1);
-        double d = a1 - a0; if (d < 0.0) d += 2.0 * kPI;
-        return d; // [0,2pi)
-    }
-
-    // Безье для сплайна
-    static inline API_Coord Add(const API_Coord& a, const API_Coord& b) { return { a.x + b.x, a.y + b.y }; }
-    static inline API_Coord Sub(const API_Coord& a, const API_Coord& b) { return { a.x - b.x, a.y - b.y }; }
-    static inline API_Coord Mul(const API_Coord& a, double s) { return { a.x * s,   a.y * s }; }
-    static inline API_Coord FromAngLen(double ang, double len) { return { std::cos(ang) * len, std::sin(ang) * len }; }
-    static inline API_Coord BezierPoint(const API_Coord& P0, const API_Coord& C1,
-        const API_Coord& C2, const API_Coord& P3, double t)
-    {
-        const double u = 1.0 - t;
-        const double b0 = u * u * u, b1 = 3 * u * u * t, b2 = 3 * u * t * t, b3 = t * t * t;
-        return { b0 * P0.x + b1 * C1.x + b2 * C2.x + b3 * P3.x,
-                 b0 * P0.y + b1 * C1.y + b2 * C2.y + b3 * P3.y };
-    }
+    // Сегменты пути и параметризация по длине — общий PathEngine (см. PathEngine.hpp),
+    // кромки дороги — точный сдвиг этих сегментов (см. OffsetCurve.hpp)
+    using PathEngine::CompiledPath;
+    using PathEngine::Seg;
 
-    // Сборка сегментов пути из элемента
-    static bool BuildPathSegments(const API_Guid& pathGuid, std::vector<Seg>& segs, double* totalLen)
+    // Замкнутость пути: конец последнего сегмента совпадает с началом первого (1 мм)
+    static bool IsPathClosed(const std::vector<Seg>& segs)
     {
-        segs.clear();
-        if (totalLen) *totalLen = 0.0;
-
-        API_Element e = {}; e.header.guid = pathGuid;
-        if (ACAPI_Element_Get(&e) != NoError) return false;
-
-        switch (e.header.type.typeID) {
-        case API_LineID:
-            PushLine(segs, e.line.begC, e.line.endC);
-            break;
-
-        case API_ArcID: {
-            Seg s; s.kind = Seg::Arc; s.c = e.arc.origC; s.r = e.arc.r;
-            double a0 = Norm2PI(e.arc.begAng);
-            double sweep = e.arc.endAng - a0;
-            while (sweep <= -2.0 * kPI) sweep += 2.0 * kPI;
-            while (sweep > 2.0 * kPI) sweep -= 2.0 * kPI;
-            s.a0 = a0; s.a1 = a0 + sweep; s.L = s.r * std::fabs(sweep);
-            if (s.L > 1e-9) segs.push_back(s);
-            break;
-        }
-
-        case API_CircleID: {
-            Seg s; s.kind = Seg::Arc; s.c = e.circle.origC; s.r = e.circle.r;
-            s.a0 = 0.0; s.a1 = 2.0 * kPI; s.L = 2.0 * kPI * s.r;
-            segs.push_back(s);
-            break;
-        }
-
-        case API_PolyLineID: {
-            API_ElementMemo memo = {};
-            if (ACAPI_Element_GetMemo(pathGuid, &memo) == NoError && memo.coords != nullptr) {
-                const Int32 nAll = (Int32)(BMGetHandleSize((GSHandle)memo.coords) / sizeof(API_Coord));
-                const Int32 nPts = std::max<Int32>(0, nAll - 1);
-                if (nPts >= 2) {
-                    for (Int32 i = 1; i <= nPts - 1; ++i) {
-                        const API_Coord& A = (*memo.coords)[i];
-                        const API_Coord& B = (*memo.coords)[i + 1];
-                        PushLine(segs, A, B);
-                    }
-                }
-            }
-            ACAPI_DisposeElemMemoHdls(&memo);
-            break;
-        }
-
-        case API_SplineID: {
-            // Кубические Безье по bezierDirs
-            API_ElementMemo memo = {};
-            if (ACAPI_Element_GetMemo(pathGuid, &memo, APIMemoMask_Polygon) == NoError &&
-                memo.coords != nullptr && memo.bezierDirs != nullptr)
-            {
-                const Int32 n = (Int32)(BMGetHandleSize((GSHandle)memo.coords) / sizeof(API_Coord));
-                if (n >= 2) {
-                    for (Int32 i = 0; i < n - 1; ++i) {
-                        const API_Coord P0 = (*memo.coords)[i];
-                        const API_Coord P3 = (*memo.coords)[i + 1];
-                        const API_SplineDir d0 = (*memo.bezierDirs)[i];
-                        const API_SplineDir d1 = (*memo.bezierDirs)[i + 1];
-                        const API_Coord C1 = Add(P0, FromAngLen(d0.dirAng, d0.lenNext));
-                        const API_Coord C2 = Sub(P3, FromAngLen(d1.dirAng, d1.lenPrev));
-
-                        const int N = 32; // сабсегментов на ребро
-                        API_Coord prev = P0;
-                        for (int k = 1; k <= N; ++k) {
-                            const double t = (double)k / (double)N;
-                            const API_Coord pt = BezierPoint(P0, C1, C2, P3, t);
-                            PushLine(segs, prev, pt);
-                            prev = pt;
-                        }
-                    }
-                }
-            }
-            ACAPI_DisposeElemMemoHdls(&memo);
-            break;
-        }
-
-        default: return false;
-        }
-
         if (segs.empty()) return false;
+        const API_Coord a = OffsetCurve::SegStart(segs.front());
+        const API_Coord b = OffsetCurve::SegEnd(segs.back());
+        const double dist = std::hypot(b.x - a.x, b.y - a.y);
 
-        double sum = 0.0; for (const Seg& s : segs) sum += s.L;
-        if (totalLen) *totalLen = sum;
-
-        Log("[RoadHelper] path len=%.3f, segs=%u", sum, (unsigned)segs.size());
-        return sum > 1e-9;
+        const bool isClosed = (dist <= 0.001);
+        Log("[RoadHelper] Проверка замкнутости: dist=%.3fмм, closed=%s", dist * 1000.0, isClosed ? "ДА" : "НЕТ");
+        return isClosed;
     }
 
-    // Параметризация по длине s
-    static void EvalOnPath(const std::vector<Seg>& segs, double s, API_Coord* outP, double* outTanAngleRad)
+    // ============================================================================
+    // создание линий в модели
+    // ============================================================================
+
+    // Описания линий копятся в ElementBatch::Batch и создаются вызывающим одной
+    // командой Undo; умолчания типа запрашиваются пакетом один раз.
+
+    void SetEdgeFitTolerance(double tolMM)
     {
-        double acc = 0.0;
-        for (const Seg& seg : segs) {
-            if (s > acc + seg.L) { acc += seg.L; continue; }
-            const double f = (seg.L < 1e-9) ? 0.0 : (s - acc) / seg.L;
-
-            if (seg.kind == Seg::Line) {
-                if (outP)           *outP = Lerp(seg.a, seg.b, f);
-                if (outTanAngleRad) *outTanAngleRad = std::atan2(seg.b.y - seg.a.y, seg.b.x - seg.a.x);
-            }
-            else {
-                const double sweep = seg.a1 - seg.a0;                 // со знаком!
-                const double ang = seg.a0 + f * sweep;
-                if (outP)           *outP = { seg.c.x + seg.r * std::cos(ang), seg.c.y + seg.r * std::sin(ang) };
-                if (outTanAngleRad) *outTanAngleRad = ang + ((sweep >= 0.0) ? +kPI / 2.0 : -kPI / 2.0);
-            }
-            return;
-        }
-        const Seg& seg = segs.back();
-        if (seg.kind == Seg::Line) {
-            if (outP)           *outP = seg.b;
-            if (outTanAngleRad) *outTanAngleRad = std::atan2(seg.b.y - seg.a.y, seg.b.x - seg.a.x);
-        }
-        else {
-            const double sweep = seg.a1 - seg.a0;
-            if (outP)           *outP = { seg.c.x + seg.r * std::cos(seg.a1), seg.c.y + seg.r * std::sin(seg.a1) };
-            if (outTanAngleRad) *outTanAngleRad = seg.a1 + ((sweep >= 0.0) ? +kPI / 2.0 : -kPI / 2.0);
-        }
+        g_edgeFitTolM = std::max(0.0, tolMM) / 1000.0;
     }
 
-    // 1) Собираем список XY-точек оси как ломаную
-    //    Для дуг генерируем точки по окружности
-    static bool CollectAxisPoints2D(const API_Guid& guid, GS::Array<API_Coord>& outPts)
+    // Сплайн по списку 2D-точек. С допуском g_edgeFitTolM точки приближаются
+    // кусочными кубиками Безье (CurveFit) — узлов в десятки раз меньше, чем
+    // точек отбора. Без допуска — узел в каждой точке: направления по соседним
+    // точкам (Catmull-Rom), длины ручек — треть соседних хорд.
+    static bool AddSplineFromPts(ElementBatch::Batch& batch, const GS::Array<API_Coord>& pts, bool closed, const char* tag)
     {
-        outPts.Clear();
-
-        API_Element el = {};
-        el.header.guid = guid;
-        if (ACAPI_Element_Get(&el) != NoError) {
-            Log("[RoadHelper] CollectAxisPoints2D: не смогли прочитать элемент оси");
-            return false;
+        std::vector<API_Coord>     fitCoords;
+        std::vector<API_SplineDir> fitDirs;
+        bool fitted = false;
+        if (g_edgeFitTolM > 0.0 && !pts.IsEmpty()) {
+            CurveFit::Stats st;
+            fitted = CurveFit::FitSpline(&pts[0], pts.GetSize(), g_edgeFitTolM, closed, fitCoords, fitDirs, &st);
+            if (fitted)
+                Log("[RoadHelper] Spline fit (%s): точек=%u -> узлов=%u, допуск=%.1fмм, откл=%.2fмм, уточнений=%u",
+                    tag, st.inPoints, st.knots, g_edgeFitTolM * 1000.0, st.maxErrM * 1000.0, st.reparams);
         }
 
-        switch (el.header.type.typeID) {
-        case API_LineID: {
-            outPts.Push(el.line.begC);
-            outPts.Push(el.line.endC);
-            break;
-        }
+        const UInt32 n = fitted ? (UInt32)fitCoords.size() : pts.GetSize();
+        if (n < 2)
+            return false;
 
-        case API_ArcID: {
-            // Для дуги генерируем точки по окружности
-            const API_Coord center = el.arc.origC;
-            const double radius = el.arc.r;
-            const double startAngle = el.arc.begAng;
-            const double endAngle = el.arc.endAng;
-            
-            // Вычисляем количество точек для дуги (минимум 8, максимум 64)
-            double sweep = endAngle - startAngle;
-            while (sweep <= -2.0 * kPI) sweep += 2.0 * kPI;
-            while (sweep > 2.0 * kPI) sweep -= 2.0 * kPI;
-            
-            const double absSweep = std::abs(sweep);
-            const int numPoints = std::max(8, std::min(64, (int)(absSweep * 16.0 / kPI)));
-            
-            for (int i = 0; i <= numPoints; ++i) {
-                const double t = (double)i / (double)numPoints;
-                const double angle = startAngle + t * sweep;
-                const API_Coord pt = {
-                    center.x + radius * std::cos(angle),
-                    center.y + radius * std::sin(angle)
-                };
-                outPts.Push(pt);
-            }
-            
-            Log("[RoadHelper] CollectAxisPoints2D: сгенерировано %u точек для дуги", (unsigned)outPts.GetSize());
-            break;
+        ElementBatch::Spec* spec = batch.Add(API_SplineID, tag);
+        if (spec == nullptr) {
+            Log("[RoadHelper] Spline FAILED (%s): нет умолчаний", tag);
+            return false;
         }
-
-        case API_CircleID: {
-            // Для круга генерируем точки по окружности
-            const API_Coord center = el.circle.origC;
-            const double radius = el.circle.r;
-            
-            const int numPoints = 32; // фиксированное количество точек для круга
-            for (int i = 0; i < numPoints; ++i) {
-                const double angle = 2.0 * kPI * (double)i / (double)numPoints;
-                const API_Coord pt = {
-                    center.x + radius * std::cos(angle),
-                    center.y + radius * std::sin(angle)
-                };
-                outPts.Push(pt);
-            }
-            
-            Log("[RoadHelper] CollectAxisPoints2D: сгенерировано %u точек для круга", (unsigned)outPts.GetSize());
-            break;
+        spec->element.header.floorInd = g_refFloor;
+        spec->element.spline.autoSmooth = false;
+        spec->element.spline.closed = false;
+
+        API_ElementMemo& memo = spec->memo;
+        memo.coords = batch.GetArena().Alloc<API_Coord>(n);
+        memo.bezierDirs = batch.GetArena().Alloc<API_SplineDir>(n);
+        spec->hasMemo = true;
+        if (memo.coords == nullptr || memo.bezierDirs == nullptr) {
+            Log("[RoadHelper] Spline FAILED (%s): нет памяти", tag);
+            return false;
         }
 
-        case API_PolyLineID:
-        case API_SplineID: {
-            API_ElementMemo memo = {};
-            if (ACAPI_Element_GetMemo(guid, &memo, APIMemoMask_Polygon) == NoError &&
-                memo.coords != nullptr)
-            {
-                const Int32 nAll = (Int32)(BMGetHandleSize((GSHandle)memo.coords) / sizeof(API_Coord));
-                const Int32 nPts = std::max<Int32>(0, nAll - 1);
-                for (Int32 i = 1; i <= nPts; ++i) { // coords[0] сторож
-                    outPts.Push((*memo.coords)[i]);
-                }
-            }
-            ACAPI_DisposeElemMemoHdls(&memo);
-            break;
+        if (fitted) {
+            std::copy(fitCoords.begin(), fitCoords.end(), *memo.coords);
+            std::copy(fitDirs.begin(), fitDirs.end(), *memo.bezierDirs);
+            return true;
         }
 
-        default:
-            Log("[RoadHelper] CollectAxisPoints2D: неподдерживаемый тип");
-            return false;
+        for (UInt32 k = 0; k < n; ++k) {
+            const API_Coord& p = pts[k];
+            const API_Coord& prev = pts[k > 0 ? k - 1 : k];
+            const API_Coord& next = pts[k + 1 < n ? k + 1 : k];
+            (*memo.coords)[k] = p;
+            API_SplineDir& d = (*memo.bezierDirs)[k];
+            d.lenPrev = std::hypot(p.x - prev.x, p.y - prev.y) / 3.0;
+            d.lenNext = std::hypot(next.x - p.x, next.y - p.y) / 3.0;
+            d.dirAng = std::atan2(next.y - prev.y, next.x - prev.x);
         }
+        return true;
+    }
 
-        if (outPts.GetSize() < 2) {
-            Log("[RoadHelper] CollectAxisPoints2D: мало точек");
-            outPts.Clear();
+    // Прямая линия между двумя точками
+    static bool AddLine2D(ElementBatch::Batch& batch, const API_Coord& a, const API_Coord& b, const char* tag)
+    {
+        ElementBatch::Spec* spec = batch.Add(API_LineID, tag);
+        if (spec == nullptr) {
+            Log("[RoadHelper] Line FAILED (%s): нет умолчаний", tag);
             return false;
         }
-
+        spec->element.header.floorInd = g_refFloor;
+        spec->element.line.begC = a;
+        spec->element.line.endC = b;
         return true;
     }
 
-    // Проверка замкнутости линии (сравнение начальной и конечной точек с точностью 1мм)
-    static bool IsLineClosed(const GS::Array<API_Coord>& pts)
+    // Полилиния из цепочки отрезков/дуг: дуги уходят в parcs как есть (arcAngle),
+    // без разбиения на точки. Дуги больше 180° делим пополам — polyline их не хранит.
+    // Вершины пишутся прямо в handle из пула пакета.
+    static bool AddPolyLineFromSegs(ElementBatch::Batch& batch, const std::vector<Seg>& segs, const char* tag)
     {
-        if (pts.GetSize() < 3) return false; // минимум 3 точки для замкнутой линии
-        
-        const API_Coord& first = pts[0];
-        const API_Coord& last = pts[pts.GetSize() - 1];
-        
-        const double tolerance = 1.0; // 1мм
-        const double dx = last.x - first.x;
-        const double dy = last.y - first.y;
-        const double dist = std::sqrt(dx * dx + dy * dy);
-        
-        bool isClosed = (dist <= tolerance);
-        Log("[RoadHelper] Проверка замкнутости: dist=%.3fмм, closed=%s", dist, isClosed ? "ДА" : "НЕТ");
-        
-        return isClosed;
-    }
+        if (segs.empty())
+            return false;
 
-    // 2) Вычисляем нормаль в точке i по соседним сегментам
-    static void ComputePerpAtIndex(
-        const GS::Array<API_Coord>& axis,
-        UIndex i,
-        double& nx,
-        double& ny
-    ) {
-        // Берём направление касательной как разницу между соседними точками
-        UIndex i0 = (i == 0) ? 0 : i - 1;
-        UIndex i1 = (i + 1 < axis.GetSize()) ? i + 1 : i;
-
-        const API_Coord& A = axis[i0];
-        const API_Coord& B = axis[i1];
-
-        double vx = B.x - A.x;
-        double vy = B.y - A.y;
-        double len = std::sqrt(vx * vx + vy * vy);
-        if (len < kEPS) {
-            nx = 0.0;
-            ny = 0.0;
-            return;
+        auto IsHalved = [](const Seg& s) { return s.kind == Seg::Arc && std::fabs(s.a1 - s.a0) > kPI; };
+        Int32 nParts = 0, nArcs = 0;
+        for (const Seg& s : segs) {
+            const Int32 k = IsHalved(s) ? 2 : 1;
+            nParts += k;
+            if (s.kind == Seg::Arc) nArcs += k;
         }
+        const Int32 nCoords = nParts + 1;
 
-        // нормализованная касательная
-        vx /= len;
-        vy /= len;
-
-        // влево от направления (перпендикуляр)
-        nx = -vy;
-        ny = vx;
-    }
-
-    // 3) Строим левую и правую кромку просто сдвигом по этому перпендикуляру
-    static void OffsetSides(
-        const GS::Array<API_Coord>& axis,
-        double halfWidthM,
-        GS::Array<API_Coord>& leftSide,
-        GS::Array<API_Coord>& rightSide
-    ) {
-        leftSide.Clear();
-        rightSide.Clear();
-
-        for (UIndex i = 0; i < axis.GetSize(); ++i) {
-            double nx = 0.0, ny = 0.0;
-            ComputePerpAtIndex(axis, i, nx, ny);
-
-            API_Coord L{ axis[i].x + nx * halfWidthM,
-                          axis[i].y + ny * halfWidthM };
-            API_Coord R{ axis[i].x - nx * halfWidthM,
-                          axis[i].y - ny * halfWidthM };
-
-            leftSide.Push(L);
-            rightSide.Push(R);
+        ElementBatch::Spec* spec = batch.Add(API_PolyLineID, tag);
+        if (spec == nullptr) {
+            Log("[RoadHelper] PolyLine FAILED (%s): нет умолчаний", tag);
+            return false;
         }
-    }
-
-    // ============================================================================
-    // создание линий в модели
-    // ============================================================================
-
-    // Сплайн по списку 2D-точек
-    static API_Guid CreateSplineFromPts(const GS::Array<API_Coord>& pts)
-    {
-        if (pts.GetSize() < 2)
-            return APINULLGuid;
-
-        // мы используем ShellHelper::CreateSplineFromPoints
-        return ShellHelper::CreateSplineFromPoints(pts);
-    }
-
-    // Прямая линия между двумя точками
-    static bool CreateSimpleLine2D(const API_Coord& a, const API_Coord& b, const char* tag)
-    {
-        API_Element lineEl = {};
-        lineEl.header.type = API_LineID;
-        if (ACAPI_Element_GetDefaults(&lineEl, nullptr) != NoError)
+        API_Element& el = spec->element;
+        el.header.floorInd = g_refFloor;
+        el.polyLine.poly.nCoords = nCoords;
+        el.polyLine.poly.nSubPolys = 1;
+        el.polyLine.poly.nArcs = nArcs;
+
+        MemoArena::Arena& arena = batch.GetArena();
+        API_ElementMemo& memo = spec->memo;
+        memo.coords = arena.Alloc<API_Coord>(nCoords + 1);
+        memo.pends = arena.Alloc<Int32>(2);
+        if (nArcs > 0)
+            memo.parcs = arena.Alloc<API_PolyArc>(nArcs);
+        spec->hasMemo = true;
+        if (memo.coords == nullptr || memo.pends == nullptr || (nArcs > 0 && memo.parcs == nullptr)) {
+            Log("[RoadHelper] PolyLine FAILED (%s): нет памяти", tag);
             return false;
+        }
 
-        lineEl.header.floorInd = g_refFloor;
-        lineEl.line.begC = a;
-        lineEl.line.endC = b;
-
-        const GSErrCode e = ACAPI_CallUndoableCommand("Create Road Line", [&]() -> GSErrCode {
-            return ACAPI_Element_Create(&lineEl, nullptr);
-            });
-
-        if (e == NoError) {
-            Log("[RoadHelper] Line created (%s)", tag);
-            return true;
+        // coords[0] — сторож, вершины с 1
+        API_Coord* coords = *memo.coords;
+        coords[0] = { 0.0, 0.0 };
+        coords[1] = OffsetCurve::SegStart(segs.front());
+        Int32 k = 1, iArc = 0;
+        auto PutArc = [&](const API_Coord& end, double sweep) {
+            coords[++k] = end;
+            (*memo.parcs)[iArc].begIndex = k - 1;
+            (*memo.parcs)[iArc].endIndex = k;
+            (*memo.parcs)[iArc].arcAngle = sweep;
+            ++iArc;
+        };
+        for (const Seg& s : segs) {
+            if (s.kind == Seg::Line) {
+                coords[++k] = s.b;
+                continue;
+            }
+            const double sweep = s.a1 - s.a0;
+            if (IsHalved(s)) {
+                const double am = s.a0 + 0.5 * sweep;
+                PutArc({ s.c.x + s.r * std::cos(am), s.c.y + s.r * std::sin(am) }, 0.5 * sweep);
+                PutArc(OffsetCurve::SegEnd(s), 0.5 * sweep);
+            }
+            else {
+                PutArc(OffsetCurve::SegEnd(s), sweep);
+            }
         }
+        (*memo.pends)[0] = 0;
+        (*memo.pends)[1] = nCoords;
 
-        Log("[RoadHelper] Line FAILED (%s): err=%d", tag, (int)e);
-        return false;
+        Log("[RoadHelper] PolyLine (%s): вершин=%d, дуг=%d", tag, (int)nCoords, (int)nArcs);
+        return true;
     }
 
     // ============================================================================
     // главная команда
     // ============================================================================
 
-    // Функция откладывания точек по spline с заданным расстоянием
-    static bool SamplePointsAlongSpline(const API_Guid& splineGuid, double stepMM, GS::Array<API_Coord>& outPts)
+    // Точки по сдвинутой цепочке с заданным шагом (для кромок сплайна)
+    static bool SampleSegsByStep(std::vector<Seg>&& segs, double stepMM, GS::Array<API_Coord>& outPts)
     {
         outPts.Clear();
-        
-        std::vector<Seg> segs;
-        double totalLen = 0.0;
-        
-        if (!BuildPathSegments(splineGuid, segs, &totalLen)) {
-            Log("[RoadHelper] ERROR: не удалось построить сегменты пути");
+
+        CompiledPath path;
+        if (!path.Assign(std::move(segs)))
             return false;
-        }
-        
-        if (totalLen < 1e-6) {
-            Log("[RoadHelper] ERROR: путь слишком короткий");
+
+        const double totalLen = path.GetLength();
+        if (totalLen < 1e-6)
             return false;
-        }
-        
+
         const double stepM = stepMM / 1000.0; // мм -> м
         const double epsilon = 1e-6;
-        
-        // Откладываем точки с заданным шагом
-        for (double s = 0.0; s <= totalLen + epsilon; s += stepM) {
-            const double clampedS = std::min(s, totalLen);
+
+        // s растёт монотонно — курсор идёт по сегментам вперёд
+        const UInt32 nSteps = (UInt32)(totalLen / stepM) + 2;
+        outPts.SetCapacity(nSteps + 1);
+        CompiledPath::Cursor cursor(path);
+        for (UInt32 k = 0; ; ++k) {
+            const double s = k * stepM;
+            if (s > totalLen - epsilon) break;
             API_Coord pt;
-            EvalOnPath(segs, clampedS, &pt, nullptr);
+            cursor.Eval(s, &pt, nullptr);
             outPts.Push(pt);
         }
-        
+
         // Обязательно добавляем последнюю точку
         API_Coord lastPt;
-        EvalOnPath(segs, totalLen, &lastPt, nullptr);
+        cursor.Eval(totalLen, &lastPt, nullptr);
         outPts.Push(lastPt);
-        
-        Log("[RoadHelper] Отложено %u точек по spline (шаг=%.1fмм, длина=%.3fм)", 
-            (unsigned)outPts.GetSize(), stepMM, totalLen);
-        
-        return outPts.GetSize() >= 2;
-    }
 
-    // Копирование элемента с перемещением по вектору используя ACAPI_Element_Edit
-    static API_Guid CopyElementWithOffset(const API_Guid& sourceGuid, double offsetX, double offsetY)
-    {
-        // Получаем информацию об элементе для определения правильного neigID
-        API_Element sourceEl = {};
-        sourceEl.header.guid = sourceGuid;
-        if (ACAPI_Element_Get(&sourceEl) != NoError) {
-            Log("[RoadHelper] ERROR: не удалось прочитать исходный элемент");
-            return APINULLGuid;
-        }
-
-        // Создаем массив с одним элементом для редактирования
-        GS::Array<API_Neig> items;
-        API_Neig neig;
-        neig.guid = sourceGuid;
-        
-        // Определяем правильный neigID в зависимости от типа элемента
-        switch (sourceEl.header.type.typeID) {
-        case API_LineID:
-            neig.neigID = APINeig_Line;
-            break;
-        case API_ArcID:
-            neig.neigID = APINeig_Arc;
-            break;
-        case API_CircleID:
-            neig.neigID = APINeig_Circ;
-            break;
-        case API_PolyLineID:
-            neig.neigID = APINeig_PolyLine;
-            break;
-        case API_SplineID:
-            neig.neigID = APINeig_Spline;
-            break;
-        default:
-            Log("[RoadHelper] ERROR: неподдерживаемый тип элемента для копирования");
-            return APINULLGuid;
-        }
-        
-        items.Push(neig);
-
-        // Параметры редактирования для копирования с перемещением
-        API_EditPars editPars = {};
-        editPars.typeID = APIEdit_Drag;
-        editPars.withDelete = false; // не удаляем оригинал
-        editPars.begC.x = 0.0;
-        editPars.begC.y = 0.0;
-        editPars.begC.z = 0.0;
-        editPars.endC.x = offsetX;
-        editPars.endC.y = offsetY;
-        editPars.endC.z = 0.0;
-
-        // Выполняем редактирование (копирование с перемещением)
-        const GSErrCode err = ACAPI_Element_Edit(&items, editPars);
-        if (err == NoError && !items.IsEmpty()) {
-            API_Guid newGuid = items[0].guid;
-            Log("[RoadHelper] Копия создана: %s", APIGuidToString(newGuid).ToCStr().Get());
-            return newGuid;
-        } else {
-            Log("[RoadHelper] ERROR: не удалось создать копию через Edit, err=%d", (int)err);
-            return APINULLGuid;
-        }
+        return outPts.GetSize() >= 2;
     }
 
-    // Универсальный алгоритм для всех типов линий кроме spline
-    static bool BuildUniversalRoad(const API_Guid& sourceGuid, double halfWidthM, API_Guid& leftGuid, API_Guid& rightGuid)
+    // Ось (g_centerLineGuid) как цепочка отрезков/дуг и обе кромки — точный сдвиг
+    // оси на ±halfWidth: скругление на внешних изломах, подрезка и удаление петель
+    // на внутренних. Общая часть BuildRoad и BuildDrapedRoad.
+    static bool BuildEdgeChains(double halfWidthM, CompiledPath& center,
+                                std::vector<Seg>& leftSegs, std::vector<Seg>& rightSegs, bool& isClosed)
     {
-        // Получаем точки исходной линии для определения направления
-        GS::Array<API_Coord> centerPts;
-        if (!CollectAxisPoints2D(sourceGuid, centerPts)) {
-            Log("[RoadHelper] ERROR: не удалось прочитать точки линии");
-            return false;
-        }
-
-        if (centerPts.GetSize() < 2) {
-            Log("[RoadHelper] ERROR: недостаточно точек для универсального алгоритма");
+        PathEngine::PathStats pathStats;
+        if (!center.Build(g_centerLineGuid, PathEngine::kDefaultChordTolM, &pathStats)) {
+            Log("[RoadHelper] ERROR: не удалось построить сегменты пути");
             return false;
         }
+        Log("[RoadHelper] path len=%.3f, segs=%u", center.GetLength(), (unsigned)center.GetSegmentCount());
 
-        // Проверяем замкнутость
-        bool isClosed = IsLineClosed(centerPts);
-        Log("[RoadHelper] Универсальный алгоритм: %s линия, точек=%u", 
-            isClosed ? "замкнутая" : "открытая", (unsigned)centerPts.GetSize());
-
-        // Для дуг и кругов используем специальный алгоритм с построением перпендикуляров
-        API_Element el = {};
-        el.header.guid = sourceGuid;
-        if (ACAPI_Element_Get(&el) == NoError && 
-            (el.header.type.typeID == API_ArcID || el.header.type.typeID == API_CircleID)) {
-            
-            // Используем алгоритм с перпендикулярами для дуг
-            GS::Array<API_Coord> leftPts, rightPts;
-            if (!BuildPerpendicularPoints(centerPts, halfWidthM, leftPts, rightPts)) {
-                Log("[RoadHelper] ERROR: не удалось построить перпендикуляры для дуги");
-                return false;
-            }
-            
-            // Создаем сплайны из точек
-            leftGuid = CreateSplineFromPts(leftPts);
-            rightGuid = CreateSplineFromPts(rightPts);
-            
-            if (leftGuid == APINULLGuid || rightGuid == APINULLGuid) {
-                Log("[RoadHelper] ERROR: не удалось создать сплайны для дуги");
-                return false;
-            }
-            
-            Log("[RoadHelper] Универсальный алгоритм: созданы сплайны для дуги L=%s R=%s (ширина=%.3fм)", 
-                APIGuidToString(leftGuid).ToCStr().Get(),
-                APIGuidToString(rightGuid).ToCStr().Get(),
-                halfWidthM * 2.0);
-            
-            return true;
-        }
-
-        // Для остальных типов линий используем копирование с смещением
-        // Определяем направление перпендикуляра
-        double nx = 0.0, ny = 0.0;
-        
-        if (isClosed) {
-            // Для замкнутых линий используем направление от первой точки
-            ComputePerpAtIndex(centerPts, 0, nx, ny);
-        } else {
-            // Для открытых линий используем направление от начала к концу
-            const API_Coord& start = centerPts[0];
-            const API_Coord& end = centerPts[centerPts.GetSize() - 1];
-            
-            double dx = end.x - start.x;
-            double dy = end.y - start.y;
-            double len = std::sqrt(dx * dx + dy * dy);
-            
-            if (len < kEPS) {
-                Log("[RoadHelper] ERROR: линия слишком короткая");
-                return false;
-            }
-            
-            // Перпендикуляр (поворот на 90 градусов)
-            nx = -dy / len;
-            ny = dx / len;
-        }
-
-        // Создаем две копии с смещением по перпендикуляру в undoable команде
-        const double leftOffsetX = nx * halfWidthM;
-        const double leftOffsetY = ny * halfWidthM;
-        const double rightOffsetX = -nx * halfWidthM;
-        const double rightOffsetY = -ny * halfWidthM;
+        isClosed = IsPathClosed(center.GetSegments());
 
-        GSErrCode err = ACAPI_CallUndoableCommand("Copy Road Lines", [&]() -> GSErrCode {
-            leftGuid = CopyElementWithOffset(sourceGuid, leftOffsetX, leftOffsetY);
-            rightGuid = CopyElementWithOffset(sourceGuid, rightOffsetX, rightOffsetY);
-            
-            if (leftGuid == APINULLGuid || rightGuid == APINULLGuid) {
-                Log("[RoadHelper] ERROR: не удалось создать копии линии");
-                return APIERR_GENERAL;
-            }
-            
-            return NoError;
-        });
+        OffsetCurve::Options opt;
+        opt.join = OffsetCurve::JoinType::Round;
+        opt.closed = isClosed;
 
-        if (err != NoError) {
-            Log("[RoadHelper] ERROR: не удалось выполнить команду копирования, err=%d", (int)err);
+        OffsetCurve::Stats stL, stR;
+        if (!OffsetCurve::Offset(center.GetSegments(), halfWidthM, opt, leftSegs, &stL) ||
+            !OffsetCurve::Offset(center.GetSegments(), -halfWidthM, opt, rightSegs, &stR)) {
+            Log("[RoadHelper] ERROR: кромка выродилась (ширина больше радиусов оси?)");
             return false;
         }
-
-        Log("[RoadHelper] Универсальный алгоритм: созданы копии L=%s R=%s (ширина=%.3fм)", 
-            APIGuidToString(leftGuid).ToCStr().Get(),
-            APIGuidToString(rightGuid).ToCStr().Get(),
-            halfWidthM * 2.0);
-
+        Log("[RoadHelper] offset L: segs=%u round=%u miter=%u inner=%u collapsed=%u loops=%u",
+            (unsigned)leftSegs.size(), stL.joinsRound, stL.joinsMiter, stL.joinsInner, stL.collapsedArcs, stL.loopsRemoved);
+        Log("[RoadHelper] offset R: segs=%u round=%u miter=%u inner=%u collapsed=%u loops=%u",
+            (unsigned)rightSegs.size(), stR.joinsRound, stR.joinsMiter, stR.joinsInner, stR.collapsedArcs, stR.loopsRemoved);
         return true;
     }
 
-    // Функция построения перпендикуляров для получения двух рядов точек
-    bool BuildPerpendicularPoints(const GS::Array<API_Coord>& centerPts, double halfWidthM, 
-                                 GS::Array<API_Coord>& leftPts, GS::Array<API_Coord>& rightPts)
-    {
-        leftPts.Clear();
-        rightPts.Clear();
-        
-        if (centerPts.GetSize() < 2) {
-            Log("[RoadHelper] ERROR: недостаточно точек для построения перпендикуляров");
-            return false;
-        }
-        
-        for (UIndex i = 0; i < centerPts.GetSize(); ++i) {
-            double nx = 0.0, ny = 0.0;
-            ComputePerpAtIndex(centerPts, i, nx, ny);
-            
-            const API_Coord& center = centerPts[i];
-            API_Coord left{ center.x + nx * halfWidthM, center.y + ny * halfWidthM };
-            API_Coord right{ center.x - nx * halfWidthM, center.y - ny * halfWidthM };
-            
-            leftPts.Push(left);
-            rightPts.Push(right);
-        }
-        
-        Log("[RoadHelper] Построено %u перпендикуляров (ширина=%.3fм)", 
-            (unsigned)leftPts.GetSize(), halfWidthM * 2.0);
-        
-        return leftPts.GetSize() >= 2 && rightPts.GetSize() >= 2;
-    }
-
     bool BuildRoad(const RoadParams& params)
     {
         Log("[RoadHelper] >>> BuildRoad: width=%.1fмм, step=%.1fмм",
@@ -778,81 +417,70 @@ namespace RoadHelper {
             Log("[RoadHelper] ERROR: не удалось прочитать элемент");
             return false;
         }
+        const bool isSpline = (el.header.type.typeID == API_SplineID);
+        if (isSpline && params.sampleStepMM <= 0.0) {
+            Log("[RoadHelper] ERROR: для spline нужен шаг > 0");
+            return false;
+        }
 
         const double halfWidthM = (params.widthMM / 1000.0) * 0.5; // мм -> м/2
-        GS::Array<API_Coord> leftPts;
-        GS::Array<API_Coord> rightPts;
-        bool success = false;
-
-        // Выбираем алгоритм в зависимости от типа линии
-        API_Guid leftGuid = APINULLGuid;
-        API_Guid rightGuid = APINULLGuid;
-        
-        if (el.header.type.typeID == API_SplineID) {
-            // Для spline используем старый алгоритм с откладыванием точек
-            if (params.sampleStepMM <= 0.0) {
-                Log("[RoadHelper] ERROR: для spline нужен шаг > 0");
-                return false;
-            }
 
-            GS::Array<API_Coord> centerPts;
-            if (!SamplePointsAlongSpline(g_centerLineGuid, params.sampleStepMM, centerPts)) {
-                Log("[RoadHelper] ERROR: не удалось отложить точки по spline");
-                return false;
-            }
+        CompiledPath center;
+        std::vector<Seg> leftSegs, rightSegs;
+        bool isClosed = false;
+        if (!BuildEdgeChains(halfWidthM, center, leftSegs, rightSegs, isClosed))
+            return false;
 
+        // Точки кап — до того как сегменты уйдут в создание элементов
+        const API_Coord capA0 = OffsetCurve::SegStart(leftSegs.front());
+        const API_Coord capB0 = OffsetCurve::SegStart(rightSegs.front());
+        const API_Coord capA1 = OffsetCurve::SegEnd(leftSegs.back());
+        const API_Coord capB1 = OffsetCurve::SegEnd(rightSegs.back());
+
+        // Кромки и капы — одним пакетом, одной командой Undo
+        ElementBatch::Batch batch;
+        bool edgesOk = false;
+        if (isSpline) {
+            // Для spline кромки остаются сплайнами: точки по сдвинутой цепочке с шагом
             GS::Array<API_Coord> leftPts, rightPts;
-            success = BuildPerpendicularPoints(centerPts, halfWidthM, leftPts, rightPts);
-            if (success) {
-                leftGuid = CreateSplineFromPts(leftPts);
-                rightGuid = CreateSplineFromPts(rightPts);
-            }
+            edgesOk = SampleSegsByStep(std::move(leftSegs), params.sampleStepMM, leftPts) &&
+                      SampleSegsByStep(std::move(rightSegs), params.sampleStepMM, rightPts) &&
+                      AddSplineFromPts(batch, leftPts, isClosed, "left") &&
+                      AddSplineFromPts(batch, rightPts, isClosed, "right");
             Log("[RoadHelper] Использован алгоритм для spline");
         } else {
-            // Для всех остальных типов линий используем универсальный алгоритм с копированием
-            success = BuildUniversalRoad(g_centerLineGuid, halfWidthM, leftGuid, rightGuid);
-            Log("[RoadHelper] Использован универсальный алгоритм с копированием");
+            // Линия/дуга/окружность/полилиния — кромки полилиниями с точными дугами
+            edgesOk = AddPolyLineFromSegs(batch, leftSegs, "left") &&
+                      AddPolyLineFromSegs(batch, rightSegs, "right");
+            Log("[RoadHelper] Использован точный сдвиг (полилинии с дугами)");
         }
 
-        if (!success || leftGuid == APINULLGuid || rightGuid == APINULLGuid) {
-            Log("[RoadHelper] ERROR: не удалось создать боковые линии");
+        if (!edgesOk) {
+            Log("[RoadHelper] ERROR: не удалось подготовить боковые линии");
             return false;
         }
 
-        Log("[RoadHelper] боковые линии ок: L=%s  R=%s",
-            APIGuidToString(leftGuid).ToCStr().Get(),
-            APIGuidToString(rightGuid).ToCStr().Get());
-
         // Замыкаем начало и концы прямыми линиями (только для открытых линий)
-        // Получаем точки для проверки замкнутости
-        GS::Array<API_Coord> centerPts;
-        if (CollectAxisPoints2D(g_centerLineGuid, centerPts)) {
-            bool isClosed = IsLineClosed(centerPts);
-            if (!isClosed) {
-                // Для открытых линий создаем замыкающие линии
-                // Получаем точки боковых линий
-                GS::Array<API_Coord> leftPts, rightPts;
-                if (CollectAxisPoints2D(leftGuid, leftPts) && CollectAxisPoints2D(rightGuid, rightPts)) {
-                    if (leftPts.GetSize() >= 2 && rightPts.GetSize() >= 2) {
-                        const UIndex last = leftPts.GetSize() - 1;
-                        const API_Coord capA0 = leftPts[0];
-                        const API_Coord capB0 = rightPts[0];
-                        const API_Coord capA1 = leftPts[last];
-                        const API_Coord capB1 = rightPts[last];
-
-                        bool ok1 = CreateSimpleLine2D(capA0, capB0, "start cap");
-                        bool ok2 = CreateSimpleLine2D(capA1, capB1, "end cap");
-
-                        if (!ok1 || !ok2) {
-                            Log("[RoadHelper] WARNING: не смогли сделать капы");
-                        }
-                    }
-                }
-            } else {
-                Log("[RoadHelper] Замкнутая линия - капы не нужны");
-            }
+        if (!isClosed) {
+            if (!AddLine2D(batch, capA0, capB0, "start cap") || !AddLine2D(batch, capA1, capB1, "end cap"))
+                Log("[RoadHelper] WARNING: не смогли сделать капы");
+        } else {
+            Log("[RoadHelper] Замкнутая линия - капы не нужны");
+        }
+
+        const UInt32 defaultsCalls = batch.GetDefaultsCalls();
+        std::vector<API_Guid> guids;
+        UInt32 created = 0;
+        if (!batch.Commit("Build Road", &guids, &created) || guids[0] == APINULLGuid || guids[1] == APINULLGuid) {
+            Log("[RoadHelper] ERROR: не удалось создать боковые линии");
+            return false;
         }
 
+        Log("[RoadHelper] боковые линии ок: L=%s  R=%s; элементов=%u из %u, GetDefaults=%u",
+            APIGuidToString(guids[0]).ToCStr().Get(),
+            APIGuidToString(guids[1]).ToCStr().Get(),
+            (unsigned)created, (unsigned)guids.size(), (unsigned)defaultsCalls);
+
         Log("[RoadHelper] ✅ ГОТОВО: создали контур дороги");
         return true;
     }
@@ -861,11 +489,74 @@ namespace RoadHelper {
     // Перенесено из MeshHelper: функции создания Morph (НЕ создают mesh!)
     // ============================================================================
     
+    // Morph-элемент по умолчанию; тело задаётся относительно ref (tranmat — перенос)
+    static bool PrepareMorphElement(API_Element& element, const API_Coord3D& ref, bool onRefFloor)
+    {
+        element = {};
+        element.header.type = API_MorphID;
+        
+        GSErrCode err = ACAPI_Element_GetDefaults(&element, nullptr);
+        if (err != NoError) {
+            Log("[RoadHelper] ERROR: ACAPI_Element_GetDefaults failed, err=%d", (int)err);
+            return false;
+        }
+        
+        if (onRefFloor)
+            element.header.floorInd = g_refFloor;
+        
+        Log("[RoadHelper] Morph defaults obtained, floorInd=%d", (int)element.header.floorInd);
+        
+        // Setup transformation matrix
+        double* tmx = element.morph.tranmat.tmx;
+        tmx[ 0] = 1.0;  tmx[ 4] = 0.0;  tmx[ 8] = 0.0;
+        tmx[ 1] = 0.0;  tmx[ 5] = 1.0;  tmx[ 9] = 0.0;
+        tmx[ 2] = 0.0;  tmx[ 6] = 0.0;  tmx[10] = 1.0;
+        tmx[ 3] = ref.x;  tmx[ 7] = ref.y;  tmx[11] = ref.z;
+        return true;
+    }
+    
+    // Завершение тела из builder и создание Morph (вызывать внутри Undo-команды)
+    static bool CreateMorphFromBody(API_Element& element, MorphBody::Builder& body)
+    {
+        // Finish body and copy to memo
+        API_ElementMemo memo = {};
+        BNZeroMemory(&memo, sizeof(API_ElementMemo));
+        
+        if (!body.Finish(memo)) {
+            Log("[RoadHelper] ERROR: ACAPI_Body_Finish failed");
+            ACAPI_DisposeElemMemoHdls(&memo);
+            return false;
+        }
+        
+        const MorphBody::Stats& bodyStats = body.GetStats();
+        Log("[RoadHelper] Body: треугольников=%u -> многоугольников=%u, edges=%u (ссылок из граней %u), normals=%u",
+            (unsigned)bodyStats.faces, (unsigned)bodyStats.polygons, (unsigned)bodyStats.edges,
+            (unsigned)bodyStats.edgeRefs, (unsigned)bodyStats.normals);
+        Log("[RoadHelper] Body: площадь=%.3f м2, объём=%.3f м3", body.GetArea(), body.GetVolume());
+        
+        Log("[RoadHelper] Body finished, creating Morph element...");
+        
+        // Create Morph element
+        GSErrCode createErr = ACAPI_Element_Create(&element, &memo);
+        
+        Log("[RoadHelper] ACAPI_Element_Create returned err=%d", (int)createErr);
+        ACAPI_DisposeElemMemoHdls(&memo);
+        
+        if (createErr != NoError) {
+            Log("[RoadHelper] ERROR: Failed to create Morph, err=%d", (int)createErr);
+            return false;
+        }
+        return true;
+    }
+    
     // Внутренняя реализация создания Morph из точек (без Undo-обертки)
     // thicknessMM: толщина в мм (0 = плоский, только верхняя поверхность)
     // materialTop, materialBottom, materialSide: индексы материалов для граней
+    // onRefFloor: Morph на этаже осевой (g_refFloor), Z точек — от уровня этого этажа
+    // outMeasure: площади верха/низа/бортов и объём — из builder, без второго прохода
     static bool CreateMorphFromPointsInternal(const GS::Array<API_Coord3D>& points, double thicknessMM,
-                                              API_AttributeIndex materialTop, API_AttributeIndex materialBottom, API_AttributeIndex materialSide)
+                                              API_AttributeIndex materialTop, API_AttributeIndex materialBottom, API_AttributeIndex materialSide,
+                                              bool onRefFloor = false, MorphMeasure* outMeasure = nullptr)
     {
         const UIndex numPoints = points.GetSize();
         const double thickness = thicknessMM / 1000.0; // convert to meters
@@ -881,34 +572,18 @@ namespace RoadHelper {
         const double refY = points[0].y;
         const double refZ = points[0].z;
         
-        // Create Morph element
+        // Create Morph element (defaults, floor, tranmat with reference point)
         API_Element element = {};
-        element.header.type = API_MorphID;
-        
-        GSErrCode err = ACAPI_Element_GetDefaults(&element, nullptr);
-        if (err != NoError) {
-            Log("[RoadHelper] ERROR: ACAPI_Element_GetDefaults failed, err=%d", (int)err);
+        if (!PrepareMorphElement(element, { refX, refY, refZ }, onRefFloor))
             return false;
-        }
-        
-        Log("[RoadHelper] Morph defaults obtained, floorInd=%d", (int)element.header.floorInd);
         
         // Use all points to create Morph with real Z coordinates from mesh
         Log("[RoadHelper] Creating Morph from %d points with varying Z coordinates (refZ=%.3f m)", (int)numPoints, refZ);
         
-        // Setup transformation matrix
-        double* tmx = element.morph.tranmat.tmx;
-        tmx[ 0] = 1.0;  tmx[ 4] = 0.0;  tmx[ 8] = 0.0;
-        tmx[ 1] = 0.0;  tmx[ 5] = 1.0;  tmx[ 9] = 0.0;
-        tmx[ 2] = 0.0;  tmx[ 6] = 0.0;  tmx[10] = 1.0;
-        // Use first point as reference for positioning (including Z)
-        tmx[ 3] = refX;  tmx[ 7] = refY;  tmx[11] = refZ;
-        
-        // Create body structure via ACAPI_Body_Create
-        void* bodyData = nullptr;
-        GSErrCode bodyErr = ACAPI_Body_Create(nullptr, nullptr, &bodyData);
-        if (bodyErr != NoError || bodyData == nullptr) {
-            Log("[RoadHelper] ERROR: ACAPI_Body_Create failed, err=%d", (int)bodyErr);
+        // Тело с общей топологией: рёбра и нормали без дублей (см. MorphBody.hpp)
+        MorphBody::Builder body;
+        if (!body.Begin()) {
+            Log("[RoadHelper] ERROR: ACAPI_Body_Create failed");
             return false;
         }
         
@@ -919,48 +594,34 @@ namespace RoadHelper {
         const UIndex totalVertices = hasThickness ? (numPoints * 2) : numPoints;
         
         // Add vertices (relative to reference point, including Z)
+        // vertexIndices: 0..n-1 — верх, n..2n-1 — низ
         GS::Array<UInt32> vertexIndices;
         vertexIndices.SetSize(totalVertices);
         
-        // Add top vertices (always)
         for (UIndex i = 0; i < numPoints; ++i) {
-            // Coordinates relative to first point (including Z)
-            API_Coord3D coord = {
+            const API_Coord3D coord = {
                 points[i].x - refX,
                 points[i].y - refY,
                 points[i].z - refZ  // Z relative to reference Z from mesh
             };
-            
-            UInt32 vertexIndex;
-            GSErrCode vertErr = ACAPI_Body_AddVertex(bodyData, coord, vertexIndex);
-            if (vertErr != NoError) {
-                Log("[RoadHelper] ERROR: ACAPI_Body_AddVertex failed for top vertex %d, err=%d", (int)i, (int)vertErr);
-                ACAPI_Body_Dispose(&bodyData);
+            if (!body.AddVertex(coord, vertexIndices[i])) {
+                Log("[RoadHelper] ERROR: ACAPI_Body_AddVertex failed for top vertex %d", (int)i);
                 return false;
             }
-            vertexIndices[i] = vertexIndex;
-            // Не логируем каждый vertex для производительности - только ошибки
         }
         
-        // Add bottom vertices if thickness > 0
         if (hasThickness) {
             for (UIndex i = 0; i < numPoints; ++i) {
                 // Bottom vertices: same XY, but Z shifted down by thickness
-                API_Coord3D coord = {
+                const API_Coord3D coord = {
                     points[i].x - refX,
                     points[i].y - refY,
-                    points[i].z - refZ - thickness  // Z shifted down
+                    points[i].z - refZ - thickness
                 };
-                
-                UInt32 vertexIndex;
-                GSErrCode vertErr = ACAPI_Body_AddVertex(bodyData, coord, vertexIndex);
-                if (vertErr != NoError) {
-                    Log("[RoadHelper] ERROR: ACAPI_Body_AddVertex failed for bottom vertex %d, err=%d", (int)i, (int)vertErr);
-                    ACAPI_Body_Dispose(&bodyData);
+                if (!body.AddVertex(coord, vertexIndices[numPoints + i])) {
+                    Log("[RoadHelper] ERROR: ACAPI_Body_AddVertex failed for bottom vertex %d", (int)i);
                     return false;
                 }
-                vertexIndices[numPoints + i] = vertexIndex;
-                // Не логируем каждый vertex для производительности - только ошибки
             }
             Log("[RoadHelper] Added %d top vertices and %d bottom vertices (total: %d)", 
                 (int)numPoints, (int)numPoints, (int)totalVertices);
@@ -968,8 +629,6 @@ namespace RoadHelper {
             Log("[RoadHelper] Added %d top vertices (flat surface)", (int)numPoints);
         }
         
-        Log("[RoadHelper] Vertices added, creating edges and triangulating...");
-        
         // The points are arranged as: left contour (0..n/2-1), then right contour in reverse (n/2..n-1)
         // Triangulation scheme: for each segment i:
         //   Triangle 1: L_i, R_i, L_{i+1}
@@ -981,16 +640,6 @@ namespace RoadHelper {
         Log("[RoadHelper] Triangulating %d points (%d left + %d right) into %d triangles (2 per segment)", 
             (int)numPoints, (int)numLeftPoints, (int)numLeftPoints, (int)numTriangles);
         
-        // Add polygon normal - we'll compute it per triangle
-        Int32 polyNormalIndex;
-        API_Vector3D normal = {0.0, 0.0, 1.0}; // default normal
-        GSErrCode normErr = ACAPI_Body_AddPolyNormal(bodyData, normal, polyNormalIndex);
-        if (normErr != NoError) {
-            Log("[RoadHelper] ERROR: ACAPI_Body_AddPolyNormal failed, err=%d", (int)normErr);
-            ACAPI_Body_Dispose(&bodyData);
-            return false;
-        }
-        
         // Materials for different faces (passed as parameters)
         API_OverriddenAttribute materialTopAttr;
         materialTopAttr = materialTop;
@@ -1001,342 +650,86 @@ namespace RoadHelper {
         API_OverriddenAttribute materialSideAttr;
         materialSideAttr = materialSide;
         
-        // Helper function to create a triangle (defined before use for both top and bottom surfaces)
-        // materialParam: material to use for this triangle
-        auto CreateTriangle = [&](UIndex v0, UIndex v1, UIndex v2, const API_Coord3D& p0_abs, const API_Coord3D& p1_abs, const API_Coord3D& p2_abs, int triNum, const API_OverriddenAttribute& materialParam) -> bool {
-                // Create edges for this triangle
-                Int32 edge01, edge12, edge20;
-                GSErrCode edgeErr;
-                
-                edgeErr = ACAPI_Body_AddEdge(bodyData, v0, v1, edge01);
-                if (edgeErr != NoError) {
-                    Log("[RoadHelper] ERROR: ACAPI_Body_AddEdge failed for triangle %d, edge %d-%d, err=%d", 
-                        triNum, (int)v0, (int)v1, (int)edgeErr);
-                    return false;
-                }
-                
-                edgeErr = ACAPI_Body_AddEdge(bodyData, v1, v2, edge12);
-                if (edgeErr != NoError) {
-                    Log("[RoadHelper] ERROR: ACAPI_Body_AddEdge failed for triangle %d, edge %d-%d, err=%d", 
-                        triNum, (int)v1, (int)v2, (int)edgeErr);
-                    return false;
-                }
-                
-                edgeErr = ACAPI_Body_AddEdge(bodyData, v2, v0, edge20);
-                if (edgeErr != NoError) {
-                    Log("[RoadHelper] ERROR: ACAPI_Body_AddEdge failed for triangle %d, edge %d-%d, err=%d", 
-                        triNum, (int)v2, (int)v0, (int)edgeErr);
-                    return false;
-                }
-                
-                // Compute normal for this triangle (from absolute coordinates)
-                API_Coord3D p0 = {p0_abs.x - refX, p0_abs.y - refY, p0_abs.z - refZ};
-                API_Coord3D p1 = {p1_abs.x - refX, p1_abs.y - refY, p1_abs.z - refZ};
-                API_Coord3D p2 = {p2_abs.x - refX, p2_abs.y - refY, p2_abs.z - refZ};
-                
-                // Compute cross product for normal
-                double v1x = p1.x - p0.x, v1y = p1.y - p0.y, v1z = p1.z - p0.z;
-                double v2x = p2.x - p0.x, v2y = p2.y - p0.y, v2z = p2.z - p0.z;
-                
-                API_Vector3D triNormal;
-                triNormal.x = v1y * v2z - v1z * v2y;
-                triNormal.y = v1z * v2x - v1x * v2z;
-                triNormal.z = v1x * v2y - v1y * v2x;
-                
-                // Normalize
-                double len = std::sqrt(triNormal.x * triNormal.x + triNormal.y * triNormal.y + triNormal.z * triNormal.z);
-                if (len > 1e-9) {
-                    triNormal.x /= len;
-                    triNormal.y /= len;
-                    triNormal.z /= len;
-                } else {
-                    triNormal = normal; // fallback to default
-                }
-                
-                // Add normal for this triangle
-                Int32 triNormalIndex;
-                GSErrCode normErr2 = ACAPI_Body_AddPolyNormal(bodyData, triNormal, triNormalIndex);
-                if (normErr2 != NoError) {
-                    triNormalIndex = polyNormalIndex; // fallback
-                }
-                
-                // Create polygon (triangle) from edges
-                GS::Array<Int32> triEdges;
-                triEdges.Push(edge01);
-                triEdges.Push(edge12);
-                triEdges.Push(edge20);
-                
-                // Material will be passed as parameter (top, bottom, or side)
-                // Default to top material for now, will be overridden in calls
-                UInt32 triPolyIndex;
-                GSErrCode polyErr = ACAPI_Body_AddPolygon(
-                    bodyData,
-                    triEdges,
-                    triNormalIndex,
-                    materialParam, // Use passed material
-                    triPolyIndex
-                );
-                
-                if (polyErr != NoError) {
-                    Log("[RoadHelper] ERROR: ACAPI_Body_AddPolygon failed for triangle %d, err=%d", 
-                        triNum, (int)polyErr);
-                    return false;
-                }
-                
+        // Слоты материалов: компланарные соседние треугольники одного слота
+        // builder сольёт в один многоугольник (плоское дно, прямые борта)
+        const UInt32 slotTop = body.AddMaterial(materialTopAttr);
+        const UInt32 slotBottom = body.AddMaterial(materialBottomAttr);
+        const UInt32 slotSide = body.AddMaterial(materialSideAttr);
+        
+        // Треугольник по индексам точек (верх: i, низ: numPoints + i)
+        auto AddTri = [&](UIndex a, UIndex b, UIndex c, UInt32 material) -> bool {
+            if (body.AddTriangle(vertexIndices[a], vertexIndices[b], vertexIndices[c], material))
                 return true;
+            Log("[RoadHelper] ERROR: не удалось добавить треугольник %d-%d-%d", (int)a, (int)b, (int)c);
+            return false;
         };
         
-        // Create triangles between left and right contours (top surface)
+        // Индексы левой/правой кромки на шаге i (правая — в обратном порядке)
+        auto Left  = [&](UIndex i) -> UIndex { return i; };
+        auto Right = [&](UIndex i) -> UIndex { return 2 * numLeftPoints - 1 - i; };
+        const UIndex bot = numPoints;
+        
+        // Top surface
         for (UIndex i = 0; i < numSegments; ++i) {
-            // Indices:
-            // L_i = i (left point i)
-            // L_{i+1} = i+1 (left point i+1)
-            // R_i = numLeftPoints + (numLeftPoints - 1 - i) = 2*numLeftPoints - 1 - i (right point i, in reverse order)
-            // R_{i+1} = 2*numLeftPoints - 1 - (i+1) = 2*numLeftPoints - 2 - i (right point i+1, in reverse order)
-            
-            UIndex left_i = i;
-            UIndex left_i1 = i + 1;
-            UIndex right_i = 2 * numLeftPoints - 1 - i;
-            UIndex right_i1 = 2 * numLeftPoints - 2 - i;
-            
-            // Triangle 1: L_i, R_i, L_{i+1}
-            UIndex v0_tri1 = vertexIndices[left_i];
-            UIndex v1_tri1 = vertexIndices[right_i];
-            UIndex v2_tri1 = vertexIndices[left_i1];
-            
-            // Triangle 2: L_{i+1}, R_i, R_{i+1}
-            UIndex v0_tri2 = vertexIndices[left_i1];
-            UIndex v1_tri2 = vertexIndices[right_i];
-            UIndex v2_tri2 = vertexIndices[right_i1];
-            
-            // Create Triangle 1: L_i, R_i, L_{i+1} (top surface)
-            if (!CreateTriangle(v0_tri1, v1_tri1, v2_tri1, 
-                                points[left_i], points[right_i], points[left_i1],
-                                (int)(i * 2), materialTopAttr)) {
-                ACAPI_Body_Dispose(&bodyData);
+            if (!AddTri(Left(i), Right(i), Left(i + 1), slotTop) ||
+                !AddTri(Left(i + 1), Right(i), Right(i + 1), slotTop))
                 return false;
-            }
-            
-            // Create Triangle 2: L_{i+1}, R_i, R_{i+1} (top surface)
-            if (!CreateTriangle(v0_tri2, v1_tri2, v2_tri2,
-                                points[left_i1], points[right_i], points[right_i1],
-                                (int)(i * 2 + 1), materialTopAttr)) {
-                ACAPI_Body_Dispose(&bodyData);
-                return false;
-            }
         }
         
-        Log("[RoadHelper] Top surface: %d triangles added", (int)numTriangles);
-        
-        // Create bottom surface if thickness > 0
         if (hasThickness) {
-            Log("[RoadHelper] Creating bottom surface...");
-            
-            // Bottom surface: same triangles but with bottom vertices and reversed order for correct normals
+            // Bottom surface: reversed order for downward normal
             for (UIndex i = 0; i < numSegments; ++i) {
-                UIndex left_i = i;
-                UIndex left_i1 = i + 1;
-                UIndex right_i = 2 * numLeftPoints - 1 - i;
-                UIndex right_i1 = 2 * numLeftPoints - 2 - i;
-                
-                // Bottom vertices indices (offset by numPoints)
-                UIndex bottom_left_i = numPoints + left_i;
-                UIndex bottom_left_i1 = numPoints + left_i1;
-                UIndex bottom_right_i = numPoints + right_i;
-                UIndex bottom_right_i1 = numPoints + right_i1;
-                
-                // Bottom Triangle 1: L_{i+1}, R_i, L_i (reversed order for downward normal)
-                API_Coord3D p0_bot = {points[left_i1].x - refX, points[left_i1].y - refY, points[left_i1].z - refZ - thickness};
-                API_Coord3D p1_bot = {points[right_i].x - refX, points[right_i].y - refY, points[right_i].z - refZ - thickness};
-                API_Coord3D p2_bot = {points[left_i].x - refX, points[left_i].y - refY, points[left_i].z - refZ - thickness};
-                
-                if (!CreateTriangle(vertexIndices[bottom_left_i1], vertexIndices[bottom_right_i], vertexIndices[bottom_left_i],
-                                    p0_bot, p1_bot, p2_bot, (int)(numTriangles + i * 2), materialBottomAttr)) {
-                    ACAPI_Body_Dispose(&bodyData);
-                    return false;
-                }
-                
-                // Bottom Triangle 2: R_{i+1}, R_i, L_{i+1} (reversed order)
-                API_Coord3D p3_bot = {points[right_i1].x - refX, points[right_i1].y - refY, points[right_i1].z - refZ - thickness};
-                
-                if (!CreateTriangle(vertexIndices[bottom_right_i1], vertexIndices[bottom_right_i], vertexIndices[bottom_left_i1],
-                                    p3_bot, p1_bot, p0_bot, (int)(numTriangles + i * 2 + 1), materialBottomAttr)) {
-                    ACAPI_Body_Dispose(&bodyData);
+                if (!AddTri(bot + Left(i + 1), bot + Right(i), bot + Left(i), slotBottom) ||
+                    !AddTri(bot + Right(i + 1), bot + Right(i), bot + Left(i + 1), slotBottom))
                     return false;
-                }
-            }
-            Log("[RoadHelper] Bottom surface: %d triangles added", (int)numTriangles);
-            
-            // Create side faces (left, right, front, back)
-            Log("[RoadHelper] Creating side faces...");
-            const UIndex numSideTriangles = numSegments * 4 + 4; // 2 per segment on each side + 2 for front + 2 for back
-            
-            // Left side faces (connecting left contour top to bottom)
-            for (UIndex i = 0; i < numSegments; ++i) {
-                UIndex left_i = i;
-                UIndex left_i1 = i + 1;
-                UIndex bottom_left_i = numPoints + left_i;
-                UIndex bottom_left_i1 = numPoints + left_i1;
-                
-                // Side triangle 1: L_i_top, L_i_bottom, L_{i+1}_bottom
-                API_Coord3D p_top = {points[left_i].x - refX, points[left_i].y - refY, points[left_i].z - refZ};
-                API_Coord3D p_bot = {points[left_i].x - refX, points[left_i].y - refY, points[left_i].z - refZ - thickness};
-                API_Coord3D p_bot_next = {points[left_i1].x - refX, points[left_i1].y - refY, points[left_i1].z - refZ - thickness};
-                
-                if (!CreateTriangle(vertexIndices[left_i], vertexIndices[bottom_left_i], vertexIndices[bottom_left_i1],
-                                    p_top, p_bot, p_bot_next, (int)(numTriangles * 2 + i * 2), materialSideAttr)) {
-                    ACAPI_Body_Dispose(&bodyData);
-                    return false;
-                }
-                
-                // Side triangle 2: L_i_top, L_{i+1}_bottom, L_{i+1}_top
-                API_Coord3D p_top_next = {points[left_i1].x - refX, points[left_i1].y - refY, points[left_i1].z - refZ};
-                
-                if (!CreateTriangle(vertexIndices[left_i], vertexIndices[bottom_left_i1], vertexIndices[left_i1],
-                                    p_top, p_bot_next, p_top_next, (int)(numTriangles * 2 + i * 2 + 1), materialSideAttr)) {
-                    ACAPI_Body_Dispose(&bodyData);
-                    return false;
-                }
             }
             
-            // Right side faces (connecting right contour top to bottom, in reverse order)
+            // Left and right side faces (обход — нормаль наружу: левый борт зеркален правому)
             for (UIndex i = 0; i < numSegments; ++i) {
-                UIndex right_i = 2 * numLeftPoints - 1 - i;
-                UIndex right_i1 = 2 * numLeftPoints - 2 - i;
-                UIndex bottom_right_i = numPoints + right_i;
-                UIndex bottom_right_i1 = numPoints + right_i1;
-                
-                // Side triangle 1: R_i_top, R_i_bottom, R_{i+1}_bottom - material 3
-                API_Coord3D p_top = {points[right_i].x - refX, points[right_i].y - refY, points[right_i].z - refZ};
-                API_Coord3D p_bot = {points[right_i].x - refX, points[right_i].y - refY, points[right_i].z - refZ - thickness};
-                API_Coord3D p_bot_next = {points[right_i1].x - refX, points[right_i1].y - refY, points[right_i1].z - refZ - thickness};
-                
-                if (!CreateTriangle(vertexIndices[right_i], vertexIndices[bottom_right_i], vertexIndices[bottom_right_i1],
-                                    p_top, p_bot, p_bot_next, (int)(numTriangles * 2 + numSegments * 2 + i * 2), materialSideAttr)) {
-                    ACAPI_Body_Dispose(&bodyData);
+                if (!AddTri(Left(i), bot + Left(i + 1), bot + Left(i), slotSide) ||
+                    !AddTri(Left(i), Left(i + 1), bot + Left(i + 1), slotSide) ||
+                    !AddTri(Right(i), bot + Right(i), bot + Right(i + 1), slotSide) ||
+                    !AddTri(Right(i), bot + Right(i + 1), Right(i + 1), slotSide))
                     return false;
-                }
-                
-                // Side triangle 2: R_i_top, R_{i+1}_bottom, R_{i+1}_top
-                API_Coord3D p_top_next = {points[right_i1].x - refX, points[right_i1].y - refY, points[right_i1].z - refZ};
-                
-                if (!CreateTriangle(vertexIndices[right_i], vertexIndices[bottom_right_i1], vertexIndices[right_i1],
-                                    p_top, p_bot_next, p_top_next, (int)(numTriangles * 2 + numSegments * 2 + i * 2 + 1), materialSideAttr)) {
-                    ACAPI_Body_Dispose(&bodyData);
-                    return false;
-                }
-            }
-            
-            // Front side (connecting first left and first right points)
-            UIndex left_first = 0;
-            UIndex right_first = 2 * numLeftPoints - 1;
-            UIndex bottom_left_first = numPoints + left_first;
-            UIndex bottom_right_first = numPoints + right_first;
-            
-            // Front triangle 1: L_0_top, L_0_bottom, R_0_bottom - material 3
-            API_Coord3D p_left_top = {points[left_first].x - refX, points[left_first].y - refY, points[left_first].z - refZ};
-            API_Coord3D p_left_bot = {points[left_first].x - refX, points[left_first].y - refY, points[left_first].z - refZ - thickness};
-            API_Coord3D p_right_bot = {points[right_first].x - refX, points[right_first].y - refY, points[right_first].z - refZ - thickness};
-            
-            if (!CreateTriangle(vertexIndices[left_first], vertexIndices[bottom_left_first], vertexIndices[bottom_right_first],
-                                p_left_top, p_left_bot, p_right_bot, (int)(numTriangles * 2 + numSegments * 4), materialSideAttr)) {
-                ACAPI_Body_Dispose(&bodyData);
-                return false;
             }
             
-            // Front triangle 2: L_0_top, R_0_bottom, R_0_top
-            API_Coord3D p_right_top = {points[right_first].x - refX, points[right_first].y - refY, points[right_first].z - refZ};
-            
-            if (!CreateTriangle(vertexIndices[left_first], vertexIndices[bottom_right_first], vertexIndices[right_first],
-                                p_left_top, p_right_bot, p_right_top, (int)(numTriangles * 2 + numSegments * 4 + 1), materialSideAttr)) {
-                ACAPI_Body_Dispose(&bodyData);
+            // Front (first left/right points) and back (last left/right points)
+            const UIndex lf = Left(0), rf = Right(0);
+            const UIndex ll = Left(numLeftPoints - 1), rl = Right(numLeftPoints - 1);
+            if (!AddTri(lf, bot + lf, bot + rf, slotSide) ||
+                !AddTri(lf, bot + rf, rf, slotSide) ||
+                !AddTri(ll, bot + rl, bot + ll, slotSide) ||
+                !AddTri(ll, rl, bot + rl, slotSide))
                 return false;
-            }
-            
-            // Back side (connecting last left and last right points)
-            UIndex left_last = numLeftPoints - 1;
-            UIndex right_last = numLeftPoints; // first point of right contour in our array
-            UIndex bottom_left_last = numPoints + left_last;
-            UIndex bottom_right_last = numPoints + right_last;
-            
-            // Back triangle 1: L_last_top, L_last_bottom, R_last_bottom - material 3
-            API_Coord3D p_left_top_back = {points[left_last].x - refX, points[left_last].y - refY, points[left_last].z - refZ};
-            API_Coord3D p_left_bot_back = {points[left_last].x - refX, points[left_last].y - refY, points[left_last].z - refZ - thickness};
-            API_Coord3D p_right_bot_back = {points[right_last].x - refX, points[right_last].y - refY, points[right_last].z - refZ - thickness};
-            
-            if (!CreateTriangle(vertexIndices[left_last], vertexIndices[bottom_left_last], vertexIndices[bottom_right_last],
-                                p_left_top_back, p_left_bot_back, p_right_bot_back, (int)(numTriangles * 2 + numSegments * 4 + 2), materialSideAttr)) {
-                ACAPI_Body_Dispose(&bodyData);
-                return false;
-            }
-            
-            // Back triangle 2: L_last_top, R_last_bottom, R_last_top
-            API_Coord3D p_right_top_back = {points[right_last].x - refX, points[right_last].y - refY, points[right_last].z - refZ};
-            
-            if (!CreateTriangle(vertexIndices[left_last], vertexIndices[bottom_right_last], vertexIndices[right_last],
-                                p_left_top_back, p_right_bot_back, p_right_top_back, (int)(numTriangles * 2 + numSegments * 4 + 3), materialSideAttr)) {
-                ACAPI_Body_Dispose(&bodyData);
-                return false;
-            }
-            
-            Log("[RoadHelper] Side faces: %d triangles added (left: %d, right: %d, front: 2, back: 2)", 
-                (int)numSideTriangles, (int)(numSegments * 2), (int)(numSegments * 2));
         }
         
         const UIndex totalTriangles = hasThickness ? (numTriangles * 2 + numSegments * 4 + 4) : numTriangles;
         Log("[RoadHelper] Total %d triangles added, finishing body...", (int)totalTriangles);
         
-        // Finish body and copy to memo
-        API_ElementMemo memo = {};
-        BNZeroMemory(&memo, sizeof(API_ElementMemo));
-        
-        GSErrCode finishErr = ACAPI_Body_Finish(bodyData, &memo.morphBody, &memo.morphMaterialMapTable);
-        ACAPI_Body_Dispose(&bodyData);
-        
-        if (finishErr != NoError) {
-            Log("[RoadHelper] ERROR: ACAPI_Body_Finish failed, err=%d", (int)finishErr);
-            ACAPI_DisposeElemMemoHdls(&memo);
-            return false;
+        if (outMeasure != nullptr) {
+            outMeasure->topArea = body.GetSlotArea(slotTop);
+            outMeasure->bottomArea = body.GetSlotArea(slotBottom);
+            outMeasure->sideArea = body.GetSlotArea(slotSide);
+            outMeasure->volume = hasThickness ? body.GetVolume() : 0.0;
         }
         
-        Log("[RoadHelper] Body finished, creating Morph element...");
-        
-        // Create Morph element
-        GSErrCode createErr = ACAPI_Element_Create(&element, &memo);
-        
-        Log("[RoadHelper] ACAPI_Element_Create returned err=%d", (int)createErr);
-        
-        if (createErr != NoError) {
-            Log("[RoadHelper] ERROR: Failed to create Morph, err=%d", (int)createErr);
-            ACAPI_DisposeElemMemoHdls(&memo);
+        if (!CreateMorphFromBody(element, body))
             return false;
-        }
-            
-        ACAPI_DisposeElemMemoHdls(&memo);
         
         Log("[RoadHelper] SUCCESS: Morph created from %d points with varying Z coordinates (refZ=%.3f m)", 
             (int)numPoints, refZ);
         return true;
     }
     
-    // Вычисление площади 3D треугольника через векторное произведение
-    static double CalculateTriangleArea3D(const API_Coord3D& a, const API_Coord3D& b, const API_Coord3D& c)
-    {
-        // Векторы от a к b и от a к c
-        double v1x = b.x - a.x, v1y = b.y - a.y, v1z = b.z - a.z;
-        double v2x = c.x - a.x, v2y = c.y - a.y, v2z = c.z - a.z;
-        
-        // Векторное произведение v1 × v2
-        double crossX = v1y * v2z - v1z * v2y;
-        double crossY = v1z * v2x - v1x * v2z;
-        double crossZ = v1x * v2y - v1y * v2x;
-        
-        // Длина вектора = площадь параллелограмма, делим на 2 для площади треугольника
-        double area = 0.5 * std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ);
-        return area;
-    }
+    // Вычисление площади верхней поверхности Morph (без создания тела).
+    // Точки сначала раскладываются по отдельным массивам x/y/z (SoA): левая
+    // кромка по порядку, правая — в обратном, так что полоса i — это индексы
+    // i и i+1 в обоих. На x64 полосы идут по kAreaLanes за итерацию: два
+    // регистра SSE2 по две полосы, загрузки подряд, sqrt — _mm_sqrt_pd.
+    // Автовекторизации sqrt здесь не ждём: без -fno-math-errno компиляторы
+    // оставляют скалярный вызов. Хвост и прочие платформы — скалярно.
+    static constexpr UIndex kAreaLanes = 4;
     
-    // Вычисление площади верхней поверхности Morph
     double CalculateMorphSurfaceArea(const GS::Array<API_Coord3D>& points)
     {
         const UIndex numPoints = points.GetSize();
@@ -1345,53 +738,98 @@ namespace RoadHelper {
             return 0.0;
         }
         
-        // Схема триангуляции та же, что при создании Morph
+        // Схема триангуляции та же, что при создании Morph:
+        //   L_i, R_i, L_{i+1}  и  L_{i+1}, R_i, R_{i+1}
         const UIndex numLeftPoints = numPoints / 2;
         const UIndex numSegments = numLeftPoints - 1;
         
+        std::vector<double> soa(6 * (size_t)numLeftPoints);
+        double* lx = soa.data();
+        double* ly = lx + numLeftPoints;
+        double* lz = ly + numLeftPoints;
+        double* rx = lz + numLeftPoints;
+        double* ry = rx + numLeftPoints;
+        double* rz = ry + numLeftPoints;
+        for (UIndex j = 0; j < numLeftPoints; ++j) {
+            const API_Coord3D& l = points[j];
+            const API_Coord3D& r = points[2 * numLeftPoints - 1 - j];
+            lx[j] = l.x; ly[j] = l.y; lz[j] = l.z;
+            rx[j] = r.x; ry[j] = r.y; rz[j] = r.z;
+        }
+        
+        UIndex i = 0;
         double totalArea = 0.0;
         
-        for (UIndex i = 0; i < numSegments; ++i) {
-            UIndex left_i = i;
-            UIndex left_i1 = i + 1;
-            UIndex right_i = 2 * numLeftPoints - 1 - i;
-            UIndex right_i1 = 2 * numLeftPoints - 2 - i;
+#if defined(_M_X64) || defined(__x86_64__)
+        // Удвоенная площадь пар треугольников полос i, i+1
+        auto stripArea2x2 = [&](UIndex s) -> __m128d {
+            const __m128d l0x = _mm_loadu_pd(lx + s), l1x = _mm_loadu_pd(lx + s + 1);
+            const __m128d l0y = _mm_loadu_pd(ly + s), l1y = _mm_loadu_pd(ly + s + 1);
+            const __m128d l0z = _mm_loadu_pd(lz + s), l1z = _mm_loadu_pd(lz + s + 1);
+            const __m128d r0x = _mm_loadu_pd(rx + s), r1x = _mm_loadu_pd(rx + s + 1);
+            const __m128d r0y = _mm_loadu_pd(ry + s), r1y = _mm_loadu_pd(ry + s + 1);
+            const __m128d r0z = _mm_loadu_pd(rz + s), r1z = _mm_loadu_pd(rz + s + 1);
             
-            // Triangle 1: L_i, R_i, L_{i+1}
-            double area1 = CalculateTriangleArea3D(
-                points[left_i],
-                points[right_i],
-                points[left_i1]
-            );
+            // треугольник 1: (R_i - L_i) x (L_{i+1} - L_i)
+            const __m128d ax = _mm_sub_pd(r0x, l0x), ay = _mm_sub_pd(r0y, l0y), az = _mm_sub_pd(r0z, l0z);
+            const __m128d bx = _mm_sub_pd(l1x, l0x), by = _mm_sub_pd(l1y, l0y), bz = _mm_sub_pd(l1z, l0z);
+            const __m128d c1x = _mm_sub_pd(_mm_mul_pd(ay, bz), _mm_mul_pd(az, by));
+            const __m128d c1y = _mm_sub_pd(_mm_mul_pd(az, bx), _mm_mul_pd(ax, bz));
+            const __m128d c1z = _mm_sub_pd(_mm_mul_pd(ax, by), _mm_mul_pd(ay, bx));
             
-            // Triangle 2: L_{i+1}, R_i, R_{i+1}
-            double area2 = CalculateTriangleArea3D(
-                points[left_i1],
-                points[right_i],
-                points[right_i1]
-            );
+            // треугольник 2: (R_i - L_{i+1}) x (R_{i+1} - L_{i+1})
+            const __m128d dx = _mm_sub_pd(r0x, l1x), dy = _mm_sub_pd(r0y, l1y), dz = _mm_sub_pd(r0z, l1z);
+            const __m128d ex = _mm_sub_pd(r1x, l1x), ey = _mm_sub_pd(r1y, l1y), ez = _mm_sub_pd(r1z, l1z);
+            const __m128d c2x = _mm_sub_pd(_mm_mul_pd(dy, ez), _mm_mul_pd(dz, ey));
+            const __m128d c2y = _mm_sub_pd(_mm_mul_pd(dz, ex), _mm_mul_pd(dx, ez));
+            const __m128d c2z = _mm_sub_pd(_mm_mul_pd(dx, ey), _mm_mul_pd(dy, ex));
             
-            totalArea += area1 + area2;
+            const __m128d n1 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(c1x, c1x), _mm_mul_pd(c1y, c1y)), _mm_mul_pd(c1z, c1z));
+            const __m128d n2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(c2x, c2x), _mm_mul_pd(c2y, c2y)), _mm_mul_pd(c2z, c2z));
+            return _mm_add_pd(_mm_sqrt_pd(n1), _mm_sqrt_pd(n2));
+        };
+        
+        __m128d lane01 = _mm_setzero_pd(), lane23 = _mm_setzero_pd();
+        for (; i + kAreaLanes <= numSegments; i += kAreaLanes) {
+            lane01 = _mm_add_pd(lane01, stripArea2x2(i));
+            lane23 = _mm_add_pd(lane23, stripArea2x2(i + 2));
+        }
+        double lane[kAreaLanes];
+        _mm_storeu_pd(lane, lane01);
+        _mm_storeu_pd(lane + 2, lane23);
+        for (UIndex k = 0; k < kAreaLanes; ++k)
+            totalArea += 0.5 * lane[k];
+#endif
+        
+        // хвост, не кратный числу дорожек (без SSE2 — все полосы)
+        for (; i < numSegments; ++i) {
+            const double ax = rx[i] - lx[i], ay = ry[i] - ly[i], az = rz[i] - lz[i];
+            const double bx = lx[i + 1] - lx[i], by = ly[i + 1] - ly[i], bz = lz[i + 1] - lz[i];
+            const double c1x = ay * bz - az * by, c1y = az * bx - ax * bz, c1z = ax * by - ay * bx;
+            
+            const double dx = rx[i] - lx[i + 1], dy = ry[i] - ly[i + 1], dz = rz[i] - lz[i + 1];
+            const double ex = rx[i + 1] - lx[i + 1], ey = ry[i + 1] - ly[i + 1], ez = rz[i + 1] - lz[i + 1];
+            const double c2x = dy * ez - dz * ey, c2y = dz * ex - dx * ez, c2z = dx * ey - dy * ex;
+            
+            totalArea += 0.5 * (std::sqrt(c1x * c1x + c1y * c1y + c1z * c1z) +
+                                std::sqrt(c2x * c2x + c2y * c2y + c2z * c2z));
         }
         
         Log("[RoadHelper] Calculated surface area: %.3f m² (%d triangles)", totalArea, (int)(numSegments * 2));
         return totalArea;
     }
     
-    // Создание текстовой выноски с площадью
-    bool CreateAreaLabel(const API_Coord& position, double areaM2)
+    // Текстовый элемент в пакет (создаётся вызывающим в его команде Undo)
+    static bool AddTextLabel(ElementBatch::Batch& batch, const API_Coord& position, const char* text)
     {
-        Log("[RoadHelper] CreateAreaLabel: creating text label at (%.3f, %.3f) with area %.3f m2", 
-            position.x, position.y, areaM2);
-        
-        API_Element element = {};
-        element.header.type = API_TextID;
-        
-        GSErrCode err = ACAPI_Element_GetDefaults(&element, nullptr);
-        if (err != NoError) {
-            Log("[RoadHelper] ERROR: ACAPI_Element_GetDefaults failed for text, err=%d", (int)err);
+        ElementBatch::Spec* spec = batch.Add(API_TextID, "text");
+        if (spec == nullptr) {
+            Log("[RoadHelper] ERROR: ACAPI_Element_GetDefaults failed for text");
             return false;
         }
+        API_Element& element = spec->element;
+        // умолчания общие для пакетов — этаж в них с первого запроса, не текущий
+        element.header.floorInd = g_refFloor;
         
         // Устанавливаем позицию и параметры текста
         element.text.loc = position;
@@ -1399,30 +837,31 @@ namespace RoadHelper {
         element.text.width = 100.0; // Фиксированная ширина для горизонтального текста
         element.text.nonBreaking = true; // Без переноса строк
         
+        API_ElementMemo& memo = spec->memo;
+        
+        // В AC27 textContent это char** (UTF-8, с нулём в конце); handle — из пула пакета
+        const size_t textLen = std::strlen(text) + 1;
+        memo.textContent = batch.GetArena().Alloc<char>((UInt32)textLen);
+        spec->hasMemo = true;
+        if (memo.textContent == nullptr)
+            return false;
+        std::memcpy(*memo.textContent, text, textLen);
+        return true;
+    }
+    
+    // Создание текстовой выноски с площадью
+    bool CreateAreaLabel(const API_Coord& position, double areaM2)
+    {
+        Log("[RoadHelper] CreateAreaLabel: creating text label at (%.3f, %.3f) with area %.3f m2", 
+            position.x, position.y, areaM2);
+        
         // Формируем текст с площадью
         char textBuf[256];
         snprintf(textBuf, sizeof(textBuf), "S = %.2f m2", areaM2);
         
-        API_ElementMemo memo = {};
-        BNZeroMemory(&memo, sizeof(API_ElementMemo));
-        
-        // В AC27 textContent это char** - нужно выделить память через BMAllocateHandle
-        GS::UniString textStr(textBuf);
-        Int32 textLen = textStr.GetLength() + 1;
-        memo.textContent = reinterpret_cast<char**>(BMAllocateHandle(textLen * sizeof(char), ALLOCATE_CLEAR, 0));
-        if (memo.textContent != nullptr) {
-            strcpy_s(*memo.textContent, textLen, textStr.ToCStr().Get());
-        }
-        
-        // Создаем текстовый элемент
-        err = ACAPI_CallUndoableCommand("Create Area Label", [&]() -> GSErrCode {
-            return ACAPI_Element_Create(&element, &memo);
-        });
-        
-        ACAPI_DisposeElemMemoHdls(&memo);
-        
-        if (err != NoError) {
-            Log("[RoadHelper] ERROR: Failed to create text element, err=%d", (int)err);
+        ElementBatch::Batch batch;
+        if (!AddTextLabel(batch, position, textBuf) || !batch.Commit("Create Area Label")) {
+            Log("[RoadHelper] ERROR: Failed to create text element");
             return false;
         }
         
@@ -1439,44 +878,379 @@ namespace RoadHelper {
         }) == NoError;
     }
     
-    // Кэш для списка покрытий (чтобы не загружать каждый раз)
+    // Morph и выноска с его площадью (и объёмом при толщине) — одним шагом Undo;
+    // площадь берётся из построения тела, без пересчёта по точкам
+    bool CreateMorphWithAreaLabel(const GS::Array<API_Coord3D>& points, double thicknessMM,
+                                  API_AttributeIndex materialTop, API_AttributeIndex materialBottom, API_AttributeIndex materialSide,
+                                  const API_Coord& labelPos, MorphMeasure* outMeasure)
+    {
+        MorphMeasure measure;
+        char textBuf[256] = {};
+        const GSErrCode err = ACAPI_CallUndoableCommand("Create Morph with Area Label", [&]() -> GSErrCode {
+            if (!CreateMorphFromPointsInternal(points, thicknessMM, materialTop, materialBottom, materialSide, false, &measure))
+                return APIERR_GENERAL;
+            
+            if (measure.volume > 0.0)
+                snprintf(textBuf, sizeof(textBuf), "S = %.2f m2, V = %.2f m3", measure.topArea, measure.volume);
+            else
+                snprintf(textBuf, sizeof(textBuf), "S = %.2f m2", measure.topArea);
+            ElementBatch::Batch batch;
+            return AddTextLabel(batch, labelPos, textBuf) && batch.CreateAll() == 1 ? NoError : APIERR_GENERAL;
+        });
+        if (err != NoError) {
+            Log("[RoadHelper] ERROR: Morph with area label failed, err=%d", (int)err);
+            return false;
+        }
+        
+        if (outMeasure != nullptr)
+            *outMeasure = measure;
+        Log("[RoadHelper] SUCCESS: Morph + label: %s (низ=%.3f м2, борта=%.3f м2)", textBuf, measure.bottomArea, measure.sideArea);
+        return true;
+    }
+    
+    // ============================================================================
+    // Покрытие дороги по рельефу (Morph по кромкам с отметками Mesh)
+    // ============================================================================
+
+    // Уровень этажа (м) — Z из 3D-модели абсолютные, Morph хранит их от этажа
+    static double GetStoryLevel(short floorInd)
+    {
+        API_StoryInfo si = {};
+        if (ACAPI_ProjectSetting_GetStorySettings(&si) != NoError || si.data == nullptr)
+            return 0.0;
+
+        double level = 0.0;
+        const Int32 cnt = (Int32)(BMGetHandleSize((GSHandle)si.data) / sizeof(API_StoryType));
+        const Int32 idx = floorInd - si.firstStory;
+        if (idx >= 0 && idx < cnt)
+            level = (*si.data)[idx].level;
+
+        BMKillHandle((GSHandle*)&si.data);
+        return level;
+    }
+
+    // nStations+1 точек по цепочке на равных долях её длины: пары «лево/право»
+    // на одной доле лежат на одном поперечнике и на кривых
+    static void SampleSegsByFraction(std::vector<Seg>&& segs, UInt32 nStations, std::vector<API_Coord>& outPts)
+    {
+        outPts.clear();
+        CompiledPath path;
+        if (!path.Assign(std::move(segs)))
+            return;
+
+        const double totalLen = path.GetLength();
+        outPts.resize((size_t)nStations + 1);
+        CompiledPath::Cursor cursor(path);
+        for (UInt32 k = 0; k <= nStations; ++k)
+            cursor.Eval(totalLen * (double)k / (double)nStations, &outPts[k], nullptr);
+    }
+
+    // Промахи мимо сетки заполняются ближайшей найденной отметкой вдоль кромки
+    static bool FillMissingZ(std::vector<double>& z, const std::vector<bool>& hit)
+    {
+        const size_t n = z.size();
+        size_t first = n;
+        for (size_t i = 0; i < n; ++i) if (hit[i]) { first = i; break; }
+        if (first == n) return false;
+
+        for (size_t i = 0; i < first; ++i) z[i] = z[first];
+        double last = z[first];
+        for (size_t i = first; i < n; ++i) {
+            if (hit[i]) last = z[i];
+            else        z[i] = last;
+        }
+        return true;
+    }
+
+    // Скользящее среднее продольного профиля (окно 2*half+1 станций, у концов — укороченное)
+    static void SmoothProfile(std::vector<double>& z, UInt32 half)
+    {
+        const size_t n = z.size();
+        if (half == 0 || n < 3) return;
+
+        std::vector<double> prefix(n + 1, 0.0);
+        for (size_t i = 0; i < n; ++i) prefix[i + 1] = prefix[i] + z[i];
+        for (size_t i = 0; i < n; ++i) {
+            const size_t a = (i > half) ? i - half : 0;
+            const size_t b = std::min(n - 1, i + (size_t)half);
+            z[i] = (prefix[b + 1] - prefix[a]) / (double)(b - a + 1);
+        }
+    }
+
+    bool BuildDrapedRoad(const RoadParams& params, const DrapeParams& drape)
+    {
+        Log("[RoadHelper] >>> BuildDrapedRoad: width=%.1fмм, step=%.1fмм, thickness=%.1fмм, smooth=%.1fмм",
+            params.widthMM, params.sampleStepMM, drape.thicknessMM, drape.smoothLengthMM);
+
+        if (g_centerLineGuid == APINULLGuid) {
+            Log("[RoadHelper] ERROR: нет осевой линии (сначала SetCenterLine())");
+            return false;
+        }
+        if (g_terrainMeshGuid == APINULLGuid) {
+            Log("[RoadHelper] ERROR: нет рельефа (сначала SetTerrainMesh())");
+            return false;
+        }
+        if (params.widthMM <= 0.0 || params.sampleStepMM <= 0.0) {
+            Log("[RoadHelper] ERROR: ширина и шаг должны быть > 0");
+            return false;
+        }
+
+        const double halfWidthM = (params.widthMM / 1000.0) * 0.5; // мм -> м/2
+        const double stepM = params.sampleStepMM / 1000.0;
+
+        CompiledPath center;
+        std::vector<Seg> leftSegs, rightSegs;
+        bool isClosed = false;
+        if (!BuildEdgeChains(halfWidthM, center, leftSegs, rightSegs, isClosed))
+            return false;
+
+        const UInt32 nStations = std::max<UInt32>(1, (UInt32)std::ceil(center.GetLength() / stepM - 1e-9));
+        std::vector<API_Coord> xy;
+        {
+            std::vector<API_Coord> rightPts;
+            SampleSegsByFraction(std::move(leftSegs), nStations, xy);
+            SampleSegsByFraction(std::move(rightSegs), nStations, rightPts);
+            if (xy.empty() || rightPts.empty()) {
+                Log("[RoadHelper] ERROR: не удалось разложить станции по кромкам");
+                return false;
+            }
+            xy.insert(xy.end(), rightPts.begin(), rightPts.end());   // [лево 0..N][право 0..N]
+        }
+
+        // Все точки обеих кромок — одним пакетом через индекс треугольников
+        TerrainSampler::Index terrain;
+        if (!terrain.Build(g_terrainMeshGuid)) {
+            Log("[RoadHelper] ERROR: не удалось прочитать треугольники рельефа");
+            return false;
+        }
+        const size_t nEdge = (size_t)nStations + 1;
+        std::vector<double> z(xy.size(), 0.0);
+        std::unique_ptr<bool[]> hitBuf(new bool[xy.size()]);
+        const UInt32 hits = terrain.SampleBatch(xy.data(), (UInt32)xy.size(), z.data(), hitBuf.get());
+        Log("[RoadHelper] drape: треугольников=%u, станций=%u, попаданий=%u из %u",
+            (unsigned)terrain.GetTriangleCount(), (unsigned)nEdge, (unsigned)hits, (unsigned)xy.size());
+
+        std::vector<double> zL(z.begin(), z.begin() + nEdge), zR(z.begin() + nEdge, z.end());
+        std::vector<bool> hitL(hitBuf.get(), hitBuf.get() + nEdge), hitR(hitBuf.get() + nEdge, hitBuf.get() + xy.size());
+        if (!FillMissingZ(zL, hitL) || !FillMissingZ(zR, hitR)) {
+            Log("[RoadHelper] ERROR: кромка дороги целиком вне рельефа");
+            return false;
+        }
+
+        if (drape.smoothLengthMM > 0.0) {
+            const UInt32 half = (UInt32)std::floor(drape.smoothLengthMM * 0.5 / params.sampleStepMM + 0.5);
+            SmoothProfile(zL, half);
+            SmoothProfile(zR, half);
+            Log("[RoadHelper] drape: профиль сглажен, окно=%u станций", (unsigned)(2 * half + 1));
+        }
+
+        // Точки для Morph: левая кромка вперёд, правая — обратно; Z от уровня этажа оси
+        const double zBase = GetStoryLevel(g_refFloor) - drape.zOffsetMM / 1000.0;
+        GS::Array<API_Coord3D> points;
+        points.SetCapacity((UInt32)(2 * nEdge));
+        for (size_t k = 0; k < nEdge; ++k)
+            points.Push({ xy[k].x, xy[k].y, zL[k] - zBase });
+        for (size_t k = nEdge; k-- > 0; )
+            points.Push({ xy[nEdge + k].x, xy[nEdge + k].y, zR[k] - zBase });
+
+        const GSErrCode err = ACAPI_CallUndoableCommand("Build Draped Road", [&]() -> GSErrCode {
+            return CreateMorphFromPointsInternal(points, drape.thicknessMM,
+                drape.materialTop, drape.materialBottom, drape.materialSide, true) ? NoError : APIERR_GENERAL;
+            });
+        if (err != NoError) {
+            Log("[RoadHelper] ERROR: не удалось создать покрытие, err=%d", (int)err);
+            return false;
+        }
+
+        Log("[RoadHelper] ✅ ГОТОВО: покрытие по рельефу (%u точек)", (unsigned)points.GetSize());
+        return true;
+    }
+
+    // ============================================================================
+    // Коридор по шаблону поперечного профиля (одно тело Morph)
+    // ============================================================================
+
+    bool BuildCorridor(const Corridor::Template& tpl, double maxStepMM)
+    {
+        Log("[RoadHelper] >>> BuildCorridor: точек шаблона=%u, толщина=%.3fм, maxStep=%.1fмм",
+            (unsigned)tpl.points.size(), tpl.thicknessM, maxStepMM);
+
+        if (g_centerLineGuid == APINULLGuid) {
+            Log("[RoadHelper] ERROR: нет осевой линии (сначала SetCenterLine())");
+            return false;
+        }
+        if (!Corridor::IsValid(tpl)) {
+            Log("[RoadHelper] ERROR: шаблон профиля: нужно >= 2 точек по возрастанию смещения");
+            return false;
+        }
+
+        CompiledPath center;
+        PathEngine::PathStats pathStats;
+        if (!center.Build(g_centerLineGuid, PathEngine::kDefaultChordTolM, &pathStats)) {
+            Log("[RoadHelper] ERROR: не удалось построить сегменты пути");
+            return false;
+        }
+        const bool isClosed = IsPathClosed(center.GetSegments());
+
+        // Тело относительно начала оси; станции пишутся в builder по одной
+        const API_Coord start = OffsetCurve::SegStart(center.GetSegments().front());
+        const API_Coord3D ref = { start.x, start.y, 0.0 };
+
+        Corridor::Options opt;
+        opt.maxStepM = maxStepMM / 1000.0;
+        Corridor::Stats corStats;
+
+        const GSErrCode err = ACAPI_CallUndoableCommand("Build Road Corridor", [&]() -> GSErrCode {
+            API_Element element = {};
+            if (!PrepareMorphElement(element, ref, true))
+                return APIERR_GENERAL;
+
+            MorphBody::Builder body;
+            if (!body.Begin()) {
+                Log("[RoadHelper] ERROR: ACAPI_Body_Create failed");
+                return APIERR_GENERAL;
+            }
+            if (!Corridor::Sweep(center.GetSegments(), isClosed, tpl, opt, ref, body, &corStats)) {
+                Log("[RoadHelper] ERROR: не удалось протянуть профиль вдоль оси");
+                return APIERR_GENERAL;
+            }
+            Log("[RoadHelper] corridor: станций=%u (на изломах %u), полос=%u, длина=%.3fм",
+                (unsigned)corStats.stations, (unsigned)corStats.miterStations, (unsigned)corStats.strips, center.GetLength());
+
+            return CreateMorphFromBody(element, body) ? NoError : APIERR_GENERAL;
+            });
+
+        if (err != NoError) {
+            Log("[RoadHelper] ERROR: коридор не создан, err=%d", (int)err);
+            return false;
+        }
+
+        Log("[RoadHelper] ✅ ГОТОВО: коридор создан");
+        return true;
+    }
+
+    // ============================================================================
+    // Земляные работы: линии нулевых работ и объёмы выемки/насыпи
+    // ============================================================================
+
+    // Непрерывные участки найденных точек одной стороны — отдельные полилинии
+    static UInt32 AddDaylightLines(ElementBatch::Batch& batch, const std::vector<Earthworks::StationResult>& st, bool left, const char* tag)
+    {
+        UInt32 added = 0;
+        std::vector<Seg> run;
+        auto Flush = [&]() {
+            if (!run.empty() && AddPolyLineFromSegs(batch, run, tag))
+                ++added;
+            run.clear();
+        };
+
+        for (size_t i = 1; i < st.size(); ++i) {
+            const bool ok0 = left ? st[i - 1].foundL : st[i - 1].foundR;
+            const bool ok1 = left ? st[i].foundL : st[i].foundR;
+            if (!ok0 || !ok1) { Flush(); continue; }
+
+            Seg s = {};
+            s.kind = Seg::Line;
+            s.a = left ? st[i - 1].daylightL : st[i - 1].daylightR;
+            s.b = left ? st[i].daylightL : st[i].daylightR;
+            s.L = std::hypot(s.b.x - s.a.x, s.b.y - s.a.y);
+            if (s.L > kEPS) run.push_back(s);
+        }
+        Flush();
+        return added;
+    }
+
+    bool BuildEarthworks(const Corridor::Template& tpl, const Earthworks::Params& params)
+    {
+        Log("[RoadHelper] >>> BuildEarthworks: откосы 1:%.2f (выемка) / 1:%.2f (насыпь), шаг=%.2fм",
+            params.cutSlopeH, params.fillSlopeH, params.stationStepM);
+
+        if (g_centerLineGuid == APINULLGuid) {
+            Log("[RoadHelper] ERROR: нет осевой линии (сначала SetCenterLine())");
+            return false;
+        }
+        if (g_terrainMeshGuid == APINULLGuid) {
+            Log("[RoadHelper] ERROR: нет рельефа (сначала SetTerrainMesh())");
+            return false;
+        }
+        if (!Corridor::IsValid(tpl) || params.stationStepM <= 0.0) {
+            Log("[RoadHelper] ERROR: нужен корректный шаблон профиля и шаг пикетов > 0");
+            return false;
+        }
+
+        CompiledPath center;
+        if (!center.Build(g_centerLineGuid)) {
+            Log("[RoadHelper] ERROR: не удалось построить сегменты пути");
+            return false;
+        }
+        TerrainSampler::Index terrain;
+        if (!terrain.Build(g_terrainMeshGuid)) {
+            Log("[RoadHelper] ERROR: не удалось прочитать треугольники рельефа");
+            return false;
+        }
+
+        // Высоты шаблона — от уровня этажа оси (как у коридора)
+        Earthworks::Params p = params;
+        p.baseZ = GetStoryLevel(g_refFloor);
+
+        std::vector<Earthworks::StationResult> stations;
+        Earthworks::Totals totals;
+        if (!Earthworks::Compute(center, tpl.points, terrain, p, stations, totals)) {
+            Log("[RoadHelper] ERROR: не удалось посчитать поперечники");
+            return false;
+        }
+        Log("[RoadHelper] earthworks: пикетов=%u, потоков=%u, без пересечения=%u сторон, выемка=%.3fм3, насыпь=%.3fм3",
+            (unsigned)totals.stations, (unsigned)totals.threads, (unsigned)totals.daylightMissing,
+            totals.cutVolume, totals.fillVolume);
+
+        API_Coord labelPos;
+        center.Eval(0.5 * center.GetLength(), &labelPos, nullptr);
+        char textBuf[256];
+        snprintf(textBuf, sizeof(textBuf), "Cut = %.2f m3, Fill = %.2f m3", totals.cutVolume, totals.fillVolume);
+
+        // Линии нулевых работ и сводка — один пакет, одна команда отмены
+        ElementBatch::Batch batch;
+        const UInt32 nLines = AddDaylightLines(batch, stations, true, "daylight L") + AddDaylightLines(batch, stations, false, "daylight R");
+        if (!AddTextLabel(batch, labelPos, textBuf) || !batch.Commit("Build Earthworks")) {
+            Log("[RoadHelper] ERROR: земляные работы не созданы");
+            return false;
+        }
+
+        Log("[RoadHelper] ✅ ГОТОВО: земляные работы (%u линий нулевых работ), %s", (unsigned)nLines, textBuf);
+        return true;
+    }
+
+    // Список покрытий для палитры — производный от AttributeCache::Surfaces():
+    // перестраивается, только когда таблица атрибутов перечитана
     static GS::Array<SurfaceFinishInfo> g_cachedFinishes;
-    static bool g_finishesCacheValid = false;
+    static UInt32 g_finishesGeneration = 0;
     
     // Получить список всех доступных покрытий (материалы - они используются как покрытия/текстуры)
-    GS::Array<SurfaceFinishInfo> GetSurfaceFinishesList()
+    const GS::Array<SurfaceFinishInfo>& GetSurfaceFinishesList()
     {
-        // Возвращаем кэш, если он валиден
-        if (g_finishesCacheValid && g_cachedFinishes.GetSize() > 0) {
+        AttributeCache::Table& surfaces = AttributeCache::Surfaces();
+        const UInt32 generation = surfaces.GetGeneration();
+        if (generation == g_finishesGeneration)
             return g_cachedFinishes;
-        }
         
-        // Очищаем кэш и загружаем заново
+        const std::vector<AttributeCache::Entry>& entries = surfaces.GetEntries();
         g_cachedFinishes.Clear();
-        
-        GS::Array<API_Attribute> attributes;
-        GSErrCode err = ACAPI_Attribute_GetAttributesByType(API_MaterialID, attributes);
-        
-        if (err == NoError) {
-            for (UIndex i = 0; i < attributes.GetSize(); ++i) {
-                SurfaceFinishInfo info;
-                // Получаем числовой индекс из API_AttributeIndex
-                // Используем порядковый номер + 1, так как индексы начинаются с 1
-                info.index = (Int32)(i + 1);
-                info.name = attributes[i].header.name;
-                g_cachedFinishes.Push(info);
-            }
-            g_finishesCacheValid = true;
+        g_cachedFinishes.SetCapacity((UInt32)entries.size());
+        for (const AttributeCache::Entry& e : entries) {
+            SurfaceFinishInfo info;
+            // настоящий индекс атрибута: после удаления покрытий индексы идут с пропусками
+            info.index = e.index.ToInt32_Deprecated();
+            info.name = e.name;
+            g_cachedFinishes.Push(info);
         }
-        
+        g_finishesGeneration = generation;
         return g_cachedFinishes;
     }
     
-    // Сбросить кэш покрытий (вызывать при изменении материалов в проекте)
+    // Сбросить кэш покрытий вручную (обычно хватает уведомлений AttributeCache)
     void InvalidateSurfaceFinishesCache()
     {
-        g_finishesCacheValid = false;
-        g_cachedFinishes.Clear();
+        AttributeCache::Surfaces().Invalidate();
     }
 
 } // namespace RoadHelper
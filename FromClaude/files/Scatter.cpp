@@ -0,0 +1,169 @@
+// Scatter.cpp
+#include "Scatter.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace Scatter {
+
+	// Фоновая сетка Int32 на ячейку: 16M ячеек — 64 МБ
+	static constexpr double kMaxCells = 16.0 * 1024.0 * 1024.0;
+	static constexpr double kTwoPI = 6.283185307179586476925286766559;
+
+	Rng::Rng(UInt64 seed)
+	{
+		// splitmix64: близкие seed дают несвязанные начальные состояния
+		UInt64 z = seed + 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		m_s = z ^ (z >> 31);
+		if (m_s == 0) m_s = 0x9E3779B97F4A7C15ull;
+	}
+
+	UInt64 Rng::Next()
+	{
+		m_s ^= m_s >> 12;
+		m_s ^= m_s << 25;
+		m_s ^= m_s >> 27;
+		return m_s * 0x2545F4914F6CDD1Dull;
+	}
+
+	bool PoissonDisk(const Boundary::Region& region, const PoissonParams& params, std::vector<API_Coord>& out)
+	{
+		out.clear();
+		if (region.IsEmpty() || params.radiusM <= 1e-9)
+			return false;
+
+		const API_Box& box = region.GetBox();
+		const double r = params.radiusM;
+		const double r2 = r * r;
+		const double cell = r / std::sqrt(2.0);
+		const double w = box.xMax - box.xMin, h = box.yMax - box.yMin;
+		const double cells = (std::floor(w / cell) + 1.0) * (std::floor(h / cell) + 1.0);
+		if (cells > kMaxCells)
+			return false;
+
+		const Int32 nx = (Int32)std::floor(w / cell) + 1;
+		const Int32 ny = (Int32)std::floor(h / cell) + 1;
+		std::vector<Int32> grid((size_t)nx * (size_t)ny, -1);
+		std::vector<UInt32> active;
+		Rng rng(params.seed);
+		const UInt32 attempts = std::max<UInt32>(1, params.attempts);
+
+		auto cellOf = [&](const API_Coord& p, Int32& gx, Int32& gy) {
+			gx = std::min(nx - 1, (Int32)((p.x - box.xMin) / cell));
+			gy = std::min(ny - 1, (Int32)((p.y - box.yMin) / cell));
+		};
+
+		// Сначала соседи по сетке (дёшево), затем принадлежность области
+		auto fits = [&](const API_Coord& p) -> bool {
+			if (p.x < box.xMin || p.x > box.xMax || p.y < box.yMin || p.y > box.yMax)
+				return false;
+			Int32 gx, gy;
+			cellOf(p, gx, gy);
+			const Int32 x0 = std::max(0, gx - 2), x1 = std::min(nx - 1, gx + 2);
+			const Int32 y0 = std::max(0, gy - 2), y1 = std::min(ny - 1, gy + 2);
+			for (Int32 y = y0; y <= y1; ++y) {
+				const Int32* row = &grid[(size_t)y * (size_t)nx];
+				for (Int32 x = x0; x <= x1; ++x) {
+					const Int32 idx = row[x];
+					if (idx < 0) continue;
+					const double dx = out[(size_t)idx].x - p.x, dy = out[(size_t)idx].y - p.y;
+					if (dx * dx + dy * dy < r2)
+						return false;
+				}
+			}
+			return region.Contains(p.x, p.y);
+		};
+
+		auto add = [&](const API_Coord& p) {
+			Int32 gx, gy;
+			cellOf(p, gx, gy);
+			grid[(size_t)gy * (size_t)nx + (size_t)gx] = (Int32)out.size();
+			active.push_back((UInt32)out.size());
+			out.push_back(p);
+		};
+
+		auto full = [&]() { return params.maxPoints != 0 && out.size() >= params.maxPoints; };
+
+		// Рост от активных точек: кандидаты в кольце [r, 2r), равномерно по площади
+		auto grow = [&]() {
+			while (!active.empty() && !full()) {
+				const UInt32 slot = rng.Below((UInt32)active.size());
+				const API_Coord base = out[active[slot]];
+				bool found = false;
+				for (UInt32 k = 0; k < attempts; ++k) {
+					const double a = kTwoPI * rng.Uniform();
+					const double d = r * std::sqrt(1.0 + 3.0 * rng.Uniform());
+					const API_Coord c = { base.x + d * std::cos(a), base.y + d * std::sin(a) };
+					if (fits(c)) {
+						add(c);
+						found = true;
+						break;
+					}
+				}
+				if (!found) {
+					active[slot] = active.back();
+					active.pop_back();
+				}
+			}
+		};
+
+		// Зёрна: пустые ячейки по строкам — каждая связная часть области
+		// получает своё; O(ячейки) за весь проход
+		for (Int32 gy = 0; gy < ny && !full(); ++gy) {
+			for (Int32 gx = 0; gx < nx && !full(); ++gx) {
+				if (grid[(size_t)gy * (size_t)nx + (size_t)gx] >= 0)
+					continue;
+				const API_Coord c = { box.xMin + (gx + rng.Uniform()) * cell, box.yMin + (gy + rng.Uniform()) * cell };
+				if (!fits(c))
+					continue;
+				add(c);
+				grow();
+			}
+		}
+
+		return !out.empty();
+	}
+
+	UInt32 Lattice(const Boundary::Region& region, const LatticeParams& params,
+		const std::function<void(const API_Coord&)>& emit)
+	{
+		if (region.IsEmpty() || params.stepM <= 1e-9)
+			return 0;
+
+		const API_Box& box0 = region.GetBox();
+		const API_Coord pivot = { (box0.xMin + box0.xMax) * 0.5, (box0.yMin + box0.yMax) * 0.5 };
+		Boundary::Region local = region;
+		local.Rotate(-params.angleRad, pivot);
+		const API_Box& box = local.GetBox();
+
+		const bool   hex = params.kind == LatticeKind::Hex;
+		const double dx = params.stepM;
+		const double dy = hex ? params.stepM * std::sqrt(3.0) * 0.5 : params.stepM;
+		const double c = std::cos(params.angleRad), s = std::sin(params.angleRad);
+
+		const Int64 j0 = (Int64)std::ceil((box.yMin - pivot.y) / dy);
+		const Int64 j1 = (Int64)std::floor((box.yMax - pivot.y) / dy);
+
+		UInt32 count = 0;
+		std::vector<double> spans;
+		for (Int64 j = j0; j <= j1; ++j) {
+			const double y = pivot.y + (double)j * dy;
+			local.Spans(y, spans);
+			const double ox = pivot.x + ((hex && (j & 1) != 0) ? dx * 0.5 : 0.0);
+			for (size_t k = 0; k + 1 < spans.size(); k += 2) {
+				const Int64 i0 = (Int64)std::ceil((spans[k] - ox) / dx);
+				const Int64 i1 = (Int64)std::floor((spans[k + 1] - ox) / dx);
+				for (Int64 i = i0; i <= i1; ++i) {
+					// обратно в план: поворот на angleRad вокруг pivot
+					const double lx = ox + (double)i * dx - pivot.x, ly = y - pivot.y;
+					emit({ pivot.x + c * lx - s * ly, pivot.y + s * lx + c * ly });
+					++count;
+				}
+			}
+		}
+		return count;
+	}
+
+} // namespace Scatter
@@ -0,0 +1,64 @@
+// Scatter.hpp — раскладка точек в области (Boundary::Region): случайная —
+// пуассоновский диск по Бриджсону, регулярная — квадратная или
+// шестиугольная решётка. Фоновая сетка с ячейкой r/√2 держит не больше
+// одной точки, проверка соседей — 5×5 ячеек, весь проход
+// O(точки × attempts). ГСЧ свой (xorshift64*): при том же seed раскладка
+// одинакова на всех платформах и стандартных библиотеках.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "Boundary.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace Scatter {
+
+	class Rng {
+	public:
+		explicit Rng(UInt64 seed);
+
+		UInt64 Next();
+		// [0, 1)
+		double Uniform() { return (double)(Next() >> 11) * (1.0 / 9007199254740992.0); }
+		double Uniform(double a, double b) { return a + (b - a) * Uniform(); }
+		// [0, n)
+		UInt32 Below(UInt32 n) { return (UInt32)(Next() % (UInt64)n); }
+
+	private:
+		UInt64 m_s;
+	};
+
+	struct PoissonParams {
+		double radiusM = 1.0;    // наименьшее расстояние между точками
+		UInt64 seed = 1;
+		UInt32 attempts = 30;    // кандидатов вокруг активной точки (k у Бриджсона)
+		UInt32 maxPoints = 0;    // 0 — без ограничения
+	};
+
+	// Точки в region не ближе radiusM друг к другу. Несвязные части и
+	// отверстия обходятся: после исчерпания активного списка новое зерно
+	// ищется проходом по пустым ячейкам сетки. false — пустая область или
+	// фоновая сетка слишком велика для radiusM.
+	bool PoissonDisk(const Boundary::Region& region, const PoissonParams& params, std::vector<API_Coord>& out);
+
+	enum class LatticeKind {
+		Square,
+		Hex        // нечётные ряды сдвинуты на полшага, ряды через step·√3/2
+	};
+
+	struct LatticeParams {
+		LatticeKind kind = LatticeKind::Square;
+		double      stepM = 1.0;
+		double      angleRad = 0.0;   // поворот решётки; начало — центр габарита области
+	};
+
+	// Узлы решётки внутри region (отверстия пропускаются). Копия области
+	// поворачивается в систему решётки, по каждому ряду берутся пролёты
+	// Region::Spans, узлы пролёта — арифметикой, без проверки точек.
+	// emit — по рядам, слева направо; возвращает число узлов.
+	UInt32 Lattice(const Boundary::Region& region, const LatticeParams& params,
+		const std::function<void(const API_Coord&)>& emit);
+
+} // namespace Scatter
@@ -0,0 +1,284 @@
+// TerrainSampler.cpp
+#include "TerrainSampler.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace TerrainSampler {
+
+	// Проекция на план меньше этой площади — вертикальная грань (борт сетки)
+	static constexpr double kMinPlanArea = 1e-10;
+	// Грань с меньшей z-составляющей единичной нормали — борт или дно сетки
+	static constexpr double kMinUpNormal = 1e-6;
+
+	static inline void Transform(const API_Tranmat& tm, const API_VertType3D& v, double& x, double& y, double& z)
+	{
+		const double* m = tm.tmx;
+		x = m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3];
+		y = m[4] * v.x + m[5] * v.y + m[6] * v.z + m[7];
+		z = m[8] * v.x + m[9] * v.y + m[10] * v.z + m[11];
+	}
+
+	// Удвоенная площадь кольца в плане со знаком (> 0 — против часовой)
+	static double SignedArea2(const double* x, const double* y, size_t n)
+	{
+		double a = 0.0;
+		for (size_t i = 0, j = n - 1; i < n; j = i++)
+			a += (x[j] - x[i]) * (y[j] + y[i]);
+		return a;
+	}
+
+	// Триангуляция контура в плане отсечением ушей: грань ровной сетки — весь
+	// её контур, невыпуклый, и веер от первой вершины вышел бы за него.
+	// outIdx — тройки индексов вершин.
+	static void EarClip(const double* px, const double* py, size_t n, std::vector<UInt32>& outIdx)
+	{
+		outIdx.clear();
+		if (n < 3) return;
+		std::vector<UInt32> ring(n);
+		for (size_t i = 0; i < n; ++i) ring[i] = (UInt32)i;
+		if (SignedArea2(px, py, n) < 0.0) std::reverse(ring.begin(), ring.end());
+
+		auto cross = [&](UInt32 a, UInt32 b, UInt32 c) {
+			return (px[b] - px[a]) * (py[c] - py[a]) - (px[c] - px[a]) * (py[b] - py[a]);
+		};
+
+		size_t i = 0, misses = 0;
+		while (ring.size() > 3) {
+			const size_t m = ring.size();
+			const UInt32 a = ring[(i + m - 1) % m], b = ring[i], c = ring[(i + 1) % m];
+			bool ear = cross(a, b, c) > 0.0;
+			for (size_t k = 0; ear && k < m; ++k) {
+				const UInt32 p = ring[k];
+				if (p != a && p != b && p != c && cross(a, b, p) >= 0.0 && cross(b, c, p) >= 0.0 && cross(c, a, p) >= 0.0)
+					ear = false;
+			}
+			// полный круг без уха — вырожденный остаток (совпадающие вершины), режем как есть
+			if (ear || misses >= m) {
+				outIdx.insert(outIdx.end(), { a, b, c });
+				ring.erase(ring.begin() + i);
+				if (i >= ring.size()) i = 0;
+				misses = 0;
+			} else {
+				i = (i + 1) % m;
+				++misses;
+			}
+		}
+		outIdx.insert(outIdx.end(), { ring[0], ring[1], ring[2] });
+	}
+
+	bool Index::InHole(const Tri& t, double x, double y) const
+	{
+		for (UInt32 h = t.hole0; h < t.hole1; ++h) {
+			const Ring& r = m_holes[h];
+			if (x < r.minX || x > r.maxX || y < r.minY || y > r.maxY) continue;
+			bool in = false;
+			for (UInt32 i = r.begin, j = r.end - 1; i < r.end; j = i++) {
+				if ((m_holeY[i] > y) != (m_holeY[j] > y) &&
+					x < (m_holeX[j] - m_holeX[i]) * (y - m_holeY[i]) / (m_holeY[j] - m_holeY[i]) + m_holeX[i])
+					in = !in;
+			}
+			if (in) return true;
+		}
+		return false;
+	}
+
+	bool Index::ZInTri(const Tri& t, double x, double y, double& outZ)
+	{
+		const double d = (t.y1 - t.y2) * (t.x0 - t.x2) + (t.x2 - t.x1) * (t.y0 - t.y2);
+		if (std::fabs(d) < kMinPlanArea) return false;
+		const double l0 = ((t.y1 - t.y2) * (x - t.x2) + (t.x2 - t.x1) * (y - t.y2)) / d;
+		const double l1 = ((t.y2 - t.y0) * (x - t.x2) + (t.x0 - t.x2) * (y - t.y2)) / d;
+		const double l2 = 1.0 - l0 - l1;
+		const double eps = -1e-9;   // точка на общем ребре попадает в оба треугольника
+		if (l0 < eps || l1 < eps || l2 < eps) return false;
+		outZ = l0 * t.z0 + l1 * t.z1 + l2 * t.z2;
+		return true;
+	}
+
+	bool Index::Build(const API_Guid& meshGuid)
+	{
+		m_tris.clear();
+		m_holes.clear();
+		m_holeX.clear();
+		m_holeY.clear();
+		m_cellStart.clear();
+		m_cellTris.clear();
+		m_nx = m_ny = 0;
+
+		API_Elem_Head head = {};
+		head.guid = meshGuid;
+		if (ACAPI_Element_GetHeader(&head) != NoError)
+			return false;
+
+		API_ElemInfo3D info3D = {};
+		if (ACAPI_ModelAccess_Get3DInfo(head, &info3D) != NoError)
+			return false;
+
+		// Треугольники верхних граней тела. Борта и дно отбрасываются по нормали:
+		// иначе точка вне контура сетки или в её отверстии попадала бы в дно.
+		std::vector<double> px, py, pz;
+		std::vector<UInt32> ringEnd;   // концы колец в px: [0] — внешний контур, дальше — отверстия
+		std::vector<UInt32> tri;
+		for (Int32 ib = info3D.fbody; ib <= info3D.lbody; ++ib) {
+			API_Component3D comp = {};
+			comp.header.typeID = API_BodyID;
+			comp.header.index = ib;
+			if (ACAPI_ModelAccess_GetComponent(&comp) != NoError)
+				continue;
+			const Int32 nPgon = comp.body.nPgon;
+			const API_Tranmat tm = comp.body.tranmat;
+			const double* m = tm.tmx;
+
+			for (Int32 ip = 1; ip <= nPgon; ++ip) {
+				comp.header.typeID = API_PgonID;
+				comp.header.index = ip;
+				if (ACAPI_ModelAccess_GetComponent(&comp) != NoError)
+					continue;
+				const Int32 fpedg = comp.pgon.fpedg, lpedg = comp.pgon.lpedg;
+				const Int32 ipvect = comp.pgon.ipvect;
+
+				// нормаль грани (отрицательный индекс — обратное направление)
+				comp.header.typeID = API_VectID;
+				comp.header.index = std::abs(ipvect);
+				if (ipvect == 0 || ACAPI_ModelAccess_GetComponent(&comp) != NoError)
+					continue;
+				const double sign = ipvect < 0 ? -1.0 : 1.0;
+				const double nx = sign * comp.vect.x, ny = sign * comp.vect.y, nz = sign * comp.vect.z;
+				const double upZ = m[8] * nx + m[9] * ny + m[10] * nz;
+				if (upZ <= kMinUpNormal * std::sqrt(nx * nx + ny * ny + nz * nz))
+					continue;
+
+				px.clear(); py.clear(); pz.clear();
+				ringEnd.clear();
+				for (Int32 ie = fpedg; ie <= lpedg; ++ie) {
+					comp.header.typeID = API_PedgID;
+					comp.header.index = ie;
+					if (ACAPI_ModelAccess_GetComponent(&comp) != NoError)
+						break;
+					const Int32 pedg = comp.pedg.pedg;
+					if (pedg == 0) {   // конец кольца, дальше — отверстие
+						ringEnd.push_back((UInt32)px.size());
+						continue;
+					}
+
+					comp.header.typeID = API_EdgeID;
+					comp.header.index = std::abs(pedg);
+					if (ACAPI_ModelAccess_GetComponent(&comp) != NoError)
+						break;
+					const Int32 iv = (pedg > 0) ? comp.edge.vert1 : comp.edge.vert2;
+
+					comp.header.typeID = API_VertID;
+					comp.header.index = iv;
+					if (ACAPI_ModelAccess_GetComponent(&comp) != NoError)
+						break;
+					double x, y, z;
+					Transform(tm, comp.vert, x, y, z);
+					px.push_back(x); py.push_back(y); pz.push_back(z);
+				}
+				ringEnd.push_back((UInt32)px.size());
+
+				// отверстия: кольца после внешнего контура, проверяются при опросе
+				const UInt32 hole0 = (UInt32)m_holes.size();
+				for (size_t r = 1; r < ringEnd.size(); ++r) {
+					const UInt32 b = ringEnd[r - 1], e = ringEnd[r];
+					if (e - b < 3) continue;
+					Ring ring = { (UInt32)m_holeX.size(), 0, px[b], px[b], py[b], py[b] };
+					for (UInt32 k = b; k < e; ++k) {
+						m_holeX.push_back(px[k]); m_holeY.push_back(py[k]);
+						ring.minX = std::min(ring.minX, px[k]); ring.maxX = std::max(ring.maxX, px[k]);
+						ring.minY = std::min(ring.minY, py[k]); ring.maxY = std::max(ring.maxY, py[k]);
+					}
+					ring.end = (UInt32)m_holeX.size();
+					m_holes.push_back(ring);
+				}
+				const UInt32 hole1 = (UInt32)m_holes.size();
+
+				EarClip(px.data(), py.data(), ringEnd[0], tri);
+				for (size_t k = 0; k + 2 < tri.size(); k += 3) {
+					const UInt32 a = tri[k], b = tri[k + 1], c = tri[k + 2];
+					const Tri t = { px[a], py[a], pz[a], px[b], py[b], pz[b], px[c], py[c], pz[c], hole0, hole1 };
+					const double area2 = (t.x1 - t.x0) * (t.y2 - t.y0) - (t.x2 - t.x0) * (t.y1 - t.y0);
+					if (std::fabs(area2) >= kMinPlanArea) m_tris.push_back(t);
+				}
+			}
+		}
+		if (m_tris.empty())
+			return false;
+
+		// Сетка ячеек: ~2 треугольника на ячейку, не больше 4n+16 ячеек
+		double minX = m_tris[0].x0, maxX = minX, minY = m_tris[0].y0, maxY = minY;
+		for (const Tri& t : m_tris) {
+			minX = std::min({ minX, t.x0, t.x1, t.x2 }); maxX = std::max({ maxX, t.x0, t.x1, t.x2 });
+			minY = std::min({ minY, t.y0, t.y1, t.y2 }); maxY = std::max({ maxY, t.y0, t.y1, t.y2 });
+		}
+		const size_t nTris = m_tris.size();
+		const double w = std::max(maxX - minX, 1e-6), h = std::max(maxY - minY, 1e-6);
+		m_cell = std::sqrt(w * h / std::max<double>(1.0, nTris * 0.5));
+		while ((std::ceil(w / m_cell) + 1.0) * (std::ceil(h / m_cell) + 1.0) > 4.0 * nTris + 16.0)
+			m_cell *= 2.0;
+		m_minX = minX; m_minY = minY;
+		m_nx = (Int32)std::floor(w / m_cell) + 1;
+		m_ny = (Int32)std::floor(h / m_cell) + 1;
+
+		auto CellRange = [&](const Tri& t, Int32& cx0, Int32& cy0, Int32& cx1, Int32& cy1) {
+			cx0 = std::max<Int32>(0, (Int32)((std::min({ t.x0, t.x1, t.x2 }) - m_minX) / m_cell));
+			cy0 = std::max<Int32>(0, (Int32)((std::min({ t.y0, t.y1, t.y2 }) - m_minY) / m_cell));
+			cx1 = std::min<Int32>(m_nx - 1, (Int32)((std::max({ t.x0, t.x1, t.x2 }) - m_minX) / m_cell));
+			cy1 = std::min<Int32>(m_ny - 1, (Int32)((std::max({ t.y0, t.y1, t.y2 }) - m_minY) / m_cell));
+		};
+
+		// два прохода: подсчёт и раскладка
+		m_cellStart.assign((size_t)m_nx * m_ny + 1, 0);
+		for (const Tri& t : m_tris) {
+			Int32 cx0, cy0, cx1, cy1;
+			CellRange(t, cx0, cy0, cx1, cy1);
+			for (Int32 cy = cy0; cy <= cy1; ++cy)
+				for (Int32 cx = cx0; cx <= cx1; ++cx)
+					++m_cellStart[(size_t)cy * m_nx + cx + 1];
+		}
+		for (size_t c = 0; c + 1 < m_cellStart.size(); ++c)
+			m_cellStart[c + 1] += m_cellStart[c];
+		m_cellTris.resize(m_cellStart.back());
+		std::vector<UInt32> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+		for (UInt32 i = 0; i < (UInt32)nTris; ++i) {
+			Int32 cx0, cy0, cx1, cy1;
+			CellRange(m_tris[i], cx0, cy0, cx1, cy1);
+			for (Int32 cy = cy0; cy <= cy1; ++cy)
+				for (Int32 cx = cx0; cx <= cx1; ++cx)
+					m_cellTris[fill[(size_t)cy * m_nx + cx]++] = i;
+		}
+		return true;
+	}
+
+	bool Index::SampleZ(double x, double y, double& outZ) const
+	{
+		if (m_tris.empty()) return false;
+		const double fx = (x - m_minX) / m_cell, fy = (y - m_minY) / m_cell;
+		if (fx < 0.0 || fy < 0.0 || fx >= (double)m_nx || fy >= (double)m_ny) return false;
+		const size_t c = (size_t)(Int32)fy * m_nx + (Int32)fx;
+
+		bool hit = false;
+		for (UInt32 k = m_cellStart[c]; k < m_cellStart[c + 1]; ++k) {
+			double z;
+			const Tri& t = m_tris[m_cellTris[k]];
+			if (ZInTri(t, x, y, z) && (!hit || z > outZ) && !InHole(t, x, y)) {
+				outZ = z;
+				hit = true;
+			}
+		}
+		return hit;
+	}
+
+	UInt32 Index::SampleBatch(const API_Coord* pts, UInt32 n, double* outZ, bool* outHit) const
+	{
+		UInt32 hits = 0;
+		for (UInt32 i = 0; i < n; ++i) {
+			outZ[i] = 0.0;
+			outHit[i] = SampleZ(pts[i].x, pts[i].y, outZ[i]);
+			if (outHit[i]) ++hits;
+		}
+		return hits;
+	}
+
+} // namespace TerrainSampler
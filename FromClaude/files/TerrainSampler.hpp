@@ -0,0 +1,57 @@
+// TerrainSampler.hpp — отметки рельефа (Mesh) под точками плана.
+// Треугольники берутся из 3D-модели сетки один раз, для поиска треугольника
+// под точкой — равномерная сетка ячеек (CSR). Пакетный опрос без повторного
+// чтения модели.
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <vector>
+
+namespace TerrainSampler {
+
+	class Index {
+	public:
+		// Треугольники верхних граней Mesh из 3D-модели: грани с нормалью вверх,
+		// невыпуклые — отсечением ушей, отверстия граней учитываются. Борта и
+		// дно отбрасываются.
+		bool Build(const API_Guid& meshGuid);
+
+		size_t GetTriangleCount() const { return m_tris.size(); }
+		bool   IsEmpty() const { return m_tris.empty(); }
+
+		// Отметка в абсолютных координатах проекта; false — точка вне сетки
+		// или в её отверстии. Несколько граней над точкой — берётся наибольшая.
+		bool SampleZ(double x, double y, double& outZ) const;
+
+		// Пакет точек: outZ[i] / outHit[i]; возвращает число попаданий
+		UInt32 SampleBatch(const API_Coord* pts, UInt32 n, double* outZ, bool* outHit) const;
+
+	private:
+		struct Tri {
+			double x0, y0, z0;
+			double x1, y1, z1;
+			double x2, y2, z2;
+			UInt32 hole0, hole1;   // отверстия грани: m_holes[hole0..hole1)
+		};
+
+		struct Ring {
+			UInt32 begin, end;     // вершины в m_holeX/m_holeY
+			double minX, maxX, minY, maxY;
+		};
+
+		static bool ZInTri(const Tri& t, double x, double y, double& outZ);
+		bool InHole(const Tri& t, double x, double y) const;
+
+		std::vector<Tri>    m_tris;
+		std::vector<Ring>   m_holes;
+		std::vector<double> m_holeX, m_holeY;
+		std::vector<UInt32> m_cellStart;   // размер nx*ny+1
+		std::vector<UInt32> m_cellTris;
+		double              m_minX = 0.0, m_minY = 0.0;
+		double              m_cell = 1.0;
+		Int32               m_nx = 0, m_ny = 0;
+	};
+
+} // namespace TerrainSampler
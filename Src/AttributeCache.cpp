@@ -0,0 +1,173 @@
+// AttributeCache.cpp
+#include "AttributeCache.hpp"
+
+namespace AttributeCache {
+
+// Ключ хэша — имя в UTF-8: ToCStr() по умолчанию в системной кодировке
+// теряет символы вне её (кириллица на не-русской системе → «?»)
+static std::string NameKey(const GS::UniString& name)
+{
+	return std::string(name.ToCStr(0, MaxUSize, CC_UTF8).Get());
+}
+
+void Table::EnsureLoaded()
+{
+	// Атрибут, добавленный в Менеджере атрибутов, уведомления не даёт —
+	// число атрибутов сверяем при каждом обращении (один вызов API)
+	UInt32 count = 0;
+	if (ACAPI_Attribute_GetNum(m_type, count) != NoError)
+		count = 0;
+	if (m_valid && count == m_count)
+		return;
+
+	m_entries.clear();
+	m_byName.clear();
+	m_count = count;
+	m_valid = true;
+	++m_generation;
+
+	GS::Array<API_Attribute> attributes;
+	if (ACAPI_Attribute_GetAttributesByType(m_type, attributes) != NoError) {
+		m_valid = false;
+		return;
+	}
+
+	m_entries.reserve(attributes.GetSize());
+	m_byName.reserve(attributes.GetSize());
+	for (UIndex i = 0; i < attributes.GetSize(); ++i) {
+		const API_AttributeHeader& h = attributes[i].header;
+		m_entries.push_back({ h.index, GS::UniString(h.name) });
+		// одинаковые имена (регистр, пробелы) — находится первый
+		m_byName.emplace(NameKey(m_entries.back().name), (UInt32)(m_entries.size() - 1));
+	}
+}
+
+const std::vector<Entry>& Table::GetEntries()
+{
+	EnsureLoaded();
+	return m_entries;
+}
+
+bool Table::FindIndex(const GS::UniString& name, API_AttributeIndex& outIndex)
+{
+	EnsureLoaded();
+	auto it = m_byName.find(NameKey(name));
+	if (it == m_byName.end() || !IsCurrent(it->second)) {
+		// не нашли или атрибут переименован/удалён — один раз перечитываем
+		Reload();
+		it = m_byName.find(NameKey(name));
+		if (it == m_byName.end())
+			return false;
+	}
+	outIndex = m_entries[it->second].index;
+	return true;
+}
+
+bool Table::IsCurrent(UInt32 position)
+{
+	EnsureLoaded();
+	if (position >= m_entries.size())
+		return false;
+	API_Attribute attr = {};
+	attr.header.typeID = m_type;
+	attr.header.index  = m_entries[position].index;
+	if (ACAPI_Attribute_Get(&attr) != NoError)
+		return false;
+	return GS::UniString(attr.header.name) == m_entries[position].name;
+}
+
+UInt32 Table::GetGeneration()
+{
+	EnsureLoaded();
+	return m_generation;
+}
+
+// ---------- Таблицы ----------
+
+Table& Surfaces()
+{
+	static Table table(API_MaterialID);
+	return table;
+}
+
+Table& BuildingMaterials()
+{
+	static Table table(API_BuildingMaterialID);
+	return table;
+}
+
+Table& Layers()
+{
+	static Table table(API_LayerID);
+	return table;
+}
+
+static UInt32 s_epoch = 0;
+
+UInt32 GetEpoch()
+{
+	return s_epoch;
+}
+
+void InvalidateAll()
+{
+	++s_epoch;
+	Surfaces().Invalidate();
+	BuildingMaterials().Invalidate();
+	Layers().Invalidate();
+}
+
+// ---------- Уведомления ----------
+
+void OnProjectEvent(API_NotifyEventID notifID)
+{
+	switch (notifID) {
+		case APINotify_New:
+		case APINotify_NewAndReset:
+		case APINotify_Open:
+		case APINotify_Close:
+		case APINotify_ChangeProjectDB:
+		case APINotify_ReceiveChanges:
+			InvalidateAll();
+			break;
+		default:
+			break;
+	}
+}
+
+static GSErrCode ProjectEventHandler(API_NotifyEventID notifID, Int32 /*param*/)
+{
+	OnProjectEvent(notifID);
+	return NoError;
+}
+
+// Удаление атрибута с заменой (Менеджер атрибутов, слияние) — индексы сдвигаются
+static GSErrCode AttributeReplacementHandler(const API_AttributeReplaceIndexTable& /*table*/)
+{
+	InvalidateAll();
+	return NoError;
+}
+
+// Смена умолчаний инструмента: таблицы атрибутов не трогаем, только номер сброса
+static GSErrCode DefaultsChangeHandler(const API_ToolBoxItem* /*defElemType*/)
+{
+	++s_epoch;
+	return NoError;
+}
+
+GSErrCode RegisterNotifications()
+{
+	GSErrCode err = ACAPI_ProjectOperation_CatchProjectEvent(
+		APINotify_New | APINotify_NewAndReset | APINotify_Open | APINotify_Close |
+		APINotify_ChangeProjectDB | APINotify_ReceiveChanges,
+		ProjectEventHandler);
+	if (err == NoError)
+		err = ACAPI_Notification_CatchAttributeReplacement(AttributeReplacementHandler);
+	if (err == NoError) {
+		const API_ToolBoxItem allTypes = {};   // API_ZombieElemID — все типы
+		err = ACAPI_Notification_CatchDefaultChange(&allTypes, DefaultsChangeHandler);
+	}
+	return err;
+}
+
+} // namespace AttributeCache
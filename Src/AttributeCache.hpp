@@ -0,0 +1,80 @@
+// AttributeCache.hpp — списки атрибутов проекта (покрытия, строительные
+// материалы, слои) для палитр: читаются один раз, отдаются по const-ссылке,
+// поиск индекса по имени — хэш O(1). Сбрасываются по уведомлениям Archicad
+// (смена/открытие проекта, замена атрибутов) и при расхождении числа атрибутов.
+// Переименование или удаление с добавлением число не меняет: списки для палитры
+// перечитываются при каждом запросе (Reload), а позиция из палитры перед
+// использованием сверяется с проектом по индексу и имени (IsCurrent).
+#pragma once
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AttributeCache {
+
+struct Entry {
+	API_AttributeIndex index;   // настоящий индекс атрибута (не порядковый номер)
+	GS::UniString      name;
+};
+
+class Table {
+public:
+	explicit Table(API_AttrTypeID type) : m_type(type) {}
+
+	Table(const Table&) = delete;
+	Table& operator=(const Table&) = delete;
+
+	// Атрибуты в порядке индексов; ссылка действительна до следующего сброса
+	const std::vector<Entry>& GetEntries();
+
+	// Индекс по точному имени; false — такого атрибута нет. Найденный атрибут
+	// сверяется с проектом, при расхождении таблица перечитывается
+	bool FindIndex(const GS::UniString& name, API_AttributeIndex& outIndex);
+
+	// Атрибут в позиции position ещё есть в проекте под тем же именем
+	bool IsCurrent(UInt32 position);
+
+	// Номер загрузки: меняется при каждой перечитке — для производных кэшей
+	UInt32 GetGeneration();
+
+	void Invalidate() { m_valid = false; }
+
+	// Перечитать сейчас — перед выдачей списка в палитру
+	void Reload() { Invalidate(); EnsureLoaded(); }
+
+private:
+	void EnsureLoaded();
+
+	API_AttrTypeID                          m_type;
+	bool                                    m_valid = false;
+	UInt32                                  m_count = 0;        // ACAPI_Attribute_GetNum на момент загрузки
+	UInt32                                  m_generation = 0;
+	std::vector<Entry>                      m_entries;
+	std::unordered_map<std::string, UInt32> m_byName;           // имя (UTF-8) -> позиция в m_entries
+};
+
+// Покрытия (API_MaterialID — «Surfaces» в AC27)
+Table& Surfaces();
+// Строительные материалы
+Table& BuildingMaterials();
+// Слои
+Table& Layers();
+
+void InvalidateAll();
+
+// Номер сброса: растёт при каждом InvalidateAll и при смене умолчаний
+// инструментов. Для кэшей вне таблиц, которым нужны те же события
+// (умолчания элементов ElementBatch), — без обращения к API.
+UInt32 GetEpoch();
+
+// Подписка на уведомления проекта, замены атрибутов и смены умолчаний (из Initialize)
+GSErrCode RegisterNotifications();
+
+// Для add-on со своим обработчиком событий проекта — вызвать из него
+void OnProjectEvent(API_NotifyEventID notifID);
+
+} // namespace AttributeCache
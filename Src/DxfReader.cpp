@@ -0,0 +1,567 @@
+#include "DxfReader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace DxfReader {
+
+namespace {
+
+constexpr std::size_t kBufSize   = 1 << 16;
+constexpr std::size_t kValueMax  = 4096;   // строковое значение DXF — до 2049 символов
+constexpr std::size_t kLayerMax  = 256;
+
+// 18 символов + \r\n + 0x1A + 0x00
+constexpr char        kBinarySentinel[] = "AutoCAD Binary DXF\r\n\x1a";
+constexpr std::size_t kBinarySentinelLen = sizeof (kBinarySentinel);
+
+// =============================================================================
+// Буферизованный поток байтов
+// =============================================================================
+
+class Source {
+public:
+	explicit Source (std::FILE* f) : file (f), buf (new char[kBufSize]) {}
+
+	// Первые n байт файла (для распознавания формата); n <= kBufSize
+	bool Peek (std::size_t n)
+	{
+		if (len - pos < n) Fill ();
+		return len - pos >= n;
+	}
+	const char* Data () const { return buf.get () + pos; }
+	void        Skip (std::size_t n) { pos += n; }
+
+	int Get ()
+	{
+		if (pos == len && !Fill ()) return EOF;
+		return (unsigned char) buf[pos++];
+	}
+
+	bool Read (void* dst, std::size_t n)
+	{
+		char* out = static_cast<char*> (dst);
+		while (n > 0) {
+			if (pos == len && !Fill ()) return false;
+			const std::size_t k = std::min (n, len - pos);
+			std::memcpy (out, buf.get () + pos, k);
+			pos += k; out += k; n -= k;
+		}
+		return true;
+	}
+
+	// Строка без \r\n в dst (длиннее cap-1 — обрезается, хвост пропускается).
+	// false — конец файла до начала строки.
+	bool Line (char* dst, std::size_t cap, std::size_t& outLen)
+	{
+		outLen = 0;
+		if (pos == len && !Fill ()) return false;
+		for (;;) {
+			const char* beg = buf.get () + pos;
+			const char* nl  = static_cast<const char*> (std::memchr (beg, '\n', len - pos));
+			const std::size_t k = nl ? (std::size_t) (nl - beg) : len - pos;
+			const std::size_t take = std::min (k, cap - 1 - outLen);
+			std::memcpy (dst + outLen, beg, take);
+			outLen += take;
+			pos += k;
+			if (nl) { ++pos; break; }
+			if (!Fill ()) break;
+		}
+		if (outLen > 0 && dst[outLen - 1] == '\r') --outLen;
+		dst[outLen] = '\0';
+		return true;
+	}
+
+	std::uint64_t Consumed () const { return total - (len - pos); }
+
+private:
+	bool Fill ()
+	{
+		// недочитанный хвост — в начало буфера
+		const std::size_t rest = len - pos;
+		std::memmove (buf.get (), buf.get () + pos, rest);
+		const std::size_t got = std::fread (buf.get () + rest, 1, kBufSize - rest, file);
+		pos = 0;
+		len = rest + got;
+		total += got;
+		return got > 0;
+	}
+
+	std::FILE*              file;
+	std::unique_ptr<char[]> buf;
+	std::size_t             pos = 0, len = 0;
+	std::uint64_t           total = 0;
+};
+
+// =============================================================================
+// Разбор чисел без локали
+// =============================================================================
+
+double ParseReal (const char* s)
+{
+	static const double kPow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+									 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	while (*s == ' ' || *s == '\t') ++s;
+	bool neg = false;
+	if (*s == '-' || *s == '+') neg = (*s++ == '-');
+
+	std::uint64_t mant = 0;
+	int digits = 0, exp10 = 0;
+	for (; *s >= '0' && *s <= '9'; ++s) {
+		if (digits < 19) { mant = mant * 10 + (std::uint64_t) (*s - '0'); if (mant != 0) ++digits; }
+		else ++exp10;
+	}
+	if (*s == '.') {
+		for (++s; *s >= '0' && *s <= '9'; ++s) {
+			if (digits < 19) { mant = mant * 10 + (std::uint64_t) (*s - '0'); if (mant != 0) ++digits; --exp10; }
+		}
+	}
+	if (*s == 'e' || *s == 'E') {
+		++s;
+		bool eneg = false;
+		if (*s == '-' || *s == '+') eneg = (*s++ == '-');
+		int e = 0;
+		for (; *s >= '0' && *s <= '9'; ++s)
+			if (e < 10000) e = e * 10 + (*s - '0');
+		exp10 += eneg ? -e : e;
+	}
+
+	double v = (double) mant;
+	if (exp10 < 0) v = (exp10 >= -22) ? v / kPow10[-exp10] : v * std::pow (10.0, exp10);
+	else if (exp10 > 0) v = (exp10 <= 22) ? v * kPow10[exp10] : v * std::pow (10.0, exp10);
+	return neg ? -v : v;
+}
+
+// Копия с обрезкой по размеру dst
+void CopyName (char* dst, std::size_t cap, const char* src, std::size_t len)
+{
+	const std::size_t n = std::min (len, cap - 1);
+	std::memcpy (dst, src, n);
+	dst[n] = '\0';
+}
+
+bool ParseCode (const char* s, int& out)
+{
+	while (*s == ' ' || *s == '\t') ++s;
+	bool neg = false;
+	if (*s == '-') { neg = true; ++s; }
+	if (*s < '0' || *s > '9') return false;
+	int v = 0;
+	for (; *s >= '0' && *s <= '9'; ++s) v = v * 10 + (*s - '0');
+	while (*s == ' ' || *s == '\t') ++s;
+	if (*s != '\0') return false;
+	out = neg ? -v : v;
+	return true;
+}
+
+// =============================================================================
+// Группы «код — значение»
+// =============================================================================
+
+enum class ValueType { String, Real, Int16, Int32, Int64, Bool, Binary };
+
+// Тип значения по коду группы (двоичный DXF)
+ValueType TypeOf (int code)
+{
+	if (code >= 10   && code <= 59)   return ValueType::Real;
+	if (code >= 60   && code <= 79)   return ValueType::Int16;
+	if (code >= 90   && code <= 99)   return ValueType::Int32;
+	if (code >= 110  && code <= 149)  return ValueType::Real;
+	if (code >= 160  && code <= 169)  return ValueType::Int64;
+	if (code >= 170  && code <= 179)  return ValueType::Int16;
+	if (code >= 210  && code <= 239)  return ValueType::Real;
+	if (code >= 270  && code <= 289)  return ValueType::Int16;
+	if (code >= 290  && code <= 299)  return ValueType::Bool;
+	if (code >= 310  && code <= 319)  return ValueType::Binary;
+	if (code >= 370  && code <= 389)  return ValueType::Int16;
+	if (code >= 400  && code <= 409)  return ValueType::Int16;
+	if (code >= 420  && code <= 429)  return ValueType::Int32;
+	if (code >= 440  && code <= 459)  return ValueType::Int32;
+	if (code >= 460  && code <= 469)  return ValueType::Real;
+	if (code == 1004)                 return ValueType::Binary;
+	if (code >= 1010 && code <= 1059) return ValueType::Real;
+	if (code >= 1060 && code <= 1070) return ValueType::Int16;
+	if (code == 1071)                 return ValueType::Int32;
+	return ValueType::String;
+}
+
+class Groups {
+public:
+	Groups (Source& s, bool isBinary, bool wide) : src (s), binary (isBinary), wideCodes (wide) {}
+
+	// Следующая пара; false — конец файла (eof) или обрыв/мусор (error)
+	bool Next ()
+	{
+		return binary ? NextBinary () : NextAscii ();
+	}
+
+	int         Code () const   { return code; }
+	const char* Str () const    { return str; }
+	std::size_t StrLen () const { return strLen; }
+	// ASCII — разбор строки по требованию: у пропускаемых групп числа не разбираются
+	double      Real () const    { return binary ? real : ParseReal (str); }
+	int         Int () const     { return binary ? integer : (int) ParseReal (str); }
+
+	bool        Failed () const { return failed; }
+	const char* Error () const  { return error; }
+	std::uint64_t LineNo () const { return lineNo; }
+
+private:
+	bool NextAscii ()
+	{
+		// конец файла без EOF допустим, как и пустые строки в самом конце
+		std::size_t n = 0;
+		do {
+			if (!src.Line (str, kValueMax, n)) return false;
+			++lineNo;
+		} while (n == 0);
+		if (!ParseCode (str, code)) return Fail ("ожидался код группы");
+		if (!src.Line (str, kValueMax, strLen)) return Fail ("нет значения группы");
+		++lineNo;
+		return true;
+	}
+
+	bool NextBinary ()
+	{
+		int c0 = src.Get ();
+		if (c0 == EOF) return false;
+		if (wideCodes) {
+			const int c1 = src.Get ();
+			if (c1 == EOF) return Fail ("обрыв кода группы");
+			code = (std::int16_t) (std::uint16_t) (c0 | (c1 << 8));
+		} else if (c0 == 255) {
+			unsigned char b[2];
+			if (!src.Read (b, 2)) return Fail ("обрыв кода группы");
+			code = (std::int16_t) (std::uint16_t) (b[0] | (b[1] << 8));
+		} else {
+			code = c0;
+		}
+
+		str[0] = '\0';
+		strLen = 0;
+		integer = 0;
+		unsigned char b[8];
+		switch (TypeOf (code)) {
+		case ValueType::String: {
+			for (;;) {
+				const int c = src.Get ();
+				if (c == EOF) return Fail ("обрыв строки");
+				if (c == 0) break;
+				if (strLen + 1 < kValueMax) str[strLen++] = (char) c;
+			}
+			str[strLen] = '\0';
+			break;
+		}
+		case ValueType::Real:
+			if (!src.Read (b, 8)) return Fail ("обрыв числа");
+			{
+				std::uint64_t u = 0;
+				for (int k = 7; k >= 0; --k) u = (u << 8) | b[k];
+				std::memcpy (&real, &u, 8);
+			}
+			break;
+		case ValueType::Int16:
+			if (!src.Read (b, 2)) return Fail ("обрыв числа");
+			integer = (std::int16_t) (std::uint16_t) (b[0] | (b[1] << 8));
+			break;
+		case ValueType::Int32:
+			if (!src.Read (b, 4)) return Fail ("обрыв числа");
+			integer = (std::int32_t) ((std::uint32_t) b[0] | ((std::uint32_t) b[1] << 8) |
+									  ((std::uint32_t) b[2] << 16) | ((std::uint32_t) b[3] << 24));
+			break;
+		case ValueType::Int64:  if (!src.Read (b, 8)) return Fail ("обрыв числа"); break;
+		case ValueType::Bool:   if (!src.Read (b, 1)) return Fail ("обрыв числа"); break;
+		case ValueType::Binary: {
+			const int n = src.Get ();
+			if (n == EOF) return Fail ("обрыв двоичных данных");
+			for (int k = 0; k < n; ++k)
+				if (src.Get () == EOF) return Fail ("обрыв двоичных данных");
+			break;
+		}
+		}
+		return true;
+	}
+
+	bool Fail (const char* what)
+	{
+		failed = true;
+		error = what;
+		return false;
+	}
+
+	Source&       src;
+	const bool    binary;
+	const bool    wideCodes;
+	int           code = 0;
+	char          str[kValueMax] = {};
+	std::size_t   strLen = 0;
+	double        real = 0.0;
+	int           integer = 0;
+	bool          failed = false;
+	const char*   error = "";
+	std::uint64_t lineNo = 0;
+};
+
+// =============================================================================
+// Сущность
+// =============================================================================
+
+struct Entity {
+	EntityKind  kind = EntityKind::Point;
+	char        layer[kLayerMax] = {};
+	bool        hasLayer = false;
+	bool        wanted = true;
+	double      x = 0.0, y = 0.0, z = 0.0;
+	double      nx = 0.0, ny = 0.0, nz = 1.0;
+	std::string text;   // ёмкость переживает сущности — без выделений в установившемся режиме
+
+	bool IsText () const { return kind == EntityKind::Text || kind == EntityKind::MText || kind == EntityKind::Attrib; }
+	bool InOcs () const  { return kind != EntityKind::Point && kind != EntityKind::MText; }
+
+	void Reset (EntityKind k)
+	{
+		kind = k;
+		layer[0] = '\0';
+		hasLayer = false;
+		wanted = true;
+		x = y = z = 0.0;
+		nx = ny = 0.0; nz = 1.0;
+		text.clear ();
+	}
+};
+
+bool KindOf (const char* name, EntityKind& out)
+{
+	switch (name[0]) {
+	case 'A':
+		if (std::strcmp (name, "ARC") == 0)    { out = EntityKind::Arc;    return true; }
+		if (std::strcmp (name, "ATTRIB") == 0) { out = EntityKind::Attrib; return true; }
+		break;
+	case 'C':
+		if (std::strcmp (name, "CIRCLE") == 0) { out = EntityKind::Circle; return true; }
+		break;
+	case 'I':
+		if (std::strcmp (name, "INSERT") == 0) { out = EntityKind::Insert; return true; }
+		break;
+	case 'M':
+		if (std::strcmp (name, "MTEXT") == 0)  { out = EntityKind::MText;  return true; }
+		break;
+	case 'P':
+		if (std::strcmp (name, "POINT") == 0)  { out = EntityKind::Point;  return true; }
+		break;
+	case 'T':
+		if (std::strcmp (name, "TEXT") == 0)   { out = EntityKind::Text;   return true; }
+		break;
+	}
+	return false;
+}
+
+// OCS -> WCS по «произвольной оси» DXF: нормаль N = ось Z, ось X — Wy x N
+// (нормаль почти вдоль Z) или Wz x N
+void OcsToWcs (const Entity& e, double& x, double& y)
+{
+	x = e.x; y = e.y;
+	if (!e.InOcs () || (e.nx == 0.0 && e.ny == 0.0 && e.nz > 0.0))
+		return;
+	const double len = std::sqrt (e.nx * e.nx + e.ny * e.ny + e.nz * e.nz);
+	if (len < 1e-12) return;
+	const double az[3] = { e.nx / len, e.ny / len, e.nz / len };
+	double ax[3];
+	if (std::fabs (az[0]) < 1.0 / 64.0 && std::fabs (az[1]) < 1.0 / 64.0) {
+		ax[0] = az[2]; ax[1] = 0.0; ax[2] = -az[0];    // (0,1,0) x N
+	} else {
+		ax[0] = -az[1]; ax[1] = az[0]; ax[2] = 0.0;    // (0,0,1) x N
+	}
+	const double axLen = std::sqrt (ax[0] * ax[0] + ax[1] * ax[1] + ax[2] * ax[2]);
+	for (double& c : ax) c /= axLen;
+	const double ay[2] = { az[1] * ax[2] - az[2] * ax[1], az[2] * ax[0] - az[0] * ax[2] };
+	x = e.x * ax[0] + e.y * ay[0] + e.z * az[0];
+	y = e.x * ax[1] + e.y * ay[1] + e.z * az[1];
+}
+
+} // namespace
+
+// =============================================================================
+// Публичный API
+// =============================================================================
+
+bool SameName (const char* a, const char* b)
+{
+	for (;; ++a, ++b) {
+		char ca = *a, cb = *b;
+		if (ca >= 'a' && ca <= 'z') ca = (char) (ca - 'a' + 'A');
+		if (cb >= 'a' && cb <= 'z') cb = (char) (cb - 'a' + 'A');
+		if (ca != cb) return false;
+		if (ca == '\0') return true;
+	}
+}
+
+double UnitMeters (int insUnits)
+{
+	switch (insUnits) {
+	case 1:  return 0.0254;       // дюймы
+	case 2:  return 0.3048;       // футы
+	case 3:  return 1609.344;     // мили
+	case 4:  return 0.001;        // мм
+	case 5:  return 0.01;         // см
+	case 6:  return 1.0;          // м
+	case 7:  return 1000.0;       // км
+	case 8:  return 0.0254e-6;    // микродюймы
+	case 9:  return 0.0254e-3;    // милы
+	case 10: return 0.9144;       // ярды
+	case 11: return 1e-10;        // ангстремы
+	case 12: return 1e-9;         // нм
+	case 13: return 1e-6;         // мкм
+	case 14: return 0.1;          // дм
+	case 15: return 10.0;         // декаметры
+	case 16: return 100.0;        // гектометры
+	case 17: return 1e9;          // гигаметры
+	case 18: return 149597870700.0;   // астрономические единицы
+	case 19: return 9460730472580800.0;   // световые годы
+	case 20: return 3.0856775814913673e16;   // парсеки
+	case 21: return 1200.0 / 3937.0;   // геодезические футы США
+	default: return 0.0;
+	}
+}
+
+bool Read (std::FILE* f, Sink& sink, Stats* stats, std::string* error)
+{
+	if (f == nullptr) {
+		if (error) *error = "файл не открыт";
+		return false;
+	}
+
+	Source src (f);
+	bool binary = false, wide = false;
+	if (src.Peek (kBinarySentinelLen + 2) && std::memcmp (src.Data (), kBinarySentinel, kBinarySentinelLen) == 0) {
+		binary = true;
+		// первая группа — 0/"SECTION": в R13+ код занимает 2 байта (00 00 'S'), в R12 — 1 (00 'S')
+		wide = src.Data ()[kBinarySentinelLen + 1] == 0;
+		src.Skip (kBinarySentinelLen);
+	} else if (src.Peek (3) && std::memcmp (src.Data (), "\xEF\xBB\xBF", 3) == 0) {
+		src.Skip (3);
+	}
+
+	Groups g (src, binary, wide);
+	Stats  st;
+	st.binary = binary;
+
+	enum class Section { None, Header, Entities, Other };
+	Section section = Section::None;
+	bool    utf8 = false;
+	char    codepage[64] = {};
+	int     insUnits = 0;
+	char    headerVar[64] = {};
+	bool    headerSent = false;
+	bool    sawSection = false;
+
+	Entity cur;
+	bool   inEntity = false;
+	bool   stopped = false;
+
+	auto sendHeader = [&] () {
+		if (!headerSent) { sink.OnHeader (utf8, codepage, insUnits); headerSent = true; }
+	};
+
+	// Готовая сущность — приёмнику; false — приёмник попросил остановиться
+	auto flush = [&] () -> bool {
+		inEntity = false;
+		if (!cur.hasLayer) cur.wanted = sink.WantLayer ("0");
+		if (!cur.wanted) return true;
+		double x = 0.0, y = 0.0;
+		OcsToWcs (cur, x, y);
+		++st.delivered;
+		if (cur.IsText ())
+			return cur.text.empty () || sink.OnText (cur.kind, cur.layer, x, y, cur.text.c_str (), cur.text.size ());
+		return sink.OnPoint (cur.kind, cur.layer, x, y);
+	};
+
+	while (!stopped && g.Next ()) {
+		const int code = g.Code ();
+
+		if (code == 0) {
+			if (inEntity && !flush ()) { stopped = true; break; }
+			const char* v = g.Str ();
+			if (std::strcmp (v, "SECTION") == 0) {
+				sawSection = true;
+				if (!g.Next ()) break;
+				if (g.Code () != 2)                          section = Section::Other;
+				else if (SameName (g.Str (), "HEADER"))     section = Section::Header;
+				else if (SameName (g.Str (), "ENTITIES"))   { section = Section::Entities; sendHeader (); }
+				else                                         section = Section::Other;
+				continue;
+			}
+			if (std::strcmp (v, "ENDSEC") == 0) { section = Section::None; continue; }
+			if (std::strcmp (v, "EOF") == 0) break;
+			if (section == Section::Entities) {
+				++st.entities;
+				EntityKind kind;
+				if (KindOf (v, kind)) { cur.Reset (kind); inEntity = true; }
+			}
+			continue;
+		}
+
+		if (section == Section::Header) {
+			if (code == 9) {
+				CopyName (headerVar, sizeof (headerVar), g.Str (), g.StrLen ());
+			} else if (code == 1 && std::strcmp (headerVar, "$ACADVER") == 0) {
+				utf8 = std::strcmp (g.Str (), "AC1021") >= 0;
+			} else if (code == 3 && std::strcmp (headerVar, "$DWGCODEPAGE") == 0) {
+				CopyName (codepage, sizeof (codepage), g.Str (), g.StrLen ());
+			} else if (code == 70 && std::strcmp (headerVar, "$INSUNITS") == 0) {
+				insUnits = g.Int ();
+			}
+			continue;
+		}
+
+		// тело ненужной сущности — только чтение пар
+		if (!inEntity || !cur.wanted)
+			continue;
+
+		switch (code) {
+		case 8:
+			CopyName (cur.layer, kLayerMax, g.Str (), g.StrLen ());
+			cur.hasLayer = true;
+			cur.wanted = sink.WantLayer (cur.layer);
+			break;
+		case 10:  cur.x = g.Real ();  break;
+		case 20:  cur.y = g.Real ();  break;
+		case 30:  cur.z = g.Real ();  break;
+		case 210: cur.nx = g.Real (); break;
+		case 220: cur.ny = g.Real (); break;
+		case 230: cur.nz = g.Real (); break;
+		case 1:
+			if (cur.IsText ()) cur.text.append (g.Str (), g.StrLen ());
+			break;
+		case 3:
+			// MTEXT: куски по 250 символов перед последним (код 1)
+			if (cur.kind == EntityKind::MText) cur.text.append (g.Str (), g.StrLen ());
+			break;
+		}
+	}
+
+	if (!stopped && !g.Failed () && inEntity)
+		flush ();
+
+	st.bytes = src.Consumed ();
+	if (stats) *stats = st;
+
+	if (g.Failed ()) {
+		if (error) {
+			char buf[160];
+			if (binary) std::snprintf (buf, sizeof (buf), "DXF: %s (байт %llu)", g.Error (), (unsigned long long) st.bytes);
+			else        std::snprintf (buf, sizeof (buf), "DXF: %s (строка %llu)", g.Error (), (unsigned long long) g.LineNo ());
+			*error = buf;
+		}
+		return false;
+	}
+	if (!sawSection) {
+		if (error) *error = "DXF: нет ни одной секции — не DXF?";
+		return false;
+	}
+	return true;
+}
+
+} // namespace DxfReader
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace DxfReader {
+
+// Потоковое чтение DXF (ASCII и двоичный, R12 и R13+) без импорта в Archicad:
+// файл идёт блоками фиксированного буфера, из секции ENTITIES разбираются только
+// точки (центры ARC/CIRCLE, POINT, точки вставки INSERT) и надписи
+// (TEXT/MTEXT/ATTRIB). Тела остальных сущностей и сущностей чужих слоёв
+// пропускаются без разбора чисел и без выделений памяти; блоки (BLOCKS) не
+// раскрываются.
+
+enum class EntityKind { Arc, Circle, Point, Insert, Text, MText, Attrib };
+
+// Приёмник сущностей. Строки — байты файла как есть (кодировка — OnHeader),
+// координаты — в мировой системе (OCS пересчитана по нормали 210/220/230).
+class Sink {
+public:
+	virtual ~Sink () = default;
+
+	// Кодировка строк: utf8 — $ACADVER >= AC1021 (R2007), иначе кодовая
+	// страница $DWGCODEPAGE (например, "ANSI_1251"). insUnits — $INSUNITS
+	// (0 — не задано или без единиц; см. UnitMeters). Вызывается один раз до сущностей.
+	virtual void OnHeader (bool /*utf8*/, const char* /*codepage*/, int /*insUnits*/) {}
+
+	// Нужен ли слой; false — тело сущности пропускается
+	virtual bool WantLayer (const char* layer) = 0;
+
+	// false — прекратить чтение (файл дальше не читается)
+	virtual bool OnPoint (EntityKind kind, const char* layer, double x, double y) = 0;
+	virtual bool OnText (EntityKind kind, const char* layer, double x, double y, const char* text, std::size_t len) = 0;
+};
+
+struct Stats {
+	bool          binary   = false;
+	std::uint32_t entities = 0;   // всего сущностей в ENTITIES
+	std::uint32_t delivered = 0;  // передано приёмнику
+	std::uint64_t bytes    = 0;   // прочитано из файла
+};
+
+// f открыт в двоичном режиме. false — не DXF или файл оборван посреди
+// группы; error — описание для лога.
+bool Read (std::FILE* f, Sink& sink, Stats* stats = nullptr, std::string* error = nullptr);
+
+// Имена слоёв и секций DXF сравниваются без учёта регистра (ASCII)
+bool SameName (const char* a, const char* b);
+
+// Единица $INSUNITS в метрах; 0 — без единиц или неизвестный код
+double UnitMeters (int insUnits);
+
+} // namespace DxfReader
@@ -0,0 +1,377 @@
+#include "LabelPattern.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+namespace LabelPattern {
+
+namespace {
+
+// Целые как в GS, без GSRoot: модуль собирается и в тестах
+using UInt32 = std::uint32_t;
+using Int32  = std::int32_t;
+
+// Классы символов: 0 — прочие, 1 — цифры, 2 — пробельные (кроме явных
+// символов шаблона), далее — по одному на каждый явный символ
+const UInt32 kOtherClass        = 0;
+const UInt32 kDigitClass        = 1;
+const UInt32 kSpaceClass        = 2;
+const UInt32 kFirstLiteralClass = 3;
+
+const UInt32 kMaxAlternatives = 32;    // маски альтернатив — UInt32
+const UInt32 kMaxStates       = 1024;
+
+const UInt32 kMinusSign = 0x2212;      // «−»
+const UInt32 kPlusMinus = 0x00B1;      // «±»
+
+inline bool IsDigit (UInt32 c) { return c >= '0' && c <= '9'; }
+inline bool IsSpace (UInt32 c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == 0x00A0; }
+inline bool IsSign  (UInt32 c) { return c == '+' || c == '-' || c == kMinusSign || c == kPlusMinus; }
+
+// Без учёта регистра: латиница и кириллица (с «ё»)
+inline UInt32 Fold (UInt32 c)
+{
+	if (c >= 'A' && c <= 'Z')       return c + 0x20;
+	if (c >= 0x0410 && c <= 0x042F) return c + 0x20;
+	if (c == 0x0401)                return 0x0451;
+	return c;
+}
+
+enum class TokenKind { Literal, Any, Space, Number, Tail };
+
+struct Token {
+	TokenKind kind;
+	UInt32    ch = 0;
+};
+
+// Условие перехода НКА
+enum class EdgeKind { Literal, Any, Space, Digit, Sign, Sep };
+
+struct Edge {
+	EdgeKind kind;
+	UInt32   ch;
+	Int32    to;
+};
+
+struct NfaState {
+	std::vector<Edge>  edges;
+	std::vector<Int32> eps;
+	UInt32             alt    = 0;
+	bool               number = false;   // вход только по символу числа
+	bool               final  = false;
+};
+
+struct Nfa {
+	std::vector<NfaState> states;
+
+	Int32 Add (UInt32 alt, bool number = false)
+	{
+		states.emplace_back ();
+		states.back ().alt = alt;
+		states.back ().number = number;
+		return (Int32) states.size () - 1;
+	}
+
+	void Link (Int32 from, EdgeKind kind, Int32 to, UInt32 ch = 0)
+	{
+		states[from].edges.push_back ({ kind, ch, to });
+	}
+};
+
+void Closure (const Nfa& nfa, std::vector<Int32>& set)
+{
+	std::vector<bool> seen (nfa.states.size (), false);
+	for (Int32 s : set) seen[s] = true;
+	for (std::size_t i = 0; i < set.size (); ++i) {
+		for (Int32 t : nfa.states[set[i]].eps) {
+			if (seen[t]) continue;
+			seen[t] = true;
+			set.push_back (t);
+		}
+	}
+	std::sort (set.begin (), set.end ());
+}
+
+std::string AltError (const char* what, UInt32 alt)
+{
+	char buf[160];
+	std::snprintf (buf, sizeof (buf), "%s (альтернатива %u)", what, (unsigned) alt + 1);
+	return buf;
+}
+
+// Разбор текста шаблона на альтернативы из токенов
+bool Tokenize (const std::uint16_t* p, std::size_t len, std::vector<std::vector<Token>>& alts, std::string* error)
+{
+	auto fail = [&] (const char* what) {
+		if (error != nullptr) *error = AltError (what, (UInt32) alts.size () - 1);
+		return false;
+	};
+
+	alts.emplace_back ();
+	for (std::size_t i = 0; i < len; ++i) {
+		const UInt32 c = p[i];
+		std::vector<Token>& cur = alts.back ();
+		if (!cur.empty () && cur.back ().kind == TokenKind::Tail && c != '|')
+			return fail ("«*» допустим только в конце");
+
+		switch (c) {
+		case '|':
+			alts.emplace_back ();
+			if (alts.size () > kMaxAlternatives)
+				return fail ("слишком много альтернатив");
+			break;
+		case '#': cur.push_back ({ TokenKind::Number }); break;
+		case '?': cur.push_back ({ TokenKind::Any }); break;
+		case '*': cur.push_back ({ TokenKind::Tail }); break;
+		case '\\':
+			if (++i == len)
+				return fail ("«\\» в конце шаблона");
+			cur.push_back ({ TokenKind::Literal, Fold (p[i]) });
+			break;
+		default:
+			// пробелы подряд — один токен «ноль или больше»
+			if (IsSpace (c)) {
+				if (cur.empty () || cur.back ().kind != TokenKind::Space)
+					cur.push_back ({ TokenKind::Space });
+			} else {
+				cur.push_back ({ TokenKind::Literal, Fold (c) });
+			}
+			break;
+		}
+	}
+
+	for (std::size_t a = 0; a < alts.size (); ++a) {
+		const std::vector<Token>& tokens = alts[a];
+		std::size_t numbers = 0, numberAt = 0;
+		for (std::size_t t = 0; t < tokens.size (); ++t)
+			if (tokens[t].kind == TokenKind::Number) { ++numbers; numberAt = t; }
+		if (numbers != 1) {
+			if (error != nullptr) *error = AltError ("нужно ровно одно «#»", (UInt32) a);
+			return false;
+		}
+		// Граница числа по ДКА — по последнему символу числа, поэтому сразу
+		// за ним (через пробелы) не должно быть того, что число продолжит
+		std::size_t t = numberAt + 1;
+		while (t < tokens.size () && tokens[t].kind == TokenKind::Space) ++t;
+		if (t < tokens.size () && (tokens[t].kind == TokenKind::Any ||
+			(tokens[t].kind == TokenKind::Literal && (IsDigit (tokens[t].ch) || IsSign (tokens[t].ch) || tokens[t].ch == '.' || tokens[t].ch == ','))))
+		{
+			if (error != nullptr) *error = AltError ("после «#» не может идти «?», цифра, знак или разделитель", (UInt32) a);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Альтернатива -> цепочка состояний НКА от start
+void BuildAlternative (Nfa& nfa, Int32 start, UInt32 alt, const std::vector<Token>& tokens)
+{
+	Int32 cur = nfa.Add (alt);
+	nfa.states[start].eps.push_back (cur);
+
+	for (const Token& tok : tokens) {
+		switch (tok.kind) {
+		case TokenKind::Literal:
+		case TokenKind::Any: {
+			const Int32 t = nfa.Add (alt);
+			nfa.Link (cur, tok.kind == TokenKind::Any ? EdgeKind::Any : EdgeKind::Literal, t, tok.ch);
+			cur = t;
+			break;
+		}
+		case TokenKind::Space:
+			nfa.Link (cur, EdgeKind::Space, cur);
+			break;
+		case TokenKind::Tail:
+			nfa.Link (cur, EdgeKind::Any, cur);
+			break;
+		case TokenKind::Number: {
+			// [знак] цифры [разделитель цифры*] | [знак] разделитель цифры
+			const Int32 sign  = nfa.Add (alt, true);
+			const Int32 whole = nfa.Add (alt, true);
+			const Int32 dot   = nfa.Add (alt, true);
+			const Int32 frac  = nfa.Add (alt, true);
+			const Int32 exit  = nfa.Add (alt);
+			nfa.Link (cur,   EdgeKind::Sign,  sign);
+			nfa.Link (cur,   EdgeKind::Digit, whole);
+			nfa.Link (cur,   EdgeKind::Sep,   dot);
+			nfa.Link (sign,  EdgeKind::Digit, whole);
+			nfa.Link (sign,  EdgeKind::Sep,   dot);
+			nfa.Link (whole, EdgeKind::Digit, whole);
+			nfa.Link (whole, EdgeKind::Sep,   frac);
+			nfa.Link (dot,   EdgeKind::Digit, frac);
+			nfa.Link (frac,  EdgeKind::Digit, frac);
+			nfa.states[whole].eps.push_back (exit);
+			nfa.states[frac].eps.push_back (exit);
+			cur = exit;
+			break;
+		}
+		}
+	}
+	nfa.states[cur].final = true;
+}
+
+} // namespace
+
+UInt32 Matcher::ClassOf (UInt32 ch) const
+{
+	if (ch < 128)
+		return asciiClass[ch];
+	const UInt32 c = Fold (ch);
+	const auto it = std::lower_bound (literalChars.begin (), literalChars.end (), c);
+	if (it != literalChars.end () && *it == c)
+		return kFirstLiteralClass + (UInt32) (it - literalChars.begin ());
+	return IsSpace (c) ? kSpaceClass : kOtherClass;
+}
+
+bool Matcher::Compile (const std::uint16_t* pattern, std::size_t len, char separator, std::string* error)
+{
+	sep = separator;
+	altCount = 0;
+	next.clear ();
+	acceptMask.clear ();
+	numberMask.clear ();
+
+	std::vector<std::vector<Token>> alts;
+	if (!Tokenize (pattern, len, alts, error))
+		return false;
+	altCount = (UInt32) alts.size ();
+
+	// Явные символы: литералы, разделитель и знаки — каждый свой класс
+	literalChars.assign ({ (UInt32) '+', (UInt32) '-', kMinusSign, kPlusMinus, (UInt32) (unsigned char) sep });
+	for (const std::vector<Token>& tokens : alts)
+		for (const Token& tok : tokens)
+			if (tok.kind == TokenKind::Literal) literalChars.push_back (tok.ch);
+	std::sort (literalChars.begin (), literalChars.end ());
+	literalChars.erase (std::unique (literalChars.begin (), literalChars.end ()), literalChars.end ());
+	classCount = kFirstLiteralClass + (UInt32) literalChars.size ();
+
+	for (UInt32 c = 0; c < 128; ++c) {
+		const UInt32 f = Fold (c);
+		const auto it = std::lower_bound (literalChars.begin (), literalChars.end (), f);
+		if (it != literalChars.end () && *it == f) asciiClass[c] = kFirstLiteralClass + (UInt32) (it - literalChars.begin ());
+		else if (IsDigit (c))                      asciiClass[c] = kDigitClass;
+		else if (IsSpace (c))                      asciiClass[c] = kSpaceClass;
+		else                                       asciiClass[c] = kOtherClass;
+	}
+
+	Nfa nfa;
+	const Int32 start = nfa.Add (0);
+	for (UInt32 a = 0; a < altCount; ++a)
+		BuildAlternative (nfa, start, a, alts[a]);
+
+	auto accepts = [&] (const Edge& e, UInt32 cls) {
+		const bool   literal = cls >= kFirstLiteralClass;
+		const UInt32 ch      = literal ? literalChars[cls - kFirstLiteralClass] : 0;
+		switch (e.kind) {
+		case EdgeKind::Any:     return true;
+		case EdgeKind::Literal: return literal && ch == e.ch;
+		case EdgeKind::Space:   return cls == kSpaceClass || (literal && IsSpace (ch));
+		case EdgeKind::Digit:   return cls == kDigitClass || (literal && IsDigit (ch));
+		case EdgeKind::Sign:    return literal && IsSign (ch);
+		case EdgeKind::Sep:     return literal && ch == (UInt32) (unsigned char) sep;
+		}
+		return false;
+	};
+
+	// Построение подмножеств
+	std::map<std::vector<Int32>, Int32> index;
+	std::vector<std::vector<Int32>>     sets;
+	auto intern = [&] (std::vector<Int32>& set) -> Int32 {
+		if (set.empty ()) return -1;
+		Closure (nfa, set);
+		const auto it = index.find (set);
+		if (it != index.end ()) return it->second;
+		const Int32 id = (Int32) sets.size ();
+		UInt32 acc = 0, num = 0;
+		for (Int32 s : set) {
+			if (nfa.states[s].final)  acc |= 1u << nfa.states[s].alt;
+			if (nfa.states[s].number) num |= 1u << nfa.states[s].alt;
+		}
+		index.emplace (set, id);
+		sets.push_back (set);
+		acceptMask.push_back (acc);
+		numberMask.push_back (num);
+		return id;
+	};
+
+	std::vector<Int32> init = { start };
+	intern (init);
+	for (std::size_t d = 0; d < sets.size (); ++d) {
+		if (sets.size () > kMaxStates) {
+			if (error != nullptr) *error = "шаблон слишком сложный";
+			return false;
+		}
+		next.resize (sets.size () * classCount, -1);
+		for (UInt32 cls = 0; cls < classCount; ++cls) {
+			std::vector<Int32> target;
+			for (Int32 s : sets[d])
+				for (const Edge& e : nfa.states[s].edges)
+					if (accepts (e, cls)) target.push_back (e.to);
+			std::sort (target.begin (), target.end ());
+			target.erase (std::unique (target.begin (), target.end ()), target.end ());
+			// sets может переразместиться внутри intern — индекс, а не ссылка
+			const Int32 to = intern (target);
+			next[d * classCount + cls] = to;
+		}
+	}
+	next.resize (sets.size () * classCount, -1);
+	return true;
+}
+
+bool Matcher::Match (const std::uint16_t* p, std::size_t len, double& outMm) const
+{
+	if (next.empty ())
+		return false;
+
+	std::size_t b = 0, e = len;
+	while (b < e && IsSpace (p[b])) ++b;
+	while (e > b && IsSpace (p[e - 1])) --e;
+
+	// Границы числа по альтернативам: первый и последний прочитанный символ числа
+	Int32 numBeg[kMaxAlternatives], numEnd[kMaxAlternatives];
+	std::fill (numBeg, numBeg + altCount, -1);
+
+	Int32 s = 0;
+	for (std::size_t i = b; i < e; ++i) {
+		s = next[(std::size_t) s * classCount + ClassOf (p[i])];
+		if (s < 0)
+			return false;
+		for (UInt32 m = numberMask[s], a = 0; m != 0; m >>= 1, ++a) {
+			if ((m & 1) == 0) continue;
+			if (numBeg[a] < 0) numBeg[a] = (Int32) i;
+			numEnd[a] = (Int32) i + 1;
+		}
+	}
+
+	UInt32 acc = acceptMask[s], a = 0;
+	if (acc == 0)
+		return false;
+	while ((acc & 1) == 0) { acc >>= 1; ++a; }
+
+	// Число: все цифры — в одну мантиссу, затем одно деление на 10^n
+	bool   neg = false, frac = false;
+	double mant = 0.0;
+	int    fracDigits = 0;
+	for (Int32 i = numBeg[a]; i < numEnd[a]; ++i) {
+		const UInt32 c = p[i];
+		if (IsDigit (c)) {
+			mant = mant * 10.0 + (double) (c - '0');
+			if (frac) ++fracDigits;
+		} else if (c == '-' || c == kMinusSign) {
+			neg = true;
+		} else if (c == (UInt32) (unsigned char) sep) {
+			frac = true;
+		}
+	}
+	static const double kPow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+		1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	double val = mant;
+	for (; fracDigits > 22; fracDigits -= 22) val /= kPow10[22];
+	val /= kPow10[fracDigits];
+
+	outMm = (neg ? -val : val) * 1000.0;
+	return true;
+}
+
+} // namespace LabelPattern
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace LabelPattern {
+
+// Формат надписи-отметки. Одна или несколько альтернатив через '|':
+//   #       — число: знак (+ - − ±), цифры, разделитель из настроек, цифры;
+//             захватывается, ровно одно в альтернативе
+//   ?       — любой один символ (например, «▲»)
+//   пробел  — ноль или больше пробельных символов
+//   *       — любой хвост (только в конце альтернативы)
+//   \x      — символ x буквально (\#  \?  \*  \|  \\)
+//   прочее  — сам символ, без учёта регистра (латиница, кириллица)
+// Пример: "#|ур. #|H=#|# м|?#". Надпись сравнивается целиком (без пробелов
+// по краям); подошло несколько альтернатив — берётся первая.
+//
+// Шаблон один раз компилируется в ДКА над классами символов; разбор надписи —
+// один проход по символам: переход по таблице и отметка границ числа.
+// Шаблон и надпись — единицы UTF-16 (GS::UniChar), длины — в единицах.
+class Matcher {
+public:
+	// false — ошибка в шаблоне (error — описание для пользователя, UTF-8)
+	bool Compile (const std::uint16_t* pattern, std::size_t len, char separator, std::string* error = nullptr);
+
+	// Отметка в мм; false — надпись не подходит ни под одну альтернативу
+	bool Match (const std::uint16_t* text, std::size_t len, double& outMm) const;
+
+	std::uint32_t GetStateCount () const { return (std::uint32_t) acceptMask.size (); }
+
+private:
+	std::uint32_t ClassOf (std::uint32_t ch) const;
+
+	char                        sep = '.';
+	std::uint32_t               altCount = 0;
+	std::uint32_t               classCount = 0;
+	std::uint32_t               asciiClass[128] = {};
+	std::vector<std::uint32_t>  literalChars;   // отсортированы; класс литерала = индекс + kFirstLiteralClass
+	std::vector<std::int32_t>   next;           // [состояние * classCount + класс], -1 — тупик
+	std::vector<std::uint32_t>  acceptMask;     // альтернативы, принимающие в состоянии
+	std::vector<std::uint32_t>  numberMask;     // альтернативы, только что прочитавшие символ числа
+};
+
+} // namespace LabelPattern
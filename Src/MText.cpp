@@ -0,0 +1,184 @@
+#include "MText.hpp"
+
+namespace MText {
+
+namespace {
+
+// Код символа без знака: байт UTF-8 или единица UTF-16
+inline unsigned Unit (char c)          { return (unsigned char) c; }
+inline unsigned Unit (std::uint16_t c) { return c; }
+
+inline int HexValue (unsigned c)
+{
+	if (c >= '0' && c <= '9') return (int) (c - '0');
+	if (c >= 'A' && c <= 'F') return (int) (c - 'A' + 10);
+	if (c >= 'a' && c <= 'f') return (int) (c - 'a' + 10);
+	return -1;
+}
+
+inline bool IsDigit (unsigned c) { return c >= '0' && c <= '9'; }
+
+// Код, дающий символ: 0 оборвал бы строку, одиночная половинка суррогатной
+// пары — неверный UTF-8 и неполная пара в UTF-16
+inline bool IsCharCode (unsigned cp) { return cp != 0 && (cp < 0xD800 || cp > 0xDFFF); }
+
+// Кодовая точка до U+FFFF -> UTF-8 (1..3 байта)
+inline std::size_t Encode (unsigned cp, char* out)
+{
+	if (cp < 0x80) {
+		out[0] = (char) cp;
+		return 1;
+	}
+	if (cp < 0x800) {
+		out[0] = (char) (0xC0 | (cp >> 6));
+		out[1] = (char) (0x80 | (cp & 0x3F));
+		return 2;
+	}
+	out[0] = (char) (0xE0 | (cp >> 12));
+	out[1] = (char) (0x80 | ((cp >> 6) & 0x3F));
+	out[2] = (char) (0x80 | (cp & 0x3F));
+	return 3;
+}
+
+// -> UTF-16: все коды MTEXT дают символы BMP, одна единица
+inline std::size_t Encode (unsigned cp, std::uint16_t* out)
+{
+	out[0] = (std::uint16_t) cp;
+	return 1;
+}
+
+template <typename Char>
+std::size_t StripImpl (const Char* src, std::size_t len, Char* dst, std::size_t cap)
+{
+	if (cap == 0)
+		return 0;
+
+	// Запись всегда не правее чтения: каждый код даёт не больше байт, чем занимает
+	const std::size_t limit = cap - 1;
+	std::size_t i = 0, o = 0;
+
+	auto put = [&] (Char c) {
+		if (o < limit) dst[o++] = c;
+	};
+	auto putCodePoint = [&] (unsigned cp) {
+		Char buf[3];
+		const std::size_t n = Encode (cp, buf);
+		for (std::size_t k = 0; k < n; ++k) put (buf[k]);
+	};
+
+	while (i < len) {
+		const unsigned c = Unit (src[i]);
+
+		if (c == '{' || c == '}') {
+			++i;
+			continue;
+		}
+
+		if (c == '%' && i + 2 < len && Unit (src[i + 1]) == '%') {
+			const unsigned k = Unit (src[i + 2]);
+			switch (k) {
+			case 'd': case 'D': putCodePoint (0x00B0); i += 3; continue;
+			case 'p': case 'P': putCodePoint (0x00B1); i += 3; continue;
+			case 'c': case 'C': putCodePoint (0x2300); i += 3; continue;
+			case 'o': case 'O':
+			case 'u': case 'U':
+			case 'k': case 'K': i += 3; continue;
+			case '%':           put (src[i]); i += 3; continue;
+			default:
+				if (i + 4 < len && IsDigit (k) && IsDigit (Unit (src[i + 3])) && IsDigit (Unit (src[i + 4]))) {
+					const unsigned cp = (k - '0') * 100 + (Unit (src[i + 3]) - '0') * 10 + (Unit (src[i + 4]) - '0');
+					if (IsCharCode (cp)) {
+						putCodePoint (cp);
+						i += 5;
+						continue;
+					}
+				}
+				break;
+			}
+		}
+
+		if (c == '\\' && i + 1 < len) {
+			const unsigned k = Unit (src[i + 1]);
+			switch (k) {
+			case 'P': case 'N': case 'X':
+				put ((Char) '\n');
+				i += 2;
+				continue;
+			case '~':
+				put ((Char) ' ');
+				i += 2;
+				continue;
+			case 'L': case 'l': case 'O': case 'o': case 'K': case 'k':
+				i += 2;
+				continue;
+			case 'f': case 'F': case 'H': case 'W': case 'Q': case 'T':
+			case 'A': case 'C': case 'c': case 'p':
+				// код с аргументом до ';'
+				i += 2;
+				while (i < len && Unit (src[i]) != ';') ++i;
+				if (i < len) ++i;
+				continue;
+			case 'S':
+				// дробь: верх и низ через ^ / #, экранирование — обратной косой
+				i += 2;
+				while (i < len && Unit (src[i]) != ';') {
+					const unsigned s = Unit (src[i]);
+					if (s == '\\' && i + 1 < len) {
+						put (src[i + 1]);
+						i += 2;
+						continue;
+					}
+					put ((s == '^' || s == '#') ? (Char) '/' : src[i]);
+					++i;
+				}
+				if (i < len) ++i;
+				continue;
+			case 'U':
+				if (i + 6 < len && Unit (src[i + 2]) == '+') {
+					const int h0 = HexValue (Unit (src[i + 3])), h1 = HexValue (Unit (src[i + 4]));
+					const int h2 = HexValue (Unit (src[i + 5])), h3 = HexValue (Unit (src[i + 6]));
+					const unsigned cp = (unsigned) ((h0 << 12) | (h1 << 8) | (h2 << 4) | h3);
+					if ((h0 | h1 | h2 | h3) >= 0 && IsCharCode (cp)) {
+						putCodePoint (cp);
+						i += 7;
+						continue;
+					}
+				}
+				break;
+			case 'M':
+				// \M+NXXXX — многобайтовый символ кодовой страницы N, для чисел не нужен
+				if (i + 7 < len && Unit (src[i + 2]) == '+') {
+					i += 8;
+					continue;
+				}
+				break;
+			default:
+				break;
+			}
+			// \\ \{ \} и неизвестные коды — символ после обратной косой как есть
+			put (src[i + 1]);
+			i += 2;
+			continue;
+		}
+
+		put (src[i]);
+		++i;
+	}
+
+	dst[o] = 0;
+	return o;
+}
+
+} // namespace
+
+std::size_t Strip (const char* src, std::size_t len, char* dst, std::size_t cap)
+{
+	return StripImpl (src, len, dst, cap);
+}
+
+std::size_t Strip (const std::uint16_t* src, std::size_t len, std::uint16_t* dst, std::size_t cap)
+{
+	return StripImpl (src, len, dst, cap);
+}
+
+} // namespace MText
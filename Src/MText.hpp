@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MText {
+
+// Снимает коды форматирования MTEXT/TEXT за один проход без выделений памяти:
+//   {…}  \f…; \F…; \H…; \W…; \Q…; \T…; \A…; \C…; \c…; \p…;  — убираются,
+//   \L \l \O \o \K \k — убираются, \P \N \X — перевод строки, \~ — пробел,
+//   \\ \{ \} — сам символ, \S a^b; / \S a/b; / \S a#b; — «a/b»,
+//   \U+XXXX — символ в UTF-8, \M+NXXXX — убирается,
+//   %%d %%p %%c — «°», «±», «⌀» (UTF-8), %%nnn — символ с кодом nnn,
+//   %%o %%u %%k — убираются, %%% — «%».
+// Код 0 и половинки суррогатных пар (\U+D800…\U+DFFF) символа не дают —
+// такие последовательности остаются текстом, как неизвестные коды.
+// Результат никогда не длиннее исходного, поэтому dst может совпадать с src
+// (очистка на месте). Пишет не больше cap-1 байт и завершающий 0; возвращает длину.
+// Вход — UTF-8: в однобайтовой кодовой странице «°» и прочие коды были бы
+// неверными байтами, такой текст сначала перекодируется и чистится в UTF-16.
+std::size_t Strip (const char* src, std::size_t len, char* dst, std::size_t cap);
+
+// То же над единицами UTF-16 (GS::UniChar): символы кодов — одной единицей.
+// Длины и cap — в единицах.
+std::size_t Strip (const std::uint16_t* src, std::size_t len, std::uint16_t* dst, std::size_t cap);
+
+} // namespace MText
@@ -0,0 +1,223 @@
+#include "NearestKernel.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define NEAREST_KERNEL_X64 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+	#if defined(__GNUC__) || defined(__clang__)
+		#define NEAREST_KERNEL_TARGET_AVX2 __attribute__ ((target ("avx2")))
+	#else
+		#define NEAREST_KERNEL_TARGET_AVX2
+	#endif
+#endif
+
+namespace NearestKernel {
+
+namespace {
+
+// Начальное значение минимума: чуть больше maxD2, чтобы условие «d2 <= maxD2»
+// свелось к одному строгому сравнению «d2 < best» во всех реализациях.
+inline float InitialBest (float maxD2)
+{
+	return std::nextafter (maxD2, std::numeric_limits<float>::infinity ());
+}
+
+#if defined(NEAREST_KERNEL_X64)
+
+// Свёртка покомпонентных минимумов: меньшее d2, при равенстве — меньший индекс.
+inline std::size_t ReduceLanes (const float* laneD2, const std::int32_t* laneIdx, int lanes, float& best)
+{
+	std::size_t bestIdx = kNone;
+	for (int k = 0; k < lanes; ++k) {
+		if (laneIdx[k] < 0) continue;
+		const std::size_t idx = (std::size_t) laneIdx[k];
+		if (laneD2[k] < best || (laneD2[k] == best && idx < bestIdx)) {
+			best    = laneD2[k];
+			bestIdx = idx;
+		}
+	}
+	return bestIdx;
+}
+
+// Хвост после векторной части: индексы больше всех уже просмотренных,
+// поэтому строгое «<» сохраняет правило «меньший индекс при равенстве».
+inline std::size_t ScanTail (const float* xs, const float* ys, std::size_t i, std::size_t n,
+							 float qx, float qy, float& best, std::size_t bestIdx)
+{
+	for (; i < n; ++i) {
+		const float dx = xs[i] - qx;
+		const float dy = ys[i] - qy;
+		const float d2 = dx * dx + dy * dy;
+		if (d2 < best) { best = d2; bestIdx = i; }
+	}
+	return bestIdx;
+}
+
+std::size_t FindNearestSSE2 (const float* xs, const float* ys, std::size_t n,
+							 float qx, float qy, float maxD2, float& outD2)
+{
+	const float init = InitialBest (maxD2);
+
+	const __m128  vqx   = _mm_set1_ps (qx);
+	const __m128  vqy   = _mm_set1_ps (qy);
+	const __m128i vstep = _mm_set1_epi32 (4);
+	__m128  vbest    = _mm_set1_ps (init);
+	__m128i vbestIdx = _mm_set1_epi32 (-1);
+	__m128i vidx     = _mm_setr_epi32 (0, 1, 2, 3);
+
+	std::size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m128 dx = _mm_sub_ps (_mm_loadu_ps (xs + i), vqx);
+		const __m128 dy = _mm_sub_ps (_mm_loadu_ps (ys + i), vqy);
+		const __m128 d2 = _mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy));
+		const __m128 lt = _mm_cmplt_ps (d2, vbest);
+		const __m128i lti = _mm_castps_si128 (lt);
+		vbest    = _mm_or_ps (_mm_and_ps (lt, d2), _mm_andnot_ps (lt, vbest));
+		vbestIdx = _mm_or_si128 (_mm_and_si128 (lti, vidx), _mm_andnot_si128 (lti, vbestIdx));
+		vidx     = _mm_add_epi32 (vidx, vstep);
+	}
+
+	alignas (16) float        laneD2[4];
+	alignas (16) std::int32_t laneIdx[4];
+	_mm_store_ps (laneD2, vbest);
+	_mm_store_si128 (reinterpret_cast<__m128i*> (laneIdx), vbestIdx);
+
+	float best = init;
+	std::size_t bestIdx = ReduceLanes (laneD2, laneIdx, 4, best);
+	bestIdx = ScanTail (xs, ys, i, n, qx, qy, best, bestIdx);
+
+	if (bestIdx != kNone) outD2 = best;
+	return bestIdx;
+}
+
+NEAREST_KERNEL_TARGET_AVX2
+std::size_t FindNearestAVX2 (const float* xs, const float* ys, std::size_t n,
+							 float qx, float qy, float maxD2, float& outD2)
+{
+	const float init = InitialBest (maxD2);
+
+	const __m256  vqx   = _mm256_set1_ps (qx);
+	const __m256  vqy   = _mm256_set1_ps (qy);
+	const __m256i vstep = _mm256_set1_epi32 (8);
+	__m256  vbest    = _mm256_set1_ps (init);
+	__m256i vbestIdx = _mm256_set1_epi32 (-1);
+	__m256i vidx     = _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7);
+
+	std::size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m256 dx = _mm256_sub_ps (_mm256_loadu_ps (xs + i), vqx);
+		const __m256 dy = _mm256_sub_ps (_mm256_loadu_ps (ys + i), vqy);
+		const __m256 d2 = _mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dy, dy));
+		const __m256 lt = _mm256_cmp_ps (d2, vbest, _CMP_LT_OQ);
+		vbest    = _mm256_blendv_ps (vbest, d2, lt);
+		vbestIdx = _mm256_blendv_epi8 (vbestIdx, vidx, _mm256_castps_si256 (lt));
+		vidx     = _mm256_add_epi32 (vidx, vstep);
+	}
+
+	alignas (32) float        laneD2[8];
+	alignas (32) std::int32_t laneIdx[8];
+	_mm256_store_ps (laneD2, vbest);
+	_mm256_store_si256 (reinterpret_cast<__m256i*> (laneIdx), vbestIdx);
+
+	float best = init;
+	std::size_t bestIdx = ReduceLanes (laneD2, laneIdx, 8, best);
+	bestIdx = ScanTail (xs, ys, i, n, qx, qy, best, bestIdx);
+
+	if (bestIdx != kNone) outD2 = best;
+	return bestIdx;
+}
+
+bool CpuHasAVX2 ()
+{
+#if defined(_MSC_VER)
+	int r[4] = {};
+	__cpuid (r, 0);
+	if (r[0] < 7) return false;
+	__cpuid (r, 1);
+	const bool osxsave = (r[2] & (1 << 27)) != 0;
+	const bool avx     = (r[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx) return false;
+	if ((_xgetbv (0) & 0x6) != 0x6) return false;   // ОС сохраняет YMM-регистры
+	__cpuidex (r, 7, 0);
+	return (r[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init ();
+	return __builtin_cpu_supports ("avx2") != 0;
+#endif
+}
+
+#endif // NEAREST_KERNEL_X64
+
+struct Dispatch {
+	FindFn      fn;
+	const char* name;
+};
+
+Dispatch SelectKernel ()
+{
+#if defined(NEAREST_KERNEL_X64)
+	if (CpuHasAVX2 ())
+		return { FindNearestAVX2, "AVX2" };
+	return { FindNearestSSE2, "SSE2" };
+#else
+	return { FindNearestScalar, "scalar" };
+#endif
+}
+
+const Dispatch& GetDispatch ()
+{
+	static const Dispatch dispatch = SelectKernel ();
+	return dispatch;
+}
+
+} // namespace
+
+std::size_t FindNearestScalar (const float* xs, const float* ys, std::size_t n,
+							   float qx, float qy, float maxD2, float& outD2)
+{
+	float best = InitialBest (maxD2);
+	std::size_t bestIdx = kNone;
+	for (std::size_t i = 0; i < n; ++i) {
+		const float dx = xs[i] - qx;
+		const float dy = ys[i] - qy;
+		const float d2 = dx * dx + dy * dy;
+		if (d2 < best) { best = d2; bestIdx = i; }
+	}
+	if (bestIdx != kNone) outD2 = best;
+	return bestIdx;
+}
+
+std::size_t FindNearest (const float* xs, const float* ys, std::size_t n,
+						 float qx, float qy, float maxD2, float& outD2)
+{
+	return GetDispatch ().fn (xs, ys, n, qx, qy, maxD2, outD2);
+}
+
+FindFn GetKernel (Kernel kernel)
+{
+	switch (kernel) {
+	case Kernel::Scalar:
+		return FindNearestScalar;
+#if defined(NEAREST_KERNEL_X64)
+	case Kernel::SSE2:
+		return FindNearestSSE2;
+	case Kernel::AVX2:
+		return CpuHasAVX2 () ? FindNearestAVX2 : nullptr;
+#endif
+	default:
+		return nullptr;
+	}
+}
+
+const char* GetActiveKernelName ()
+{
+	return GetDispatch ().name;
+}
+
+} // namespace NearestKernel
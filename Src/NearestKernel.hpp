@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace NearestKernel {
+
+constexpr std::size_t kNone = static_cast<std::size_t> (-1);
+
+// Якоря (точки привязки текстов) в раскладке SoA: отдельные массивы x и y
+// относительно локального начала координат. После сдвига координаты
+// укладываются в единицы километров, поэтому float32 хватает с запасом.
+struct AnchorSet {
+	double             originX = 0.0;
+	double             originY = 0.0;
+	std::vector<float> xs;
+	std::vector<float> ys;
+
+	void  Reserve (std::size_t n)             { xs.reserve (n); ys.reserve (n); }
+	void  Push (double x, double y)           { xs.push_back ((float) (x - originX)); ys.push_back ((float) (y - originY)); }
+	float LocalX (double x) const             { return (float) (x - originX); }
+	float LocalY (double y) const             { return (float) (y - originY); }
+	std::size_t GetSize () const              { return xs.size (); }
+};
+
+// Ближайшая точка среди xs[0..n) ys[0..n) к (qx, qy) с d2 <= maxD2.
+// Возвращает индекс в диапазоне или kNone; при равных расстояниях — меньший индекс.
+// outD2 заполняется только при успехе.
+using FindFn = std::size_t (*) (const float* xs, const float* ys, std::size_t n,
+								float qx, float qy, float maxD2, float& outD2);
+
+// Скалярная эталонная реализация (для проверки SIMD-веток).
+std::size_t FindNearestScalar (const float* xs, const float* ys, std::size_t n,
+							   float qx, float qy, float maxD2, float& outD2);
+
+// Отдельные реализации — для сверки с эталоном в тестах; nullptr — ветка
+// не собрана для этой архитектуры или процессор её не поддерживает.
+enum class Kernel { Scalar, SSE2, AVX2 };
+FindFn GetKernel (Kernel kernel);
+
+// Лучшая доступная реализация для текущего процессора (AVX2 / SSE2 / scalar).
+// Выбор делается один раз при первом вызове.
+std::size_t FindNearest (const float* xs, const float* ys, std::size_t n,
+						 float qx, float qy, float maxD2, float& outD2);
+
+// Имя выбранной реализации — для лога.
+const char* GetActiveKernelName ();
+
+} // namespace NearestKernel
@@ -0,0 +1,356 @@
+#include "PointFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(_WIN32)
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace PointFile {
+
+// =============================================================================
+// Отображение в память
+// =============================================================================
+
+MappedFile::~MappedFile ()
+{
+	Close ();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open (const wchar_t* path, std::string* error)
+{
+	Close ();
+	HANDLE h = CreateFileW (path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (h == INVALID_HANDLE_VALUE) {
+		if (error != nullptr) *error = "файл не открывается";
+		return false;
+	}
+	file = h;
+
+	LARGE_INTEGER len = {};
+	if (!GetFileSizeEx (h, &len)) {
+		if (error != nullptr) *error = "размер файла не определяется";
+		Close ();
+		return false;
+	}
+	size = (std::size_t) len.QuadPart;
+	if (size == 0)
+		return true;	// пустой файл не отображается
+
+	mapping = CreateFileMappingW (h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping != nullptr)
+		data = static_cast<const char*> (MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr) {
+		if (error != nullptr) *error = "файл не отображается в память";
+		Close ();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close ()
+{
+	if (data != nullptr)    UnmapViewOfFile (data);
+	if (mapping != nullptr) CloseHandle (mapping);
+	if (file != nullptr)    CloseHandle (file);
+	data    = nullptr;
+	mapping = nullptr;
+	file    = nullptr;
+	size    = 0;
+}
+
+#else
+
+bool MappedFile::Open (const char* path, std::string* error)
+{
+	Close ();
+	fd = ::open (path, O_RDONLY);
+	if (fd < 0) {
+		if (error != nullptr) *error = "файл не открывается";
+		return false;
+	}
+
+	struct stat st = {};
+	if (::fstat (fd, &st) != 0) {
+		if (error != nullptr) *error = "размер файла не определяется";
+		Close ();
+		return false;
+	}
+	size = (std::size_t) st.st_size;
+	if (size == 0)
+		return true;	// пустой файл не отображается
+
+	void* p = ::mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) {
+		if (error != nullptr) *error = "файл не отображается в память";
+		Close ();
+		return false;
+	}
+	::madvise (p, size, MADV_SEQUENTIAL);
+	data = static_cast<const char*> (p);
+	return true;
+}
+
+void MappedFile::Close ()
+{
+	if (data != nullptr) ::munmap (const_cast<char*> (data), size);
+	if (fd >= 0)         ::close (fd);
+	data = nullptr;
+	fd   = -1;
+	size = 0;
+}
+
+#endif
+
+namespace {
+
+// =============================================================================
+// Разбор строк
+// =============================================================================
+
+const std::size_t kDetectBytes = 64u << 10;
+
+inline bool IsBlank (char c) { return c == ' ' || c == '\t'; }
+
+// Число поля [p, end) без локали — как DxfReader::ParseReal, но в границах
+// буфера (отображение не завершается нулём) и с десятичной запятой.
+// Поле должно быть числом целиком (пробелы и кавычки по краям допустимы).
+bool ParseField (const char* p, const char* end, char decimal, double& out)
+{
+	static const double kPow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+									 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	while (p < end && (IsBlank (*p) || *p == '"')) ++p;
+	while (end > p && (IsBlank (end[-1]) || end[-1] == '"' || end[-1] == '\r')) --end;
+	if (p == end)
+		return false;
+
+	bool neg = false;
+	if (*p == '-' || *p == '+') neg = (*p++ == '-');
+
+	std::uint64_t mant = 0;
+	int digits = 0, exp10 = 0, seen = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; ++p, ++seen) {
+		if (digits < 19) { mant = mant * 10 + (std::uint64_t) (*p - '0'); if (mant != 0) ++digits; }
+		else ++exp10;
+	}
+	if (p < end && *p == decimal) {
+		for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++seen) {
+			if (digits < 19) { mant = mant * 10 + (std::uint64_t) (*p - '0'); if (mant != 0) ++digits; --exp10; }
+		}
+	}
+	if (seen == 0)
+		return false;
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		++p;
+		bool eneg = false;
+		if (p < end && (*p == '-' || *p == '+')) eneg = (*p++ == '-');
+		int e = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; ++p)
+			if (e < 10000) e = e * 10 + (*p - '0');
+		exp10 += eneg ? -e : e;
+	}
+	if (p != end)
+		return false;
+
+	double v = (double) mant;
+	if (exp10 < 0) v = (exp10 >= -22) ? v / kPow10[-exp10] : v * std::pow (10.0, exp10);
+	else if (exp10 > 0) v = (exp10 <= 22) ? v * kPow10[exp10] : v * std::pow (10.0, exp10);
+	out = neg ? -v : v;
+	return true;
+}
+
+// Строка [p, end) без '\n'; false — нужных колонок нет или в них не числа
+bool ParseLine (const char* p, const char* end, const Layout& l, char delim, Point& pt)
+{
+	const std::size_t last = std::max (l.xCol, std::max (l.yCol, l.zCol));
+	double v[3];
+	int    got = 0;
+	for (std::size_t col = 0; ; ++col) {
+		if (delim == ' ') {
+			while (p < end && IsBlank (*p)) ++p;
+			if (p == end) return false;
+		}
+		const char* f = p;
+		if (delim == ' ') while (p < end && !IsBlank (*p)) ++p;
+		else              while (p < end && *p != delim) ++p;
+
+		const int k = col == l.xCol ? 0 : col == l.yCol ? 1 : col == l.zCol ? 2 : -1;
+		if (k >= 0) {
+			if (!ParseField (f, p, l.decimal, v[k])) return false;
+			++got;
+		}
+		if (col == last) break;
+		if (p == end) return false;
+		++p;
+	}
+	if (got != 3)
+		return false;
+	pt = { v[0], v[1], v[2] };
+	return true;
+}
+
+// Начало строки, в которой лежит pos (pos == 0 или сразу после '\n')
+std::size_t AlignToLine (const char* data, std::size_t size, std::size_t pos)
+{
+	if (pos == 0 || pos >= size)
+		return std::min (pos, size);
+	const void* nl = std::memchr (data + pos - 1, '\n', size - (pos - 1));
+	return nl != nullptr ? (std::size_t) (static_cast<const char*> (nl) - data) + 1 : size;
+}
+
+struct ChunkResult {
+	std::vector<Point> points;
+	std::uint64_t      lines   = 0;
+	std::uint64_t      skipped = 0;
+};
+
+void ParseChunk (const char* p, const char* end, const Layout& l, char delim, ChunkResult& res)
+{
+	// плотность точек в порции заранее неизвестна — оценка по 32 байта на строку
+	res.points.reserve ((std::size_t) (end - p) / 32);
+	while (p < end) {
+		const char* nl = static_cast<const char*> (std::memchr (p, '\n', (std::size_t) (end - p)));
+		const char* e  = nl != nullptr ? nl : end;
+		const char* t  = p;
+		while (t < e && (IsBlank (*t) || *t == '\r')) ++t;
+		if (t < e) {
+			++res.lines;
+			Point pt;
+			if (ParseLine (p, e, l, delim, pt)) res.points.push_back (pt);
+			else                                ++res.skipped;
+		}
+		p = nl != nullptr ? nl + 1 : end;
+	}
+}
+
+} // namespace
+
+char DetectDelimiter (const char* data, std::size_t size, char decimal)
+{
+	if (data == nullptr || size == 0)
+		return ' ';
+
+	std::size_t tabs = 0, semis = 0, commas = 0, lines = 0;
+	const char* p   = data;
+	const char* end = data + std::min (size, kDetectBytes);
+	while (p < end && lines < 64) {
+		const char* nl = static_cast<const char*> (std::memchr (p, '\n', (std::size_t) (end - p)));
+		const char* e  = nl != nullptr ? nl : end;
+		if (std::memchr (p, '\t', (std::size_t) (e - p)) != nullptr) ++tabs;
+		if (std::memchr (p, ';',  (std::size_t) (e - p)) != nullptr) ++semis;
+		if (std::memchr (p, ',',  (std::size_t) (e - p)) != nullptr) ++commas;
+		++lines;
+		p = nl != nullptr ? nl + 1 : end;
+	}
+	// разделитель есть почти в каждой строке; заголовок или хвост могут выпасть
+	const std::size_t need = lines - lines / 4;
+	if (lines == 0)                          return ' ';
+	if (tabs >= need)                        return '\t';
+	if (semis >= need)                       return ';';
+	if (decimal != ',' && commas >= need)    return ',';
+	return ' ';
+}
+
+bool Read (const char* data, std::size_t size, const Layout& layout, std::vector<Point>& out,
+		   Stats* stats, const Progress& progress, unsigned threads)
+{
+	Stats st;
+	st.bytes = size;
+
+	// пустой файл не отображается: data == nullptr, в memchr его не передаём
+	if (data == nullptr || size == 0) {
+		out.clear ();
+		if (progress)
+			progress (0, 0);
+		if (stats != nullptr) *stats = st;
+		return true;
+	}
+
+	// BOM UTF-8 перед первой строкой
+	std::size_t begin = 0;
+	if (size >= 3 && (unsigned char) data[0] == 0xEF && (unsigned char) data[1] == 0xBB && (unsigned char) data[2] == 0xBF)
+		begin = 3;
+
+	const char delim = layout.delimiter != 0 ? layout.delimiter : DetectDelimiter (data + begin, size - begin, layout.decimal);
+	st.delimiter = delim;
+
+	// Порции по границам строк: строка принадлежит порции, где она начинается
+	const std::size_t body    = size - begin;
+	const std::size_t nChunks = std::max<std::size_t> (1, (body + kChunkBytes - 1) / kChunkBytes);
+	std::vector<std::size_t> bounds (nChunks + 1);
+	for (std::size_t c = 0; c <= nChunks; ++c)
+		bounds[c] = begin + AlignToLine (data + begin, body, std::min (body, c * kChunkBytes));
+	std::vector<ChunkResult> parts (nChunks);
+
+	unsigned nThreads = threads != 0 ? threads : std::max (1u, std::thread::hardware_concurrency ());
+	nThreads = (unsigned) std::min<std::size_t> (nThreads, nChunks);
+	st.chunks  = (std::uint32_t) nChunks;
+	st.threads = nThreads;
+
+	// Порции раздаёт атомарный счётчик; вызывающий поток тоже разбирает
+	// и между своими порциями сообщает прогресс
+	std::atomic<std::size_t>   next (0);
+	std::atomic<std::uint64_t> done (0);
+	std::atomic<bool>          cancel (false);
+	auto Worker = [&] (bool reporter) {
+		for (;;) {
+			if (cancel.load (std::memory_order_relaxed)) break;
+			const std::size_t c = next.fetch_add (1);
+			if (c >= nChunks) break;
+			ParseChunk (data + bounds[c], data + bounds[c + 1], layout, delim, parts[c]);
+			const std::uint64_t d = done.fetch_add (bounds[c + 1] - bounds[c]) + (bounds[c + 1] - bounds[c]);
+			if (reporter && progress && !progress (d, body))
+				cancel = true;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve (nThreads - 1);
+	for (unsigned t = 1; t < nThreads; ++t)
+		pool.emplace_back (Worker, false);
+	Worker (true);
+	for (std::thread& th : pool)
+		th.join ();
+
+	if (cancel) {
+		if (stats != nullptr) *stats = st;
+		return false;
+	}
+	if (progress)
+		progress (body, body);
+
+	std::size_t total = 0;
+	for (const ChunkResult& r : parts) {
+		total += r.points.size ();
+		st.lines += r.lines;
+		st.skipped += r.skipped;
+	}
+	out.clear ();
+	out.reserve (total);
+	for (ChunkResult& r : parts) {
+		out.insert (out.end (), r.points.begin (), r.points.end ());
+		std::vector<Point> ().swap (r.points);
+	}
+	if (stats != nullptr) *stats = st;
+	return true;
+}
+
+} // namespace PointFile
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace PointFile {
+
+// Текстовые файлы точек съёмки (CSV, XYZ, PENZD/PNEZD): строка — точка, поля
+// через разделитель. Файл отображается в память и режется на порции по
+// границам строк; порции разбираются параллельно, порядок точек сохраняется.
+// Строки без чисел в нужных колонках (заголовки, комментарии) пропускаются.
+
+// Отображение файла в память только для чтения
+class MappedFile {
+public:
+	MappedFile () = default;
+	~MappedFile ();
+
+	MappedFile (const MappedFile&) = delete;
+	MappedFile& operator= (const MappedFile&) = delete;
+
+#if defined(_WIN32)
+	bool Open (const wchar_t* path, std::string* error = nullptr);
+#else
+	bool Open (const char* path, std::string* error = nullptr);
+#endif
+	void Close ();
+
+	const char* Data () const { return data; }
+	std::size_t Size () const { return size; }
+
+private:
+	const char* data = nullptr;
+	std::size_t size = 0;
+#if defined(_WIN32)
+	void*       file    = nullptr;
+	void*       mapping = nullptr;
+#else
+	int         fd = -1;
+#endif
+};
+
+struct Layout {
+	char        delimiter = 0;     // ';' '\t' ',' или ' ' (пробелы подряд — один); 0 — DetectDelimiter
+	char        decimal   = '.';   // '.' или ','
+	std::size_t xCol = 0, yCol = 1, zCol = 2;   // номера колонок с нуля
+};
+
+struct Point { double x, y, z; };
+
+// Порция разбора — 4 МБ; границы порций сдвигаются к началу строки
+constexpr std::size_t kChunkBytes = 4u << 20;
+
+struct Stats {
+	std::uint64_t bytes     = 0;
+	std::uint64_t lines     = 0;   // непустых строк
+	std::uint64_t skipped   = 0;   // из них без чисел в нужных колонках
+	std::uint32_t chunks    = 0;
+	std::uint32_t threads   = 0;
+	char          delimiter = 0;   // фактический разделитель
+};
+
+// Вызывается из вызывающего потока между порциями; false — отмена
+using Progress = std::function<bool (std::uint64_t done, std::uint64_t total)>;
+
+// Разделитель по первым строкам: табуляция, ';', ',' (если десятичная — не
+// запятая), иначе пробелы
+char DetectDelimiter (const char* data, std::size_t size, char decimal);
+
+// threads = 0 — по числу ядер. false — отменено через progress (out не заполняется).
+// Пустой файл (data == nullptr, size == 0) — true и ни одной точки.
+bool Read (const char* data, std::size_t size, const Layout& layout, std::vector<Point>& out,
+		   Stats* stats = nullptr, const Progress& progress = nullptr, unsigned threads = 0);
+
+} // namespace PointFile
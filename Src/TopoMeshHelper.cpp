@@ -1,13 +1,23 @@
 #include "TopoMeshHelper.hpp"
+#include "NearestKernel.hpp"
+#include "DxfReader.hpp"
+#include "MText.hpp"
+#include "LabelPattern.hpp"
+#include "PointFile.hpp"
+#include "AttributeCache.hpp"
 
 #include "APIEnvir.h"
 #include "ACAPinc.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <vector>
+#include <string>
 #include <limits>
+#include <unordered_map>
 
 // =============================================================================
 // Внутренние структуры
@@ -25,10 +35,18 @@ struct TopoParams {
 	double        bboxOffsetMm;
 	GS::UniString meshName;
 	Int32         meshLayerIdx;
+	bool          fromDxf;        // источник — DXF из SetDxfFile, а не слой проекта
+	GS::UniString dxfLayers;      // индексы слоёв DXF через запятую; пусто — все
+	double        dxfUnitM;       // единица координат DXF в метрах; 0 — по $INSUNITS
+	GS::UniString labelPattern;   // формат надписей (LabelPattern); пусто — число в начале надписи
+	bool          fromPoints;     // источник — файл точек из SetPointFile (CSV/XYZ/PENZD)
+	Int32         pointCols[3];   // колонки X, Y, Z файла точек, с 1
+	char          pointDelimiter; // 0 — определить по файлу
+	double        pointUnitM;     // единица координат файла в метрах
 };
 
 struct ArcPoint { double x, y; };
-struct TextItem { double x, y; GS::UniString text; };
+struct TextItem { double x, y; GS::UniString text; double elevMm; };
 
 // =============================================================================
 // JSON парсер
@@ -37,7 +55,8 @@ struct TextItem { double x, y; GS::UniString text; };
 static GS::UniString JsonGetString(const GS::UniString& json, const char* key)
 {
 	GS::UniString searchKey = GS::UniString("\"") + key + "\":";
-	const char* src   = json.ToCStr().Get();
+	const auto  utf8  = json.ToCStr(0, MaxUSize, CC_UTF8);
+	const char* src   = utf8.Get();
 	const char* found = std::strstr(src, searchKey.ToCStr().Get());
 	if (found == nullptr) return GS::EmptyUniString;
 
@@ -45,12 +64,27 @@ static GS::UniString JsonGetString(const GS::UniString& json, const char* key)
 	while (*val == ' ') ++val;
 
 	if (*val == '"') {
-		++val;
-		const char* end = std::strchr(val, '"');
-		if (end == nullptr) return GS::EmptyUniString;
-		char buf[512] = {};
-		std::strncpy(buf, val, (size_t)(end - val));
-		return GS::UniString(buf);
+		// Строка JSON.stringify: \" \\ \/ \n \t \r и \uXXXX (шаблон надписей — с обратной косой)
+		std::string buf;
+		for (++val; *val != '\0' && *val != '"'; ++val) {
+			if (*val != '\\') { buf += *val; continue; }
+			const char k = *++val;
+			if      (k == 'n') buf += '\n';
+			else if (k == 't') buf += '\t';
+			else if (k == 'r') buf += '\r';
+			else if (k == 'u' && std::strlen(val) >= 5) {
+				char hex[5] = { val[1], val[2], val[3], val[4], '\0' };
+				const unsigned cp = (unsigned)std::strtoul(hex, nullptr, 16);
+				if (cp < 0x80)       buf += (char)cp;
+				else if (cp < 0x800) { buf += (char)(0xC0 | (cp >> 6)); buf += (char)(0x80 | (cp & 0x3F)); }
+				else                 { buf += (char)(0xE0 | (cp >> 12)); buf += (char)(0x80 | ((cp >> 6) & 0x3F)); buf += (char)(0x80 | (cp & 0x3F)); }
+				val += 4;
+			}
+			else if (k != '\0') buf += k;
+			else break;
+		}
+		if (*val != '"') return GS::EmptyUniString;
+		return GS::UniString(buf.c_str(), CC_UTF8);
 	} else {
 		char buf[64] = {};
 		int i = 0;
@@ -89,7 +123,27 @@ static bool ParseTopoParams(const GS::UniString& json, TopoParams& p)
 	if (p.meshName.IsEmpty()) p.meshName = "TopoMesh";
 	GS::UniString sep = JsonGetString(json, "separator");
 	p.separator = (sep == ",") ? ',' : '.';
-	if (p.layerIdx < 0) {
+	const GS::UniString source = JsonGetString(json, "source");
+	p.fromDxf    = source == "dxf";
+	p.fromPoints = source == "points";
+	p.dxfLayers  = JsonGetString(json, "dxfLayers");
+	const GS::UniString dxfUnits = JsonGetString(json, "dxfUnits");
+	p.dxfUnitM   = dxfUnits == "m" ? 1.0 : dxfUnits == "mm" ? 0.001 : 0.0;
+	p.labelPattern = JsonGetString(json, "labelPattern");
+	p.pointCols[0] = JsonGetInt(json, "colX", 1);
+	p.pointCols[1] = JsonGetInt(json, "colY", 2);
+	p.pointCols[2] = JsonGetInt(json, "colZ", 3);
+	const GS::UniString delim = JsonGetString(json, "delimiter");
+	p.pointDelimiter = delim == "tab"       ? '\t'
+					 : delim == "semicolon" ? ';'
+					 : delim == "comma"     ? ','
+					 : delim == "space"     ? ' ' : 0;
+	p.pointUnitM = JsonGetString(json, "pointUnits") == "mm" ? 0.001 : 1.0;
+	if (p.fromPoints && (p.pointCols[0] < 1 || p.pointCols[1] < 1 || p.pointCols[2] < 1)) {
+		ACAPI_WriteReport("[TopoMesh] Ошибка: колонки X/Y/Z нумеруются с 1", false);
+		return false;
+	}
+	if (!p.fromDxf && !p.fromPoints && p.layerIdx < 0) {
 		ACAPI_WriteReport("[TopoMesh] Ошибка: layerIdx не задан", false);
 		return false;
 	}
@@ -103,7 +157,10 @@ static bool ParseTopoParams(const GS::UniString& json, TopoParams& p)
 static bool ParseElevation(const char* text, char sep, double& outMm)
 {
 	if (text == nullptr || *text == '\0') return false;
-	while (*text == ' ') ++text;
+	while (*text == ' ' || *text == '\n' || *text == '\t') ++text;
+	// «±» перед нулевой отметкой (%%p): UTF-8 и однобайтовые кодовые страницы
+	if      ((unsigned char)text[0] == 0xC2 && (unsigned char)text[1] == 0xB1) text += 2;
+	else if ((unsigned char)text[0] == 0xB1) ++text;
 	bool neg = false;
 	if      (*text == '+') ++text;
 	else if (*text == '-') { neg = true; ++text; }
@@ -117,26 +174,54 @@ static bool ParseElevation(const char* text, char sep, double& outMm)
 	return true;
 }
 
+// Текст надписи без кодов форматирования MTEXT — до разбора отметки.
+// Очистка на месте: результат не длиннее исходного.
+static GS::UniString StripFormatInPlace(char* text)
+{
+	const size_t len = std::strlen(text);
+	MText::Strip(text, len, text, len + 1);
+	return GS::UniString(text, CC_UTF8);
+}
+
+// Отметка надписи при сборе: по шаблону, скомпилированному один раз на запуск,
+// или (шаблон пуст) прежним разбором числа в начале надписи
+struct ElevationParser {
+	LabelPattern::Matcher matcher;
+	bool                  usePattern = false;
+	char                  sep        = '.';
+
+	bool Init(const GS::UniString& pattern, char separator, GS::UniString* error = nullptr)
+	{
+		sep        = separator;
+		usePattern = !pattern.IsEmpty();
+		if (!usePattern) return true;
+		std::string compileError;
+		const bool ok = matcher.Compile(reinterpret_cast<const std::uint16_t*>(pattern.ToUStr().Get()),
+			pattern.GetLength(), separator, &compileError);
+		if (!ok && error != nullptr) *error = GS::UniString(compileError.c_str(), CC_UTF8);
+		return ok;
+	}
+
+	bool Parse(const GS::UniString& text, double& outMm) const
+	{
+		if (usePattern)
+			return matcher.Match(reinterpret_cast<const std::uint16_t*>(text.ToUStr().Get()), text.GetLength(), outMm);
+		return ParseElevation(text.ToCStr().Get(), sep, outMm);
+	}
+};
+
 // =============================================================================
 // Индекс атрибута слоя
 // =============================================================================
 
+// listIndex — позиция в списке палитры (GetLayerListJson), не индекс атрибута:
+// после удаления слоёв индексы идут с пропусками
 static API_AttributeIndex GetLayerAttrIdx(Int32 listIndex)
 {
-	GS::UInt32 layerCount = 0;
-	if (ACAPI_Attribute_GetNum(API_LayerID, layerCount) != NoError || layerCount == 0)
+	const std::vector<AttributeCache::Entry>& layers = AttributeCache::Layers().GetEntries();
+	if (listIndex < 0 || listIndex >= (Int32)layers.size())
 		return ACAPI_CreateAttributeIndex(1);
-
-	Int32 current = 0;
-	for (Int32 i = 1; i <= static_cast<Int32>(layerCount); ++i) {
-		API_Attribute attr = {};
-		attr.header.typeID = API_LayerID;
-		attr.header.index  = ACAPI_CreateAttributeIndex(i);
-		if (ACAPI_Attribute_Get(&attr) != NoError) continue;
-		if (current == listIndex) return attr.header.index;
-		++current;
-	}
-	return ACAPI_CreateAttributeIndex(1);
+	return layers[listIndex].index;
 }
 
 // =============================================================================
@@ -166,6 +251,7 @@ static double GetStoryElevM(Int32 storyIdx)
 // =============================================================================
 
 static void CollectOnLayer(API_AttributeIndex layerAttrIdx,
+	const ElevationParser& parser,
 	std::vector<ArcPoint>& arcs,
 	std::vector<TextItem>& texts)
 {
@@ -192,38 +278,392 @@ static void CollectOnLayer(API_AttributeIndex layerAttrIdx,
 		ti.x = elem.text.loc.x;
 		ti.y = elem.text.loc.y;
 		if (memo.textContent != nullptr && *memo.textContent != nullptr)
-			ti.text = GS::UniString(*memo.textContent);
+			ti.text = StripFormatInPlace(*memo.textContent);
 		ACAPI_DisposeElemMemoHdls(&memo);
-		if (!ti.text.IsEmpty()) texts.push_back(ti);
+		// надписи, не похожие на отметку, в сопоставление не идут
+		if (!ti.text.IsEmpty() && parser.Parse(ti.text, ti.elevMm)) texts.push_back(ti);
+	}
+}
+
+// =============================================================================
+// Сбор точек и текстов из DXF
+// =============================================================================
+
+static GS::UniString            g_dxfPath;
+static std::vector<std::string> g_dxfLayers;   // имена слоёв — байты файла, порядок SetDxfFile
+
+static GSCharCode DxfCharCode(bool utf8, const char* codepage)
+{
+	if (utf8) return CC_UTF8;
+	if (DxfReader::SameName(codepage, "ANSI_1251")) return CC_Cyrillic;
+	if (DxfReader::SameName(codepage, "ANSI_1252")) return CC_WestEuropean;
+	return CC_Default;
+}
+
+static std::FILE* OpenDxf(const GS::UniString& path)
+{
+#if defined(GS_WIN)
+	return _wfopen(reinterpret_cast<const wchar_t*>(path.ToUStr().Get()), L"rb");
+#else
+	return std::fopen(path.ToCStr(0, MaxUSize, CC_UTF8).Get(), "rb");
+#endif
+}
+
+// Слои DXF с числом точек и надписей — для выбора в палитре
+class DxfLayerScan : public DxfReader::Sink {
+public:
+	struct Layer { std::string name; UInt32 points = 0, texts = 0; };
+
+	std::vector<Layer> layers;
+	GSCharCode         charCode = CC_UTF8;
+
+	void OnHeader(bool utf8, const char* codepage, int) override { charCode = DxfCharCode(utf8, codepage); }
+	bool WantLayer(const char*) override { return true; }
+	bool OnPoint(DxfReader::EntityKind, const char* layer, double, double) override { ++Find(layer).points; return true; }
+	bool OnText(DxfReader::EntityKind, const char* layer, double, double, const char*, std::size_t) override { ++Find(layer).texts; return true; }
+
+private:
+	Layer& Find(const char* name)
+	{
+		// сущности одного слоя обычно идут подряд
+		if (last < layers.size() && DxfReader::SameName(layers[last].name.c_str(), name)) return layers[last];
+		for (last = 0; last < layers.size(); ++last)
+			if (DxfReader::SameName(layers[last].name.c_str(), name)) return layers[last];
+		layers.push_back({ name });
+		return layers.back();
+	}
+	size_t last = 0;
+};
+
+// Точки и надписи выбранных слоёв — сразу в массивы MatchPoints, координаты
+// в метрах. unitM — единица файла из палитры; 0 — по $INSUNITS (без единиц — метры).
+// parser == nullptr — надписи как есть (образец для палитры)
+class DxfCollector : public DxfReader::Sink {
+public:
+	DxfCollector(const std::vector<std::string>& layers, const ElevationParser* parser,
+		std::vector<ArcPoint>* arcs, std::vector<TextItem>& texts, size_t maxTexts = 0, double unitM = 0.0)
+		: m_layers(layers), m_parser(parser), m_arcs(arcs), m_texts(texts), m_maxTexts(maxTexts), m_scale(unitM) {}
+
+	void OnHeader(bool utf8, const char* codepage, int insUnits) override
+	{
+		m_charCode = DxfCharCode(utf8, codepage);
+		m_insUnits = insUnits;
+		if (m_scale <= 0.0) m_scale = DxfReader::UnitMeters(insUnits);
+		if (m_scale <= 0.0) m_scale = 1.0;
+	}
+
+	double GetScale() const    { return m_scale; }
+	int    GetInsUnits() const { return m_insUnits; }
+
+	bool WantLayer(const char* layer) override
+	{
+		if (m_layers.empty()) return true;
+		for (const std::string& l : m_layers)
+			if (DxfReader::SameName(l.c_str(), layer)) return true;
+		return false;
+	}
+
+	bool OnPoint(DxfReader::EntityKind, const char*, double x, double y) override
+	{
+		if (m_arcs != nullptr) m_arcs->push_back({ x * m_scale, y * m_scale });
+		return true;
+	}
+
+	bool OnText(DxfReader::EntityKind, const char*, double x, double y, const char* text, std::size_t) override
+	{
+		// сначала перекодировка из кодовой страницы файла, затем снятие кодов
+		// MTEXT над UTF-16: «°» «±» «⌀» и \U+XXXX — символы, а не байты UTF-8,
+		// прочитанные как ANSI_1251. Буфер переживает надписи
+		const GS::UniString raw(text, m_charCode);
+		const UInt32 len = raw.GetLength();
+		if (m_buf.size() < (size_t)len + 1) m_buf.resize((size_t)len + 1);
+		const size_t n = MText::Strip(reinterpret_cast<const std::uint16_t*>(raw.ToUStr().Get()), len,
+			m_buf.data(), m_buf.size());
+
+		TextItem ti;
+		ti.x = x * m_scale;
+		ti.y = y * m_scale;
+		ti.text = GS::UniString(reinterpret_cast<const GS::UniChar::Layout*>(m_buf.data()), (USize)n);
+		ti.elevMm = 0.0;
+		if (m_parser != nullptr && !m_parser->Parse(ti.text, ti.elevMm)) return true;
+		m_texts.push_back(ti);
+		return m_maxTexts == 0 || m_texts.size() < m_maxTexts;
+	}
+
+private:
+	const std::vector<std::string>& m_layers;
+	const ElevationParser*          m_parser;
+	std::vector<ArcPoint>*          m_arcs;
+	std::vector<TextItem>&          m_texts;
+	size_t                          m_maxTexts;
+	double                          m_scale;
+	int                             m_insUnits = 0;
+	GSCharCode                      m_charCode = CC_UTF8;
+	std::vector<std::uint16_t>      m_buf;
+};
+
+// "0,2,5" -> имена слоёв из g_dxfLayers
+static void ResolveDxfLayers(const GS::UniString& csv, std::vector<std::string>& out)
+{
+	out.clear();
+	const char* s = csv.ToCStr().Get();
+	while (*s != '\0') {
+		char* end = nullptr;
+		const long idx = std::strtol(s, &end, 10);
+		if (end == s) { ++s; continue; }
+		if (idx >= 0 && (size_t)idx < g_dxfLayers.size())
+			out.push_back(g_dxfLayers[(size_t)idx]);
+		s = end;
+	}
+}
+
+static bool CollectFromDxf(const GS::UniString& layersCsv,
+	const ElevationParser* parser,
+	std::vector<ArcPoint>* arcs,
+	std::vector<TextItem>& texts,
+	size_t maxTexts = 0,
+	double unitM = 0.0)
+{
+	if (g_dxfPath.IsEmpty()) {
+		ACAPI_WriteReport("[TopoMesh] DXF не выбран", false);
+		return false;
+	}
+	std::vector<std::string> layers;
+	ResolveDxfLayers(layersCsv, layers);
+
+	std::FILE* f = OpenDxf(g_dxfPath);
+	if (f == nullptr) {
+		ACAPI_WriteReport("[TopoMesh] Не открыть DXF: %s", false, g_dxfPath.ToCStr().Get());
+		return false;
+	}
+	DxfCollector      sink(layers, parser, arcs, texts, maxTexts, unitM);
+	DxfReader::Stats  st;
+	std::string       error;
+	const bool ok = DxfReader::Read(f, sink, &st, &error);
+	std::fclose(f);
+
+	ACAPI_WriteReport("[TopoMesh] DXF (%s): %.1f МБ, сущностей %u, со слоёв %u взято %u", false,
+		st.binary ? "двоичный" : "ASCII", (double)st.bytes / 1048576.0,
+		(unsigned)st.entities, (unsigned)layers.size(), (unsigned)st.delivered);
+	ACAPI_WriteReport("[TopoMesh] DXF: $INSUNITS=%d, единица %g м%s", false,
+		sink.GetInsUnits(), sink.GetScale(), unitM > 0.0 ? " (задана в палитре)" : "");
+	if (!ok)
+		ACAPI_WriteReport("[TopoMesh] %s", false, error.c_str());
+	return ok;
+}
+
+// =============================================================================
+// Импорт точек из файла CSV/XYZ/PENZD
+// =============================================================================
+
+static GS::UniString g_pointPath;
+
+// Разделитель колонок <-> значение "delimiter" в JSON палитры
+static const char* DelimiterKey(char delim)
+{
+	switch (delim) {
+	case '\t': return "tab";
+	case ';':  return "semicolon";
+	case ',':  return "comma";
+	case ' ':  return "space";
+	default:   return "auto";
 	}
 }
 
+static bool MapPointFile(const GS::UniString& path, PointFile::MappedFile& file)
+{
+	std::string error;
+#if defined(GS_WIN)
+	const bool ok = file.Open(reinterpret_cast<const wchar_t*>(path.ToUStr().Get()), &error);
+#else
+	const bool ok = file.Open(path.ToCStr(0, MaxUSize, CC_UTF8).Get(), &error);
+#endif
+	if (!ok)
+		ACAPI_WriteReport("[TopoMesh] Файл точек %s: %s", false, path.ToCStr().Get(), error.c_str());
+	return ok;
+}
+
+// Точки файла — сразу в TopoPoint, без надписей и сопоставления.
+// Прогресс — окно процесса Archicad (с отменой), итог — в отчёте
+static bool ImportPoints(const TopoParams& params, std::vector<TopoPoint>& topo)
+{
+	if (g_pointPath.IsEmpty()) {
+		ACAPI_WriteReport("[TopoMesh] Файл точек не выбран", false);
+		return false;
+	}
+	PointFile::MappedFile file;
+	if (!MapPointFile(g_pointPath, file)) return false;
+
+	PointFile::Layout layout;
+	layout.delimiter = params.pointDelimiter;
+	layout.decimal   = params.separator;
+	layout.xCol      = (size_t)(params.pointCols[0] - 1);
+	layout.yCol      = (size_t)(params.pointCols[1] - 1);
+	layout.zCol      = (size_t)(params.pointCols[2] - 1);
+	if (layout.delimiter == ',' && layout.decimal == ',') {
+		ACAPI_WriteReport("[TopoMesh] Запятая не может разделять и колонки, и дробную часть", false);
+		return false;
+	}
+
+	GS::UniString title  = "Импорт точек";
+	GS::UniString phase  = "Чтение файла";
+	Int32         nPhase = 1;
+	Int32         maxVal = 100;
+	bool          showPercent = true;
+	ACAPI_ProcessWindow_InitProcessWindow(&title, &nPhase);
+	ACAPI_ProcessWindow_SetNextProcessPhase(&phase, &maxVal, &showPercent);
+
+	std::vector<PointFile::Point> pts;
+	PointFile::Stats              st;
+	const bool ok = PointFile::Read(file.Data(), file.Size(), layout, pts, &st,
+		[](std::uint64_t done, std::uint64_t total) {
+			Int32 value = total > 0 ? (Int32)(done * 100 / total) : 100;
+			ACAPI_ProcessWindow_SetProcessValue(&value);
+			return !ACAPI_ProcessWindow_IsProcessCanceled();
+		});
+	ACAPI_ProcessWindow_CloseProcessWindow();
+	if (!ok) {
+		ACAPI_WriteReport("[TopoMesh] Импорт точек отменён", false);
+		return false;
+	}
+
+	ACAPI_WriteReport("[TopoMesh] Файл точек: %.1f МБ, разделитель %s, строк %llu, без чисел %llu, точек %u (порций %u, потоков %u)",
+		false, (double)st.bytes / 1048576.0, DelimiterKey(st.delimiter),
+		(unsigned long long)st.lines, (unsigned long long)st.skipped, (unsigned)pts.size(),
+		(unsigned)st.chunks, (unsigned)st.threads);
+
+	topo.resize(pts.size());
+	for (size_t i = 0; i < pts.size(); ++i)
+		topo[i] = { pts[i].x * params.pointUnitM, pts[i].y * params.pointUnitM, pts[i].z * params.pointUnitM };
+	return true;
+}
+
 // =============================================================================
 // Сопоставление Arc <-> Text
 // =============================================================================
 
+// Якоря текстов разложены по ячейкам сетки (шаг >= радиуса поиска) так, что
+// каждая ячейка — непрерывный диапазон в SoA-массивах. Для дуги просматриваются
+// 3x3 соседние ячейки, каждая — одним вызовом SIMD-ядра. Для малого числа
+// текстов сетка вырождается в одну ячейку (полный перебор тем же ядром).
+struct TextGrid {
+	NearestKernel::AnchorSet anchors;
+	std::vector<UInt32>      order;      // позиция в anchors -> индекс в texts
+	std::vector<UInt32>      cellStart;  // CSR: ячейка c = [cellStart[c], cellStart[c+1])
+	double                   cellSize = 1.0;
+	Int32                    nx = 1, ny = 1;
+
+	Int32 CellX (double x) const { return Cell ((x - anchors.originX) / cellSize, nx); }
+	Int32 CellY (double y) const { return Cell ((y - anchors.originY) / cellSize, ny); }
+
+	// Номер ячейки прижимается к [-2, n + 1] ещё в double: дуга далеко за
+	// сеткой (или NaN) не переполняет Int32 при приведении, а окно 3x3 вокруг
+	// -2 или n + 1 не задевает ни одной ячейки.
+	static Int32 Cell (double t, Int32 n)
+	{
+		const double c = std::floor (t);
+		return (Int32)std::min (std::max (-2.0, c), (double)n + 1.0);   // max (-2, NaN) == -2
+	}
+};
+
+static void BuildTextGrid(const std::vector<TextItem>& texts, double radiusM, TextGrid& grid)
+{
+	const size_t n = texts.size();
+	double minX = texts[0].x, maxX = texts[0].x;
+	double minY = texts[0].y, maxY = texts[0].y;
+	for (const TextItem& t : texts) {
+		if (t.x < minX) minX = t.x; if (t.x > maxX) maxX = t.x;
+		if (t.y < minY) minY = t.y; if (t.y > maxY) maxY = t.y;
+	}
+	grid.anchors.originX = minX;
+	grid.anchors.originY = minY;
+
+	// Шаг не меньше радиуса (достаточно соседей 3x3); укрупняем, пока ячеек
+	// не станет порядка числа текстов — иначе пустые ячейки съедают память.
+	const double kMinTextsForGrid = 64;
+	const double w = std::max(maxX - minX, 1.0e-6);
+	const double h = std::max(maxY - minY, 1.0e-6);
+	grid.cellSize = std::max(radiusM, 1.0e-6);
+	if ((double)n < kMinTextsForGrid)
+		grid.cellSize = std::max(grid.cellSize, std::max(w, h) * 2.0);
+	while ((std::floor(w / grid.cellSize) + 1.0) * (std::floor(h / grid.cellSize) + 1.0) > 4.0 * (double)n + 16.0)
+		grid.cellSize *= 2.0;
+	grid.nx = (Int32)std::floor(w / grid.cellSize) + 1;
+	grid.ny = (Int32)std::floor(h / grid.cellSize) + 1;
+
+	// Сортировка подсчётом по ячейкам
+	const size_t nCells = (size_t)grid.nx * (size_t)grid.ny;
+	std::vector<UInt32> cellOf(n);
+	grid.cellStart.assign(nCells + 1, 0);
+	for (size_t i = 0; i < n; ++i) {
+		const Int32 cx = std::min(grid.CellX(texts[i].x), grid.nx - 1);
+		const Int32 cy = std::min(grid.CellY(texts[i].y), grid.ny - 1);
+		cellOf[i] = (UInt32)cy * (UInt32)grid.nx + (UInt32)cx;
+		++grid.cellStart[cellOf[i] + 1];
+	}
+	for (size_t c = 0; c < nCells; ++c)
+		grid.cellStart[c + 1] += grid.cellStart[c];
+
+	std::vector<UInt32> fill(grid.cellStart.begin(), grid.cellStart.end() - 1);
+	grid.order.resize(n);
+	grid.anchors.xs.resize(n);
+	grid.anchors.ys.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		const UInt32 pos = fill[cellOf[i]]++;
+		grid.order[pos]         = (UInt32)i;
+		grid.anchors.xs[pos]    = grid.anchors.LocalX(texts[i].x);
+		grid.anchors.ys[pos]    = grid.anchors.LocalY(texts[i].y);
+	}
+}
+
 static std::vector<TopoPoint> MatchPoints(
 	const std::vector<ArcPoint>& arcs,
 	const std::vector<TextItem>& texts,
-	double radiusMm, char sep)
+	double radiusMm)
 {
-	const double r2 = (radiusMm / 1000.0) * (radiusMm / 1000.0);
 	std::vector<TopoPoint> result;
+	if (texts.empty()) return result;
 	result.reserve(arcs.size());
 
+	const double radiusM = radiusMm / 1000.0;
+	const float  r2      = (float)(radiusM * radiusM);
+
+	TextGrid grid;
+	BuildTextGrid(texts, radiusM, grid);
+	ACAPI_WriteReport("[TopoMesh] Сетка текстов %dx%d, шаг %.3f м, ядро %s", false,
+		(int)grid.nx, (int)grid.ny, grid.cellSize, NearestKernel::GetActiveKernelName());
+
+	const float* xs = grid.anchors.xs.data();
+	const float* ys = grid.anchors.ys.data();
+
 	for (size_t ai = 0; ai < arcs.size(); ++ai) {
-		double bestD2 = std::numeric_limits<double>::max();
-		const TextItem* best = nullptr;
-		for (size_t ti = 0; ti < texts.size(); ++ti) {
-			const double dx = arcs[ai].x - texts[ti].x;
-			const double dy = arcs[ai].y - texts[ti].y;
-			const double d2 = dx*dx + dy*dy;
-			if (d2 <= r2 && d2 < bestD2) { bestD2 = d2; best = &texts[ti]; }
+		const float  qx = grid.anchors.LocalX(arcs[ai].x);
+		const float  qy = grid.anchors.LocalY(arcs[ai].y);
+		const Int32  cx = grid.CellX(arcs[ai].x);
+		const Int32  cy = grid.CellY(arcs[ai].y);
+
+		float  bestD2  = 0.0f;
+		UInt32 bestTxt = 0;
+		bool   found   = false;
+		for (Int32 y = std::max<Int32>(cy - 1, 0); y <= std::min<Int32>(cy + 1, grid.ny - 1); ++y) {
+			for (Int32 x = std::max<Int32>(cx - 1, 0); x <= std::min<Int32>(cx + 1, grid.nx - 1); ++x) {
+				const size_t c   = (size_t)y * (size_t)grid.nx + (size_t)x;
+				const UInt32 beg = grid.cellStart[c];
+				const UInt32 cnt = grid.cellStart[c + 1] - beg;
+				if (cnt == 0) continue;
+
+				float d2 = 0.0f;
+				const size_t k = NearestKernel::FindNearest(xs + beg, ys + beg, cnt, qx, qy, r2, d2);
+				if (k == NearestKernel::kNone) continue;
+				// при равных расстояниях — текст, встретившийся раньше (как при полном переборе)
+				const UInt32 txt = grid.order[beg + k];
+				if (!found || d2 < bestD2 || (d2 == bestD2 && txt < bestTxt)) {
+					bestD2 = d2; bestTxt = txt; found = true;
+				}
+			}
 		}
-		if (best == nullptr) continue;
-		double elevMm = 0.0;
-		if (!ParseElevation(best->text.ToCStr().Get(), sep, elevMm)) continue;
-		result.push_back({ arcs[ai].x, arcs[ai].y, elevMm / 1000.0 });
+		if (!found) continue;
+		result.push_back({ arcs[ai].x, arcs[ai].y, texts[bestTxt].elevMm / 1000.0 });
 	}
 	return result;
 }
@@ -255,19 +695,40 @@ static GSErrCode BuildMesh(const std::vector<TopoPoint>& pts,
 		return Error;
 	}
 
+	// Дубль — точка ближе eps по X и Y к уже оставленной; остаётся первая.
+	// Оставленные точки разложены по ячейкам размера eps (хеш ячейки -> цепочка),
+	// так что дубль ищется только в соседних 3x3 ячейках — миллионы точек из
+	// файла проходят за линейное время
 	std::vector<TopoPoint> uniqPts;
 	uniqPts.reserve(pts.size());
 	const double eps = 1.0e-6;
+	std::unordered_map<UInt64, Int32> cellHead;
+	std::vector<Int32>                cellNext;
+	cellHead.reserve(pts.size());
+	cellNext.reserve(pts.size());
+	auto cellKey = [](Int64 cx, Int64 cy) { return (UInt64)cx * 0x9E3779B97F4A7C15ull ^ (UInt64)cy; };
 	for (const TopoPoint& tp : pts) {
+		const Int64 cx = (Int64)std::floor(tp.x / eps);
+		const Int64 cy = (Int64)std::floor(tp.y / eps);
 		bool duplicate = false;
-		for (const TopoPoint& up : uniqPts) {
-			if (std::fabs(tp.x - up.x) < eps && std::fabs(tp.y - up.y) < eps) {
-				duplicate = true;
-				break;
+		for (Int64 dx = -1; dx <= 1 && !duplicate; ++dx) {
+			for (Int64 dy = -1; dy <= 1 && !duplicate; ++dy) {
+				const auto it = cellHead.find(cellKey(cx + dx, cy + dy));
+				if (it == cellHead.end()) continue;
+				// разные ячейки с одним хешем делят цепочку — сравниваются координаты
+				for (Int32 k = it->second; k >= 0; k = cellNext[k]) {
+					if (std::fabs(tp.x - uniqPts[k].x) < eps && std::fabs(tp.y - uniqPts[k].y) < eps) {
+						duplicate = true;
+						break;
+					}
+				}
 			}
 		}
-		if (!duplicate)
-			uniqPts.push_back(tp);
+		if (duplicate) continue;
+		const auto ins = cellHead.emplace(cellKey(cx, cy), (Int32)uniqPts.size());
+		cellNext.push_back(ins.second ? -1 : ins.first->second);
+		ins.first->second = (Int32)uniqPts.size();
+		uniqPts.push_back(tp);
 	}
 	if (uniqPts.size() < 3) {
 		ACAPI_WriteReport("[TopoMesh] После удаления дублей осталось %d точек", false, (int)uniqPts.size());
@@ -290,19 +751,18 @@ static GSErrCode BuildMesh(const std::vector<TopoPoint>& pts,
 
 	
 	const Int32 nC   = 4;                    // число углов контура
+	const Int32 nCC  = nC + 1;               // с замыкающей вершиной
 	const Int32 nTP  = (Int32)uniqPts.size();
-	const Int32 nTot = nC + nTP;  
+	const Int32 nTot = nCC + nTP;            // вершины с 1 до nTot
 
 	API_Element     elem = {};
 	API_ElementMemo memo = {};
-	BNZeroMemory(&elem, sizeof(elem));
-	BNZeroMemory(&memo, sizeof(memo));
 
+	// memo умолчаний не запрашиваем: оно всё равно заменяется нашими handle
 	elem.header.type.typeID = API_MeshID;
-	GSErrCode err = ACAPI_Element_GetDefaults(&elem, &memo);
+	GSErrCode err = ACAPI_Element_GetDefaults(&elem, nullptr);
 	if (err != NoError) {
 		ACAPI_WriteReport("[TopoMesh] GetDefaults failed: %d", false, (int)err);
-		ACAPI_DisposeElemMemoHdls(&memo);
 		return err;
 	}
 
@@ -317,10 +777,10 @@ static GSErrCode BuildMesh(const std::vector<TopoPoint>& pts,
 	elem.mesh.poly.nSubPolys = 1;
 	elem.mesh.poly.nArcs     = 0;
 
-	ACAPI_DisposeElemMemoHdls(&memo);
-	memo.coords    = reinterpret_cast<API_Coord**>(BMAllocateHandle((nTot+1)*(GSSize)sizeof(API_Coord), ALLOCATE_CLEAR, 0));
-	memo.meshPolyZ = reinterpret_cast<double**>  (BMAllocateHandle((nTot+1)*(GSSize)sizeof(double),     ALLOCATE_CLEAR, 0));
-	memo.pends     = reinterpret_cast<Int32**>   (BMAllocateHandle(2        *(GSSize)sizeof(Int32),      ALLOCATE_CLEAR, 0));
+	// Все элементы заполняются ниже — без ALLOCATE_CLEAR; [0] — сторож
+	memo.coords    = reinterpret_cast<API_Coord**>(BMAllocateHandle((nTot+1)*(GSSize)sizeof(API_Coord), 0, 0));
+	memo.meshPolyZ = reinterpret_cast<double**>  (BMAllocateHandle((nTot+1)*(GSSize)sizeof(double),     0, 0));
+	memo.pends     = reinterpret_cast<Int32**>   (BMAllocateHandle(2        *(GSSize)sizeof(Int32),      0, 0));
 
 	if (!memo.coords || !memo.meshPolyZ || !memo.pends) {
 		ACAPI_WriteReport("[TopoMesh] Ошибка памяти", false);
@@ -332,6 +792,9 @@ static GSErrCode BuildMesh(const std::vector<TopoPoint>& pts,
 	const double cx[4] = { minX, maxX, maxX, minX };
 	const double cy[4] = { minY, minY, maxY, maxY };
 
+	(*memo.coords)[0]    = { 0.0, 0.0 };
+	(*memo.meshPolyZ)[0] = 0.0;
+
 	// Вставляем контурные углы (индексы 1..nC)
 	for (Int32 i = 0; i < nC; ++i) {
 		(*memo.coords)[i+1].x    = cx[i];
@@ -386,25 +849,17 @@ namespace TopoMeshHelper {
 
 GS::UniString GetLayerListJson()
 {
-	GS::UInt32 layerCount = 0;
-	if (ACAPI_Attribute_GetNum(API_LayerID, layerCount) != NoError)
-		return "[]";
+	// Перечитываем при каждом запросе: переименование и удаление с добавлением
+	// слоя число слоёв не меняют, позиции списка разошлись бы с проектом
+	AttributeCache::Layers().Reload();
+	const std::vector<AttributeCache::Entry>& layers = AttributeCache::Layers().GetEntries();
 
 	GS::UniString json = "[";
-	bool  first   = true;
-	Int32 listIdx = 0;
-
-	for (Int32 i = 1; i <= static_cast<Int32>(layerCount); ++i) {
-		API_Attribute attr = {};
-		attr.header.typeID = API_LayerID;
-		attr.header.index  = ACAPI_CreateAttributeIndex(i);
-		if (ACAPI_Attribute_Get(&attr) != NoError) continue;
-		if (!first) json += ",";
-		first = false;
+	for (size_t listIdx = 0; listIdx < layers.size(); ++listIdx) {
+		if (listIdx > 0) json += ",";
 		json += GS::UniString::Printf("{\"name\":\"%s\",\"index\":%d}",
-			JsonEscape(GS::UniString(attr.header.name)).ToCStr().Get(),
+			JsonEscape(layers[listIdx].name).ToCStr().Get(),
 			(int)listIdx);
-		++listIdx;
 	}
 	json += "]";
 	return json;
@@ -431,6 +886,49 @@ GS::UniString GetStoryListJson()
 	return json;
 }
 
+bool SetDxfFile(const GS::UniString& path, GS::Array<DxfLayerInfo>& outLayers)
+{
+	outLayers.Clear();
+	g_dxfPath.Clear();
+	g_dxfLayers.clear();
+
+	std::FILE* f = OpenDxf(path);
+	if (f == nullptr) {
+		ACAPI_WriteReport("[TopoMesh] Не открыть DXF: %s", false, path.ToCStr().Get());
+		return false;
+	}
+	DxfLayerScan     scan;
+	DxfReader::Stats st;
+	std::string      error;
+	const bool ok = DxfReader::Read(f, scan, &st, &error);
+	std::fclose(f);
+	if (!ok) {
+		ACAPI_WriteReport("[TopoMesh] %s", false, error.c_str());
+		return false;
+	}
+
+	g_dxfPath = path;
+	for (const DxfLayerScan::Layer& l : scan.layers) {
+		g_dxfLayers.push_back(l.name);
+		DxfLayerInfo info;
+		info.name   = GS::UniString(l.name.c_str(), scan.charCode);
+		info.points = l.points;
+		info.texts  = l.texts;
+		outLayers.Push(info);
+	}
+	ACAPI_WriteReport("[TopoMesh] DXF: %.1f МБ, сущностей %u, слоёв с точками/надписями %u", false,
+		(double)st.bytes / 1048576.0, (unsigned)st.entities, (unsigned)scan.layers.size());
+	return true;
+}
+
+GS::UniString GetDxfSampleText(const GS::UniString& layersCsv)
+{
+	std::vector<TextItem> texts;
+	if (!CollectFromDxf(layersCsv, nullptr, nullptr, texts, 1) || texts.empty())
+		return "(надписей на слоях DXF не найдено)";
+	return texts[0].text;
+}
+
 GS::UniString GetSampleElevationText(Int32 layerIdx)
 {
 	API_AttributeIndex layerAttrIdx = GetLayerAttrIdx(layerIdx);
@@ -447,20 +945,59 @@ GS::UniString GetSampleElevationText(Int32 layerIdx)
 		if (ACAPI_Element_GetMemo(textList[i], &memo, APIMemoMask_TextContent) != NoError) continue;
 		GS::UniString result;
 		if (memo.textContent != nullptr && *memo.textContent != nullptr)
-			result = GS::UniString(*memo.textContent);
+			result = StripFormatInPlace(*memo.textContent);
 		ACAPI_DisposeElemMemoHdls(&memo);
 		if (!result.IsEmpty()) return result;
 	}
 	return "(текстов на слое не найдено)";
 }
 
+bool SetPointFile(const GS::UniString& path, GS::Array<GS::UniString>& outHead, GS::UniString& outDelimiter)
+{
+	outHead.Clear();
+	PointFile::MappedFile file;
+	if (!MapPointFile(path, file)) return false;
+	g_pointPath = path;
+
+	// первые непустые строки — для выбора колонок в палитре
+	const char* p   = file.Data();
+	const char* end = p + file.Size();
+	if (file.Size() >= 3 && (unsigned char)p[0] == 0xEF && (unsigned char)p[1] == 0xBB && (unsigned char)p[2] == 0xBF)
+		p += 3;
+	while (p < end && outHead.GetSize() < 5) {
+		const char* nl = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+		const char* e  = nl != nullptr ? nl : end;
+		std::string line(p, e);
+		while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.pop_back();
+		if (!line.empty()) outHead.Push(GS::UniString(line.c_str(), CC_UTF8));
+		p = nl != nullptr ? nl + 1 : end;
+	}
+	outDelimiter = DelimiterKey(PointFile::DetectDelimiter(file.Data(), file.Size(), '.'));
+	ACAPI_WriteReport("[TopoMesh] Файл точек: %.1f МБ, разделитель %s", false,
+		(double)file.Size() / 1048576.0, outDelimiter.ToCStr().Get());
+	return true;
+}
+
+bool ParseElevationLabel(const GS::UniString& text, const GS::UniString& pattern, char sep,
+	double& outM, GS::UniString* error)
+{
+	ElevationParser parser;
+	if (!parser.Init(pattern, sep, error)) return false;
+	double mm = 0.0;
+	if (!parser.Parse(text, mm)) {
+		if (error != nullptr) *error = GS::UniString("надпись не подходит под шаблон", CC_UTF8);
+		return false;
+	}
+	outM = mm / 1000.0;
+	return true;
+}
+
 bool CreateTopoMesh(const GS::UniString& jsonPayload)
 {
 	TopoParams params = {};
 	if (!ParseTopoParams(jsonPayload, params)) return false;
 
-	GS::UInt32 layerCount = 0;
-	ACAPI_Attribute_GetNum(API_LayerID, layerCount);
+	const GS::UInt32 layerCount = (GS::UInt32)AttributeCache::Layers().GetEntries().size();
 	ACAPI_WriteReport("[TopoMesh] srcIdx=%d dstIdx=%d radius=%.0f sep=%c story=%d bbox=%.0f layers=%u name='%s'",
 		false,
 		params.layerIdx, params.meshLayerIdx,
@@ -468,7 +1005,7 @@ bool CreateTopoMesh(const GS::UniString& jsonPayload)
 		params.storyIdx, params.bboxOffsetMm,
 		layerCount, params.meshName.ToCStr().Get());
 
-	if (params.layerIdx < 0 || params.layerIdx >= (Int32)layerCount) {
+	if (!params.fromDxf && !params.fromPoints && (params.layerIdx < 0 || params.layerIdx >= (Int32)layerCount)) {
 		ACAPI_WriteReport("[TopoMesh] Неверный исходный слой %d", false, params.layerIdx);
 		return false;
 	}
@@ -476,6 +1013,13 @@ bool CreateTopoMesh(const GS::UniString& jsonPayload)
 		ACAPI_WriteReport("[TopoMesh] Неверный слой для Mesh %d", false, params.meshLayerIdx);
 		return false;
 	}
+	// Позиции — из списка, показанного палитрой: слой с тех пор могли
+	// переименовать или удалить, тогда позиция указывает не на тот слой
+	if ((!params.fromDxf && !params.fromPoints && !AttributeCache::Layers().IsCurrent((UInt32)params.layerIdx)) ||
+		!AttributeCache::Layers().IsCurrent((UInt32)params.meshLayerIdx)) {
+		ACAPI_WriteReport("[TopoMesh] Слои проекта изменились — обновите список слоёв в палитре", false);
+		return false;
+	}
 
 	if (params.storyIdx <= 0) {
 		API_StoryInfo si = {};
@@ -490,18 +1034,37 @@ bool CreateTopoMesh(const GS::UniString& jsonPayload)
 		ACAPI_WriteReport("[TopoMesh] storyIdx fallback -> %d", false, params.storyIdx);
 	}
 
-	API_AttributeIndex layerAttrIdx = GetLayerAttrIdx(params.layerIdx);
-
-	std::vector<ArcPoint> arcs;
-	std::vector<TextItem> texts;
-	CollectOnLayer(layerAttrIdx, arcs, texts);
+	std::vector<TopoPoint> topo;
+	if (params.fromPoints) {
+		// координаты с отметками — сопоставлять нечего
+		if (!ImportPoints(params, topo)) return false;
+	} else {
+		ElevationParser parser;
+		GS::UniString   patternError;
+		if (!parser.Init(params.labelPattern, params.separator, &patternError)) {
+			ACAPI_WriteReport("[TopoMesh] Ошибка в шаблоне надписей '%s': %s", false,
+				params.labelPattern.ToCStr().Get(), patternError.ToCStr().Get());
+			return false;
+		}
+		if (parser.usePattern)
+			ACAPI_WriteReport("[TopoMesh] Шаблон надписей '%s': состояний ДКА %u", false,
+				params.labelPattern.ToCStr().Get(), (unsigned)parser.matcher.GetStateCount());
+
+		std::vector<ArcPoint> arcs;
+		std::vector<TextItem> texts;
+		if (params.fromDxf) {
+			if (!CollectFromDxf(params.dxfLayers, &parser, &arcs, texts, 0, params.dxfUnitM)) return false;
+		} else {
+			CollectOnLayer(GetLayerAttrIdx(params.layerIdx), parser, arcs, texts);
+		}
 
-	ACAPI_WriteReport("[TopoMesh] Дуг: %d, текстов: %d", false, (int)arcs.size(), (int)texts.size());
-	if (arcs.empty()) { ACAPI_WriteReport("[TopoMesh] Нет Arc на слое", false); return false; }
-	if (texts.empty()) { ACAPI_WriteReport("[TopoMesh] Нет текстов на слое", false); return false; }
+		ACAPI_WriteReport("[TopoMesh] Дуг: %d, надписей-отметок: %d", false, (int)arcs.size(), (int)texts.size());
+		if (arcs.empty()) { ACAPI_WriteReport("[TopoMesh] Нет Arc на слое", false); return false; }
+		if (texts.empty()) { ACAPI_WriteReport("[TopoMesh] Нет надписей-отметок на слое", false); return false; }
 
-	std::vector<TopoPoint> topo = MatchPoints(arcs, texts, params.radiusMm, params.separator);
-	ACAPI_WriteReport("[TopoMesh] Сопоставлено: %d", false, (int)topo.size());
+		topo = MatchPoints(arcs, texts, params.radiusMm);
+		ACAPI_WriteReport("[TopoMesh] Сопоставлено: %d", false, (int)topo.size());
+	}
 	if (topo.size() < 3) { ACAPI_WriteReport("[TopoMesh] Мало точек", false); return false; }
 
 	const double storyElevM = GetStoryElevM(params.storyIdx);
@@ -538,20 +1101,10 @@ bool CreateTopoMesh(const GS::UniString& jsonPayload)
 void GetLayerList(GS::Array<GS::Pair<GS::UniString, Int32>>& outLayers)
 {
 	outLayers.Clear();
-	GS::UInt32 layerCount = 0;
-	if (ACAPI_Attribute_GetNum(API_LayerID, layerCount) != NoError || layerCount == 0)
-		return;
-
-	Int32 listIdx = 0;
-	for (GS::UInt32 i = 1; i <= layerCount; ++i) {
-		API_Attribute attr = {};
-		attr.header.typeID = API_LayerID;
-		attr.header.index  = ACAPI_CreateAttributeIndex((short)i);
-		if (ACAPI_Attribute_Get(&attr) == NoError) {
-			outLayers.Push(GS::Pair<GS::UniString, Int32>{ attr.header.name, listIdx });
-			++listIdx;
-		}
-	}
+	AttributeCache::Layers().Reload();   // см. GetLayerListJson
+	const std::vector<AttributeCache::Entry>& layers = AttributeCache::Layers().GetEntries();
+	for (size_t listIdx = 0; listIdx < layers.size(); ++listIdx)
+		outLayers.Push(GS::Pair<GS::UniString, Int32>{ layers[listIdx].name, (Int32)listIdx });
 }
 
 void GetStoryList(GS::Array<GS::Pair<GS::UniString, Int32>>& outStories)
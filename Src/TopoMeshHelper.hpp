@@ -18,6 +18,33 @@ GS::UniString GetStoryListJson ();
 
 GS::UniString GetSampleElevationText (Int32 layerIdx);
 
+// DXF-файл как источник точек и отметок вместо слоя проекта (без импорта):
+// слой с числом точек (ARC/CIRCLE/POINT/INSERT) и надписей (TEXT/MTEXT/ATTRIB)
+struct DxfLayerInfo {
+	GS::UniString name;
+	UInt32        points = 0;
+	UInt32        texts  = 0;
+};
+
+// Запоминает файл для CreateTopoMesh ("source":"dxf") и возвращает его слои;
+// false — файл не открылся или это не DXF
+bool SetDxfFile (const GS::UniString& path, GS::Array<DxfLayerInfo>& outLayers);
+
+// Первая надпись на слоях DXF (layersCsv — индексы из SetDxfFile через запятую)
+GS::UniString GetDxfSampleText (const GS::UniString& layersCsv);
+
+// Файл точек CSV/XYZ/PENZD как источник вместо точек с надписями: строка —
+// точка с колонками X, Y, Z. Запоминает файл для CreateTopoMesh ("source":"points")
+// и возвращает первые строки и найденный разделитель ("tab", "semicolon",
+// "comma", "space"); false — файл не открылся
+bool SetPointFile (const GS::UniString& path, GS::Array<GS::UniString>& outHead, GS::UniString& outDelimiter);
+
+// Отметка надписи в метрах так же, как при создании Mesh: по шаблону
+// (LabelPattern, пусто — число в начале надписи) и разделителю; для предпросмотра.
+// false — ошибка в шаблоне или надпись не подошла (error — причина)
+bool ParseElevationLabel (const GS::UniString& text, const GS::UniString& pattern, char sep,
+	double& outM, GS::UniString* error = nullptr);
+
 bool CreateTopoMesh (const GS::UniString& jsonPayload);
 
 } // namespace TopoMeshHelper
\ No newline at end of file
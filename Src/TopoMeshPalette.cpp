@@ -4,6 +4,9 @@
 #include "APIEnvir.h"
 #include "ACAPinc.h"
 #include "DGBrowser.hpp"
+#include "DGFileDialog.hpp"
+#include "FileTypeManager.hpp"
+#include "Location.hpp"
 
 #include "Array.hpp"
 #include "Pair.hpp"
@@ -74,6 +77,56 @@ static Int32 GetIntFromJs (GS::Ref<JS::Base> p, Int32 def = 0)
 	return def;
 }
 
+static GS::Array<GS::Ref<JS::Base>> GetArrayFromJs (GS::Ref<JS::Base> p)
+{
+	if (GS::Ref<JS::Array> a = GS::DynamicCast<JS::Array> (p))
+		return a->GetItemArray ();
+
+	return {};
+}
+
+// =============================================================================
+// Выбор DXF-файла
+// =============================================================================
+
+static FTM::TypeID GetFileTypeId (FTM::FileTypeManager& types, const char* extension)
+{
+	const FTM::FileType fileType (nullptr, extension, 0, 0, 0);
+	FTM::TypeID typeId = FTM::FileTypeManager::SearchForType (fileType);
+	if (typeId == FTM::UnknownType)
+		typeId = types.AddType (fileType);
+	return typeId;
+}
+
+static bool PickDxfLocation (IO::Location& out)
+{
+	static FTM::FileTypeManager dxfTypes ("TopoMeshDxf");
+
+	DG::FileDialog dialog (DG::FileDialog::OpenFile);
+	dialog.SetTitle ("DXF с отметками");
+	dialog.AddFilter (GetFileTypeId (dxfTypes, "dxf"));
+	if (!dialog.Invoke ())
+		return false;
+
+	out = dialog.GetSelectedFile (0);
+	return true;
+}
+
+static bool PickPointFileLocation (IO::Location& out)
+{
+	static FTM::FileTypeManager pointTypes ("TopoMeshPoints");
+
+	DG::FileDialog dialog (DG::FileDialog::OpenFile);
+	dialog.SetTitle ("Файл точек CSV/XYZ/PENZD");
+	for (const char* extension : { "csv", "xyz", "txt", "pts", "penzd", "pnezd" })
+		dialog.AddFilter (GetFileTypeId (pointTypes, extension));
+	if (!dialog.Invoke ())
+		return false;
+
+	out = dialog.GetSelectedFile (0);
+	return true;
+}
+
 // =============================================================================
 // Регистрация JS объекта ACAPI в браузере
 // =============================================================================
@@ -144,6 +197,106 @@ static void RegisterTopoMeshJSObject (DG::Browser& browser)
 			return new JS::Value (ok);
 		}));
 
+	// -------------------------------------------------------------------------
+	// ACAPI.PickDxfFile() -> [fileName, [ [layerName, points, texts], ... ]]
+	// или [] — отмена / файл не DXF
+	// -------------------------------------------------------------------------
+	jsACAPI->AddItem (new JS::Function ("PickDxfFile",
+		[] (GS::Ref<JS::Base>) -> GS::Ref<JS::Base> {
+
+			JS::Array* result = new JS::Array ();
+			IO::Location location;
+			if (!PickDxfLocation (location))
+				return result;
+
+			GS::UniString path;
+			IO::Name      fileName;
+			location.ToPath (&path);
+			location.GetLastLocalName (&fileName);
+
+			GS::Array<TopoMeshHelper::DxfLayerInfo> layers;
+			if (!TopoMeshHelper::SetDxfFile (path, layers))
+				return result;
+
+			JS::Array* arr = new JS::Array ();
+			for (const auto& it : layers) {
+				JS::Array* row = new JS::Array ();
+				row->AddItem (new JS::Value (it.name));
+				row->AddItem (new JS::Value (static_cast<double> (it.points)));
+				row->AddItem (new JS::Value (static_cast<double> (it.texts)));
+				arr->AddItem (row);
+			}
+			result->AddItem (new JS::Value (fileName.ToString ()));
+			result->AddItem (arr);
+			return result;
+		}));
+
+	// -------------------------------------------------------------------------
+	// ACAPI.GetDxfSampleText(layersCsv) -> string
+	// layersCsv = индексы слоёв из PickDxfFile через запятую
+	// -------------------------------------------------------------------------
+	jsACAPI->AddItem (new JS::Function ("GetDxfSampleText",
+		[] (GS::Ref<JS::Base> param) -> GS::Ref<JS::Base> {
+			const GS::UniString sample = TopoMeshHelper::GetDxfSampleText (GetStringFromJs (param));
+			return new JS::Value (sample);
+		}));
+
+	// -------------------------------------------------------------------------
+	// ACAPI.PickPointFile() -> [fileName, delimiter, [line, ...]]
+	// delimiter — "tab" | "semicolon" | "comma" | "space"; [] — отмена / не открылся
+	// -------------------------------------------------------------------------
+	jsACAPI->AddItem (new JS::Function ("PickPointFile",
+		[] (GS::Ref<JS::Base>) -> GS::Ref<JS::Base> {
+
+			JS::Array* result = new JS::Array ();
+			IO::Location location;
+			if (!PickPointFileLocation (location))
+				return result;
+
+			GS::UniString path;
+			IO::Name      fileName;
+			location.ToPath (&path);
+			location.GetLastLocalName (&fileName);
+
+			GS::Array<GS::UniString> head;
+			GS::UniString            delimiter;
+			if (!TopoMeshHelper::SetPointFile (path, head, delimiter))
+				return result;
+
+			JS::Array* lines = new JS::Array ();
+			for (const GS::UniString& line : head)
+				lines->AddItem (new JS::Value (line));
+			result->AddItem (new JS::Value (fileName.ToString ()));
+			result->AddItem (new JS::Value (delimiter));
+			result->AddItem (lines);
+			return result;
+		}));
+
+	// -------------------------------------------------------------------------
+	// ACAPI.ParseElevationLabel([text, labelPattern, separator])
+	//   -> [true, отметка в метрах] | [false, причина]
+	// Тот же разбор, что при создании Mesh — для предпросмотра шаблона
+	// -------------------------------------------------------------------------
+	jsACAPI->AddItem (new JS::Function ("ParseElevationLabel",
+		[] (GS::Ref<JS::Base> param) -> GS::Ref<JS::Base> {
+			const GS::Array<GS::Ref<JS::Base>> args = GetArrayFromJs (param);
+			const GS::UniString text    = args.GetSize () > 0 ? GetStringFromJs (args[0]) : GS::EmptyUniString;
+			const GS::UniString pattern = args.GetSize () > 1 ? GetStringFromJs (args[1]) : GS::EmptyUniString;
+			const GS::UniString sep     = args.GetSize () > 2 ? GetStringFromJs (args[2]) : GS::EmptyUniString;
+
+			double        elevM = 0.0;
+			GS::UniString error;
+			const bool ok = TopoMeshHelper::ParseElevationLabel (text, pattern, sep == "," ? ',' : '.', elevM, &error);
+
+			JS::Array* result = new JS::Array ();
+			result->AddItem (new JS::Value (ok));
+			if (ok)
+				result->AddItem (new JS::Value (elevM));
+			else
+				result->AddItem (new JS::Value (error));
+			return result;
+		}));
+
 	browser.RegisterAsynchJSObject (jsACAPI);
 }
 
@@ -2,9 +2,14 @@
 #ifndef ACAPINC_STUB_H
 #define ACAPINC_STUB_H
 
+#include <cstddef>   // size_t: the real headers bring it in through GSRoot
+
 // Basic types and constants used in this project
 using Int32 = int;
 using UInt32 = unsigned int;
+using Int64 = long long;
+using UInt64 = unsigned long long;
+using GSHandle = char**;
 using GSErrCode = int;
 constexpr GSErrCode NoError = 0;
 
@@ -36,12 +41,66 @@ struct API_StoryInfo {
     short lastStory;
 };
 
+// Geometry value types (FromClaude/files: PathEngine, Boundary, Scatter...)
+struct API_Coord { double x, y; };
+struct API_Box { double xMin, yMin, xMax, yMax; };
+struct API_SplineDir { double lenPrev, lenNext, dirAng; };
+struct API_PolyArc { Int32 begIndex, endIndex; double arcAngle; };
+struct API_Guid { unsigned char data[16]; };
+
+enum API_ElemTypeID {
+    API_ZombieElemID = 0,
+    API_LineID,
+    API_PolyLineID,
+    API_ArcID,
+    API_CircleID,
+    API_SplineID,
+    API_HatchID,
+    API_SlabID
+};
+
+struct API_ElemType { API_ElemTypeID typeID; };
+
+struct API_Elem_Head {
+    API_ElemType type;
+    API_Guid guid;
+};
+
+struct API_LineType { API_Elem_Head head; API_Coord begC, endC; };
+struct API_ArcType { API_Elem_Head head; API_Coord origC; double r, begAng, endAng; };
+struct API_CircleType { API_Elem_Head head; API_Coord origC; double r; };
+
+// the real API_Element is a union of the element types, each starting with the header
+struct API_Element {
+    API_Elem_Head header;
+    API_LineType line;
+    API_ArcType arc;
+    API_CircleType circle;
+};
+
+struct API_ElementMemo {
+    API_Coord** coords;
+    Int32** pends;
+    API_PolyArc** parcs;
+    API_SplineDir** bezierDirs;
+};
+
+constexpr UInt64 APIMemoMask_Polygon = 0x0001;
+constexpr GSErrCode APIERR_BADID = -2130313112;
+
 // stub functions
 inline GSErrCode ACAPI_Attribute_GetNum(API_AttributeID, UInt32& count) { count = 0; return NoError; }
 inline API_AttributeIndex ACAPI_CreateAttributeIndex(short i) { API_AttributeIndex idx; idx.index = i; return idx; }
 inline GSErrCode ACAPI_Attribute_Get(API_Attribute*) { return NoError; }
 inline GSErrCode ACAPI_ProjectSetting_GetStorySettings(API_StoryInfo*) { return NoError; }
 inline void BMKillHandle(void*) {}
+inline long BMGetHandleSize(GSHandle) { return 0; }
+
+// no elements in headless builds: reading one always fails
+inline GSErrCode ACAPI_Element_Get(API_Element*) { return APIERR_BADID; }
+inline GSErrCode ACAPI_Element_GetHeader(API_Elem_Head*) { return APIERR_BADID; }
+inline GSErrCode ACAPI_Element_GetMemo(const API_Guid&, API_ElementMemo*, UInt64 = 0) { return APIERR_BADID; }
+inline GSErrCode ACAPI_DisposeElemMemoHdls(API_ElementMemo*) { return NoError; }
 
 // qsort/pop? not needed
 
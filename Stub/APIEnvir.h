@@ -0,0 +1,7 @@
+// Minimal stub of Graphisoft Archicad API for headless compilation
+#ifndef APIENVIR_STUB_H
+#define APIENVIR_STUB_H
+
+// platform setup lives in the real APIEnvir.h; nothing needed for the stub
+
+#endif // APIENVIR_STUB_H
@@ -0,0 +1,139 @@
+// Ограниченная очередь: ёмкость до степени двойки, порядок FIFO, отказ на
+// полной/пустой очереди, повторное использование ячеек по кругу; несколько
+// поставщиков и потребителей — каждое значение доходит ровно один раз.
+
+#include "BoundedQueue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+// Сколько значений поместилось в пустую очередь
+template <class T>
+unsigned FillCount (BoundedQueue::Queue<T>& queue)
+{
+	unsigned n = 0;
+	while (queue.TryPush ((T) n) && n < 1000) ++n;
+	return n;
+}
+
+void TestCapacity ()
+{
+	struct Case {
+		size_t   requested;
+		unsigned expected;
+	};
+	const Case kCases[] = { { 0, 2 }, { 1, 2 }, { 2, 2 }, { 3, 4 }, { 4, 4 }, { 5, 8 }, { 64, 64 }, { 65, 128 } };
+	for (const Case& c : kCases) {
+		BoundedQueue::Queue<int> queue (c.requested);
+		const unsigned n = FillCount (queue);
+		CHECK (n == c.expected, "ёмкость %zu: поместилось %u, ожидалось %u", c.requested, n, c.expected);
+	}
+}
+
+void TestFifo ()
+{
+	BoundedQueue::Queue<int> queue (4);
+	int v = -1;
+	CHECK (!queue.TryPop (v) && v == -1, "пустая очередь отдала значение");
+
+	// несколько кругов по кольцу: ячейки переиспользуются, порядок сохраняется
+	int next = 0, expected = 0;
+	for (int round = 0; round < 10; ++round) {
+		for (int k = 0; k < 3; ++k)
+			CHECK (queue.TryPush (next++), "круг %d: TryPush", round);
+		for (int k = 0; k < 2; ++k) {
+			CHECK (queue.TryPop (v) && v == expected, "круг %d: получено %d, ожидалось %d", round, v, expected);
+			++expected;
+		}
+		// на каждом круге очередь длиннее на 1 — доливаем до полной и проверяем отказ
+		while (next - expected < 4) CHECK (queue.TryPush (next++), "круг %d: доливка", round);
+		CHECK (!queue.TryPush (-1), "круг %d: полная очередь приняла значение", round);
+		while (next - expected > 1) {
+			CHECK (queue.TryPop (v) && v == expected, "круг %d: получено %d, ожидалось %d", round, v, expected);
+			++expected;
+		}
+	}
+	while (queue.TryPop (v)) {
+		CHECK (v == expected, "хвост: получено %d, ожидалось %d", v, expected);
+		++expected;
+	}
+	CHECK (expected == next, "потеряно %d значений", next - expected);
+}
+
+void TestThreads ()
+{
+	// поставщики кладут непересекающиеся диапазоны; потребители отмечают
+	// полученное — повтор или пропуск виден по счётчику значения
+	const unsigned kProducers = 4, kConsumers = 4;
+	const std::uint32_t kPerProducer = 200000;
+	const std::uint32_t total = kProducers * kPerProducer;
+
+	BoundedQueue::Queue<std::uint32_t> queue (64);
+	std::vector<std::atomic<unsigned char>> seen (total);
+	for (auto& s : seen) s.store (0, std::memory_order_relaxed);
+	std::atomic<std::uint32_t> received { 0 };
+	std::atomic<bool> outOfOrder { false };
+
+	std::vector<std::thread> threads;
+	for (unsigned p = 0; p < kProducers; ++p) {
+		threads.emplace_back ([&, p] {
+			for (std::uint32_t i = 0; i < kPerProducer; ++i) {
+				const std::uint32_t value = p * kPerProducer + i;
+				while (!queue.TryPush (value)) std::this_thread::yield ();
+			}
+		});
+	}
+	for (unsigned c = 0; c < kConsumers; ++c) {
+		threads.emplace_back ([&] {
+			// от одного поставщика значения идут по возрастанию
+			std::vector<std::int64_t> last (kProducers, -1);
+			std::uint32_t value;
+			while (received.load (std::memory_order_relaxed) < total) {
+				if (!queue.TryPop (value)) {
+					std::this_thread::yield ();
+					continue;
+				}
+				seen[value].fetch_add (1, std::memory_order_relaxed);
+				const unsigned p = value / kPerProducer;
+				if ((std::int64_t) value <= last[p]) outOfOrder = true;
+				last[p] = value;
+				received.fetch_add (1, std::memory_order_relaxed);
+			}
+		});
+	}
+	for (std::thread& t : threads) t.join ();
+
+	std::uint32_t missing = 0, repeated = 0;
+	for (auto& s : seen) {
+		const unsigned n = s.load ();
+		if (n == 0) ++missing;
+		if (n > 1) ++repeated;
+	}
+	CHECK (received == total && missing == 0 && repeated == 0, "получено %u из %u, пропущено %u, повторов %u",
+		   (unsigned) received, (unsigned) total, (unsigned) missing, (unsigned) repeated);
+	CHECK (!outOfOrder, "значения одного поставщика пришли не по порядку");
+	std::uint32_t v;
+	CHECK (!queue.TryPop (v), "очередь не пуста после всех потребителей");
+}
+
+} // namespace
+
+int main ()
+{
+	TestCapacity ();
+	TestFifo ();
+	TestThreads ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
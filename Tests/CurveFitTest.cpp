@@ -0,0 +1,180 @@
+// Аппроксимация точек сплайном: отклонение кривой от каждой точки не больше
+// допуска (проверяется по самой кривой, не по Stats), число узлов падает с
+// ростом допуска, прямая — один кусок, совпадающие подряд точки, замкнутый
+// контур с общей касательной, отказ на вырожденном входе.
+
+#include "CurveFit.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+const double kPI = 3.1415926535897932384626433832795;
+
+struct Fit {
+	bool                       ok = false;
+	std::vector<API_Coord>     coords;
+	std::vector<API_SplineDir> dirs;
+	CurveFit::Stats            stats;
+};
+
+Fit Run (const std::vector<API_Coord>& pts, double tolM, bool closed = false)
+{
+	Fit f;
+	f.ok = CurveFit::FitSpline (pts.data (), (UInt32) pts.size (), tolM, closed, f.coords, f.dirs, &f.stats);
+	return f;
+}
+
+// Точка куска k сплайна (узлы k и k+1) — как её строит Archicad
+API_Coord Eval (const Fit& f, size_t k, double t)
+{
+	const API_Coord& p0 = f.coords[k];
+	const API_Coord& p3 = f.coords[k + 1];
+	const API_Coord  p1 = { p0.x + std::cos (f.dirs[k].dirAng) * f.dirs[k].lenNext, p0.y + std::sin (f.dirs[k].dirAng) * f.dirs[k].lenNext };
+	const API_Coord  p2 = { p3.x - std::cos (f.dirs[k + 1].dirAng) * f.dirs[k + 1].lenPrev, p3.y - std::sin (f.dirs[k + 1].dirAng) * f.dirs[k + 1].lenPrev };
+	const double s = 1.0 - t;
+	const double b0 = s * s * s, b1 = 3.0 * s * s * t, b2 = 3.0 * s * t * t, b3 = t * t * t;
+	return { b0 * p0.x + b1 * p1.x + b2 * p2.x + b3 * p3.x, b0 * p0.y + b1 * p1.y + b2 * p2.y + b3 * p3.y };
+}
+
+// Наибольшее расстояние от точек до кривой: кривая — плотная ломаная
+double MaxDeviation (const Fit& f, const std::vector<API_Coord>& pts)
+{
+	const int kSteps = 400;
+	std::vector<API_Coord> poly;
+	for (size_t k = 0; k + 1 < f.coords.size (); ++k)
+		for (int i = (k == 0 ? 0 : 1); i <= kSteps; ++i)
+			poly.push_back (Eval (f, k, (double) i / kSteps));
+
+	double worst = 0.0;
+	for (const API_Coord& p : pts) {
+		double best = 1e300;
+		for (size_t i = 0; i + 1 < poly.size (); ++i) {
+			const API_Coord& a = poly[i];
+			const API_Coord& b = poly[i + 1];
+			const double rx = b.x - a.x, ry = b.y - a.y, len2 = rx * rx + ry * ry;
+			double t = len2 > 0.0 ? ((p.x - a.x) * rx + (p.y - a.y) * ry) / len2 : 0.0;
+			t = std::fmin (std::fmax (t, 0.0), 1.0);
+			best = std::fmin (best, std::hypot (p.x - a.x - rx * t, p.y - a.y - ry * t));
+		}
+		worst = std::fmax (worst, best);
+	}
+	return worst;
+}
+
+std::vector<API_Coord> ArcPoints (double r, double sweep, double stepM)
+{
+	std::vector<API_Coord> pts;
+	const int n = (int) std::ceil (r * sweep / stepM);
+	for (int i = 0; i <= n; ++i) {
+		const double a = sweep * i / n;
+		pts.push_back ({ r * std::cos (a), r * std::sin (a) });
+	}
+	return pts;
+}
+
+// Трасса: прямая, переходная дуга, синусоида — как точки отбора кромки дороги
+std::vector<API_Coord> RoadPoints ()
+{
+	std::vector<API_Coord> pts;
+	for (int i = 0; i <= 40; ++i) pts.push_back ({ 0.5 * i, 0.0 });
+	for (int i = 1; i <= 60; ++i) {
+		const double a = -kPI / 2.0 + (kPI / 2.0) * i / 60.0;
+		pts.push_back ({ 20.0 + 30.0 * std::cos (a), 30.0 + 30.0 * std::sin (a) });
+	}
+	for (int i = 1; i <= 200; ++i) {
+		const double y = 30.0 + 0.5 * i;
+		pts.push_back ({ 50.0 + 3.0 * std::sin (y / 8.0), y });
+	}
+	return pts;
+}
+
+void TestTolerance ()
+{
+	const std::vector<API_Coord> road = RoadPoints ();
+	UInt32 prevKnots = 0xFFFFFFFFu;
+	for (double tol : { 0.0005, 0.001, 0.005, 0.02, 0.1 }) {
+		const Fit f = Run (road, tol);
+		CHECK (f.ok && f.coords.size () == f.dirs.size (), "допуск %g: FitSpline", tol);
+		if (!f.ok) continue;
+		const double dev = MaxDeviation (f, road);
+		// кривая проверяется ломаной — запас на её хорды
+		CHECK (dev <= tol * 1.01 + 1e-6, "допуск %g: отклонение %g", tol, dev);
+		// Stats меряет до точки кривой при параметре точки — не меньше расстояния до кривой
+		CHECK (f.stats.maxErrM <= tol + 1e-12 && f.stats.maxErrM >= dev - 1e-4, "допуск %g: Stats.maxErrM %g, по кривой %g", tol, f.stats.maxErrM, dev);
+		CHECK (f.stats.knots == f.coords.size () && f.stats.inPoints == road.size (), "допуск %g: Stats", tol);
+		CHECK (f.stats.knots <= prevKnots, "допуск %g: узлов %u больше, чем при меньшем допуске (%u)", tol, f.stats.knots, prevKnots);
+		CHECK (f.stats.knots * 5 < road.size (), "допуск %g: узлов %u на %zu точек", tol, f.stats.knots, road.size ());
+		prevKnots = f.stats.knots;
+
+		// концы — первая и последняя точки, ручек за концами нет
+		CHECK (std::hypot (f.coords.front ().x - road.front ().x, f.coords.front ().y - road.front ().y) < 1e-12 &&
+			   std::hypot (f.coords.back ().x - road.back ().x, f.coords.back ().y - road.back ().y) < 1e-12, "допуск %g: концы сдвинуты", tol);
+		CHECK (f.dirs.front ().lenPrev == 0.0 && f.dirs.back ().lenNext == 0.0, "допуск %g: ручки за концами", tol);
+	}
+}
+
+void TestShapes ()
+{
+	// прямая — один кусок, ручки вдоль неё
+	std::vector<API_Coord> line;
+	for (int i = 0; i <= 50; ++i) line.push_back ({ 2.0 * i, 1.0 * i });
+	Fit f = Run (line, 0.001);
+	CHECK (f.ok && f.coords.size () == 2 && MaxDeviation (f, line) < 1e-9, "прямая: узлов %zu", f.coords.size ());
+	CHECK (f.ok && std::fabs (f.dirs[0].dirAng - std::atan2 (1.0, 2.0)) < 1e-12, "прямая: направление %g", f.ok ? f.dirs[0].dirAng : 0.0);
+
+	// четверть окружности r = 50 — несколько кусков в пределах допуска
+	const std::vector<API_Coord> arc = ArcPoints (50.0, kPI / 2.0, 0.5);
+	f = Run (arc, 0.001);
+	CHECK (f.ok && f.coords.size () >= 3 && f.coords.size () * 10 < arc.size (), "дуга: узлов %zu на %zu точек", f.coords.size (), arc.size ());
+	CHECK (f.ok && MaxDeviation (f, arc) <= 0.00101, "дуга: отклонение %g", f.ok ? MaxDeviation (f, arc) : 0.0);
+
+	// совпадающие подряд точки не считаются
+	std::vector<API_Coord> dup;
+	for (const API_Coord& p : arc) { dup.push_back (p); dup.push_back (p); }
+	f = Run (dup, 0.001);
+	CHECK (f.ok && f.stats.inPoints == arc.size (), "повторы: точек %u, ожидалось %zu", f.stats.inPoints, arc.size ());
+
+	// замкнутый контур: в первом и последнем узле одно направление
+	std::vector<API_Coord> circle = ArcPoints (10.0, 2.0 * kPI, 0.25);
+	circle.back () = circle.front ();
+	f = Run (circle, 0.001, true);
+	CHECK (f.ok && std::fabs (f.dirs.front ().dirAng - f.dirs.back ().dirAng) < 1e-12, "замкнутый: направления %g и %g",
+		   f.ok ? f.dirs.front ().dirAng : 0.0, f.ok ? f.dirs.back ().dirAng : 0.0);
+	CHECK (f.ok && std::fabs (f.dirs.front ().dirAng - kPI / 2.0) < 1e-3, "замкнутый: касательная %g", f.ok ? f.dirs.front ().dirAng : 0.0);
+	CHECK (f.ok && MaxDeviation (f, circle) <= 0.00101, "замкнутый: отклонение %g", f.ok ? MaxDeviation (f, circle) : 0.0);
+}
+
+void TestDegenerate ()
+{
+	const std::vector<API_Coord> one = { { 1, 1 } };
+	const std::vector<API_Coord> same = { { 1, 1 }, { 1, 1 }, { 1, 1 } };
+	const std::vector<API_Coord> two = { { 0, 0 }, { 3, 4 } };
+	CHECK (!Run ({}, 0.001).ok, "пустой вход");
+	CHECK (!Run (one, 0.001).ok, "одна точка");
+	CHECK (!Run (same, 0.001).ok, "все точки совпадают");
+	CHECK (!Run (two, 0.0).ok && !Run (two, -1.0).ok, "допуск <= 0");
+
+	const Fit f = Run (two, 0.001);
+	CHECK (f.ok && f.coords.size () == 2 && std::fabs (f.dirs[0].lenNext + f.dirs[1].lenPrev - 10.0 / 3.0) < 1e-9,
+		   "две точки: узлов %zu", f.coords.size ());
+}
+
+} // namespace
+
+int main ()
+{
+	TestTolerance ();
+	TestShapes ();
+	TestDegenerate ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,423 @@
+// Чтение DXF: один и тот же чертёж в ASCII, двоичном R12 и двоичном R13+
+// должен давать одинаковые сущности; проверяются заголовок (кодировка,
+// $INSUNITS), пересчёт OCS, фильтр слоёв, сборка MTEXT из кусков (3, затем 1)
+// и ошибки на оборванном файле.
+
+#include "DxfReader.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace DxfReader;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+// =============================================================================
+// Запись DXF в память
+// =============================================================================
+
+enum class Format { Ascii, BinaryR12, BinaryR13 };
+
+const char* NameOf (Format format)
+{
+	switch (format) {
+	case Format::Ascii:     return "ASCII";
+	case Format::BinaryR12: return "R12";
+	case Format::BinaryR13: return "R13+";
+	}
+	return "?";
+}
+
+class Writer {
+public:
+	explicit Writer (Format f) : format (f)
+	{
+		if (format != Format::Ascii)
+			bytes.append ("AutoCAD Binary DXF\r\n\x1a", 22);   // с нулём в конце
+		boundaries.push_back (bytes.size ());
+	}
+
+	void Str (int code, const char* value)
+	{
+		Code (code);
+		if (format == Format::Ascii) { bytes += value; bytes += "\r\n"; }
+		else                         bytes.append (value, std::strlen (value) + 1);
+		boundaries.push_back (bytes.size ());
+	}
+
+	void Real (int code, double value)
+	{
+		Code (code);
+		if (format == Format::Ascii) {
+			char buf[64];
+			std::snprintf (buf, sizeof (buf), "%.12g\r\n", value);
+			bytes += buf;
+		} else {
+			std::uint64_t u;
+			std::memcpy (&u, &value, 8);
+			for (int k = 0; k < 8; ++k) bytes += (char) (u >> (8 * k));
+		}
+		boundaries.push_back (bytes.size ());
+	}
+
+	void Int16 (int code, int value)
+	{
+		Code (code);
+		if (format == Format::Ascii) {
+			char buf[32];
+			std::snprintf (buf, sizeof (buf), "%6d\r\n", value);
+			bytes += buf;
+		} else {
+			bytes += (char) (value & 0xFF);
+			bytes += (char) ((value >> 8) & 0xFF);
+		}
+		boundaries.push_back (bytes.size ());
+	}
+
+	const std::string&              Bytes () const      { return bytes; }
+	// Смещения границ групп: обрезка ровно по ним — не ошибка
+	const std::vector<std::size_t>& Boundaries () const { return boundaries; }
+	// Смещения начала значений ASCII-групп (строка кода прочитана, значения нет)
+	const std::vector<std::size_t>& ValueStarts () const { return valueStarts; }
+
+private:
+	void Code (int code)
+	{
+		switch (format) {
+		case Format::Ascii: {
+			char buf[16];
+			std::snprintf (buf, sizeof (buf), "%3d\r\n", code);
+			bytes += buf;
+			valueStarts.push_back (bytes.size ());
+			break;
+		}
+		case Format::BinaryR12:
+			if (code < 255) { bytes += (char) code; break; }
+			bytes += (char) 255;
+			// fall through — дальше 2 байта кода, как в R13+
+		case Format::BinaryR13:
+			bytes += (char) (code & 0xFF);
+			bytes += (char) ((code >> 8) & 0xFF);
+			break;
+		}
+	}
+
+	Format                   format;
+	std::string              bytes;
+	std::vector<std::size_t> boundaries;
+	std::vector<std::size_t> valueStarts;
+};
+
+// Тестовый чертёж: заголовок, пропускаемая секция TABLES и семь сущностей
+void WriteDrawing (Writer& w, const char* acadVer, int insUnits)
+{
+	w.Str (0, "SECTION"); w.Str (2, "HEADER");
+	w.Str (9, "$ACADVER");     w.Str (1, acadVer);
+	w.Str (9, "$DWGCODEPAGE"); w.Str (3, "ANSI_1251");
+	w.Str (9, "$INSUNITS");    w.Int16 (70, insUnits);
+	w.Str (9, "$EXTMIN");      w.Real (10, -1.0); w.Real (20, -2.0); w.Real (30, 0.0);
+	w.Str (0, "ENDSEC");
+
+	w.Str (0, "SECTION"); w.Str (2, "TABLES");
+	w.Str (0, "TABLE");   w.Str (2, "LAYER"); w.Int16 (70, 1);
+	w.Str (0, "ENDTAB");
+	w.Str (0, "ENDSEC");
+
+	w.Str (0, "SECTION"); w.Str (2, "ENTITIES");
+
+	// окружность на слое Arcs
+	w.Str (0, "CIRCLE"); w.Str (5, "1A"); w.Str (8, "Arcs");
+	w.Real (10, 10.5); w.Real (20, 20.25); w.Real (30, 0.0); w.Real (40, 1.0);
+
+	// дуга с нормалью (0,0,-1): OCS X = -WCS X
+	w.Str (0, "ARC"); w.Str (8, "ARCS");
+	w.Real (10, 5.0); w.Real (20, 7.0); w.Real (30, 0.0); w.Real (40, 2.0);
+	w.Real (50, 0.0); w.Real (51, 90.0);
+	w.Real (210, 0.0); w.Real (220, 0.0); w.Real (230, -1.0);
+
+	// точка чужого слоя — не доходит до приёмника
+	w.Str (0, "POINT"); w.Str (8, "Other");
+	w.Real (10, 99.0); w.Real (20, 99.0); w.Real (30, 0.0);
+
+	// надпись с наклонной нормалью: OCS -> WCS по «произвольной оси»
+	w.Str (0, "TEXT"); w.Str (8, "Texts");
+	w.Real (10, 1.0); w.Real (20, 2.0); w.Real (30, 3.0); w.Real (40, 0.25);
+	w.Str (1, "125.40");
+	w.Real (210, 1.0); w.Real (220, 0.0); w.Real (230, 0.0);
+
+	// MTEXT: куски кода 3 по порядку, затем последний кусок кода 1;
+	// нормаль MTEXT — направление, точка вставки уже в WCS
+	w.Str (0, "MTEXT"); w.Str (8, "texts");
+	w.Real (10, -3.0); w.Real (20, 4.0); w.Real (30, 0.0);
+	w.Str (3, "AAA"); w.Str (3, "BBB"); w.Str (1, "CCC");
+	w.Real (210, 0.0); w.Real (220, 0.0); w.Real (230, -1.0);
+
+	// вставка без кода 8 — слой "0"
+	w.Str (0, "INSERT"); w.Str (2, "BLK");
+	w.Real (10, 8.0); w.Real (20, 9.0); w.Real (30, 0.0);
+	w.Int16 (1070, 7);   // расширенные данные: двухбайтовый код и в R12
+
+	// неподдерживаемая сущность — только считается
+	w.Str (0, "LINE"); w.Str (8, "Arcs");
+	w.Real (10, 0.0); w.Real (20, 0.0); w.Real (11, 1.0); w.Real (21, 1.0);
+
+	w.Str (0, "ENDSEC");
+	w.Str (0, "EOF");
+}
+
+// =============================================================================
+// Приёмник
+// =============================================================================
+
+struct Item {
+	EntityKind  kind;
+	std::string layer;
+	double      x, y;
+	std::string text;
+	bool        isText;
+};
+
+class Recorder : public Sink {
+public:
+	explicit Recorder (std::vector<const char*> wanted, std::size_t stop = 0) : layers (std::move (wanted)), stopAfter (stop) {}
+
+	void OnHeader (bool u, const char* cp, int units) override
+	{
+		++headers;
+		utf8 = u;
+		codepage = cp;
+		insUnits = units;
+	}
+
+	bool WantLayer (const char* layer) override
+	{
+		if (layers.empty ()) return true;
+		for (const char* l : layers)
+			if (SameName (l, layer)) return true;
+		return false;
+	}
+
+	bool OnPoint (EntityKind kind, const char* layer, double x, double y) override
+	{
+		items.push_back ({ kind, layer, x, y, std::string (), false });
+		return stopAfter == 0 || items.size () < stopAfter;
+	}
+
+	bool OnText (EntityKind kind, const char* layer, double x, double y, const char* text, std::size_t len) override
+	{
+		items.push_back ({ kind, layer, x, y, std::string (text, len), true });
+		return stopAfter == 0 || items.size () < stopAfter;
+	}
+
+	std::vector<const char*> layers;
+	std::size_t              stopAfter;
+	int                      headers = 0;
+	bool                     utf8 = false;
+	std::string              codepage;
+	int                      insUnits = -1;
+	std::vector<Item>        items;
+};
+
+// Байты -> временный файл -> Read
+bool ReadBytes (const std::string& bytes, Sink& sink, Stats* stats, std::string* error)
+{
+	std::FILE* f = std::tmpfile ();
+	if (f == nullptr) {
+		CHECK (false, "tmpfile не создан");
+		return false;
+	}
+	std::fwrite (bytes.data (), 1, bytes.size (), f);
+	std::rewind (f);
+	const bool ok = Read (f, sink, stats, error);
+	std::fclose (f);
+	return ok;
+}
+
+bool Near (double a, double b)
+{
+	return std::fabs (a - b) < 1e-9;
+}
+
+// =============================================================================
+// Тесты
+// =============================================================================
+
+void TestFormat (Format format)
+{
+	const char* name = NameOf (format);
+	Writer w (format);
+	WriteDrawing (w, "AC1015", 4);
+
+	Recorder sink ({ "arcs", "TEXTS", "0" });
+	Stats st;
+	std::string error;
+	const bool ok = ReadBytes (w.Bytes (), sink, &st, &error);
+	CHECK (ok, "%s: чтение не прошло: %s", name, error.c_str ());
+	if (!ok) return;
+
+	CHECK (st.binary == (format != Format::Ascii), "%s: binary=%d", name, (int) st.binary);
+	CHECK (st.bytes == w.Bytes ().size (), "%s: прочитано %llu из %zu байт", name, (unsigned long long) st.bytes, w.Bytes ().size ());
+	CHECK (st.entities == 7, "%s: сущностей %u, ожидалось 7", name, (unsigned) st.entities);
+	CHECK (st.delivered == 5, "%s: передано %u, ожидалось 5", name, (unsigned) st.delivered);
+
+	CHECK (sink.headers == 1, "%s: OnHeader вызван %d раз", name, sink.headers);
+	CHECK (!sink.utf8, "%s: AC1015 — не UTF-8", name);
+	CHECK (sink.codepage == "ANSI_1251", "%s: кодовая страница '%s'", name, sink.codepage.c_str ());
+	CHECK (sink.insUnits == 4, "%s: $INSUNITS=%d, ожидалось 4", name, sink.insUnits);
+
+	CHECK (sink.items.size () == 5, "%s: сущностей у приёмника %zu, ожидалось 5", name, sink.items.size ());
+	if (sink.items.size () != 5) return;
+
+	const Item& circle = sink.items[0];
+	CHECK (circle.kind == EntityKind::Circle && circle.layer == "Arcs" && Near (circle.x, 10.5) && Near (circle.y, 20.25),
+		   "%s: CIRCLE (%g, %g) на '%s'", name, circle.x, circle.y, circle.layer.c_str ());
+
+	const Item& arc = sink.items[1];
+	CHECK (arc.kind == EntityKind::Arc && Near (arc.x, -5.0) && Near (arc.y, 7.0),
+		   "%s: ARC с нормалью -Z: (%g, %g), ожидалось (-5, 7)", name, arc.x, arc.y);
+
+	// N = +X: ось X OCS = Wz x N = (0,1,0), ось Y = N x Ax = (0,0,1)
+	const Item& text = sink.items[2];
+	CHECK (text.kind == EntityKind::Text && text.isText && text.text == "125.40",
+		   "%s: TEXT '%s'", name, text.text.c_str ());
+	CHECK (Near (text.x, 3.0) && Near (text.y, 1.0), "%s: TEXT с нормалью +X: (%g, %g), ожидалось (3, 1)", name, text.x, text.y);
+
+	const Item& mtext = sink.items[3];
+	CHECK (mtext.kind == EntityKind::MText && mtext.text == "AAABBBCCC",
+		   "%s: MTEXT '%s', ожидалось 'AAABBBCCC'", name, mtext.text.c_str ());
+	CHECK (Near (mtext.x, -3.0) && Near (mtext.y, 4.0), "%s: MTEXT пересчитан как OCS: (%g, %g)", name, mtext.x, mtext.y);
+
+	const Item& insert = sink.items[4];
+	CHECK (insert.kind == EntityKind::Insert && insert.layer.empty () && Near (insert.x, 8.0) && Near (insert.y, 9.0),
+		   "%s: INSERT (%g, %g) на '%s'", name, insert.x, insert.y, insert.layer.c_str ());
+}
+
+void TestHeader ()
+{
+	// AC1021 (R2007) и новее — строки в UTF-8; нет $INSUNITS — 0
+	Writer w (Format::Ascii);
+	w.Str (0, "SECTION"); w.Str (2, "HEADER");
+	w.Str (9, "$ACADVER"); w.Str (1, "AC1027");
+	w.Str (0, "ENDSEC");
+	w.Str (0, "SECTION"); w.Str (2, "ENTITIES");
+	w.Str (0, "ENDSEC");
+	w.Str (0, "EOF");
+
+	Recorder sink ({});
+	std::string error;
+	CHECK (ReadBytes (w.Bytes (), sink, nullptr, &error), "AC1027: %s", error.c_str ());
+	CHECK (sink.headers == 1 && sink.utf8, "AC1027: utf8=%d", (int) sink.utf8);
+	CHECK (sink.insUnits == 0, "без $INSUNITS: %d", sink.insUnits);
+
+	CHECK (UnitMeters (0) == 0.0, "без единиц: %g", UnitMeters (0));
+	CHECK (UnitMeters (4) == 0.001, "мм: %g", UnitMeters (4));
+	CHECK (UnitMeters (5) == 0.01, "см: %g", UnitMeters (5));
+	CHECK (UnitMeters (6) == 1.0, "м: %g", UnitMeters (6));
+	CHECK (UnitMeters (1) == 0.0254, "дюймы: %g", UnitMeters (1));
+	CHECK (UnitMeters (99) == 0.0, "неизвестный код: %g", UnitMeters (99));
+}
+
+void TestLayerFilter ()
+{
+	for (Format format : { Format::Ascii, Format::BinaryR12, Format::BinaryR13 }) {
+		Writer w (format);
+		WriteDrawing (w, "AC1015", 6);
+
+		Recorder all ({});
+		Stats st;
+		CHECK (ReadBytes (w.Bytes (), all, &st, nullptr), "%s: все слои", NameOf (format));
+		CHECK (all.items.size () == 6 && st.delivered == 6, "%s: все слои — %zu сущностей", NameOf (format), all.items.size ());
+
+		Recorder texts ({ "tExTs" });
+		CHECK (ReadBytes (w.Bytes (), texts, nullptr, nullptr), "%s: слой Texts", NameOf (format));
+		bool onlyTexts = texts.items.size () == 2;
+		for (const Item& it : texts.items) onlyTexts = onlyTexts && it.isText && SameName (it.layer.c_str (), "TEXTS");
+		CHECK (onlyTexts, "%s: фильтр слоя Texts — %zu сущностей", NameOf (format), texts.items.size ());
+
+		Recorder none ({ "Missing" });
+		CHECK (ReadBytes (w.Bytes (), none, &st, nullptr), "%s: пустой фильтр", NameOf (format));
+		CHECK (none.items.empty () && st.delivered == 0 && st.entities == 7,
+			   "%s: чужой слой — %zu сущностей, всего %u", NameOf (format), none.items.size (), (unsigned) st.entities);
+
+		// остановка приёмником: файл дальше не читается
+		Recorder first ({}, 1);
+		CHECK (ReadBytes (w.Bytes (), first, &st, nullptr), "%s: остановка", NameOf (format));
+		CHECK (first.items.size () == 1, "%s: после остановки %zu сущностей", NameOf (format), first.items.size ());
+	}
+}
+
+void TestTruncated ()
+{
+	// двоичный: обрезка внутри группы — ошибка, ровно по границе — нет
+	for (Format format : { Format::BinaryR12, Format::BinaryR13 }) {
+		Writer w (format);
+		WriteDrawing (w, "AC1015", 4);
+		const std::string& full = w.Bytes ();
+		const std::vector<std::size_t>& bounds = w.Boundaries ();
+		std::size_t b = 0;
+		int wrong = 0;
+		// с первой полной группы (0/SECTION) — иначе «не DXF»
+		for (std::size_t cut = bounds[1]; cut < full.size (); ++cut) {
+			while (b < bounds.size () && bounds[b] < cut) ++b;
+			const bool atBoundary = b < bounds.size () && bounds[b] == cut;
+			Recorder sink ({});
+			std::string error;
+			const bool ok = ReadBytes (full.substr (0, cut), sink, nullptr, &error);
+			if (ok != atBoundary || (!ok && error.empty ())) {
+				if (wrong++ < 5)
+					CHECK (false, "%s: обрезка на %zu байте: ok=%d, граница=%d, ошибка '%s'",
+						   NameOf (format), cut, (int) ok, (int) atBoundary, error.c_str ());
+			}
+		}
+		CHECK (wrong == 0, "%s: неверных исходов обрезки %d", NameOf (format), wrong);
+	}
+
+	// ASCII: код группы без значения
+	{
+		Writer w (Format::Ascii);
+		WriteDrawing (w, "AC1015", 4);
+		int wrong = 0;
+		for (std::size_t cut : w.ValueStarts ()) {
+			if (cut == w.ValueStarts ().front ()) continue;
+			Recorder sink ({});
+			std::string error;
+			if (ReadBytes (w.Bytes ().substr (0, cut), sink, nullptr, &error) || error.find ("строка") == std::string::npos) {
+				if (wrong++ < 5)
+					CHECK (false, "ASCII: обрезка после кода на %zu байте не дала ошибки ('%s')", cut, error.c_str ());
+			}
+		}
+		CHECK (wrong == 0, "ASCII: неверных исходов обрезки %d", wrong);
+	}
+
+	// не DXF
+	{
+		Recorder sink ({});
+		std::string error;
+		CHECK (!ReadBytes ("hello\nworld\n", sink, nullptr, &error) && !error.empty (), "текст без кодов групп прочитан как DXF");
+		CHECK (!ReadBytes ("", sink, nullptr, &error) && !error.empty (), "пустой файл прочитан как DXF");
+	}
+}
+
+} // namespace
+
+int main ()
+{
+	TestFormat (Format::Ascii);
+	TestFormat (Format::BinaryR12);
+	TestFormat (Format::BinaryR13);
+	TestHeader ();
+	TestLayerFilter ();
+	TestTruncated ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// Шаблоны надписей-отметок: таблица «шаблон, надпись — отметка или отказ»
+// для документированных форм (#, «ур. #», «H=#», «# м», «?#*»), экранирования
+// и десятичного разделителя; ошибки компиляции шаблона.
+
+#include "LabelPattern.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+using U16 = std::vector<std::uint16_t>;
+
+// UTF-8 (до U+FFFF) -> UTF-16
+U16 ToUtf16 (const std::string& s)
+{
+	U16 out;
+	for (std::size_t i = 0; i < s.size ();) {
+		const unsigned char c = (unsigned char) s[i];
+		unsigned cp;
+		if (c < 0x80)      { cp = c; i += 1; }
+		else if (c < 0xE0) { cp = ((c & 0x1Fu) << 6) | (s[i + 1] & 0x3Fu); i += 2; }
+		else               { cp = ((c & 0x0Fu) << 12) | ((s[i + 1] & 0x3Fu) << 6) | (s[i + 2] & 0x3Fu); i += 3; }
+		out.push_back ((std::uint16_t) cp);
+	}
+	return out;
+}
+
+bool Compile (LabelPattern::Matcher& matcher, const char* pattern, char sep, std::string* error = nullptr)
+{
+	const U16 p = ToUtf16 (pattern);
+	return matcher.Compile (p.data (), p.size (), sep, error);
+}
+
+const double kNoMatch = -1e300;
+
+struct Case {
+	const char* pattern;
+	char        sep;
+	const char* text;
+	double      expectedMm;   // kNoMatch — надпись не подходит
+};
+
+const Case kCases[] = {
+	// голое число
+	{ "#",          '.', "125.40",              125400.0 },
+	{ "#",          '.', "  125.40\t",          125400.0 },   // пробелы по краям не в счёт
+	{ "#",          '.', "-1.5",                -1500.0 },
+	{ "#",          '.', "\xE2\x88\x92" "2",    -2000.0 },    // «−2»
+	{ "#",          '.', "\xC2\xB1" "0.000",    0.0 },        // «±0.000»
+	{ "#",          '.', "+3",                  3000.0 },
+	{ "#",          '.', ".5",                  500.0 },
+	{ "#",          '.', "12.",                 12000.0 },
+	{ "#",          '.', "0.0001",              0.1 },
+	{ "#",          '.', "",                    kNoMatch },
+	{ "#",          '.', "abc",                 kNoMatch },
+	{ "#",          '.', "1.2.3",               kNoMatch },
+	{ "#",          '.', "12a",                 kNoMatch },
+	{ "#",          '.', "-",                   kNoMatch },
+	{ "#",          '.', ".",                   kNoMatch },
+	{ "#",          '.', "+-1",                 kNoMatch },
+	{ "#",          '.', "1 2",                 kNoMatch },
+	// десятичный разделитель из настроек
+	{ "#",          ',', "12,5",                12500.0 },
+	{ "#",          ',', "12.5",                kNoMatch },
+	{ "#",          '.', "12,5",                kNoMatch },
+	// «ур. #»: без учёта регистра, пробел — ноль или больше
+	{ "ур. #",      ',', "ур. 12,50",           12500.0 },
+	{ "ур. #",      ',', "УР.   -0,75",         -750.0 },
+	{ "ур. #",      ',', "ур.12,5",             12500.0 },
+	{ "ур. #",      ',', "ур 12,5",             kNoMatch },
+	{ "ур. #",      ',', "ур. 12,5 м",          kNoMatch },
+	// «H=#»
+	{ "H=#",        '.', "H=100.5",             100500.0 },
+	{ "H=#",        '.', "h=100.5",             100500.0 },
+	{ "H=#",        '.', "H = 100.5",           kNoMatch },
+	{ "H=#",        '.', "100.5",               kNoMatch },
+	// «# м»
+	{ "# м",        '.', "12.5 м",              12500.0 },
+	{ "# м",        '.', "12.5М",               12500.0 },
+	{ "# м",        '.', "12.5\xC2\xA0м",       12500.0 },    // неразрывный пробел
+	{ "# м",        '.', "12.5 m",              kNoMatch },
+	// «?#*»: один любой символ, число, любой хвост
+	{ "?#*",        '.', "\xE2\x96\xB2" "125.4 (ПК3)", 125400.0 },   // «▲125.4 (ПК3)»
+	{ "?#*",        '.', "x-3",                 -3000.0 },
+	{ "?#*",        '.', "125.4",               25400.0 },    // «?» съедает первую цифру
+	{ "?#*",        '.', "\xE2\x96\xB2",        kNoMatch },
+	// альтернативы: подошло несколько — первая, граница числа у каждой своя
+	{ "?#|#",       '.', "12",                  2000.0 },
+	{ "#|?#",       '.', "12",                  12000.0 },
+	{ "#|ур. #|H=#|# м|?#", '.', "H=7",         7000.0 },
+	{ "#|ур. #|H=#|# м|?#", '.', "ур. 8.5",     8500.0 },
+	{ "#|ур. #|H=#|# м|?#", '.', "\xE2\x96\xB2" "9", 9000.0 },
+	{ "#|ур. #|H=#|# м|?#", '.', "отм. 9",      kNoMatch },
+	// экранирование
+	{ "N\\##",      '.', "N#12",                12000.0 },
+	{ "N\\##",      '.', "N12",                 kNoMatch },
+	{ "#\\*",       '.', "12*",                 12000.0 },
+	{ "#\\*",       '.', "12x",                 kNoMatch },
+	{ "\\?#",       '.', "?5",                  5000.0 },
+	{ "\\?#",       '.', "x5",                  kNoMatch },
+	{ "a\\|#",      '.', "a|5",                 5000.0 },
+	{ "\\\\#",      '.', "\\5",                 5000.0 },
+	// кириллица без учёта регистра, включая «ё»
+	{ "отмётка #",  '.', "ОТМЁТКА 1",           1000.0 },
+};
+
+void TestTable ()
+{
+	for (const Case& c : kCases) {
+		LabelPattern::Matcher matcher;
+		std::string error;
+		if (!Compile (matcher, c.pattern, c.sep, &error)) {
+			CHECK (false, "'%s': ошибка компиляции: %s", c.pattern, error.c_str ());
+			continue;
+		}
+		const U16 text = ToUtf16 (c.text);
+		double mm = 0.0;
+		const bool ok = matcher.Match (text.data (), text.size (), mm);
+		if (c.expectedMm == kNoMatch)
+			CHECK (!ok, "'%s' / '%s': подошло (%g мм), ожидался отказ", c.pattern, c.text, mm);
+		else
+			CHECK (ok && std::fabs (mm - c.expectedMm) < 1e-9, "'%s' / '%s': %s %g мм, ожидалось %g",
+				   c.pattern, c.text, ok ? "" : "отказ,", mm, c.expectedMm);
+	}
+}
+
+void TestErrors ()
+{
+	const char* const kBad[] = {
+		"",               // нет «#»
+		"ур.",            // нет «#»
+		"##",             // два числа
+		"#|",             // пустая альтернатива
+		"#*x",            // «*» не в конце
+		"#\\",            // «\» в конце
+		"#?",             // «?» сразу после числа
+		"# 5",            // цифра после числа
+		"#.",             // разделитель после числа
+		"#-",             // знак после числа
+	};
+	for (const char* pattern : kBad) {
+		LabelPattern::Matcher matcher;
+		std::string error;
+		CHECK (!Compile (matcher, pattern, '.', &error), "'%s': ошибка не найдена", pattern);
+		CHECK (!error.empty (), "'%s': нет описания ошибки", pattern);
+		// не скомпилированный шаблон ничего не принимает
+		const U16 text = ToUtf16 ("1");
+		double mm = 0.0;
+		CHECK (!matcher.Match (text.data (), text.size (), mm), "'%s': принята надпись после ошибки", pattern);
+	}
+
+	// 32 альтернативы — предел масок, 33 — ошибка
+	std::string many = "#";
+	for (int i = 1; i < 32; ++i) many += "|#";
+	LabelPattern::Matcher matcher;
+	CHECK (Compile (matcher, many.c_str (), '.'), "32 альтернативы не компилируются");
+	many += "|#";
+	std::string error;
+	CHECK (!Compile (matcher, many.c_str (), '.', &error), "33 альтернативы компилируются");
+}
+
+void TestRecompile ()
+{
+	// тот же Matcher с другим шаблоном и разделителем — без следов прежнего
+	LabelPattern::Matcher matcher;
+	CHECK (Compile (matcher, "ур. #|# м", ','), "первый шаблон");
+	CHECK (matcher.GetStateCount () > 1, "нет состояний ДКА");
+	CHECK (Compile (matcher, "H=#", '.'), "второй шаблон");
+	double mm = 0.0;
+	const U16 old = ToUtf16 ("ур. 1,5"), cur = ToUtf16 ("H=1.5");
+	CHECK (!matcher.Match (old.data (), old.size (), mm), "прежний шаблон всё ещё действует");
+	CHECK (matcher.Match (cur.data (), cur.size (), mm) && mm == 1500.0, "новый шаблон: %g", mm);
+}
+
+} // namespace
+
+int main ()
+{
+	TestTable ();
+	TestErrors ();
+	TestRecompile ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+// Замер MText::Strip на надписях съёмки (UTF-8 и UTF-16).
+// Не тест: собирается вместе с тестами, запускается вручную:
+//   MTextBench [число надписей, по умолчанию 1000000] [чертёж.dxf]
+// С чертежом набор — его TEXT/MTEXT/ATTRIB (все слои) по кругу до заданного
+// числа: мерить стоит на настоящей съёмке, доли голых чисел и тяжёлого MTEXT
+// у разных бюро сильно разные. Без чертежа — встроенный набор: надписи по
+// образцам съёмок со случайными отметками и номерами точек.
+
+#include "DxfReader.hpp"
+#include "MText.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+// =============================================================================
+// Встроенный набор
+// =============================================================================
+
+// Образец надписи: «#» — отметка, «№» — номер точки; вес — сколько таких на
+// сотню надписей. Больше всего голых отметок TEXT, затем MTEXT из шаблонов
+// оформления (шрифт, высота, цвет), двухстрочные «номер/отметка», колодцы.
+struct Sample {
+	const char* text;
+	unsigned    weight;
+};
+
+const Sample kSamples[] = {
+	{ "#",                                                              34 },
+	{ "{\\fGOST type A|b0|i0|c204|p34;#}",                              12 },
+	{ "\\A1;#",                                                          8 },
+	{ "\\A1;\xE2\x84\x96\\P#",                                           8 },   // номер точки над отметкой
+	{ "\\pxqc;{\\fArial|b1|i0|c204|p34;\\C1;#}",                         5 },
+	{ "\xD1\x83\xD1\x80. #",                                             5 },   // «ур. #»
+	{ "{\\H2.5;\\C7;\xD0\xBB.#}\\P{\\H2.5;\xD1\x82.#}",                  4 },   // колодец: «л.#», «т.#»
+	{ "\\A1;{\\H0.7x;\\S#^;}",                                           4 },   // отметка верхним индексом
+	{ "H=#",                                                             3 },
+	{ "%%p0.000",                                                        3 },
+	{ "\\U+25B2#",                                                       3 },   // «▲#»
+	{ "%%c\xE2\x84\x96 \\~ #%%d",                                        2 },   // диаметр трубы и угол
+	{ "\\A1;\\H2.5;\\W0.8;\\C1;#\\P\\S+0^-1;",                           2 },
+	{ "{\\fGOST type A|b0|i0|c204|p34;\\H2.5;\xD0\x93\xD1\x80\xD1\x83\xD0\xBD\xD1\x82: "
+	  "\xD1\x81\xD1\x83\xD0\xB3\xD0\xBB\xD0\xB8\xD0\xBD\xD0\xBE\xD0\xBA\\P"
+	  "\xD0\xA3\xD0\x93\xD0\x92 #}",                                     2 },   // «Грунт: суглинок\PУГВ #»
+	{ "{\\fGOST type A|b0|i0|c204|p34;\\L#}",                            1 },
+};
+
+// xorshift32: набор один и тот же от запуска к запуску
+struct Random {
+	std::uint32_t state = 2463534242u;
+
+	std::uint32_t Next ()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+};
+
+std::string MakeLabel (Random& rnd)
+{
+	unsigned total = 0;
+	for (const Sample& s : kSamples) total += s.weight;
+	unsigned pick = rnd.Next () % total;
+	const Sample* sample = kSamples;
+	while (pick >= sample->weight) pick -= (sample++)->weight;
+
+	std::string label;
+	char number[32];
+	for (const char* p = sample->text; *p != '\0';) {
+		if (*p == '#') {
+			// отметка 90…220 м, в половине надписей — с запятой
+			const std::uint32_t cm = 9000 + rnd.Next () % 13000;
+			std::snprintf (number, sizeof (number), "%u%c%02u", cm / 100, (rnd.Next () & 1) ? '.' : ',', cm % 100);
+			label += number;
+			++p;
+		} else if (std::strncmp (p, "\xE2\x84\x96", 3) == 0) {
+			std::snprintf (number, sizeof (number), "%u", 1 + rnd.Next () % 3000);
+			label += number;
+			p += 3;
+		} else {
+			label += *p++;
+		}
+	}
+	return label;
+}
+
+// =============================================================================
+// Надписи из чертежа
+// =============================================================================
+
+// Однобайтовый текст (DWGCODEPAGE) — в UTF-16 по таблице ANSI_1251: в этой
+// странице сдают почти все съёмки; прочие старшие байты — «?», на замер не влияет
+std::vector<std::uint16_t> FromCodepage (const std::string& s)
+{
+	std::vector<std::uint16_t> out;
+	out.reserve (s.size ());
+	for (const char ch : s) {
+		const unsigned char c = (unsigned char) ch;
+		if (c < 0x80)       out.push_back (c);
+		else if (c >= 0xC0) out.push_back ((std::uint16_t) (0x0410 + (c - 0xC0)));
+		else if (c == 0xA8) out.push_back (0x0401);
+		else if (c == 0xB8) out.push_back (0x0451);
+		else                out.push_back ('?');
+	}
+	return out;
+}
+
+class TextCollector : public DxfReader::Sink {
+public:
+	bool                     utf8 = true;
+	std::vector<std::string> texts;
+
+	void OnHeader (bool u, const char* /*codepage*/, int /*insUnits*/) override { utf8 = u; }
+	bool WantLayer (const char* /*layer*/) override { return true; }
+	bool OnPoint (DxfReader::EntityKind /*kind*/, const char* /*layer*/, double /*x*/, double /*y*/) override { return true; }
+
+	bool OnText (DxfReader::EntityKind /*kind*/, const char* /*layer*/, double /*x*/, double /*y*/, const char* text, std::size_t len) override
+	{
+		if (len > 0) texts.emplace_back (text, len);
+		return true;
+	}
+};
+
+// =============================================================================
+// Замер
+// =============================================================================
+
+// UTF-8 (до U+FFFF) -> UTF-16
+std::vector<std::uint16_t> ToUtf16 (const std::string& s)
+{
+	std::vector<std::uint16_t> out;
+	for (std::size_t i = 0; i < s.size ();) {
+		const unsigned char c = (unsigned char) s[i];
+		unsigned cp;
+		if (c < 0x80)                            { cp = c; i += 1; }
+		else if (c < 0xE0 && i + 1 < s.size ())  { cp = ((c & 0x1Fu) << 6) | (s[i + 1] & 0x3Fu); i += 2; }
+		else if (c >= 0xE0 && i + 2 < s.size ()) { cp = ((c & 0x0Fu) << 12) | ((s[i + 1] & 0x3Fu) << 6) | (s[i + 2] & 0x3Fu); i += 3; }
+		else                                     { cp = '?'; i += 1; }   // оборванная последовательность
+		out.push_back ((std::uint16_t) cp);
+	}
+	return out;
+}
+
+// UTF-16 -> UTF-8 (для однобайтовых чертежей: путь UTF-8 мерится на тех же надписях)
+std::string ToUtf8 (const std::vector<std::uint16_t>& s)
+{
+	std::string out;
+	for (const std::uint16_t cp : s) {
+		if (cp < 0x80) {
+			out += (char) cp;
+		} else if (cp < 0x800) {
+			out += (char) (0xC0 | (cp >> 6));
+			out += (char) (0x80 | (cp & 0x3F));
+		} else {
+			out += (char) (0xE0 | (cp >> 12));
+			out += (char) (0x80 | ((cp >> 6) & 0x3F));
+			out += (char) (0x80 | (cp & 0x3F));
+		}
+	}
+	return out;
+}
+
+template <typename Char>
+void Run (const char* name, const std::vector<std::vector<Char>>& labels, std::size_t units)
+{
+	std::vector<Char> buf (4096);
+	std::size_t checksum = 0;
+	const auto t0 = std::chrono::steady_clock::now ();
+	for (const std::vector<Char>& label : labels) {
+		if (label.size () >= buf.size ()) buf.resize (label.size () + 1);
+		checksum += MText::Strip (label.data (), label.size (), buf.data (), buf.size ());
+	}
+	const auto t1 = std::chrono::steady_clock::now ();
+
+	const double sec = std::chrono::duration<double> (t1 - t0).count ();
+	std::printf ("%-6s %zu надписей, %.1f МБ: %.3f с, %.1f нс/надпись, %.0f МБ/с (контроль %zu)\n",
+		name, labels.size (), (double) (units * sizeof (Char)) / 1048576.0, sec,
+		sec * 1e9 / (double) labels.size (), (double) (units * sizeof (Char)) / 1048576.0 / sec, checksum);
+}
+
+} // namespace
+
+int main (int argc, char** argv)
+{
+	const std::size_t count = argc > 1 ? (std::size_t) std::strtoull (argv[1], nullptr, 10) : 1000000;
+
+	// набор: по надписи в UTF-8 и UTF-16
+	std::vector<std::string>                corpus8;
+	std::vector<std::vector<std::uint16_t>> corpus16;
+	if (argc > 2) {
+		std::FILE* f = std::fopen (argv[2], "rb");
+		if (f == nullptr) {
+			std::fprintf (stderr, "не открыть %s\n", argv[2]);
+			return 1;
+		}
+		TextCollector collector;
+		std::string error;
+		const bool ok = DxfReader::Read (f, collector, nullptr, &error);
+		std::fclose (f);
+		if (!ok) {
+			std::fprintf (stderr, "%s: %s\n", argv[2], error.c_str ());
+			return 1;
+		}
+		if (collector.texts.empty ()) {
+			std::fprintf (stderr, "%s: надписей нет\n", argv[2]);
+			return 1;
+		}
+		for (const std::string& t : collector.texts) {
+			corpus16.push_back (collector.utf8 ? ToUtf16 (t) : FromCodepage (t));
+			corpus8.push_back (collector.utf8 ? t : ToUtf8 (corpus16.back ()));
+		}
+		std::printf ("%s: %zu надписей%s\n", argv[2], corpus8.size (), collector.utf8 ? "" : " (однобайтовая кодовая страница)");
+	} else {
+		Random rnd;
+		for (std::size_t i = 0; i < 4096; ++i) {
+			corpus8.push_back (MakeLabel (rnd));
+			corpus16.push_back (ToUtf16 (corpus8.back ()));
+		}
+		std::printf ("встроенный набор: %zu надписей по %zu образцам\n", corpus8.size (), sizeof (kSamples) / sizeof (kSamples[0]));
+	}
+
+	std::vector<std::vector<char>>          utf8 (count);
+	std::vector<std::vector<std::uint16_t>> utf16 (count);
+	std::size_t bytes = 0, units = 0;
+	for (std::size_t i = 0; i < count; ++i) {
+		const std::string& s = corpus8[i % corpus8.size ()];
+		utf8[i].assign (s.begin (), s.end ());
+		utf16[i] = corpus16[i % corpus16.size ()];
+		bytes += utf8[i].size ();
+		units += utf16[i].size ();
+	}
+
+	Run ("UTF-8", utf8, bytes);
+	Run ("UTF-16", utf16, units);
+	return 0;
+}
@@ -0,0 +1,184 @@
+// Снятие кодов MTEXT: таблица «вход — ожидаемый текст» для обеих версий
+// Strip (UTF-8 и UTF-16), очистка на месте и обрезка по cap. UTF-16 — путь
+// DXF в однобайтовой кодовой странице: текст уже перекодирован, «°» и «±» должны
+// стать символами, а не байтами UTF-8.
+
+#include "MText.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+using U16 = std::vector<std::uint16_t>;
+
+// UTF-8 (до U+FFFF) -> UTF-16
+U16 ToUtf16 (const std::string& s)
+{
+	U16 out;
+	for (std::size_t i = 0; i < s.size ();) {
+		const unsigned char c = (unsigned char) s[i];
+		unsigned cp;
+		if (c < 0x80)      { cp = c; i += 1; }
+		else if (c < 0xE0) { cp = ((c & 0x1Fu) << 6) | (s[i + 1] & 0x3Fu); i += 2; }
+		else               { cp = ((c & 0x0Fu) << 12) | ((s[i + 1] & 0x3Fu) << 6) | (s[i + 2] & 0x3Fu); i += 3; }
+		out.push_back ((std::uint16_t) cp);
+	}
+	return out;
+}
+
+std::string Hex (const U16& u)
+{
+	std::string out;
+	char buf[8];
+	for (std::uint16_t c : u) {
+		std::snprintf (buf, sizeof (buf), c < 0x80 ? "%c" : "<%04X>", c);
+		out += buf;
+	}
+	return out;
+}
+
+struct Case {
+	const char* input;
+	const char* expected;   // UTF-8
+};
+
+const Case kCases[] = {
+	// обычный текст и отметки
+	{ "",                               "" },
+	{ "125.40",                         "125.40" },
+	{ "ур. 12,5 м",                     "ур. 12,5 м" },
+	// группы и коды с аргументом до ';'
+	{ "{\\fArial|b0|i0|c204|p34;125.40}", "125.40" },
+	{ "\\H2.5;\\W0.8;\\Q15;\\T1.1;\\A1;\\C1;\\c255;\\pxqc;12.3", "12.3" },
+	{ "{\\H1.5x;+}12.3",                "+12.3" },
+	{ "\\F",                            "" },   // без ';' — до конца
+	// коды без аргумента
+	{ "\\L12\\l.3\\O0\\o\\K\\k",        "12.30" },
+	{ "a\\Pb\\Nc\\Xd",                  "a\nb\nc\nd" },
+	{ "1\\~2",                          "1 2" },
+	{ "\\\\ \\{ \\}",                   "\\ { }" },
+	{ "\\Z",                            "Z" },   // неизвестный код — символ как есть
+	{ "12\\",                           "12\\" },   // обратная косая в конце
+	// дроби
+	{ "\\S1^2;",                        "1/2" },
+	{ "\\S3/4;",                        "3/4" },
+	{ "\\S5#6;",                        "5/6" },
+	{ "\\S1\\;2;x",                     "1;2x" },
+	// символы
+	{ "%%d",                            "\xC2\xB0" },
+	{ "%%p0.000",                       "\xC2\xB1" "0.000" },
+	{ "%%c100",                         "\xE2\x8C\x80" "100" },
+	{ "%%D%%P%%C",                      "\xC2\xB0\xC2\xB1\xE2\x8C\x80" },
+	{ "%%o%%u%%k12",                    "12" },
+	{ "100%%%",                         "100%" },
+	{ "%%177",                          "\xC2\xB1" },
+	{ "%%065",                          "A" },
+	{ "%%",                             "%%" },
+	{ "%%1",                            "%%1" },
+	{ "\\U+00B112.5",                   "\xC2\xB1" "12.5" },
+	{ "\\U+0416",                       "\xD0\x96" },
+	{ "\\U+00G1",                       "U+00G1" },   // не шестнадцатеричное — как неизвестный код
+	{ "\\U+0000",                       "U+0000" },   // 0 оборвал бы строку
+	{ "1\\U+D8002",                     "1U+D8002" }, // половинки суррогатных пар — не символ
+	{ "\\U+DFFF",                       "U+DFFF" },
+	{ "\\U+D7FF\\U+E000",               "\xED\x9F\xBF\xEE\x80\x80" },   // соседи диапазона — символы
+	{ "%%000",                          "%%000" },
+	{ "\\M+1814E12",                    "12" },
+	// всё вместе: типичная отметка из MTEXT
+	{ "{\\fGOST type A|b0|i0|c204|p34;\\H0.7x;%%p}\\U+0020{\\L1.250}\\P(\\S+0^-1;)", "\xC2\xB1 1.250\n(+0/-1)" },
+};
+
+void TestTable ()
+{
+	for (const Case& c : kCases) {
+		const std::size_t len = std::strlen (c.input);
+
+		// UTF-8
+		std::vector<char> out (len + 1, '\x7f');
+		const std::size_t n = MText::Strip (c.input, len, out.data (), out.size ());
+		const std::string got (out.data (), n);
+		CHECK (got == c.expected, "UTF-8 '%s': '%s', ожидалось '%s'", c.input, got.c_str (), c.expected);
+		CHECK (out[n] == '\0', "UTF-8 '%s': нет завершающего 0", c.input);
+
+		// UTF-16: вход как перекодированный текст, ожидание — те же символы
+		const U16 in16 = ToUtf16 (c.input);
+		const U16 expected16 = ToUtf16 (c.expected);
+		U16 out16 (in16.size () + 1, 0x7f);
+		const std::size_t n16 = MText::Strip (in16.data (), in16.size (), out16.data (), out16.size ());
+		const U16 got16 (out16.begin (), out16.begin () + n16);
+		CHECK (got16 == expected16, "UTF-16 '%s': '%s', ожидалось '%s'", c.input, Hex (got16).c_str (), Hex (expected16).c_str ());
+		CHECK (out16[n16] == 0, "UTF-16 '%s': нет завершающего 0", c.input);
+	}
+}
+
+void TestInPlace ()
+{
+	for (const Case& c : kCases) {
+		std::string buf (c.input);
+		buf.push_back ('\0');
+		const std::size_t n = MText::Strip (&buf[0], buf.size () - 1, &buf[0], buf.size ());
+		CHECK (std::string (buf.c_str (), n) == c.expected, "на месте '%s': '%s'", c.input, buf.c_str ());
+
+		U16 buf16 = ToUtf16 (c.input);
+		buf16.push_back (0);
+		const std::size_t n16 = MText::Strip (buf16.data (), buf16.size () - 1, buf16.data (), buf16.size ());
+		CHECK (U16 (buf16.begin (), buf16.begin () + n16) == ToUtf16 (c.expected), "UTF-16 на месте '%s'", c.input);
+	}
+}
+
+void TestCap ()
+{
+	// не больше cap-1 единиц и 0 в конце; cap == 0 — ничего не пишется
+	const char* input = "%%p12.500\\P";
+	for (std::size_t cap = 1; cap <= 8; ++cap) {
+		std::vector<char> out (cap + 1, '\x7f');
+		const std::size_t n = MText::Strip (input, std::strlen (input), out.data (), cap);
+		CHECK (n <= cap - 1 && out[n] == '\0' && out[cap] == '\x7f', "UTF-8 cap=%zu: длина %zu", cap, n);
+		CHECK (std::memcmp (out.data (), "\xC2\xB1" "12.500\n", n) == 0, "UTF-8 cap=%zu: не префикс результата", cap);
+
+		const U16 in16 = ToUtf16 (input);
+		U16 out16 (cap + 1, 0x7f);
+		const std::size_t n16 = MText::Strip (in16.data (), in16.size (), out16.data (), cap);
+		CHECK (n16 <= cap - 1 && out16[n16] == 0 && out16[cap] == 0x7f, "UTF-16 cap=%zu: длина %zu", cap, n16);
+	}
+	char untouched = 'x';
+	CHECK (MText::Strip ("12", 2, &untouched, 0) == 0 && untouched == 'x', "cap=0 — запись в dst");
+}
+
+void TestCodepageText ()
+{
+	// ANSI_1251 после перекодировки: кириллица — единицы > 0xFF, коды — ASCII
+	const U16 in = { 0x0423, 0x0440, '.', ' ', '%', '%', 'p', '0', '.', '0', '0', '0', ' ', 0x043C };
+	const U16 expected = { 0x0423, 0x0440, '.', ' ', 0x00B1, '0', '.', '0', '0', '0', ' ', 0x043C };
+	U16 out (in.size () + 1);
+	const std::size_t n = MText::Strip (in.data (), in.size (), out.data (), out.size ());
+	CHECK (U16 (out.begin (), out.begin () + n) == expected, "кириллица + %%%%p: '%s'", Hex (U16 (out.begin (), out.begin () + n)).c_str ());
+
+	// единица с младшим байтом '\\' или '%' — не код (U+045C, U+0425)
+	const U16 tricky = { 0x045C, 'P', 0x0425, 0x0425, 'd' };
+	U16 out2 (tricky.size () + 1);
+	const std::size_t n2 = MText::Strip (tricky.data (), tricky.size (), out2.data (), out2.size ());
+	CHECK (U16 (out2.begin (), out2.begin () + n2) == tricky, "U+045C/U+0425 приняты за код: '%s'", Hex (U16 (out2.begin (), out2.begin () + n2)).c_str ());
+}
+
+} // namespace
+
+int main ()
+{
+	TestTable ();
+	TestInPlace ();
+	TestCap ();
+	TestCodepageText ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
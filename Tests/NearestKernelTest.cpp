@@ -0,0 +1,108 @@
+// Сверка SIMD-реализаций NearestKernel со скалярным эталоном:
+// индекс и d2 должны совпадать точно, при равных расстояниях — меньший индекс.
+
+#include "NearestKernel.hpp"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace NearestKernel;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+struct Named {
+	Kernel      kernel;
+	const char* name;
+};
+
+const Named kSimd[] = { { Kernel::SSE2, "SSE2" }, { Kernel::AVX2, "AVX2" } };
+
+// Все доступные SIMD-ветки против эталона на одном наборе
+void Compare (const std::vector<float>& xs, const std::vector<float>& ys, float qx, float qy, float maxD2, const char* what)
+{
+	const std::size_t n = xs.size ();
+	float refD2 = -1.0f;
+	const std::size_t ref = FindNearestScalar (xs.data (), ys.data (), n, qx, qy, maxD2, refD2);
+
+	for (const Named& k : kSimd) {
+		const FindFn fn = GetKernel (k.kernel);
+		if (fn == nullptr) continue;
+		float d2 = -1.0f;
+		const std::size_t got = fn (xs.data (), ys.data (), n, qx, qy, maxD2, d2);
+		CHECK (got == ref, "%s %s n=%zu: индекс %zu, эталон %zu", k.name, what, n, got, ref);
+		if (got == ref && ref != kNone)
+			CHECK (d2 == refD2, "%s %s n=%zu: d2 %.9g, эталон %.9g", k.name, what, n, (double) d2, (double) refD2);
+	}
+}
+
+void TestRandom ()
+{
+	std::mt19937 rng (12345);
+	std::uniform_real_distribution<float> coord (-500.0f, 500.0f);
+	// все длины хвостов: n % 8 (AVX2) и n % 4 (SSE2) — от 0 до 7
+	for (std::size_t n = 0; n <= 67; ++n) {
+		for (int rep = 0; rep < 20; ++rep) {
+			std::vector<float> xs (n), ys (n);
+			for (std::size_t i = 0; i < n; ++i) { xs[i] = coord (rng); ys[i] = coord (rng); }
+			const float qx = coord (rng), qy = coord (rng);
+			Compare (xs, ys, qx, qy, 1.0e9f, "случайные");
+			Compare (xs, ys, qx, qy, 2500.0f, "случайные, радиус 50");
+		}
+	}
+	std::vector<float> xs (100003), ys (100003);
+	for (std::size_t i = 0; i < xs.size (); ++i) { xs[i] = coord (rng); ys[i] = coord (rng); }
+	for (int rep = 0; rep < 50; ++rep)
+		Compare (xs, ys, coord (rng), coord (rng), 100.0f, "большой");
+}
+
+void TestTies ()
+{
+	// одинаковые точки по всем дорожкам и в хвосте — выигрывает первая
+	for (std::size_t n = 1; n <= 35; ++n) {
+		for (std::size_t first = 0; first < n; ++first) {
+			std::vector<float> xs (n, 100.0f), ys (n, 100.0f);
+			for (std::size_t i = first; i < n; i += 3) { xs[i] = 1.0f; ys[i] = 2.0f; }
+			Compare (xs, ys, 0.0f, 0.0f, 1.0e9f, "равные");
+			float d2 = 0.0f;
+			CHECK (FindNearestScalar (xs.data (), ys.data (), n, 0.0f, 0.0f, 1.0e9f, d2) == first,
+				   "эталон n=%zu: ожидался индекс %zu", n, first);
+		}
+	}
+}
+
+void TestRadius ()
+{
+	// d2 == maxD2 входит, чуть больше — нет
+	std::vector<float> xs = { 3.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f };
+	std::vector<float> ys = { 4.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f };
+	for (std::size_t n = 1; n <= xs.size (); ++n) {
+		std::vector<float> x (xs.begin (), xs.begin () + n), y (ys.begin (), ys.begin () + n);
+		Compare (x, y, 0.0f, 0.0f, 25.0f, "на границе");
+		Compare (x, y, 0.0f, 0.0f, 24.99f, "вне радиуса");
+		float d2 = 0.0f;
+		CHECK (FindNearestScalar (x.data (), y.data (), n, 0.0f, 0.0f, 25.0f, d2) == 0, "граница радиуса не включена");
+		CHECK (FindNearestScalar (x.data (), y.data (), n, 0.0f, 0.0f, 24.99f, d2) == kNone, "точка вне радиуса найдена");
+	}
+}
+
+} // namespace
+
+int main ()
+{
+	for (const Named& k : kSimd)
+		std::printf ("%s: %s\n", k.name, GetKernel (k.kernel) != nullptr ? "проверяется" : "недоступна");
+	std::printf ("активная: %s\n", GetActiveKernelName ());
+
+	TestRandom ();
+	TestTies ();
+	TestRadius ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+// Эквидистанта цепочки отрезков/дуг: сдвиг отрезка и дуги, стыки
+// (скругление, митра, срез по miterLimit, внутренний угол), схлопнувшиеся
+// дуги, срез петель, замкнутый контур. Общая проверка — каждая точка
+// результата на расстоянии |d| от исходного пути, цепочка без разрывов.
+
+#include "OffsetCurve.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using PathEngine::Seg;
+using PathEngine::kPI;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+const double kEps = 1e-9;
+
+Seg Line (double x0, double y0, double x1, double y1)
+{
+	Seg s;
+	s.kind = Seg::Line;
+	s.a = { x0, y0 };
+	s.b = { x1, y1 };
+	s.L = std::hypot (x1 - x0, y1 - y0);
+	return s;
+}
+
+Seg Arc (double cx, double cy, double r, double a0, double sweep)
+{
+	Seg s;
+	s.kind = Seg::Arc;
+	s.c = { cx, cy };
+	s.r = r;
+	s.a0 = a0;
+	s.a1 = a0 + sweep;
+	s.L = r * std::fabs (sweep);
+	return s;
+}
+
+// Ломаная по вершинам
+std::vector<Seg> Polyline (const std::vector<API_Coord>& pts)
+{
+	std::vector<Seg> segs;
+	for (size_t i = 1; i < pts.size (); ++i)
+		segs.push_back (Line (pts[i - 1].x, pts[i - 1].y, pts[i].x, pts[i].y));
+	return segs;
+}
+
+API_Coord PointAt (const Seg& s, double t)
+{
+	if (s.kind == Seg::Line)
+		return { s.a.x + (s.b.x - s.a.x) * t, s.a.y + (s.b.y - s.a.y) * t };
+	const double a = s.a0 + (s.a1 - s.a0) * t;
+	return { s.c.x + s.r * std::cos (a), s.c.y + s.r * std::sin (a) };
+}
+
+double Dist (const API_Coord& p, const API_Coord& q)
+{
+	return std::hypot (q.x - p.x, q.y - p.y);
+}
+
+double DistToSeg (const Seg& s, const API_Coord& p)
+{
+	if (s.kind == Seg::Line) {
+		const double rx = s.b.x - s.a.x, ry = s.b.y - s.a.y;
+		double t = ((p.x - s.a.x) * rx + (p.y - s.a.y) * ry) / (rx * rx + ry * ry);
+		t = std::fmin (std::fmax (t, 0.0), 1.0);
+		return Dist (p, PointAt (s, t));
+	}
+	// угол p внутри дуги — до окружности, иначе до ближайшего конца
+	const double sweep = s.a1 - s.a0;
+	double delta = std::atan2 (p.y - s.c.y, p.x - s.c.x) - s.a0;
+	if (sweep < 0.0) delta = -delta;
+	delta = std::fmod (delta, 2.0 * kPI);
+	if (delta < 0.0) delta += 2.0 * kPI;
+	if (delta <= std::fabs (sweep))
+		return std::fabs (Dist (p, s.c) - s.r);
+	return std::fmin (Dist (p, PointAt (s, 0.0)), Dist (p, PointAt (s, 1.0)));
+}
+
+double DistToPath (const std::vector<Seg>& path, const API_Coord& p)
+{
+	double best = 1e300;
+	for (const Seg& s : path) best = std::fmin (best, DistToSeg (s, p));
+	return best;
+}
+
+double Length (const std::vector<Seg>& segs)
+{
+	double sum = 0.0;
+	for (const Seg& s : segs) sum += s.L;
+	return sum;
+}
+
+// Цепочка без разрывов (closed — и последний к первому) и каждая точка на |d| от пути
+void CheckOffset (const char* name, const std::vector<Seg>& path, const std::vector<Seg>& out, double d, bool closed)
+{
+	CHECK (!out.empty (), "%s: пустой результат", name);
+	for (size_t k = 0; k + 1 < out.size (); ++k) {
+		const double gap = Dist (OffsetCurve::SegEnd (out[k]), OffsetCurve::SegStart (out[k + 1]));
+		CHECK (gap < 1e-7, "%s: разрыв %g после сегмента %zu", name, gap, k);
+	}
+	if (closed && !out.empty ()) {
+		const double gap = Dist (OffsetCurve::SegEnd (out.back ()), OffsetCurve::SegStart (out.front ()));
+		CHECK (gap < 1e-7, "%s: контур не замкнут (%g)", name, gap);
+	}
+	double worst = 0.0;
+	for (const Seg& s : out) {
+		const double L = s.kind == Seg::Line ? Dist (s.a, s.b) : s.r * std::fabs (s.a1 - s.a0);
+		CHECK (std::fabs (s.L - L) < kEps, "%s: L = %g, по геометрии %g", name, s.L, L);
+		for (int i = 0; i <= 16; ++i)
+			worst = std::fmax (worst, std::fabs (DistToPath (path, PointAt (s, i / 16.0)) - std::fabs (d)));
+	}
+	CHECK (worst < 1e-7, "%s: отклонение от |d| = %g", name, worst);
+}
+
+// =============================================================================
+// Отдельные сегменты
+// =============================================================================
+
+void TestLine ()
+{
+	const std::vector<Seg> path = { Line (0, 0, 10, 0) };
+	OffsetCurve::Options opt;
+	std::vector<Seg> out;
+
+	// d > 0 — влево по ходу
+	CHECK (OffsetCurve::Offset (path, 2.0, opt, out), "отрезок влево: Offset");
+	CHECK (out.size () == 1 && out[0].kind == Seg::Line && Dist (out[0].a, { 0, 2 }) < kEps && Dist (out[0].b, { 10, 2 }) < kEps,
+		   "отрезок влево: сегментов %zu", out.size ());
+
+	CHECK (OffsetCurve::Offset (path, -2.0, opt, out), "отрезок вправо: Offset");
+	CHECK (out.size () == 1 && Dist (out[0].a, { 0, -2 }) < kEps && Dist (out[0].b, { 10, -2 }) < kEps, "отрезок вправо");
+
+	// d = 0 — копия пути
+	CHECK (OffsetCurve::Offset (path, 0.0, opt, out) && out.size () == 1 && Dist (out[0].b, { 10, 0 }) < kEps, "d = 0");
+
+	// пустой путь
+	CHECK (!OffsetCurve::Offset ({}, 1.0, opt, out) && out.empty (), "пустой путь");
+}
+
+void TestArc ()
+{
+	OffsetCurve::Options opt;
+	std::vector<Seg> out;
+
+	// CCW-дуга: влево — к центру, радиус меньше; вправо — больше
+	const std::vector<Seg> ccw = { Arc (0, 0, 10, 0.0, kPI / 2.0) };
+	CHECK (OffsetCurve::Offset (ccw, 2.0, opt, out), "CCW влево: Offset");
+	CHECK (out.size () == 1 && out[0].kind == Seg::Arc && std::fabs (out[0].r - 8.0) < kEps &&
+		   std::fabs (out[0].L - 8.0 * kPI / 2.0) < kEps, "CCW влево: r = %g", out.empty () ? 0.0 : out[0].r);
+	CHECK (OffsetCurve::Offset (ccw, -2.0, opt, out) && out.size () == 1 && std::fabs (out[0].r - 12.0) < kEps, "CCW вправо");
+
+	// CW-дуга — наоборот
+	const std::vector<Seg> cw = { Arc (0, 0, 10, kPI / 2.0, -kPI / 2.0) };
+	CHECK (OffsetCurve::Offset (cw, 2.0, opt, out) && out.size () == 1 && std::fabs (out[0].r - 12.0) < kEps, "CW влево");
+	CHECK (OffsetCurve::Offset (cw, -2.0, opt, out) && out.size () == 1 && std::fabs (out[0].r - 8.0) < kEps, "CW вправо");
+
+	// радиус не больше |d| на внутренней стороне — дуга схлопывается
+	OffsetCurve::Stats st;
+	CHECK (!OffsetCurve::Offset (ccw, 10.0, opt, out, &st) && st.collapsedArcs == 1, "схлопнувшаяся дуга: %u", st.collapsedArcs);
+
+	// петля 270° радиусом 0.5 между отрезками схлопывается при d = 1; стык
+	// отрезков — скругление вокруг конца первого из них, от конца его сдвига
+	const std::vector<Seg> loop = { Line (0, 0, 10, 0), Arc (10, 0.5, 0.5, -kPI / 2.0, 1.5 * kPI), Line (9.5, 0.5, 9.5, -10) };
+	st = {};
+	CHECK (OffsetCurve::Offset (loop, 1.0, opt, out, &st) && st.collapsedArcs == 1 && st.joinsRound == 1,
+		   "стык после схлопнувшейся дуги: дуг %u, скруглений %u", st.collapsedArcs, st.joinsRound);
+	CHECK (out.size () >= 2 && out[1].kind == Seg::Arc && Dist (out[1].c, { 10, 0 }) < kEps && std::fabs (out[1].r - 1.0) < kEps &&
+		   Dist (OffsetCurve::SegStart (out[1]), OffsetCurve::SegEnd (out[0])) < kEps,
+		   "стык после схлопнувшейся дуги: скругление не от конца сдвига");
+}
+
+// =============================================================================
+// Стыки
+// =============================================================================
+
+void TestRoundJoin ()
+{
+	// поворот влево на 90°: справа — внешний угол, скругление радиусом |d| вокруг вершины
+	const std::vector<Seg> path = Polyline ({ { 0, 0 }, { 10, 0 }, { 10, 10 } });
+	OffsetCurve::Options opt;
+	OffsetCurve::Stats st;
+	std::vector<Seg> out;
+	CHECK (OffsetCurve::Offset (path, -1.0, opt, out, &st), "скругление: Offset");
+	CHECK (out.size () == 3 && out[1].kind == Seg::Arc && Dist (out[1].c, { 10, 0 }) < kEps &&
+		   std::fabs (out[1].r - 1.0) < kEps && std::fabs (out[1].a1 - out[1].a0 - kPI / 2.0) < kEps,
+		   "скругление: сегментов %zu", out.size ());
+	CHECK (st.joinsRound == 1 && st.joinsMiter == 0 && st.joinsInner == 0, "скругление: стыков %u/%u/%u", st.joinsRound, st.joinsMiter, st.joinsInner);
+	CheckOffset ("скругление", path, out, -1.0, false);
+	CHECK (std::fabs (Length (out) - (20.0 + kPI / 2.0)) < 1e-9, "скругление: длина %g", Length (out));
+
+	// слева — внутренний угол: отрезки обрезаются по пересечению
+	st = {};
+	CHECK (OffsetCurve::Offset (path, 1.0, opt, out, &st), "внутренний угол: Offset");
+	CHECK (out.size () == 2 && Dist (out[0].b, { 9, 1 }) < kEps && Dist (out[1].a, { 9, 1 }) < kEps, "внутренний угол: сегментов %zu", out.size ());
+	CHECK (st.joinsInner == 1, "внутренний угол: стыков %u", st.joinsInner);
+	CheckOffset ("внутренний угол", path, out, 1.0, false);
+
+	// излом меньше допуска хорды — митра без дуги даже при Round
+	const std::vector<Seg> gentle = Polyline ({ { 0, 0 }, { 10, 0 }, { 20, 0.001 } });
+	st = {};
+	CHECK (OffsetCurve::Offset (gentle, -1.0, opt, out, &st) && st.joinsRound == 0 && st.joinsMiter == 1 && out.size () == 2,
+		   "малый излом: стыков %u/%u, сегментов %zu", st.joinsRound, st.joinsMiter, out.size ());
+}
+
+void TestMiterJoin ()
+{
+	const std::vector<Seg> path = Polyline ({ { 0, 0 }, { 10, 0 }, { 10, 10 } });
+	OffsetCurve::Options opt;
+	opt.join = OffsetCurve::JoinType::Miter;
+	OffsetCurve::Stats st;
+	std::vector<Seg> out;
+
+	// 90°: отношение √2 < miterLimit 2 — отрезки продлеваются до точки митры
+	CHECK (OffsetCurve::Offset (path, -1.0, opt, out, &st), "митра: Offset");
+	CHECK (out.size () == 2 && Dist (out[0].b, { 11, -1 }) < kEps && Dist (out[1].a, { 11, -1 }) < kEps && st.joinsMiter == 1,
+		   "митра: сегментов %zu", out.size ());
+
+	// острый поворот на 150°: митра длиннее miterLimit — срез отрезком между концами
+	const double a = kPI * 150.0 / 180.0;
+	const std::vector<Seg> sharp = Polyline ({ { 0, 0 }, { 10, 0 }, { 10 + 10 * std::cos (a), 10 * std::sin (a) } });
+	st = {};
+	CHECK (OffsetCurve::Offset (sharp, -1.0, opt, out, &st), "срез: Offset");
+	CHECK (out.size () == 3 && Dist (out[1].a, { 10, -1 }) < kEps && Dist (out[1].b, { 10 + std::sin (a), -std::cos (a) }) < kEps,
+		   "срез: сегментов %zu", out.size ());
+
+	// тот же угол с большим пределом — митра: вершина на |d| / cos(θ/2) от угла пути
+	opt.miterLimit = 10.0;
+	CHECK (OffsetCurve::Offset (sharp, -1.0, opt, out) && out.size () == 2, "большой предел: сегментов %zu", out.size ());
+	CHECK (out.size () == 2 && Dist (out[0].b, out[1].a) < kEps && std::fabs (Dist (out[0].b, { 10, 0 }) - 1.0 / std::cos (a / 2.0)) < 1e-9,
+		   "большой предел: вершина митры");
+}
+
+void TestArcJoins ()
+{
+	// отрезок, касательная дуга, отрезок — стыки гладкие, лишних сегментов нет
+	const std::vector<Seg> path = { Line (0, 0, 10, 0), Arc (10, 5, 5, -kPI / 2.0, kPI), Line (10, 10, 0, 10) };
+	OffsetCurve::Options opt;
+	OffsetCurve::Stats st;
+	std::vector<Seg> out;
+	for (double d : { 1.0, -1.0 }) {
+		st = {};
+		CHECK (OffsetCurve::Offset (path, d, opt, out, &st), "гладкие стыки d=%g: Offset", d);
+		CHECK (out.size () == 3 && st.joinsRound + st.joinsMiter + st.joinsInner == 0, "гладкие стыки d=%g: сегментов %zu", d, out.size ());
+		CheckOffset ("гладкие стыки", path, out, d, false);
+	}
+}
+
+// =============================================================================
+// Петли и замкнутые контуры
+// =============================================================================
+
+void TestLoops ()
+{
+	// U-поворот уже 2|d|: сдвиги внутренней стороны заходят за ось — петля срезается
+	const std::vector<Seg> path = Polyline ({ { 0, 0 }, { 10, 0 }, { 10, 1 }, { 0, 1 } });
+	OffsetCurve::Options opt;
+	OffsetCurve::Stats st;
+	std::vector<Seg> out;
+	CHECK (OffsetCurve::Offset (path, 2.0, opt, out, &st), "петля: Offset");
+	CHECK (st.loopsRemoved == 1 && out.size () == 4, "петля: срезано %u, сегментов %zu", st.loopsRemoved, out.size ());
+	CHECK (out.size () == 4 && Dist (out[1].b, { 8.5, 0.5 }) < 1e-9 && Dist (out[2].a, { 8.5, 0.5 }) < 1e-9, "петля: точка среза");
+
+	// широкий U-поворот — петель нет, внешняя сторона цела
+	const std::vector<Seg> wide = Polyline ({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } });
+	st = {};
+	CHECK (OffsetCurve::Offset (wide, 2.0, opt, out, &st) && st.loopsRemoved == 0 && out.size () == 3, "широкий поворот: срезано %u", st.loopsRemoved);
+	CheckOffset ("широкий поворот", wide, out, 2.0, false);
+	st = {};
+	CHECK (OffsetCurve::Offset (wide, -2.0, opt, out, &st) && st.loopsRemoved == 0 && st.joinsRound == 2, "внешняя сторона: стыков %u", st.joinsRound);
+	CheckOffset ("внешняя сторона", wide, out, -2.0, false);
+
+	// путь сам себя пересекает — петля настоящая, сдвиг её сохраняет
+	const std::vector<Seg> crossing = Polyline ({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 5, 10 }, { 5, -5 } });
+	st = {};
+	CHECK (OffsetCurve::Offset (crossing, 0.5, opt, out, &st) && st.loopsRemoved == 0 && out.size () == 4,
+		   "петля пути: срезано %u, сегментов %zu", st.loopsRemoved, out.size ());
+	CHECK (out.size () == 4 && Dist (out[3].a, { 5.5, 9.5 }) < kEps && Dist (out[3].b, { 5.5, -5 }) < kEps, "петля пути: последний сегмент");
+}
+
+void TestClosed ()
+{
+	// квадрат против часовой: вправо — наружу (4 скругления), влево — внутрь
+	const std::vector<Seg> square = Polyline ({ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 0, 0 } });
+	OffsetCurve::Options opt;
+	opt.closed = true;
+	OffsetCurve::Stats st;
+	std::vector<Seg> out;
+
+	CHECK (OffsetCurve::Offset (square, -1.0, opt, out, &st), "наружу: Offset");
+	CHECK (st.joinsRound == 4 && out.size () == 8, "наружу: стыков %u, сегментов %zu", st.joinsRound, out.size ());
+	CHECK (std::fabs (Length (out) - (40.0 + 2.0 * kPI)) < 1e-9, "наружу: длина %g", Length (out));
+	CheckOffset ("наружу", square, out, -1.0, true);
+
+	st = {};
+	CHECK (OffsetCurve::Offset (square, 1.0, opt, out, &st), "внутрь: Offset");
+	CHECK (st.joinsInner == 4 && out.size () == 4 && std::fabs (Length (out) - 32.0) < 1e-9,
+		   "внутрь: стыков %u, сегментов %zu, длина %g", st.joinsInner, out.size (), Length (out));
+	CheckOffset ("внутрь", square, out, 1.0, true);
+
+	// окружность одной дугой
+	const std::vector<Seg> circle = { Arc (0, 0, 5, 0.0, 2.0 * kPI) };
+	CHECK (OffsetCurve::Offset (circle, 1.0, opt, out) && out.size () == 1 && std::fabs (out[0].r - 4.0) < kEps, "окружность");
+}
+
+} // namespace
+
+int main ()
+{
+	TestLine ();
+	TestArc ();
+	TestRoundJoin ();
+	TestMiterJoin ();
+	TestArcJoins ();
+	TestLoops ();
+	TestClosed ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+// Разбор файлов точек: строки через границы порций, BOM, CRLF, выбор
+// разделителя, десятичная запятая, порядок колонок, одинаковый результат
+// в 1 и N потоков, отмена через progress и пустой файл.
+
+#include "PointFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace PointFile;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+bool Same (const Point& a, const Point& b)
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+bool ReadText (const std::string& text, const Layout& layout, std::vector<Point>& out, Stats* stats = nullptr, unsigned threads = 1)
+{
+	return Read (text.data (), text.size (), layout, out, stats, nullptr, threads);
+}
+
+// =============================================================================
+// Формат строк
+// =============================================================================
+
+void TestBomAndCrlf ()
+{
+	Layout layout;
+	layout.delimiter = ';';
+	std::vector<Point> pts;
+	Stats st;
+
+	// BOM перед числом: без его снятия первое поле не число
+	CHECK (ReadText ("\xEF\xBB\xBF" "1;2;3\n4;5;6", layout, pts, &st), "BOM: Read");
+	CHECK (pts.size () == 2 && Same (pts[0], { 1, 2, 3 }) && Same (pts[1], { 4, 5, 6 }), "BOM: точек %zu", pts.size ());
+	CHECK (st.lines == 2 && st.skipped == 0, "BOM: строк %llu, пропущено %llu", (unsigned long long) st.lines, (unsigned long long) st.skipped);
+
+	// CRLF: '\r' не портит последнее поле, пустые строки не считаются
+	CHECK (ReadText ("X;Y;Z\r\n1.5;2.5;3.5\r\n\r\n  \r\n4;5;6\r\n", layout, pts, &st), "CRLF: Read");
+	CHECK (pts.size () == 2 && Same (pts[0], { 1.5, 2.5, 3.5 }) && Same (pts[1], { 4, 5, 6 }), "CRLF: точек %zu", pts.size ());
+	CHECK (st.lines == 3 && st.skipped == 1, "CRLF: строк %llu, пропущено %llu", (unsigned long long) st.lines, (unsigned long long) st.skipped);
+
+	// пробелы подряд — один разделитель, CRLF и табуляции по краям
+	layout.delimiter = ' ';
+	CHECK (ReadText ("  10   20\t30 \r\n-1e2 +2.5E-1 .5\r\n", layout, pts), "пробелы: Read");
+	CHECK (pts.size () == 2 && Same (pts[0], { 10, 20, 30 }) && Same (pts[1], { -100, 0.25, 0.5 }), "пробелы: точек %zu", pts.size ());
+
+	// поля в кавычках; лишний текст в числе — строка пропускается
+	layout.delimiter = ',';
+	CHECK (ReadText ("\"1\",\"2\",\"3\"\n1,2,3m\n1,2\n", layout, pts, &st), "кавычки: Read");
+	CHECK (pts.size () == 1 && Same (pts[0], { 1, 2, 3 }) && st.skipped == 2, "кавычки: точек %zu, пропущено %llu", pts.size (), (unsigned long long) st.skipped);
+}
+
+void TestDecimalComma ()
+{
+	Layout layout;
+	layout.delimiter = ';';
+	layout.decimal   = ',';
+	std::vector<Point> pts;
+	CHECK (ReadText ("1,5;2,25;-3,125\n7;8;9,0\n", layout, pts), "запятая: Read");
+	CHECK (pts.size () == 2 && Same (pts[0], { 1.5, 2.25, -3.125 }) && Same (pts[1], { 7, 8, 9 }), "запятая: точек %zu", pts.size ());
+
+	// с десятичной запятой точка — не число
+	CHECK (ReadText ("1.5;2;3\n", layout, pts) && pts.empty (), "запятая: точка принята за дробную часть");
+}
+
+void TestColumns ()
+{
+	// PENZD: номер, N (y), E (x), отметка, описание
+	Layout layout;
+	layout.delimiter = ',';
+	layout.xCol = 2;
+	layout.yCol = 1;
+	layout.zCol = 3;
+	std::vector<Point> pts;
+	CHECK (ReadText ("1,5000.1,3000.2,125.4,ПК1\n2,5001,3001,126,\n", layout, pts), "PENZD: Read");
+	CHECK (pts.size () == 2 && Same (pts[0], { 3000.2, 5000.1, 125.4 }) && Same (pts[1], { 3001, 5001, 126 }), "PENZD: точек %zu", pts.size ());
+}
+
+void TestDetectDelimiter ()
+{
+	struct Case {
+		const char* text;
+		char        decimal;
+		char        expected;
+	};
+	const Case kCases[] = {
+		{ "1\t2\t3\n4\t5\t6\n",               '.', '\t' },
+		{ "X;Y;Z\n1;2;3\n4;5;6\n",            '.', ';'  },
+		{ "1,2,3\n4,5,6\n",                   '.', ','  },
+		{ "1,5 2,5 3,5\n4,5 5,5 6,5\n",       ',', ' '  },   // запятая — дробная часть
+		{ "1;2,5;3\n4;5,5;6\n",               ',', ';'  },
+		{ "1 2 3\n4 5 6\n",                   '.', ' '  },
+		{ "# съёмка 2024\n1;2;3\n4;5;6\n7;8;9\n", '.', ';' },   // строка без разделителя допустима
+		{ "",                                 '.', ' '  },
+	};
+	for (const Case& c : kCases) {
+		const char got = DetectDelimiter (c.text, std::strlen (c.text), c.decimal);
+		CHECK (got == c.expected, "DetectDelimiter '%s': '%c', ожидалось '%c'", c.text, got, c.expected);
+	}
+
+	// delimiter = 0 — выбирается при чтении и сообщается в Stats
+	Layout layout;
+	std::vector<Point> pts;
+	Stats st;
+	CHECK (ReadText ("\xEF\xBB\xBF" "1\t2\t3\n4\t5\t6\n", layout, pts, &st), "авто: Read");
+	CHECK (st.delimiter == '\t' && pts.size () == 2, "авто: разделитель '%c', точек %zu", st.delimiter, pts.size ());
+}
+
+// =============================================================================
+// Порции и потоки
+// =============================================================================
+
+// Строки с номером i в полях — по точке легко понять, какая строка потерялась
+std::string Line (std::size_t i)
+{
+	char buf[96];
+	std::snprintf (buf, sizeof (buf), "%zu;%zu.25;-%zu.5\r\n", i, i * 3, i % 1000);
+	return buf;
+}
+
+Point Expected (std::size_t i)
+{
+	return { (double) i, (double) (i * 3) + 0.25, -((double) (i % 1000) + 0.5) };
+}
+
+// Строки до байта target: последняя дополняется пробелами, чтобы кончиться точно на target
+std::string FillTo (std::size_t target, std::size_t& index)
+{
+	std::string text;
+	for (;;) {
+		const std::string line = Line (index);
+		if (text.size () + line.size () + 32 > target) break;
+		text += line;
+		++index;
+	}
+	std::string last = Line (index++);
+	last.insert (0, target - text.size () - last.size (), ' ');
+	return text + last;
+}
+
+void TestChunks ()
+{
+	// Граница первой порции — сразу после '\n', второй — внутри строки,
+	// третьей — между '\r' и '\n'; последняя строка без перевода строки
+	std::size_t count = 0;
+	std::string text = FillTo (kChunkBytes, count);
+	text += FillTo (2 * kChunkBytes + 20 - text.size (), count);
+	text += FillTo (3 * kChunkBytes + 1 - text.size (), count);
+	CHECK (text[kChunkBytes - 1] == '\n' && text[2 * kChunkBytes] != '\n' && text[2 * kChunkBytes - 1] != '\n' &&
+		   text[3 * kChunkBytes - 1] == '\r' && text[3 * kChunkBytes] == '\n', "границы порций построены неверно");
+	text += "1;2;3";
+
+	Layout layout;
+	layout.delimiter = ';';
+	std::vector<Point> one, many;
+	Stats st1, stN;
+	CHECK (Read (text.data (), text.size (), layout, one, &st1, nullptr, 1), "1 поток: Read");
+	CHECK (Read (text.data (), text.size (), layout, many, &stN, nullptr, 4), "4 потока: Read");
+	CHECK (st1.chunks == 4 && stN.threads == 4, "порций %u, потоков %u", st1.chunks, stN.threads);
+
+	CHECK (one.size () == count + 1, "1 поток: точек %zu, ожидалось %zu", one.size (), count + 1);
+	std::size_t wrong = 0;
+	for (std::size_t i = 0; i < count && i < one.size (); ++i)
+		if (!Same (one[i], Expected (i)) && wrong++ == 0)
+			CHECK (false, "точка %zu: %g %g %g", i, one[i].x, one[i].y, one[i].z);
+	CHECK (!one.empty () && Same (one.back (), { 1, 2, 3 }), "последняя строка без перевода строки потеряна");
+	CHECK (st1.lines == count + 1 && st1.skipped == 0, "строк %llu, пропущено %llu", (unsigned long long) st1.lines, (unsigned long long) st1.skipped);
+
+	// N потоков — те же точки в том же порядке
+	bool same = one.size () == many.size () && st1.lines == stN.lines && st1.skipped == stN.skipped;
+	for (std::size_t i = 0; same && i < one.size (); ++i)
+		same = Same (one[i], many[i]);
+	CHECK (same, "1 и 4 потока дают разный результат (%zu и %zu точек)", one.size (), many.size ());
+
+	// threads = 0 — по числу ядер, но не больше порций
+	std::vector<Point> autoThreads;
+	Stats stA;
+	CHECK (Read (text.data (), text.size (), layout, autoThreads, &stA) && autoThreads.size () == one.size () && stA.threads <= stA.chunks,
+		   "threads=0: точек %zu, потоков %u", autoThreads.size (), stA.threads);
+}
+
+void TestCancel ()
+{
+	std::size_t count = 0;
+	std::string text;
+	while (text.size () < 3 * kChunkBytes) text += Line (count++);
+
+	Layout layout;
+	layout.delimiter = ';';
+	for (unsigned threads : { 1u, 4u }) {
+		std::vector<Point> out = { { 7, 7, 7 } };
+		unsigned calls = 0;
+		const bool ok = Read (text.data (), text.size (), layout, out, nullptr,
+			[&] (std::uint64_t done, std::uint64_t total) {
+				++calls;
+				return done < total / 3;   // отмена после первой порции
+			}, threads);
+		CHECK (!ok, "потоков %u: отмена не сработала", threads);
+		CHECK (calls >= 1, "потоков %u: progress не вызывался", threads);
+		CHECK (out.size () == 1 && Same (out[0], { 7, 7, 7 }), "потоков %u: out изменён при отмене", threads);
+	}
+
+	// без отмены последний вызов — (total, total)
+	std::uint64_t lastDone = 0, lastTotal = 1;
+	std::vector<Point> out;
+	CHECK (Read (text.data (), text.size (), layout, out, nullptr,
+		[&] (std::uint64_t done, std::uint64_t total) { lastDone = done; lastTotal = total; return true; }, 2),
+		"progress: Read");
+	CHECK (lastDone == lastTotal && lastTotal == text.size (), "progress: последний вызов %llu/%llu",
+		   (unsigned long long) lastDone, (unsigned long long) lastTotal);
+}
+
+void TestEmpty ()
+{
+	// пустой файл не отображается: data == nullptr
+	Layout layout;
+	std::vector<Point> out = { { 1, 2, 3 } };
+	Stats st;
+	bool called = false;
+	CHECK (Read (nullptr, 0, layout, out, &st, [&] (std::uint64_t, std::uint64_t) { called = true; return true; }),
+		   "пустой: Read");
+	CHECK (out.empty () && st.lines == 0 && called, "пустой: точек %zu, строк %llu", out.size (), (unsigned long long) st.lines);
+	CHECK (DetectDelimiter (nullptr, 0, '.') == ' ', "пустой: DetectDelimiter");
+
+	// только BOM и пустые строки
+	CHECK (ReadText ("\xEF\xBB\xBF\r\n\n", layout, out, &st) && out.empty () && st.lines == 0, "BOM без строк");
+}
+
+} // namespace
+
+int main ()
+{
+	TestBomAndCrlf ();
+	TestDecimalComma ();
+	TestColumns ();
+	TestDetectDelimiter ();
+	TestChunks ();
+	TestCancel ();
+	TestEmpty ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}
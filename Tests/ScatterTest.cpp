@@ -0,0 +1,328 @@
+// Область по контурам и раскладка точек в ней: чёт-нечет с отверстием,
+// пролёты по горизонтали, дуги контура, поворот; пуассоновский диск —
+// все точки в области и не ближе радиуса, одинаковая раскладка при том же
+// seed, несвязные части и отверстия; решётки — число узлов и шаг.
+
+#include "Scatter.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using PathEngine::Seg;
+using PathEngine::kPI;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...) \
+	do { if (!(cond)) { ++g_failures; std::printf ("FAIL %s:%d: ", __FILE__, __LINE__); std::printf (__VA_ARGS__); std::printf ("\n"); } } while (0)
+
+void AddLine (std::vector<Seg>& segs, double x0, double y0, double x1, double y1)
+{
+	Seg s;
+	s.kind = Seg::Line;
+	s.a = { x0, y0 };
+	s.b = { x1, y1 };
+	s.L = std::hypot (x1 - x0, y1 - y0);
+	segs.push_back (s);
+}
+
+void AddRect (std::vector<Seg>& segs, double x0, double y0, double x1, double y1)
+{
+	AddLine (segs, x0, y0, x1, y0);
+	AddLine (segs, x1, y0, x1, y1);
+	AddLine (segs, x1, y1, x0, y1);
+	AddLine (segs, x0, y1, x0, y0);
+}
+
+void AddCircle (std::vector<Seg>& segs, double cx, double cy, double r)
+{
+	Seg s;
+	s.kind = Seg::Arc;
+	s.c = { cx, cy };
+	s.r = r;
+	s.a0 = 0.0;
+	s.a1 = 2.0 * kPI;
+	s.L = 2.0 * kPI * r;
+	segs.push_back (s);
+}
+
+Boundary::Region MakeRegion (const std::vector<Seg>& segs, double chordTolM = PathEngine::kDefaultChordTolM)
+{
+	Boundary::Region region;
+	CHECK (region.Assign (segs, chordTolM), "Region::Assign");
+	return region;
+}
+
+// Квадрат 10×10 с квадратным отверстием 4×4 посередине
+Boundary::Region SquareWithHole ()
+{
+	std::vector<Seg> segs;
+	AddRect (segs, 0, 0, 10, 10);
+	AddRect (segs, 3, 3, 7, 7);
+	return MakeRegion (segs);
+}
+
+double MinPairDist (const std::vector<API_Coord>& pts)
+{
+	double best = 1e300;
+	for (size_t i = 0; i < pts.size (); ++i)
+		for (size_t j = i + 1; j < pts.size (); ++j)
+			best = std::fmin (best, std::hypot (pts[i].x - pts[j].x, pts[i].y - pts[j].y));
+	return best;
+}
+
+// =============================================================================
+// Boundary
+// =============================================================================
+
+void TestRegion ()
+{
+	const Boundary::Region region = SquareWithHole ();
+	CHECK (region.GetEdgeCount () == 8, "рёбер %zu", region.GetEdgeCount ());
+	const API_Box& box = region.GetBox ();
+	CHECK (box.xMin == 0 && box.yMin == 0 && box.xMax == 10 && box.yMax == 10, "габарит");
+
+	struct Probe {
+		double x, y;
+		bool   inside;
+	};
+	const Probe kProbes[] = {
+		{ 1, 1, true }, { 9.5, 5, true }, { 5, 1.5, true }, { 5, 8, true },
+		{ 5, 5, false }, { 3.5, 6.5, false },             // отверстие
+		{ -1, 5, false }, { 11, 5, false }, { 5, -0.5, false }, { 5, 10.5, false },
+	};
+	for (const Probe& p : kProbes)
+		CHECK (region.Contains (p.x, p.y) == p.inside, "Contains (%g, %g) != %d", p.x, p.y, p.inside);
+
+	std::vector<double> spans;
+	region.Spans (5.0, spans);
+	CHECK (spans.size () == 4 && spans[0] == 0 && spans[1] == 3 && spans[2] == 7 && spans[3] == 10, "пролёты через отверстие: %zu", spans.size ());
+	region.Spans (1.0, spans);
+	CHECK (spans.size () == 2 && spans[0] == 0 && spans[1] == 10, "пролёт под отверстием: %zu", spans.size ());
+	region.Spans (12.0, spans);
+	CHECK (spans.empty (), "пролёты вне области");
+
+	// горизонталь через вершины ромба: общая вершина двух рёбер — одно пересечение
+	std::vector<Seg> diamond;
+	AddLine (diamond, 5, 0, 10, 5);
+	AddLine (diamond, 10, 5, 5, 10);
+	AddLine (diamond, 5, 10, 0, 5);
+	AddLine (diamond, 0, 5, 5, 0);
+	const Boundary::Region rhomb = MakeRegion (diamond);
+	rhomb.Spans (5.0, spans);
+	CHECK (spans.size () == 2 && spans[0] == 0 && spans[1] == 10, "ромб: пролётов %zu", spans.size () / 2);
+	CHECK (rhomb.Contains (5, 5) && rhomb.Contains (9, 5) && !rhomb.Contains (5, 0.5 - 1.0), "ромб: Contains на уровне вершин");
+
+	// поворот на 90° вокруг (0, 0): квадрат переходит в [-10, 0] × [0, 10]
+	Boundary::Region rotated = region;
+	rotated.Rotate (kPI / 2.0, { 0, 0 });
+	CHECK (rotated.Contains (-1, 1) && !rotated.Contains (1, 1) && !rotated.Contains (-5, 5) && rotated.Contains (-9, 9), "поворот: Contains");
+	CHECK (std::fabs (rotated.GetBox ().xMin + 10) < 1e-9 && std::fabs (rotated.GetBox ().xMax) < 1e-9, "поворот: габарит");
+
+	// пустой контур и чтение элемента без API
+	Boundary::Region empty;
+	CHECK (!empty.Assign ({}) && empty.IsEmpty () && !empty.Contains (0, 0), "пустая область");
+	CHECK (!empty.Build (API_Guid {}) && empty.IsEmpty (), "Build без элемента");
+	CHECK (Boundary::IsBoundaryType (API_HatchID) && Boundary::IsBoundaryType (API_SplineID) && !Boundary::IsBoundaryType (API_LineID), "IsBoundaryType");
+}
+
+void TestRegionArcs ()
+{
+	// окружность спрямляется по допуску хорды: граница не дальше допуска от дуги
+	for (double tol : { 0.1, 0.01, 0.001 }) {
+		std::vector<Seg> segs;
+		AddCircle (segs, 0, 0, 5);
+		const Boundary::Region region = MakeRegion (segs, tol);
+		const size_t edges = region.GetEdgeCount ();
+		CHECK (edges >= 8 && edges < 2.0 * kPI / (2.0 * std::acos (1.0 - tol / 5.0)) + 2, "допуск %g: рёбер %zu", tol, edges);
+		int wrong = 0;
+		for (int i = 0; i < 360; ++i) {
+			const double a = 2.0 * kPI * i / 360.0 + 0.001;
+			if (!region.Contains ((5.0 - tol * 1.01) * std::cos (a), (5.0 - tol * 1.01) * std::sin (a))) ++wrong;
+			if (region.Contains ((5.0 + 1e-9) * std::cos (a), (5.0 + 1e-9) * std::sin (a))) ++wrong;
+		}
+		CHECK (wrong == 0, "допуск %g: ошибок у границы %d", tol, wrong);
+	}
+}
+
+// =============================================================================
+// Scatter
+// =============================================================================
+
+void TestRng ()
+{
+	Scatter::Rng a (42), b (42), c (43);
+	bool same = true, differs = false, inRange = true;
+	for (int i = 0; i < 1000; ++i) {
+		const UInt64 va = a.Next ();
+		same = same && va == b.Next ();
+		differs = differs || va != c.Next ();
+		const double u = a.Uniform ();
+		b.Uniform ();
+		inRange = inRange && u >= 0.0 && u < 1.0;
+		const UInt32 k = a.Below (7);
+		b.Below (7);
+		inRange = inRange && k < 7;
+	}
+	CHECK (same, "один seed — разные последовательности");
+	CHECK (differs, "соседние seed дают одну последовательность");
+	CHECK (inRange, "Uniform/Below вне диапазона");
+
+	// первое число — та же константа на всех платформах
+	CHECK (Scatter::Rng (1).Next () == Scatter::Rng (1).Next () && Scatter::Rng (0).Next () != 0, "нулевое состояние");
+}
+
+void TestPoisson ()
+{
+	const Boundary::Region region = SquareWithHole ();
+	Scatter::PoissonParams pp;
+	pp.radiusM = 0.5;
+	pp.seed = 7;
+
+	std::vector<API_Coord> pts;
+	CHECK (Scatter::PoissonDisk (region, pp, pts), "PoissonDisk");
+	int outside = 0;
+	for (const API_Coord& p : pts)
+		if (!region.Contains (p.x, p.y)) ++outside;
+	CHECK (outside == 0, "точек вне области или в отверстии: %d", outside);
+	CHECK (MinPairDist (pts) >= pp.radiusM, "точки ближе радиуса: %g", MinPairDist (pts));
+
+	// плотность: площадь 84 м², плотная упаковка кругов r/2 — 2/(√3·r²) на м²
+	const double area = 100.0 - 16.0;
+	const double packed = area * 2.0 / (std::sqrt (3.0) * pp.radiusM * pp.radiusM);
+	CHECK (pts.size () > 0.5 * packed && pts.size () < packed, "точек %zu при плотной упаковке %.0f", pts.size (), packed);
+
+	// без пустот: каждая точка области не дальше 2r от ближайшей раскладки
+	int gaps = 0;
+	for (double y = 0.05; y < 10.0; y += 0.1)
+		for (double x = 0.05; x < 10.0; x += 0.1) {
+			if (!region.Contains (x, y)) continue;
+			double best = 1e300;
+			for (const API_Coord& p : pts) best = std::fmin (best, std::hypot (p.x - x, p.y - y));
+			if (best > 2.0 * pp.radiusM) ++gaps;
+		}
+	CHECK (gaps == 0, "пустот больше 2r: %d", gaps);
+
+	// тот же seed — та же раскладка, другой — другая
+	std::vector<API_Coord> again, other;
+	Scatter::PoissonDisk (region, pp, again);
+	pp.seed = 8;
+	Scatter::PoissonDisk (region, pp, other);
+	bool same = again.size () == pts.size ();
+	for (size_t i = 0; same && i < pts.size (); ++i)
+		same = pts[i].x == again[i].x && pts[i].y == again[i].y;
+	CHECK (same, "один seed — разные раскладки");
+	CHECK (other.size () != pts.size () || other[0].x != pts[0].x, "разные seed — одна раскладка");
+
+	// maxPoints
+	pp.maxPoints = 10;
+	CHECK (Scatter::PoissonDisk (region, pp, pts) && pts.size () == 10, "maxPoints: точек %zu", pts.size ());
+}
+
+void TestPoissonParts ()
+{
+	// две несвязные части — зерно в каждой
+	std::vector<Seg> segs;
+	AddRect (segs, 0, 0, 2, 2);
+	AddRect (segs, 20, 20, 22, 22);
+	const Boundary::Region region = MakeRegion (segs);
+	Scatter::PoissonParams pp;
+	pp.radiusM = 0.3;
+	std::vector<API_Coord> pts;
+	CHECK (Scatter::PoissonDisk (region, pp, pts), "части: PoissonDisk");
+	size_t left = 0, right = 0;
+	for (const API_Coord& p : pts) (p.x < 10 ? left : right)++;
+	CHECK (left > 10 && right > 10, "части: %zu и %zu точек", left, right);
+
+	// пустая область, нулевой радиус, слишком частая фоновая сетка
+	Boundary::Region empty;
+	CHECK (!Scatter::PoissonDisk (empty, pp, pts) && pts.empty (), "пустая область");
+	pp.radiusM = 0.0;
+	CHECK (!Scatter::PoissonDisk (region, pp, pts), "нулевой радиус");
+	pp.radiusM = 0.001;
+	CHECK (!Scatter::PoissonDisk (region, pp, pts), "фоновая сетка больше предела");
+}
+
+void TestLattice ()
+{
+	// квадрат 10.2 × 10.2: начало решётки — центр (5.1, 5.1), узлы 0.1 ... 10.1 — 11 × 11
+	std::vector<Seg> segs;
+	AddRect (segs, 0, 0, 10.2, 10.2);
+	Scatter::LatticeParams lp;
+	std::vector<API_Coord> pts;
+	auto collect = [&] (const API_Coord& p) { pts.push_back (p); };
+
+	UInt32 n = Scatter::Lattice (MakeRegion (segs), lp, collect);
+	CHECK (n == 121 && pts.size () == 121, "квадратная: узлов %u", n);
+	CHECK (!pts.empty () && std::fabs (pts[0].x - 0.1) < 1e-9 && std::fabs (pts[0].y - 0.1) < 1e-9, "квадратная: первый узел");
+	CHECK (std::fabs (MinPairDist (pts) - 1.0) < 1e-9, "квадратная: шаг %g", MinPairDist (pts));
+
+	// отверстие [3.65, 6.65]² закрывает узлы 4.1, 5.1, 6.1 по обеим осям
+	AddRect (segs, 3.65, 3.65, 6.65, 6.65);
+	const Boundary::Region holed = MakeRegion (segs);
+	pts.clear ();
+	n = Scatter::Lattice (holed, lp, collect);
+	CHECK (n == 112, "с отверстием: узлов %u", n);
+	int outside = 0;
+	for (const API_Coord& p : pts)
+		if (!holed.Contains (p.x, p.y)) ++outside;
+	CHECK (outside == 0, "с отверстием: вне области %d", outside);
+
+	// шестиугольная: ряды через step·√3/2, нечётные сдвинуты на полшага;
+	// ожидаемые узлы — перебором решётки с проверкой по прямоугольникам
+	const double dy = std::sqrt (3.0) * 0.5;
+	UInt32 expectedHex = 0;
+	for (int j = -10; j <= 10; ++j)
+		for (int i = -10; i <= 10; ++i) {
+			const double x = 5.1 + i + ((j & 1) != 0 ? 0.5 : 0.0), y = 5.1 + j * dy;
+			const bool inOuter = x >= 0 && x <= 10.2 && y >= 0 && y <= 10.2;
+			const bool inHole = x > 3.65 && x < 6.65 && y > 3.65 && y < 6.65;
+			if (inOuter && !inHole) ++expectedHex;
+		}
+	lp.kind = Scatter::LatticeKind::Hex;
+	pts.clear ();
+	n = Scatter::Lattice (holed, lp, collect);
+	CHECK (n == expectedHex && std::fabs (MinPairDist (pts) - 1.0) < 1e-9, "шестиугольная: узлов %u, ожидалось %u, шаг %g",
+		   n, expectedHex, MinPairDist (pts));
+	outside = 0;
+	for (const API_Coord& p : pts)
+		if (!holed.Contains (p.x, p.y)) ++outside;
+	CHECK (outside == 0, "шестиугольная: вне области %d", outside);
+
+	// повёрнутая решётка в круге: число узлов ≈ площадь / шаг², шаг сохраняется
+	std::vector<Seg> circle;
+	AddCircle (circle, 100, 50, 10);
+	lp.kind = Scatter::LatticeKind::Square;
+	lp.stepM = 0.5;
+	lp.angleRad = 0.3;
+	pts.clear ();
+	const Boundary::Region disk = MakeRegion (circle);
+	n = Scatter::Lattice (disk, lp, collect);
+	const double expected = kPI * 100.0 / 0.25;
+	CHECK (std::fabs (n - expected) < 0.02 * expected, "круг: узлов %u, ожидалось ≈%.0f", n, expected);
+	CHECK (std::fabs (MinPairDist (pts) - 0.5) < 1e-9, "круг: шаг %g", MinPairDist (pts));
+	// соседи по ряду — вдоль направления angleRad
+	CHECK (pts.size () > 1 && std::fabs (std::atan2 (pts[1].y - pts[0].y, pts[1].x - pts[0].x) - lp.angleRad) < 1e-9, "круг: направление рядов");
+
+	CHECK (Scatter::Lattice (Boundary::Region (), lp, collect) == 0, "пустая область");
+	lp.stepM = 0.0;
+	CHECK (Scatter::Lattice (disk, lp, collect) == 0, "нулевой шаг");
+}
+
+} // namespace
+
+int main ()
+{
+	TestRegion ();
+	TestRegionArcs ();
+	TestRng ();
+	TestPoisson ();
+	TestPoissonParts ();
+	TestLattice ();
+
+	std::printf (g_failures == 0 ? "OK\n" : "ошибок: %d\n", g_failures);
+	return g_failures == 0 ? 0 : 1;
+}